@@ -0,0 +1,54 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package com.sun.cldc.util;
+
+/**
+ * Bulk operations on arrays that the virtual machine implements with
+ * a single range check and a single block operation, instead of one
+ * bounds-checked bytecode per element.
+ * <p>
+ * Both operations work on arrays of any type.  Elements of arrays of
+ * objects are compared by reference.
+ */
+public final class Arrays {
+
+    private Arrays() {}
+
+    /**
+     * Sets the elements <code>from</code> to <code>to - 1</code> of an
+     * array to zero, or to <code>null</code> in an array of objects.
+     *
+     * @param array  the array
+     * @param from   index of the first element to clear
+     * @param to     index after the last element to clear
+     * @exception NullPointerException if <code>array</code> is null
+     * @exception IllegalArgumentException if <code>array</code> is not
+     *            an array
+     * @exception ArrayIndexOutOfBoundsException if the range is not
+     *            within the array
+     */
+    public static native void clear(Object array, int from, int to);
+
+    /**
+     * Compares <code>length</code> elements of two arrays of the same
+     * type, starting at <code>aOffset</code> and <code>bOffset</code>.
+     *
+     * @param a        the first array
+     * @param aOffset  index of the first element of <code>a</code>
+     * @param b        the second array
+     * @param bOffset  index of the first element of <code>b</code>
+     * @param length   the number of elements to compare
+     * @return <code>true</code> if the elements are equal
+     * @exception NullPointerException if an array is null
+     * @exception IllegalArgumentException if the arrays are not arrays
+     *            of the same type
+     * @exception ArrayIndexOutOfBoundsException if a range is not
+     *            within its array
+     */
+    public static native boolean regionEquals(Object a, int aOffset,
+                                              Object b, int bOffset,
+                                              int length);
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package com.sun.cldc.util;
+
+import java.io.IOException;
+
+/**
+ * Inspects the contents of the heap of the virtual machine, for
+ * diagnosing memory footprint problems.  Both operations collect the
+ * garbage first, so that only live objects are reported.
+ * <p>
+ * Heap inspection is only available if the virtual machine was built
+ * with it; otherwise both methods throw a RuntimeException.
+ */
+public final class HeapInspector {
+
+    private HeapInspector() {
+    }
+
+    /**
+     * Prints a histogram of the heap to the standard output: the
+     * number of objects and their total size in bytes for each
+     * class, largest first.
+     */
+    public static native void printHistogram();
+
+    /**
+     * Writes the contents of the heap to a file in the binary HPROF
+     * format, which can be opened with standard heap analyzers.
+     *
+     * @param fileName the name of the file to write
+     * @exception IOException if the file can't be written
+     */
+    public static native void dumpHeap(String fileName) throws IOException;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package com.sun.cldc.util;
+
+/**
+ * Gives access to the runtime metrics kept by the virtual machine,
+ * such as the number of garbage collections and their pause times,
+ * the number of bytes allocated and the number of thread switches.
+ * <p>
+ * The metrics are only available if the virtual machine was built
+ * with them; otherwise {@link #count()} returns 0.  The constants
+ * below must match the metric identifiers in the VM (metrics.h).
+ */
+public final class Metrics {
+
+    /** Milliseconds since the virtual machine was started */
+    public static final int UPTIME              = 0;
+
+    /** Number of garbage collections */
+    public static final int GC_COUNT            = 1;
+
+    /** Total time spent in garbage collection, in milliseconds */
+    public static final int GC_PAUSE_TOTAL      = 2;
+
+    /** Longest garbage collection pause, in milliseconds */
+    public static final int GC_PAUSE_MAX        = 3;
+
+    /** Most recent garbage collection pause, in milliseconds */
+    public static final int GC_PAUSE_LAST       = 4;
+
+    /** Number of bytes allocated in the heap since startup */
+    public static final int BYTES_ALLOCATED     = 5;
+
+    /** Number of objects allocated in the heap since startup */
+    public static final int OBJECTS_ALLOCATED   = 6;
+
+    /** Size of the heap in bytes */
+    public static final int HEAP_SIZE           = 7;
+
+    /** Free heap in bytes */
+    public static final int HEAP_FREE           = 8;
+
+    /** Number of classes loaded */
+    public static final int CLASSES_LOADED      = 9;
+
+    /** Number of thread switches */
+    public static final int THREAD_SWITCHES     = 10;
+
+    /** Number of inline cache hits */
+    public static final int ICACHE_HITS         = 11;
+
+    /** Number of inline cache misses */
+    public static final int ICACHE_MISSES       = 12;
+
+    /** Inline cache hit rate, in percent */
+    public static final int ICACHE_HIT_PERCENT  = 13;
+
+    /** Number of threads that are ready to run */
+    public static final int RUN_QUEUE_LENGTH    = 14;
+
+    /** Number of events waiting on the event queue */
+    public static final int EVENT_QUEUE_DEPTH   = 15;
+
+    /** Deepest execution stack use of any thread, in bytes */
+    public static final int STACK_HIGH_WATER    = 16;
+
+    /** Number of execution stack chunks allocated in the heap */
+    public static final int STACK_CHUNKS_ALLOCATED = 17;
+
+    /** Number of execution stack chunks reused from the pool */
+    public static final int STACK_CHUNKS_REUSED = 18;
+
+    /** Number of classes found in the verifier cache */
+    public static final int VERIFIER_CACHE_HITS = 19;
+
+    /** Number of classes not found in the verifier cache */
+    public static final int VERIFIER_CACHE_MISSES = 20;
+
+    private Metrics() {
+    }
+
+    /**
+     * Returns the number of metrics supported by the virtual machine.
+     * Valid metric identifiers are 0 to <code>count() - 1</code>.
+     *
+     * @return the number of metrics, or 0 if no metrics are kept
+     */
+    public static native int count();
+
+    /**
+     * Returns the current value of a metric.
+     *
+     * @param metric the metric identifier
+     * @return the value of the metric
+     * @exception IllegalArgumentException if the metric is not supported
+     */
+    public static native long get(int metric);
+
+    /**
+     * Returns the name of a metric, e.g. "gcCount".
+     *
+     * @param metric the metric identifier
+     * @return the name of the metric
+     * @exception IllegalArgumentException if the metric is not supported
+     */
+    public static native String getName(int metric);
+
+    /**
+     * Returns the deepest use of the execution stack of a thread so
+     * far.
+     *
+     * @param thread the thread
+     * @return the stack high-water mark in bytes, or 0 if the thread
+     *         has not been started or no metrics are kept
+     */
+    public static native int getStackHighWater(Thread thread);
+
+    /**
+     * Returns all the metrics as a JSON object, in the same format
+     * that the virtual machine uses when it dumps them itself.
+     *
+     * @return a string such as <code>{"uptimeMs":1234,...}</code>
+     */
+    public static String toJSON() {
+        int count = count();
+        StringBuffer sb = new StringBuffer(count * 24 + 2);
+        sb.append('{');
+        for (int i = 0; i < count; i++) {
+            if (i > 0) {
+                sb.append(',');
+            }
+            sb.append('"').append(getName(i)).append("\":").append(get(i));
+        }
+        sb.append('}');
+        return sb.toString();
+    }
+}
@@ -557,6 +557,9 @@ class String {
             (ooffset > (long)other.count - len)) {
             return false;
         }
+        if (!ignoreCase && len > 0) {
+            return com.sun.cldc.util.Arrays.regionEquals(ta, to, pa, po, len);
+        }
         while (len-- > 0) {
             char c1 = ta[to++];
             char c2 = pa[po++];
@@ -613,12 +616,8 @@ class String {
         if ((toffset < 0) || (toffset > count - pc)) {
             return false;
         }
-        while (--pc >= 0) {
-            if (ta[to++] != pa[po++]) {
-                return false;
-            }
-        }
-        return true;
+        return (pc == 0)
+            || com.sun.cldc.util.Arrays.regionEquals(ta, to, pa, po, pc);
     }
 
     /**
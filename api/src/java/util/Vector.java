@@ -169,10 +169,8 @@ class Vector {
     public synchronized void setSize(int newSize) {
         if ((newSize > elementCount) && (newSize > elementData.length)) {
             ensureCapacityHelper(newSize);
-        } else {
-            for (int i = newSize ; i < elementCount ; i++) {
-                elementData[i] = null;
-            }
+        } else if (newSize < elementCount) {
+            com.sun.cldc.util.Arrays.clear(elementData, newSize, elementCount);
         }
         elementCount = newSize;
     }
@@ -492,9 +490,7 @@ class Vector {
      * @since   JDK1.0
      */
     public synchronized void removeAllElements() {
-        for (int i = 0; i < elementCount; i++) {
-            elementData[i] = null;
-        }
+        com.sun.cldc.util.Arrays.clear(elementData, 0, elementCount);
         elementCount = 0;
     }
 
@@ -38,6 +38,7 @@ extern "C" {
 #define JAR_FILE_SIZE_TAG       "JAR-File-Size"
 #define MAIN_CLASS_TAG          "Main-Class"
 #define USE_ONCE_TAG            "Use-Once"
+#define JAR_FILE_CRC_TAG        "JAR-File-CRC"
 
 /*
  * Standard JAM descriptor file tag names.
@@ -59,6 +60,29 @@ extern "C" {
 #define CONTENT_HTML          1
 #define CONTENT_JAVA_MANIFEST 2
 
+/*
+ * HTTP status codes returned by HTTP_Download(). A download that
+ * couldn't connect, or that was interrupted, returns HTTP_FAILED.
+ */
+#define HTTP_FAILED                0
+#define HTTP_OK                    200
+#define HTTP_PARTIAL_CONTENT       206
+#define HTTP_NOT_MODIFIED          304
+#define HTTP_RANGE_NOT_SATISFIABLE 416
+#define HTTP_SERVICE_UNAVAILABLE   503
+
+/*
+ * Maximum length of an ETag or Last-Modified validator
+ */
+#define MAX_VALIDATOR 128
+
+/*
+ * Number of times an interrupted JAR download is resumed before
+ * giving up. The partial JAR file is kept, so that the download can
+ * be resumed the next time the application is installed.
+ */
+#define JAM_DOWNLOAD_ATTEMPTS 3
+
 #define JAM_RETURN_OK         0
 #define JAM_RETURN_ERR        -1023
 
@@ -101,9 +125,49 @@ typedef struct JamApp {
     char* appName;
     char* mainClass;
     char* version;
+    char* etag;          /* Validators of the stored JAR file, used */
+    char* lastModified;  /* to make the next download conditional */
     struct JamApp* next;
 } JamApp;
 
+/*
+ * Receives the body of an HTTP response. The data goes at <offset> of
+ * the entity; each response starts with a call with no data, at the
+ * offset that the response starts from. Returns FALSE to abort the
+ * download.
+ */
+typedef int (*HttpSink) __P ((void*, long, const char*, int));
+
+typedef struct HttpRequest {
+    long offset;            /* [In] Resume the download at this offset */
+    const char* etag;       /* [In] Validators of the copy we have. Used */
+    const char* lastModified; /* for If-Range when resuming, and for */
+                            /* a conditional GET otherwise */
+    HttpSink sink;          /* [In] Receives the body */
+    void* closure;          /* [In] Passed to the sink */
+    int contentType;        /* [Out] CONTENT_HTML or CONTENT_JAVA_MANIFEST */
+    long contentLength;     /* [Out] Length of the entity, or -1 */
+    char newEtag[MAX_VALIDATOR];         /* [Out] Validators of the */
+    char newLastModified[MAX_VALIDATOR]; /* entity, or empty */
+} HttpRequest;
+
+/*
+ * A JAR file that is being written into storage. The data is written
+ * to a partial file, which replaces the JAR file once it is complete.
+ */
+typedef struct JamJarWriter {
+    FILE* fp;
+    char* jarName;
+    long size;              /* Bytes written so far */
+    long expectedSize;      /* From JAR-File-Size */
+    unsigned long crc;      /* Running CRC-32 of the bytes written */
+    unsigned long expectedCRC;
+    bool_t checkCRC;        /* The descriptor has a JAR-File-CRC */
+    long replacedSize;      /* Size of the JAR file being replaced */
+    char etag[MAX_VALIDATOR];         /* Validators of the partial file */
+    char lastModified[MAX_VALIDATOR];
+} JamJarWriter;
+
 /*=========================================================================
  * JAM functions
  *=======================================================================*/
@@ -144,7 +208,10 @@ extern JamApp* JamGetNextAppEntry __P ((void));
 extern void JamCloseAppsDatabase __P ((void));
 extern int JamSaveAppsDatabase __P ((void));
 
-extern int JamSaveJARFile __P ((JamApp*, char*, int));
+extern int JamOpenJARFile __P ((JamJarWriter*, JamApp*, JamApp*, long));
+extern int JamWriteJARFile __P ((void*, long, const char*, int));
+extern int JamCommitJARFile __P ((JamJarWriter*));
+extern void JamAbortJARFile __P ((JamJarWriter*, bool_t));
 extern int JamDeleteJARFile __P ((JamApp*));
 
 /* Internal functions */
@@ -169,6 +236,7 @@ extern void JamFreeAppUsedSpace __P ((JamApp*));
  */
 extern void HTTP_Initialize __P ((void));
 extern char* HTTP_Get __P ((const char*, int*, int*, bool_t));
+extern int HTTP_Download __P ((const char*, HttpRequest*, bool_t));
 extern void HTTP_Finalize __P ((void));
 
 #ifdef __cplusplus__
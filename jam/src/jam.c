@@ -55,6 +55,7 @@ static JamApp* downloadedApp = NULL;
  *=======================================================================*/
 
 static int GetJarURL(char* jamContent, char* parentURL, char* jarURL);
+static int CopyJarFile(const char* path, JamJarWriter* writer);
 static int JamRunApp(JamApp* app);
 
 /*
@@ -390,6 +391,149 @@ GenericGet(const char* url, int* contentTypeP, int* contentLengthP,
     }
 }
 
+/*
+ * DownloadJarFile --
+ *
+ *      Stream the JAR file of <newApp> into storage. An interrupted
+ *      download is resumed where it stopped, either right away or the
+ *      next time the app is installed. If <oldApp> has stored the same
+ *      JAR file, the download is conditional: if the JAR file hasn't
+ *      changed, the stored copy is kept and no data is transferred.
+ *
+ * RETURN: TRUE if the JAR file is in storage.
+ */
+static int
+DownloadJarFile(jamContent, jarURL, newApp, oldApp, jarLength)
+    char* jamContent;
+    char* jarURL;
+    JamApp* newApp;
+    JamApp* oldApp;
+    int jarLength;
+{
+    int attempt;
+    int httpCode = HTTP_FAILED;
+    int len;
+    char* p;
+    char crc[MAX_BUF];
+    JamJarWriter writer;
+    HttpRequest request;
+
+    /*
+     * The descriptor may give the CRC of the JAR file, which is then
+     * checked together with its size.
+     */
+    p = JamGetProp(jamContent, JAR_FILE_CRC_TAG, &len);
+    if (p != NULL) {
+        if (len >= MAX_BUF) {
+            len = MAX_BUF - 1;
+        }
+        strnzcpy(crc, p, len);
+    }
+
+    if (!JamOpenJARFile(&writer, newApp, oldApp, jarLength)) {
+        return (FALSE);
+    }
+    writer.checkCRC = (p != NULL);
+    writer.expectedCRC = (p != NULL) ? strtoul(crc, NULL, 16) : 0;
+
+    if (strncmp(jarURL, "file:", 5) == 0) {
+        return (CopyJarFile(jarURL + 5, &writer));
+    }
+
+    for (attempt = 0; attempt < JAM_DOWNLOAD_ATTEMPTS; attempt++) {
+        memset(&request, 0, sizeof (request));
+        request.sink = JamWriteJARFile;
+        request.closure = &writer;
+        if (writer.size > 0) {
+            request.offset = writer.size;
+            request.etag = writer.etag;
+            request.lastModified = writer.lastModified;
+        } else if (oldApp != NULL && writer.replacedSize > 0) {
+            request.etag = oldApp->etag;
+            request.lastModified = oldApp->lastModified;
+        }
+
+        httpCode = HTTP_Download(jarURL, &request, TRUE);
+
+        /* Remember the version of the JAR file that we are getting */
+        if (request.newEtag[0] != 0 || request.newLastModified[0] != 0) {
+            strcpy(writer.etag, request.newEtag);
+            strcpy(writer.lastModified, request.newLastModified);
+        }
+
+        switch (httpCode) {
+        case HTTP_OK:
+        case HTTP_PARTIAL_CONTENT:
+            newApp->etag = strdup(writer.etag);
+            newApp->lastModified = strdup(writer.lastModified);
+            return (JamCommitJARFile(&writer));
+
+        case HTTP_NOT_MODIFIED:
+            JamAbortJARFile(&writer, FALSE);
+            if (oldApp == NULL || writer.replacedSize == 0) {
+                return (FALSE);
+            }
+            newApp->etag = (oldApp->etag == NULL)
+                ? NULL : strdup(oldApp->etag);
+            newApp->lastModified = (oldApp->lastModified == NULL)
+                ? NULL : strdup(oldApp->lastModified);
+            return (TRUE);
+
+        case HTTP_RANGE_NOT_SATISFIABLE:
+            /* The partial file is of no use; start all over */
+            JamAbortJARFile(&writer, FALSE);
+            if (!JamOpenJARFile(&writer, newApp, oldApp, jarLength)) {
+                return (FALSE);
+            }
+            writer.checkCRC = (p != NULL);
+            writer.expectedCRC = (p != NULL) ? strtoul(crc, NULL, 16) : 0;
+            break;
+
+        case HTTP_FAILED:
+            /* Interrupted: resume with what we have got */
+            break;
+
+        default:
+            attempt = JAM_DOWNLOAD_ATTEMPTS;
+            break;
+        }
+    }
+
+    JamAbortJARFile(&writer, httpCode == HTTP_FAILED);
+    return (FALSE);
+}
+
+/*
+ * CopyJarFile --
+ *
+ *      Copy a local JAR file into storage.
+ */
+static int
+CopyJarFile(const char* path, JamJarWriter* writer)
+{
+    char buffer[1024];
+    FILE* fp;
+    int len;
+    int ok = TRUE;
+
+    if ((fp = fopen(path, "rb")) == NULL) {
+        JamError("Error opening file\n");
+        JamAbortJARFile(writer, FALSE);
+        return (FALSE);
+    }
+    JamWriteJARFile(writer, 0, NULL, 0);
+    while (ok && (len = fread(buffer, 1, sizeof (buffer), fp)) > 0) {
+        ok = JamWriteJARFile(writer, writer->size, buffer, len);
+    }
+    fclose(fp);
+
+    if (!ok) {
+        JamAbortJARFile(writer, FALSE);
+        return (FALSE);
+    }
+    return (JamCommitJARFile(writer));
+}
+
 static JamApp*
 DownloadApp(jamContent, parentURL, oldApp, retval, jarLength)
     char* jamContent;
@@ -399,11 +543,10 @@ DownloadApp(jamContent, parentURL, oldApp, retval, jarLength)
     int jarLength;
 {
     int badURL = 0;
-    int contentType, contentLength;
     int useOnceLen;
 
     char jarURL[MAX_URL];
-    char* jarContent = NULL, *jarName;
+    char* jarName;
 
     JamApp* newApp = NULL;
     char* useOnce;
@@ -421,16 +564,6 @@ DownloadApp(jamContent, parentURL, oldApp, retval, jarLength)
         goto error;
     }
 
-    /*
-     * Download the jar into apps directory.
-     */
-
-    jarContent = GenericGet(jarURL, &contentType, &contentLength, TRUE);
-    if (jarContent == NULL) {
-        badURL = 1;
-        goto error;
-    }
-
     jarName = strrchr(jarURL, '/') + 1;
     ASSERT(jarName != NULL && *jarName != 0);
 
@@ -456,20 +589,23 @@ DownloadApp(jamContent, parentURL, oldApp, retval, jarLength)
 
     newApp->version = JamGetProp(jamContent, APPLICATION_VERSION_TAG, NULL);
 
-    if (!JamSaveJARFile(newApp, jarContent, contentLength)) {
+    /*
+     * Download the jar into apps directory.
+     */
+    if (!DownloadJarFile(jamContent, jarURL, newApp, oldApp, jarLength)) {
+        badURL = 1;
         goto error;
     }
 
-    browser_free(jarContent);
-
     /*
      * Add to list of apps
      */
     AddApp(newApp, jarLength);
 
     if (oldApp != NULL) {
-        DeleteApp(oldApp, 0);
-        JamFreeAppUsedSpace(oldApp);
+        /* The JAR file of the old app has been replaced, unless it */
+        /* had a different name */
+        DeleteApp(oldApp, strcmp(oldApp->jarName, newApp->jarName) != 0);
     }
 
     useOnce = JamGetProp(jamContent, USE_ONCE_TAG, &useOnceLen);
@@ -482,8 +618,9 @@ DownloadApp(jamContent, parentURL, oldApp, retval, jarLength)
     return (newApp);
 
 error:
-    JamFreeApp(newApp);
-    browser_free(jarContent);
+    if (newApp != NULL) {
+        JamFreeApp(newApp);
+    }
 
     *retval = JamDownloadErrorPage(badURL);
 
@@ -680,6 +817,14 @@ JamRunApp(JamApp* app)
          goto done;
      }
 
+#if ENABLE_ZYGOTE
+     /* Run the app in a child of the zygote, if there is one */
+     if (ZygoteWarm) {
+         retval = ForkJVM(1, argv);
+         goto done;
+     }
+#endif
+
      retval = StartJVM(1, argv);
 
  done:
@@ -746,6 +891,8 @@ void JamFreeApp(JamApp* app) {
     browser_free(app->jarURL);
     browser_free(app->version);
     browser_free(app->mainClass);
+    browser_free(app->etag);
+    browser_free(app->lastModified);
     browser_free(app);
 }
 
@@ -782,15 +929,26 @@ static void InitInstalledApps()
  *     applications.
  * [2] Read the list of installed apps.
  * [3] Calculate used and available storage space.
+ * [4] With -zygote, initialize the VM that the apps are forked from.
  */
 void JamInitialize(char* appsDir) {
     JamInitializeStorage(appsDir);
     InitInstalledApps();
     JamInitializeUsedSpace(appList);
     HTTP_Initialize();
+#if ENABLE_ZYGOTE
+    if (JamZygote) {
+        /* If this fails, the apps are started from scratch */
+        StartZygote();
+    }
+#endif
 }
 
 void JamFinalize() {
+    HTTP_Finalize();
+#if ENABLE_ZYGOTE
+    StopZygote();
+#endif
 }
 
 int JamGetAppCount(void) {
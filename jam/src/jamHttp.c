@@ -44,6 +44,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* Just enough of global.h and the other stuff so that this will compile */
 
@@ -171,210 +172,530 @@ parseURL(const char* url, char* host, int* port, char* path)
     return TRUE;
 }
 
-static char *
-fetchURL_internal(const char *host, int port, const char *path, bool_t retry,
-                  int *httpCodeP, int *contentTypeP,
-                  int *contentLengthP, int *retryDelayP);
+/*
+ * The connection to the server of the last request. It is kept open
+ * for the next request to the same server (HTTP/1.1 keep-alive), so
+ * that downloading a descriptor and then its JAR file costs a single
+ * connection. The buffer holds response data that has been received
+ * but not yet read.
+ */
+static struct {
+    SOCKET sock;
+    char host[MAX_URL];
+    int port;
+    bool_t reused;          /* An earlier response came on this connection */
+    int start;              /* Unread data in the buffer */
+    int end;
+    char buffer[MAX_BUF];
+} connection = { INVALID_SOCKET };
+
+static void
+closeConnection(void)
+{
+    if (!IS_INVALID(connection.sock)) {
+        closesocket(connection.sock);
+        connection.sock = INVALID_SOCKET;
+    }
+}
 
 /*
- * Implement HTTP policy for retransmissions, etc. ...
+ * Connect to the server, unless the connection of the last request
+ * goes to the same server.
  */
-char*
-HTTP_Get(const char* url, int* contentTypeP, int* contentLengthP, bool_t retry)
+static bool_t
+openConnection(const char *host, int port, bool_t retry)
 {
-    int port;
-    char host[MAX_URL];
-    char path[MAX_URL];
-    parseURL(url, host, &port, path);
+    bool_t first;
+    struct hostent* hep;
+    struct sockaddr_in sin;
+    int retcode;
 
-    for(;;) {
-        int httpCode, retryDelay;
-        char *content = fetchURL_internal(host, port, path, retry,
-                                          &httpCode, contentTypeP,
-                                          contentLengthP, &retryDelay);
-        if (httpCode == 200) {
-            return content;
-        }
-        /* In all other cases, the content is NULL and should be ignored */
-        if (httpCode == 503) {
-            if (retryDelay > 0) {
-                SLEEP_MILLIS(retryDelay);
-            } else {
-                /* retryDelay is a hint, we must sleep so that javaTest can
-                 * get some cycles
-                 */
-                SLEEP_MILLIS(5);
-            }
-            continue;
+    if (!IS_INVALID(connection.sock)) {
+        if (strcmp(connection.host, host) == 0 && connection.port == port) {
+            connection.reused = TRUE;
+            return TRUE;
         }
-        return NULL;
+        closeConnection();
+    }
+
+    memset((void*)&sin, 0, sizeof (sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons((short)port);
+
+    hep = gethostbyname(host);
+    if (hep == NULL) {
+        fprintf(stderr, "Unable to resolve host name %s\n", host);
+        return FALSE;
     }
+    memcpy(&sin.sin_addr, hep->h_addr, hep->h_length);
+    for (first = TRUE;;) {
+        connection.sock = socket(PF_INET, SOCK_STREAM, 0);
+        retcode = connect(connection.sock, (struct sockaddr*)&sin, sizeof(sin));
+        if (retcode >= 0) {
+            break;
+        }
+        closeConnection();
+        if (!retry) {
+            fprintf(stderr, "Unable to connect to %s:%ld\n",
+                    host, (long)port);
+            return FALSE;
+        }
+        if (first) {
+            fprintf(stderr,
+                    "Unable to connect to %s:%ld.  Will retry\n",
+                    host, (long)port);
+            first = FALSE;
+        }
+        SLEEP_MILLIS(DEFAULT_RETRY_DELAY);
+    }
+    strcpy(connection.host, host);
+    connection.port = port;
+    connection.reused = FALSE;
+    connection.start = connection.end = 0;
+    return TRUE;
 }
 
-static char *
-fetchURL_internal(const char *host, int port, const char *path, bool_t retry,
-                  int *httpCodeP, int* contentTypeP,
-                  int *contentLengthP, int *retryDelayP)
+/*
+ * Make sure that there is unread data in the buffer.
+ * Returns FALSE on EOF or error.
+ */
+static bool_t
+fillBuffer(void)
 {
-    int sock = -1;
-    char buffer[1024]; /* we reuse this for sending and receiving the data */
-    int length, contentLength;
-    char *p;
-    char *content = NULL;
-    bool_t readBody;
     int retcode;
 
-    /* Let's set the return args to default values */
-    *httpCodeP = 404;           /* unable to make a connection */
-    *contentLengthP = 0;
-    *retryDelayP = 0;
-    *contentTypeP = ((strcmp(path + strlen(path) - 4, ".jam")) == 0)
-                                     ? CONTENT_JAVA_MANIFEST : CONTENT_HTML;
-    contentLength = 0;
-
-    /* Open the socket and connect to the server */
-    {
-        bool_t first;
-        struct hostent* hep;
-        struct sockaddr_in sin;
+    if (connection.start < connection.end) {
+        return TRUE;
+    }
+    retcode = recv(connection.sock, connection.buffer, MAX_BUF, 0);
+    if (retcode <= 0) {
+        return FALSE;
+    }
+    connection.start = 0;
+    connection.end = retcode;
+    return TRUE;
+}
 
-        memset((void*)&sin, 0, sizeof (sin));
-        sin.sin_family = AF_INET;
-        sin.sin_port = htons((short)port);
+/*
+ * Read a line of the response header, without the line terminator.
+ * Returns the length of the line, or -1 on EOF or error.
+ */
+static int
+readLine(char *line, int maxLength)
+{
+    int length = 0;
 
-        hep = gethostbyname(host);
-        if (hep == NULL) {
-            fprintf(stderr, "Unable to resolve host name %s\n", host);
-            return NULL;
+    for (;;) {
+        char c;
+        if (!fillBuffer()) {
+            return -1;
         }
-        memcpy(&sin.sin_addr, hep->h_addr, hep->h_length);
-        for (first = TRUE;;) {
-            sock = socket(PF_INET, SOCK_STREAM, 0);
-            retcode = connect(sock, (struct sockaddr*)&sin, sizeof(sin));
-            if (retcode >= 0) {
-                break;
-            } else if (!retry) {
-                fprintf(stderr, "Unable to connect to %s:%ld\n",
-                        host, (long)port);
-                goto error;
-            } else {
-                if (first) {
-                    fprintf(stderr,
-                            "Unable to connect to %s:%ld.  Will retry\n",
-                            host, (long)port);
-                    first = FALSE;
-                }
-                closesocket(sock);
-                SLEEP_MILLIS(DEFAULT_RETRY_DELAY);
-            }
+        c = connection.buffer[connection.start++];
+        if (c == '\n') {
+            break;
+        }
+        if (c != '\r' && length < maxLength - 1) {
+            line[length++] = c;
+        }
+    }
+    line[length] = '\0';
+    return length;
+}
 
+/*
+ * Read <length> bytes of the body, or everything up to EOF if <length>
+ * is negative, and pass them to the sink. <offsetP> is updated with
+ * the offset of the next byte.
+ */
+static bool_t
+readBody(HttpRequest *request, long *offsetP, long length)
+{
+    while (length != 0) {
+        int count;
+        if (!fillBuffer()) {
+            return (length < 0);
+        }
+        count = connection.end - connection.start;
+        if (length > 0 && count > length) {
+            count = length;
+        }
+        if (request->sink != NULL &&
+            !request->sink(request->closure, *offsetP,
+                           connection.buffer + connection.start, count)) {
+            return FALSE;
+        }
+        connection.start += count;
+        *offsetP += count;
+        if (length > 0) {
+            length -= count;
         }
     }
-    memset(buffer, 0, sizeof(buffer));
-    sprintf(buffer, "GET %s HTTP/1.0\n\n", path);
-    retcode = send(sock, buffer, strlen(buffer), 0);
+    return TRUE;
+}
 
-    /* Read as much as we can into "buffer". */
-    memset(buffer, 0, sizeof(buffer));
-    for (length = 0; length < sizeof(buffer); ) {
-        retcode = recv(sock, buffer + length, sizeof(buffer) - length, 0);
-        if (retcode > 0) {
-            length += retcode;
-        } else if (retcode == 0) {
-            /* EOF */
+/*
+ * Read a body with "Transfer-Encoding: chunked".
+ */
+static bool_t
+readChunkedBody(HttpRequest *request, long *offsetP)
+{
+    char line[MAX_BUF];
+    long chunkLength;
+
+    for (;;) {
+        if (readLine(line, sizeof(line)) < 0) {
+            return FALSE;
+        }
+        chunkLength = strtol(line, NULL, 16);
+        if (chunkLength <= 0) {
             break;
-        } else {
-            fprintf(stderr, "Error reading socket\n");
-            goto error;
+        }
+        if (!readBody(request, offsetP, chunkLength) ||
+            readLine(line, sizeof(line)) != 0) {
+            return FALSE;
+        }
+    }
+    /* Skip the trailer */
+    do {
+        if (readLine(line, sizeof(line)) < 0) {
+            return FALSE;
+        }
+    } while (line[0] != '\0');
+    return TRUE;
+}
+
+/*
+ * If <line> is the header <name>, return its value.
+ */
+static char *
+headerValue(char *line, const char *name)
+{
+    int length = strlen(name);
+    int i;
+
+    for (i = 0; i < length; i++) {
+        if (tolower((int)line[i]) != tolower((int)name[i])) {
+            return NULL;
+        }
+    }
+    if (line[length] != ':') {
+        return NULL;
+    }
+    line += length + 1;
+    while (*line == ' ') line++;        /* Skip additional space */
+    return line;
+}
+
+static bool_t
+sendRequest(const char *host, int port, const char *path,
+            HttpRequest *request)
+{
+    char buffer[MAX_BUF + 3 * MAX_VALIDATOR];
+    const char *validator;
+    int length;
+
+    length = sprintf(buffer,
+                     "GET %s HTTP/1.1\r\n"
+                     "Host: %s:%d\r\n"
+                     "Connection: keep-alive\r\n",
+                     path, host, port);
+    validator = (request->etag != NULL && request->etag[0] != '\0')
+                    ? request->etag : request->lastModified;
+    if (request->offset > 0) {
+        /* Resume the download, if the entity hasn't changed */
+        length += sprintf(buffer + length, "Range: bytes=%ld-\r\n",
+                          request->offset);
+        if (validator != NULL && validator[0] != '\0') {
+            length += sprintf(buffer + length, "If-Range: %s\r\n",
+                              validator);
+        }
+    } else {
+        /* Only download the entity if it has changed */
+        if (request->etag != NULL && request->etag[0] != '\0') {
+            length += sprintf(buffer + length, "If-None-Match: %s\r\n",
+                              request->etag);
+        }
+        if (request->lastModified != NULL &&
+            request->lastModified[0] != '\0') {
+            length += sprintf(buffer + length,
+                              "If-Modified-Since: %s\r\n",
+                              request->lastModified);
         }
     }
-    if (length <= 5) {
-        goto error;
+    length += sprintf(buffer + length, "\r\n");
+    return (send(connection.sock, buffer, length, 0) == length);
+}
+
+/*
+ * Send one request and read its response. Returns the HTTP status
+ * code, or HTTP_FAILED if the request couldn't be made or the
+ * response was cut off.
+ */
+static int
+fetchURL_internal(const char *host, int port, const char *path,
+                  bool_t retry, HttpRequest *request, int *retryDelayP)
+{
+    char line[MAX_BUF];
+    char *p;
+    char *value;
+    int httpCode;
+    long contentLength = -1;
+    long offset;
+    bool_t chunked = FALSE;
+    bool_t keepAlive;
+
+    *retryDelayP = 0;
+    request->contentLength = -1;
+    request->newEtag[0] = '\0';
+    request->newLastModified[0] = '\0';
+    request->contentType =
+        (strlen(path) > 4 && strcmp(path + strlen(path) - 4, ".jam") == 0)
+                                     ? CONTENT_JAVA_MANIFEST : CONTENT_HTML;
+
+    if (!openConnection(host, port, retry)) {
+        return HTTP_FAILED;
     }
 
-    /* We're assuming that the buffer is long enough to hold the complete
-     * header.  If not, well something is wrong.
+    /*
+     * The server may have closed a connection that we kept open.
+     * In that case, try once more with a fresh connection.
      */
-    p = strchr(buffer, ' ') + 1;        /* Skip past the first space */
-    while (*p == ' ') p++;              /* Skip additional space */
-    *httpCodeP = atoi(p);
-    switch(*httpCodeP) {
-        case 200:
-            readBody = TRUE; break;
-        case 503:
-            readBody = FALSE; break;
-        default:
-            fprintf(stderr, "%s not available\n", path);
-            goto error;
+    if (!sendRequest(host, port, path, request) ||
+        readLine(line, sizeof(line)) < 0) {
+        bool_t reused = connection.reused;
+        closeConnection();
+        if (!reused || !openConnection(host, port, retry) ||
+            !sendRequest(host, port, path, request) ||
+            readLine(line, sizeof(line)) < 0) {
+            fprintf(stderr, "Error reading socket\n");
+            closeConnection();
+            return HTTP_FAILED;
+        }
     }
-    p = strchr(p, '\n') + 1;
+
+    /* Status line, e.g. "HTTP/1.1 200 OK" */
+    if ((p = strchr(line, ' ')) == NULL) {
+        closeConnection();
+        return HTTP_FAILED;
+    }
+    keepAlive = (strncmp(line, "HTTP/1.0", 8) != 0);
+    while (*p == ' ') p++;              /* Skip additional space */
+    httpCode = atoi(p);
+
+    /* Headers */
+    offset = 0;
     for (;;) {
-        if (*p == '\n') {
-            p++;
+        if (readLine(line, sizeof(line)) < 0) {
+            closeConnection();
+            return HTTP_FAILED;
+        }
+        if (line[0] == '\0') {
+            break;
+        } else if ((value = headerValue(line, "Content-Length")) != NULL) {
+            contentLength = atol(value);
+        } else if ((value = headerValue(line, "Content-Range")) != NULL) {
+            /* "bytes <first>-<last>/<length>" */
+            while (*value != '\0' && !isdigit((int)*value)) value++;
+            offset = atol(value);
+            if ((value = strchr(value, '/')) != NULL && value[1] != '*') {
+                request->contentLength = atol(value + 1);
+            }
+        } else if ((value = headerValue(line, "Content-Type")) != NULL) {
+            if (strncmp(value, "application/x-jam", 17) == 0) {
+                request->contentType = CONTENT_JAVA_MANIFEST;
+            }
+        } else if ((value = headerValue(line, "Transfer-Encoding")) != NULL) {
+            chunked = (strncmp(value, "chunked", 7) == 0);
+        } else if ((value = headerValue(line, "Connection")) != NULL) {
+            if (strncmp(value, "close", 5) == 0) {
+                keepAlive = FALSE;
+            } else if (strncmp(value, "keep-alive", 10) == 0) {
+                keepAlive = TRUE;
+            }
+        } else if ((value = headerValue(line, "ETag")) != NULL) {
+            strnzcpy(request->newEtag, value, MAX_VALIDATOR - 1);
+        } else if ((value = headerValue(line, "Last-Modified")) != NULL) {
+            strnzcpy(request->newLastModified, value, MAX_VALIDATOR - 1);
+        } else if ((value = headerValue(line, "Retry-After")) != NULL) {
+            *retryDelayP = atoi(value) * 1000;
+        }
+    }
+
+    switch (httpCode) {
+        case HTTP_OK:
+            offset = 0;
+            request->contentLength = chunked ? -1 : contentLength;
             break;
-        } else if (*p == '\r' && p[1] == '\n') {
-            p += 2;
+        case HTTP_PARTIAL_CONTENT:
+            if (offset != request->offset) {
+                fprintf(stderr, "%s resumed at the wrong offset\n", path);
+                closeConnection();
+                return HTTP_FAILED;
+            }
+            break;
+        case HTTP_NOT_MODIFIED:
+            /* Has no body */
+            contentLength = 0;
+            chunked = FALSE;
+            break;
+        case HTTP_SERVICE_UNAVAILABLE:
+        case HTTP_RANGE_NOT_SATISFIABLE:
+            break;
+        default:
+            fprintf(stderr, "%s not available\n", path);
             break;
-        } else if (   strncmp("Content-length:", p, 15) == 0
-                   || strncmp("Content-Length:", p, 15) == 0) {
-            p += 15;
-            while (*p == ' ') p++;        /* Skip additional space */
-            contentLength = atoi(p);
-        } else if (   strncmp("Content-type:", p, 13) == 0
-                   || strncmp("Content-Type:", p, 13) == 0) {
-            p += 13;
-            while (*p == ' ') p++;        /* Skip additional space */
-            if (     (*contentTypeP == CONTENT_HTML)
-                     &&   (strncmp(p, "application/x-jam", 17) == 0) ) {
-                *contentTypeP = CONTENT_JAVA_MANIFEST;
+    }
+
+    /*
+     * Read the body. Only the body of a successful response is passed
+     * to the sink; the body of other responses is skipped, so that the
+     * connection can be used again.
+     */
+    if (httpCode == HTTP_OK || httpCode == HTTP_PARTIAL_CONTENT) {
+        if (request->sink != NULL &&
+            !request->sink(request->closure, offset, NULL, 0)) {
+            closeConnection();
+            return HTTP_FAILED;
+        }
+    } else {
+        if (!chunked && contentLength < 0) {
+            /* No way to find the end of the body */
+            closeConnection();
+            return httpCode;
+        }
+        {
+            HttpSink sink = request->sink;
+            bool_t ok;
+            request->sink = NULL;
+            ok = chunked ? readChunkedBody(request, &offset)
+                         : readBody(request, &offset, contentLength);
+            request->sink = sink;
+            if (!ok) {
+                closeConnection();
+            } else if (!keepAlive) {
+                closeConnection();
             }
-        } else if (   strncmp("Retry-after:", p, 12) == 0
-                   || strncmp("Retry-After:", p, 12) == 0) {
-            p += 12;
-            while (*p == ' ') p++;        /* Skip additional space */
-            *retryDelayP = atoi(p) * 1000;
         }
-        /* Skip to just past the '\r\n' or '\n' */
-        p = strchr(p, '\n') + 1;
+        return httpCode;
     }
 
-    if (!readBody) {
-        closesocket(sock);
-        return NULL;
+    if (chunked) {
+        if (!readChunkedBody(request, &offset)) {
+            closeConnection();
+            return HTTP_FAILED;
+        }
+    } else if (contentLength >= 0) {
+        if (!readBody(request, &offset, contentLength)) {
+            closeConnection();
+            return HTTP_FAILED;
+        }
+    } else {
+        /* The body ends when the server closes the connection */
+        readBody(request, &offset, -1);
+        keepAlive = FALSE;
+    }
+    if (!keepAlive) {
+        closeConnection();
     }
+    return httpCode;
+}
+
+/*
+ * Implement HTTP policy for retransmissions, etc. ...
+ *
+ * Download <url>, passing the body of the response to the sink of the
+ * request. Returns the HTTP status code of the response, or HTTP_FAILED
+ * if the download couldn't be made or was interrupted.
+ */
+int
+HTTP_Download(const char* url, HttpRequest* request, bool_t retry)
+{
+    int port;
+    char host[MAX_URL];
+    char path[MAX_URL];
 
-    content = malloc(contentLength + 1);
-    content[contentLength] = 0;    /* This saves us some grief on JAM */
-    /* Set length to be the number of characters we're going to copy
-     * into the content buffer */
-    length = length - (p - buffer);
-    memcpy(content, p, length);
-
-    while (length < contentLength) {
-        retcode = recv(sock, content + length, contentLength - length, 0);
-        if (retcode < 0) {
-            fprintf(stderr, "Bad read on socket");
-            goto error;
-        } else if (retcode == 0) {
-            fprintf(stderr, "Unexpectedly reached EOF");
-            goto error;
+    if (!parseURL(url, host, &port, path)) {
+        return HTTP_FAILED;
+    }
+
+    for(;;) {
+        int retryDelay;
+        int httpCode = fetchURL_internal(host, port, path, retry,
+                                         request, &retryDelay);
+        if (httpCode != HTTP_SERVICE_UNAVAILABLE) {
+            return httpCode;
+        }
+        if (retryDelay > 0) {
+            SLEEP_MILLIS(retryDelay);
         } else {
-            length += retcode;
+            /* retryDelay is a hint, we must sleep so that javaTest can
+             * get some cycles
+             */
+            SLEEP_MILLIS(5);
         }
     }
+}
 
-    closesocket(sock);
-    *contentLengthP = contentLength;
-    return content;
+/*
+ * The sink of HTTP_Get(), which collects the body in memory.
+ */
+typedef struct {
+    char *content;
+    long length;
+    long capacity;
+} MemorySink;
+
+static int
+memorySink(void *closure, long offset, const char *data, int length)
+{
+    MemorySink *sink = (MemorySink*)closure;
 
-error:
-    if (sock >= 0) {
-        closesocket(sock);
+    if (offset + length + 1 > sink->capacity) {
+        long capacity = (sink->capacity == 0) ? MAX_BUF : sink->capacity;
+        char *content;
+        while (offset + length + 1 > capacity) {
+            capacity *= 2;
+        }
+        content = realloc(sink->content, capacity);
+        if (content == NULL) {
+            return FALSE;
+        }
+        sink->content = content;
+        sink->capacity = capacity;
     }
-    if (content != NULL) {
-        browser_free(content);
+    if (length > 0) {
+        memcpy(sink->content + offset, data, length);
     }
-    return NULL;
+    sink->length = offset + length;
+    return TRUE;
+}
+
+/*
+ * Download <url> into memory. This is used for the descriptor files
+ * and web pages, which are small; JAR files are streamed to storage
+ * with HTTP_Download().
+ */
+char*
+HTTP_Get(const char* url, int* contentTypeP, int* contentLengthP, bool_t retry)
+{
+    HttpRequest request;
+    MemorySink sink;
+
+    memset(&request, 0, sizeof(request));
+    memset(&sink, 0, sizeof(sink));
+    request.sink = memorySink;
+    request.closure = &sink;
+
+    if (HTTP_Download(url, &request, retry) != HTTP_OK ||
+        !memorySink(&sink, sink.length, NULL, 0)) {
+        browser_free(sink.content);
+        *contentLengthP = 0;
+        return NULL;
+    }
+    sink.content[sink.length] = 0;    /* This saves us some grief on JAM */
+    *contentTypeP = request.contentType;
+    *contentLengthP = sink.length;
+    return sink.content;
 }
 
 void HTTP_Initialize() {
@@ -387,3 +708,6 @@ void HTTP_Initialize() {
 #endif
 }
 
+void HTTP_Finalize() {
+    closeConnection();
+}
@@ -205,40 +205,240 @@ int JamGetAppTotalSize(JamApp* app) {
 }
 
 /*
- * Save the app's JAR file.
+ * Update the CRC-32 of a JAR file with the given bytes. This is the
+ * same CRC that is used in ZIP files.
  */
-int JamSaveJARFile(JamApp* app, char* jarContent, int len) {
+static unsigned long
+_UpdateCRC(unsigned long crc, const unsigned char* data, int len) {
+    int i;
+
+    crc = ~crc & 0xFFFFFFFF;
+    while (--len >= 0) {
+        crc ^= *data++;
+        for (i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(long)(crc & 1));
+        }
+    }
+    return ~crc & 0xFFFFFFFF;
+}
+
+/*
+ * Return the filesystem paths of the partial file that a JAR file is
+ * downloaded into, and of the file that holds the validators of the
+ * partial file while the download is interrupted.
+ */
+static void
+_GetPartialFileNames(char* path, char* infoPath, const char* jarName) {
+    char name[JAM_MAX_PATH];
+
+    sprintf(name, "%s.part", jarName);
+    _GetStoredFileName(path, name);
+    sprintf(name, "%s.part.info", jarName);
+    _GetStoredFileName(infoPath, name);
+}
+
+/*
+ * Read the validators of a partial JAR file.
+ */
+static bool_t
+_ReadPartialInfo(JamJarWriter* writer, const char* infoPath) {
+    FILE* fp;
+    char line[MAX_VALIDATOR + 20];
+    char* p;
+
+    if ((fp = fopen(infoPath, "r")) == NULL) {
+        return FALSE;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if ((p = strpbrk(line, "\r\n")) != NULL) {
+            *p = 0;
+        }
+        if (STRNCMP1("ETAG=", line) == 0) {
+            strnzcpy(writer->etag, line + 5, MAX_VALIDATOR - 1);
+        } else if (STRNCMP1("LAST-MODIFIED=", line) == 0) {
+            strnzcpy(writer->lastModified, line + 14, MAX_VALIDATOR - 1);
+        }
+    }
+    fclose(fp);
+    return (writer->etag[0] != 0 || writer->lastModified[0] != 0);
+}
+
+/*
+ * (Re)create an empty partial file.
+ */
+static int
+_TruncatePartialFile(JamJarWriter* writer) {
+    char path[JAM_MAX_PATH];
+    char infoPath[JAM_MAX_PATH];
+
+    if (writer->fp != NULL) {
+        fclose(writer->fp);
+    }
+    _GetPartialFileNames(path, infoPath, writer->jarName);
+    writer->size = 0;
+    writer->crc = 0;
+    writer->etag[0] = writer->lastModified[0] = 0;
+    writer->fp = fopen(path, "wb+");
+    return (writer->fp != NULL);
+}
+
+/*
+ * Open the partial file that the JAR file of <app> is downloaded into.
+ * If an earlier download of the same JAR was interrupted, the partial
+ * file is kept, and the download continues where it stopped.
+ * <oldApp> is the installed version of the app, or NULL.
+ */
+int JamOpenJARFile(JamJarWriter* writer, JamApp* app, JamApp* oldApp,
+                   long expectedSize) {
+
+    char path[JAM_MAX_PATH];
+    char infoPath[JAM_MAX_PATH];
+    unsigned char buffer[1024];
+    int len;
+
+    memset(writer, 0, sizeof(JamJarWriter));
+    writer->jarName = app->jarName;
+    writer->expectedSize = expectedSize;
+
+    if (oldApp != NULL && strcmp(oldApp->jarName, app->jarName) == 0) {
+        writer->replacedSize = JamGetAppJarSize(oldApp);
+        if (writer->replacedSize < 0) {
+            writer->replacedSize = 0;
+        }
+    }
+
+    if (JamGetFreeSpace() + writer->replacedSize < expectedSize) {
+        fprintf(stderr, "not enough storage: needs %ld, has %d\n",
+                expectedSize, JamGetFreeSpace());
+        return (0);
+    }
+
+    /*
+     * Resume only if we know which version of the JAR file the
+     * partial file holds.
+     */
+    _GetPartialFileNames(path, infoPath, app->jarName);
+    if (_ReadPartialInfo(writer, infoPath)
+            && (writer->fp = fopen(path, "rb+")) != NULL) {
+        while ((len = fread(buffer, 1, sizeof(buffer), writer->fp)) > 0) {
+            writer->crc = _UpdateCRC(writer->crc, buffer, len);
+            writer->size += len;
+        }
+        if (writer->size < expectedSize) {
+            unlink(infoPath);
+            return (1);
+        }
+    }
+    unlink(infoPath);
+    return (_TruncatePartialFile(writer));
+}
+
+/*
+ * Write part of a downloaded JAR file. This is the HttpSink for JAR
+ * downloads. The size is checked as the data arrives, so that a
+ * server that sends too much can't fill up the storage.
+ */
+int JamWriteJARFile(void* closure, long offset, const char* data, int len) {
+
+    JamJarWriter* writer = (JamJarWriter*)closure;
+
+    if (offset != writer->size) {
+        if (offset != 0) {
+            fprintf(stderr, "JAR download resumed at the wrong offset\n");
+            return (0);
+        }
+        /* The server sends the whole file again */
+        if (!_TruncatePartialFile(writer)) {
+            return (0);
+        }
+    }
+
+    if (writer->size + len > writer->expectedSize) {
+        fprintf(stderr, "JAR file is larger than its %s (%ld)\n",
+                JAR_FILE_SIZE_TAG, writer->expectedSize);
+        return (0);
+    }
+
+    if (len > 0) {
+        if (fwrite(data, 1, len, writer->fp) != (size_t)len) {
+            return (0);
+        }
+        writer->crc = _UpdateCRC(writer->crc, (const unsigned char*)data, len);
+        writer->size += len;
+    }
+    return (1);
+}
+
+/*
+ * Finish writing a JAR file. If it has the expected size and CRC, it
+ * replaces the stored JAR file of the app.
+ */
+int JamCommitJARFile(JamJarWriter* writer) {
 
     char path[JAM_MAX_PATH];
-    FILE* fp = NULL;
+    char infoPath[JAM_MAX_PATH];
+    char jarPath[JAM_MAX_PATH];
+
+    _GetPartialFileNames(path, infoPath, writer->jarName);
+    _GetStoredFileName(jarPath, writer->jarName);
 
-    if (JamGetFreeSpace() < len) {
-        fprintf(stderr, "not enough storage: needs %d, has %d\n",
-                len, JamGetFreeSpace());
+    if (fclose(writer->fp) != 0) {
+        writer->fp = NULL;
         goto error;
     }
+    writer->fp = NULL;
 
-    _GetStoredFileName(path, app->jarName);
-    if ((fp = fopen(path, "wb+")) == NULL) {
+    if (writer->size != writer->expectedSize) {
+        fprintf(stderr, "JAR file has %ld bytes, expected %ld\n",
+                writer->size, writer->expectedSize);
         goto error;
     }
-    
-    if (fwrite(jarContent, 1, len, fp) != len) {
+    if (writer->checkCRC && writer->crc != writer->expectedCRC) {
+        fprintf(stderr, "JAR file has CRC %08lx, expected %08lx\n",
+                writer->crc, writer->expectedCRC);
+        goto error;
+    }
+
+    unlink(jarPath);
+    if (rename(path, jarPath) != 0) {
         goto error;
     }
-    
-    fclose(fp);
 
     /* OK */
-    usedSpace += len;
+    usedSpace += writer->size - writer->replacedSize;
     return (1);
 
  error:
-    if (fp) {
-        fclose(fp);
+    unlink(path);
+    return (0);
+}
+
+/*
+ * Stop writing a JAR file. If <keepPartial> is TRUE, the data written
+ * so far is kept together with its validators, so that the download
+ * can be resumed later.
+ */
+void JamAbortJARFile(JamJarWriter* writer, bool_t keepPartial) {
+
+    char path[JAM_MAX_PATH];
+    char infoPath[JAM_MAX_PATH];
+    FILE* fp;
+
+    if (writer->fp != NULL) {
+        fclose(writer->fp);
+        writer->fp = NULL;
     }
+    _GetPartialFileNames(path, infoPath, writer->jarName);
 
-    return (0);
+    if (keepPartial && writer->size > 0
+            && (writer->etag[0] != 0 || writer->lastModified[0] != 0)
+            && (fp = fopen(infoPath, "wb+")) != NULL) {
+        fprintf(fp, "ETAG=%s\n", writer->etag);
+        fprintf(fp, "LAST-MODIFIED=%s\n", writer->lastModified);
+        fclose(fp);
+    } else {
+        unlink(path);
+    }
 }
 
 int
@@ -303,6 +503,8 @@ int JamOpenAppsDatabase()
  *      JAR-URL=<jarURL>
  *      APP-NAME=<appName>
  *      VERSION=<version>
+ *      JAR-ETAG=<etag>
+ *      JAR-LAST-MODIFIED=<last modified date>
  * END_APP
  */
 
@@ -366,6 +568,12 @@ JamApp* JamGetNextAppEntry() {
         else if (STRNCMP1("VERSION", line) == 0) {
             app->version = strdup(value);
         }
+        else if (STRNCMP1("JAR-ETAG", line) == 0) {
+            app->etag = strdup(value);
+        }
+        else if (STRNCMP1("JAR-LAST-MODIFIED", line) == 0) {
+            app->lastModified = strdup(value);
+        }
     }
 }
 
@@ -396,6 +604,12 @@ int JamSaveAppsDatabase(void) {
         if (app->version != NULL && app->version[0] != '\0') {
             fprintf(fp, "VERSION=%s\n", app->version);
         }
+        if (app->etag != NULL && app->etag[0] != '\0') {
+            fprintf(fp, "JAR-ETAG=%s\n", app->etag);
+        }
+        if (app->lastModified != NULL && app->lastModified[0] != '\0') {
+            fprintf(fp, "JAR-LAST-MODIFIED=%s\n", app->lastModified);
+        }
         fprintf(fp, "END_APP\n");
     }
     fclose(fp);
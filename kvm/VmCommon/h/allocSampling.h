@@ -0,0 +1,64 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Allocation profiling
+ * FILE:      allocSampling.h
+ * OVERVIEW:  Sampled allocation-site profiling.  Every N bytes, the
+ *            allocator records the method and bytecode index that
+ *            allocated the current object; the samples are aggregated
+ *            into a report of the top allocation sites, together with
+ *            the number of sampled objects that survived the next
+ *            garbage collection.
+ *=======================================================================*/
+
+#if ENABLE_ALLOCATION_SAMPLING
+
+/*=========================================================================
+ * Global variables
+ *=======================================================================*/
+
+/* Number of bytes allocated between samples, or 0 if sampling is off */
+extern long AllocationSampleInterval;
+
+/* Number of bytes left to allocate until the next sample is taken */
+extern long AllocationSampleCountdown;
+
+/*=========================================================================
+ * Allocation sampling operations
+ *=======================================================================*/
+
+void InitializeAllocationSampling(void);
+void FinalizeAllocationSampling(void);
+
+void recordAllocationSample(cell* object, long size);
+void resolveAllocationSamples(void);
+void countAllocationSampleSurvivors(void);
+void printAllocationSites(FILE* file);
+
+/*
+ * Called by the allocator for each object it allocates.  The size
+ * is in bytes and includes the object header.
+ */
+#define sampleAllocation(object, size)                             \
+    if (AllocationSampleInterval > 0 &&                             \
+          (AllocationSampleCountdown -= (size)) <= 0) {             \
+        recordAllocationSample(object, size);                       \
+    }
+
+#else
+
+#define sampleAllocation(object, size)
+#define resolveAllocationSamples()
+#define countAllocationSampleSurvivors()
+#define InitializeAllocationSampling()
+#define FinalizeAllocationSampling()
+
+#endif /* ENABLE_ALLOCATION_SAMPLING */
+
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Application images
+ * FILE:      appImage.h
+ * OVERVIEW:  Application classes romized separately from the VM by
+ *            JavaCodeCompact (-arch KVM_App), and linked against the
+ *            ROM image of the VM at startup (see appImage.c).
+ *=======================================================================*/
+
+/*=========================================================================
+ * Definitions and declarations
+ *=======================================================================*/
+
+#if ENABLE_APP_IMAGE
+
+#if !ROMIZING || RELOCATABLE_ROM
+#error "ENABLE_APP_IMAGE requires a romized, non-relocatable VM"
+#endif
+
+#if !ENABLE_DYNAMIC_NATIVES
+#error "ENABLE_APP_IMAGE requires ENABLE_DYNAMIC_NATIVES"
+#endif
+
+#define APP_IMAGE_MAGIC    0x4B564D41   /* "KVMA" */
+#define APP_IMAGE_VERSION  1
+
+/* The ROM hashtables that an image adds entries to */
+enum {
+    APP_TABLE_UTF,
+    APP_TABLE_CLASS,
+    APP_TABLE_STRING,
+    APP_TABLE_COUNT
+};
+
+/* Kinds of link records.  Each one names an object of the base ROM
+ * image that the application image refers to; the VM stores the
+ * address of that object in the slot of the record.
+ */
+enum {
+    APP_LINK_CLASS,         /* Class with the given key */
+    APP_LINK_METHOD,        /* Method nameTypeKey of the class with key */
+    APP_LINK_FIELD,         /* Field nameTypeKey of the class with key */
+    APP_LINK_NAME,          /* UTF string with the given key */
+    APP_LINK_STRING         /* Interned string with the given contents */
+};
+
+struct appImageLinkStruct {
+    void**       slot;
+    long         kind;
+    long         key;
+    NameTypeKey  nameTypeKey;
+    const char*  string;    /* UTF-8 contents, for APP_LINK_STRING */
+    long         length;
+};
+
+/* The entries of the image sit at the front of the bucket chains of
+ * the ROM hashtables.  The last entry of the image in each bucket is
+ * followed by the entry that was at the head of the bucket when the
+ * image was built.  Its key is recorded so that an image built for a
+ * different ROM is not linked.
+ */
+struct appImageBucketStruct {
+    long         table;     /* APP_TABLE_UTF, ... */
+    long         index;
+    long         headKey;   /* Key of the base head, 0 if none */
+    void*        first;
+    void**       lastNext;
+};
+
+/* The descriptor exported by an image under the name "KVM_AppImage" */
+struct appImageStruct {
+    long         magic;
+    long         version;
+    long         baseCount[APP_TABLE_COUNT];   /* Entries in the base ROM */
+    long         imageCount[APP_TABLE_COUNT];  /* Entries added by the image */
+    long         bucketCount;
+    struct appImageBucketStruct* buckets;
+    long         linkCount;
+    struct appImageLinkStruct* links;
+    long         classCount;
+    CLASS*       classes;
+    long         stringCount;
+    INTERNED_STRING_INSTANCE strings;
+    SHORTARRAY   chars;
+    long*        staticData;
+    long*        masterStaticData;
+    long         staticSize;                   /* In bytes */
+    char*        classBlocks;
+    long         classBlocksSize;              /* In bytes */
+};
+
+#define APP_LINK_CLASS_RECORD(slot, key) \
+    { (void **)(slot), APP_LINK_CLASS, key, { { 0, 0 } }, NULL, 0 }
+#define APP_LINK_METHOD_RECORD(slot, key, nameTypeKey) \
+    { (void **)(slot), APP_LINK_METHOD, key, nameTypeKey, NULL, 0 }
+#define APP_LINK_FIELD_RECORD(slot, key, nameTypeKey) \
+    { (void **)(slot), APP_LINK_FIELD, key, nameTypeKey, NULL, 0 }
+#define APP_LINK_NAME_RECORD(slot, key) \
+    { (void **)(slot), APP_LINK_NAME, key, { { 0, 0 } }, NULL, 0 }
+#define APP_LINK_STRING_RECORD(slot, string, length) \
+    { (void **)(slot), APP_LINK_STRING, 0, { { 0, 0 } }, string, length }
+
+#define APP_BUCKET_RECORD(table, index, headKey, first, lastNext) \
+    { table, index, headKey, (void *)(first), (void **)(lastNext) }
+
+/*=========================================================================
+ * Global variables
+ *=======================================================================*/
+
+/* Image file given with -appimage, or NULL */
+extern char*  AppImageFile;
+
+/* Static variables of the linked image, or NULL.  The layout is that */
+/* of KVM_staticData: a count of pointers followed by the pointers. */
+extern long*  AppImageStaticData;
+
+bool_t inAppImage(void *ptr);
+
+/*=========================================================================
+ * Operations
+ *=======================================================================*/
+
+void InitializeAppImage(void);
+void FinalizeAppImage(void);
+
+#else /* ENABLE_APP_IMAGE */
+
+#define inAppImage(ptr)       FALSE
+
+#define InitializeAppImage()
+#define FinalizeAppImage()
+
+#endif /* ENABLE_APP_IMAGE */
+
@@ -117,6 +117,24 @@ int createInlineCacheEntry(cell* contents, BYTE* originalCode);
 
 ICACHE getInlineCache(int index);
 
+/*=========================================================================
+ * COMMENTS:
+ * The fast bytecodes that access static fields, call static methods
+ * or create objects must check that the class has been initialized
+ * every time they are executed.  Once the class is ready, there is
+ * nothing left to check, and the interpreter replaces the bytecode
+ * with a *_READY bytecode that doesn't.  This is not done while the
+ * class is still being initialized, not even by the current thread,
+ * so that other threads keep waiting for <clinit> to complete.
+ *
+ * The classes are initialized again when the VM is restarted, so the
+ * patched locations in code that survives the restart (that is, code
+ * outside the heap) are remembered, and get their *_FAST bytecodes
+ * back in FinalizeInlineCaching().
+ *=======================================================================*/
+
+bool_t createReadySiteEntry(BYTE* codeLoc);
+
 /*=========================================================================
  * Macro for high performance!
  *=======================================================================*/
@@ -143,6 +161,12 @@ ICACHE getInlineCache(int index);
 
 #define GETINLINECACHE(index) (&InlineCache[index])
 
+/* Breakpoints remember the *_FAST bytecode, so they are left alone */
+#define REPLACE_READY_BYTECODE(ip, bytecode)                 \
+        if (*ip != BREAKPOINT && createReadySiteEntry(ip)) { \
+            *ip = bytecode;                                  \
+        }
+
 #else /* !ENABLEFASTBYTECODES */
 
 #define InitializeInlineCaching()
@@ -367,6 +367,7 @@ extern NameTypeKey runNameAndType;
 extern NameTypeKey mainNameAndType;
 
 extern METHOD RunCustomCodeMethod;
+extern METHOD SystemArraycopyMethod;
 extern THROWABLE_INSTANCE OutOfMemoryObject;
 extern THROWABLE_INSTANCE StackOverflowObject;
 
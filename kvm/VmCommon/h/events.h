@@ -93,6 +93,8 @@ void InterpreterHandleEvent(ulong64);
         checkTimerQueue(&wakeupDelta);                              \
         InterpreterHandleEvent(wakeupDelta);                        \
         __ProcessDebugCmds(0);                                      \
+        checkMetricsDumpRequest();                                  \
+        checkHeapDumpRequest();                                     \
     } while (!SwitchThread());
 
 /*
@@ -195,8 +195,9 @@
 
 #define CHECKARRAY(thisArray, index)                                 \
     if (thisArray) {                                                 \
-        /* Check that the given index is within array boundaries */  \
-        if (index >= 0 && index < (long)thisArray->length) {
+        /* Check that the given index is within array boundaries. */ \
+        /* A negative index becomes too large when made unsigned. */ \
+        if ((unsigned long)index < (unsigned long)thisArray->length) {
 
 /*=========================================================================
  * ENDCHECKARRAY - Finish the check for valid array access
@@ -333,7 +334,7 @@
 #endif
 
 /*=========================================================================
- * RESCHEDULE - Thread rescheduling
+ * FAST_RESCHEDULE/DEBUG_RESCHEDULE - Thread rescheduling
  *=======================================================================*/
 
 #if ENABLE_JAVA_DEBUGGER
@@ -364,20 +365,32 @@
             checkDebugEvent(CurrentThread);                             \
         }
 
-/* This routine/macro is called from inside the interpreter */
-/* to check if it is time to perform thread switching and   */
-/* possibly to check for external events.  This routine is  */
-/* very performance critical!  Most of the function calls   */
-/* inside this macro definition turn into null statements   */
-/* in production builds when debugger support is turned off */
+/* Leave FastInterpret() once the debugger has armed the debug */
+/* interpreter; Interpret() then continues in DebugInterpret() */
+#define __leaveFastInterpreter()                                        \
+        if (DebugInterpreterArmed) {                                    \
+            return;                                                     \
+        }
+
+/* Leave DebugInterpret() when no thread needs it any more */
+#define __leaveDebugInterpreter()                                       \
+        if (!updateDebugInterpreter()) {                                \
+            return;                                                     \
+        }
+
+/* Thread rescheduling for DebugInterpret().  In addition to */
+/* the checks made by FAST_RESCHEDULE below, this fetches    */
+/* the bytecode hidden by a breakpoint and handles single    */
+/* stepping before every bytecode.                           */
 
-#define RESCHEDULE {                            \
+#define DEBUG_RESCHEDULE {                      \
     INC_RESHED                                  \
     checkRescheduleValid();                     \
     if (isTimeToReschedule()) {                 \
         VMSAVE                                  \
         __checkDebugEvent()                     \
         reschedule();                           \
+        __leaveDebugInterpreter()               \
         VMRESTORE                               \
     }                                           \
     if (vmDebugReady && CurrentThread) {        \
@@ -389,6 +402,11 @@
 
 #else
 
+#define __checkDebugEvent()      /**/
+#define __leaveFastInterpreter() /**/
+
+#endif /* ENABLE_JAVA_DEBUGGER */
+
 /* This routine/macro is called from inside the interpreter */
 /* to check if it is time to perform thread switching and   */
 /* possibly to check for external events.  This routine is  */
@@ -396,18 +414,18 @@
 /* inside this macro definition turn into null statements   */
 /* in production builds when debugger support is turned off */
 
-#define RESCHEDULE {                            \
+#define FAST_RESCHEDULE {                       \
     INC_RESHED                                  \
     checkRescheduleValid();                     \
     if (isTimeToReschedule()) {                 \
         VMSAVE                                  \
+        __checkDebugEvent()                     \
         reschedule();                           \
+        __leaveFastInterpreter()                \
         VMRESTORE                               \
     }                                           \
 }
 
-#endif /* ENABLE_JAVA_DEBUGGER */
-
 /*=========================================================================
  * BRANCHIF - Macro to cause a branch if a condition is true
  *=======================================================================*/
@@ -84,6 +84,12 @@ struct methodStruct {
             void (*code)(void);
             void *info;
         } native;
+#if ENABLE_LAZY_METHOD_LOADING
+        struct {              /* Used while ACC_LAZY_CODE is set */
+            unsigned long codeOffset;
+            unsigned long classfileChecksum;
+        } lazy;
+#endif
     } u;
     long  accessFlags;        /* Access indicators (public/private etc.) */
     INSTANCE_CLASS ofClass;   /* Backpointer to the class owning the field */
@@ -64,7 +64,8 @@
 struct stackStruct {
     STACK    next;
     short    size;
-    short    xxunusedxx; /* must be multiple of 4 on all platforms */
+    short    base;       /* Cells used in the chunks before this one */
+                         /* (must be multiple of 4 on all platforms) */
     cell     cells[STACKCHUNKSIZE];
 };
 
@@ -165,6 +166,14 @@ struct exceptionHandlerTableStruct {
 void pushFrame(METHOD thisMethod);
 void popFrame(void);
 
+/*=========================================================================
+ * Stack chunk pool operations
+ *=======================================================================*/
+
+void  InitializeStackChunkPool(void);
+STACK allocateStackChunk(int height);
+void  releaseStackChunks(STACK chunk);
+
 /*=========================================================================
  * Stack frame printing and debugging operations
  *=======================================================================*/
@@ -183,6 +192,22 @@ void printExecutionStack(void);
 
 void throwException(THROWABLE_INSTANCE_HANDLE exception);
 
+void InitializeExceptionHandling(void);
+
+#if ENABLE_PREALLOCATED_EXCEPTIONS
+extern bool_t ReuseVMExceptions;
+#endif
+
+#if CACHE_EXCEPTION_HANDLERS
+void flushExceptionHandlerCache(void);
+#if ENABLEPROFILING
+extern long ExceptionHandlerCacheHitCounter;
+extern long ExceptionHandlerCacheMissCounter;
+#endif
+#else
+#define flushExceptionHandlerCache()
+#endif /* CACHE_EXCEPTION_HANDLERS */
+
 /*=========================================================================
  * Operations for raising exceptions and errors from within the VM
  *=======================================================================*/
@@ -309,6 +309,10 @@ extern cell* AllHeapEnd;
 extern cell* CurrentHeap;    /* Current limits of heap space */
 extern cell* CurrentHeapEnd; /* Current heap top */
 
+#if ENABLE_HEAP_COMPACTION
+extern cell* PermanentSpaceFreePtr; /* Bottom of the permanent space */
+#endif
+
 /*=========================================================================
  * Garbage collection operations
  *=======================================================================*/
@@ -338,6 +342,16 @@ cell* callocObject(long size, GCT_ObjectType type);
 char* mallocBytes(long size);
 cell* callocPermanentObject(long size);
 
+/*    Clear the data area of an object returned by mallocHeapObject().
+ *    The memory is zero already if the collector keeps the free
+ *    space of the heap zeroed (ENABLE_PREZEROED_HEAP).
+ */
+#if ENABLE_PREZEROED_HEAP
+#define CLEAR_NEW_OBJECT(object, bytes)
+#else
+#define CLEAR_NEW_OBJECT(object, bytes) memset((object), 0, (bytes))
+#endif
+
 /*    Printing and debugging operations */
 long  getHeapSize(void);
 long  memoryFree(void);
@@ -347,6 +361,13 @@ long  memoryUsage(void);
 unsigned long  getObjectSize(cell* object);
 GCT_ObjectType getObjectType(cell* object);
 
+#if ENABLE_HEAP_DUMP
+/*  Iteration over the objects in the dynamic heap (see heapDump.c) */
+typedef void (*heapObjectFunction)(cell* object, GCT_ObjectType type,
+                                   long size, void* closure);
+void forEachHeapObject(heapObjectFunction function, void* closure);
+#endif
+
 /*=========================================================================
  * Printing and debugging operations
  *=======================================================================*/
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Garbage collection log
+ * FILE:      gcLog.h
+ * OVERVIEW:  A structured log of garbage collections, with one JSON
+ *            line per collection giving the duration of each phase
+ *            of the collector and the occupancy of the heap.
+ *=======================================================================*/
+
+#if ENABLE_GC_LOG
+
+/*=========================================================================
+ * Data types
+ *=======================================================================*/
+
+/* The phases of a collection, in the order in which they run.  A */
+/* collector that has no separate sweep or compaction phase simply */
+/* doesn't log them. */
+enum {
+    GC_PHASE_START,
+    GC_PHASE_ROOTS,       /* Marking or copying the root objects */
+    GC_PHASE_MARK,        /* Transitive marking or copying */
+    GC_PHASE_WEAK,        /* Weak pointer lists and weak references */
+    GC_PHASE_SWEEP,
+    GC_PHASE_COMPACT,
+    GC_PHASE_COUNT
+};
+
+struct gcLogEventStruct {
+    ulong64 phaseEnd[GC_PHASE_COUNT]; /* Microseconds, 0 if not run */
+    ulong64 threadStacks;   /* Microseconds spent in the thread stacks */
+                            /* while marking the roots */
+    long    requested;      /* Bytes requested by the allocator */
+    long    freeBefore;     /* Free bytes before and after the GC */
+    long    freeAfter;
+    long    largestFree;    /* Largest free chunk after the GC, in bytes */
+    long    breakTable;     /* Break table entries, or -1 if the heap */
+                            /* was not compacted */
+    long    rescans;        /* Extra heap scans after deferral overflows */
+    long    deferralOverflows;
+};
+
+/*=========================================================================
+ * Global variables
+ *=======================================================================*/
+
+/* File name given with -gclog */
+extern char* GCLogFile;
+
+/* TRUE while a collection is being logged */
+extern bool_t GCLogging;
+
+extern struct gcLogEventStruct GCLogEvent;
+
+/*=========================================================================
+ * GC log operations
+ *=======================================================================*/
+
+void InitializeGCLog(void);
+void FinalizeGCLog(void);
+void startGCLogEvent(long requested);
+void endGCLogEvent(void);
+
+/*
+ * Used by the collectors to record the end of a phase, or a value
+ * describing the collection.  These cost one test when no log is
+ * being written.
+ */
+#define logGCPhase(phase) \
+    if (GCLogging) { GCLogEvent.phaseEnd[phase] = CurrentTimeMicros_md(); }
+
+#define logGCValue(field, value) \
+    if (GCLogging) { GCLogEvent.field = (value); }
+
+#define addToGCLog(field, value) \
+    if (GCLogging) { GCLogEvent.field += (value); }
+
+#else
+
+#define InitializeGCLog()
+#define FinalizeGCLog()
+#define startGCLogEvent(requested)
+#define endGCLogEvent()
+#define logGCPhase(phase)
+#define logGCValue(field, value)
+#define addToGCLog(field, value)
+
+#endif /* ENABLE_GC_LOG */
+
@@ -177,9 +177,15 @@ typedef union {
 
 #include <runtime.h>
 #include <profiling.h>
+#include <metrics.h>
+#include <heapDump.h>
+#include <allocSampling.h>
+#include <gcLog.h>
 #include <verifier.h>
 #include <log.h>
 #include <property.h>
+#include <snapshot.h>
+#include <appImage.h>
 
 /*=========================================================================
  * Miscellaneous global variables
@@ -201,6 +207,7 @@ extern bool_t vmDebugReady;
 /* Flags for toggling certain global modes on and off */
 extern bool_t JamEnabled;
 extern bool_t JamRepeat;
+extern bool_t JamZygote;
 
 /*=========================================================================
  * Most frequently called functions are "inlined" here
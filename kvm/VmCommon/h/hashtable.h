@@ -107,6 +107,7 @@ UString getUStringX(CONST_CHAR_HANDLE nameH, int offset, int length);
 
 /* Get a unique String for a given char array */
 INTERNED_STRING_INSTANCE internString(const char *string, int length);
+INTERNED_STRING_INSTANCE findInternedString(const char *string, int length);
 
 /* Convert utf8 to unicode */
 short utf2unicode(const char **utf);
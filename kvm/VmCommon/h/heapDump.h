@@ -0,0 +1,61 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Heap inspection
+ * FILE:      heapDump.h
+ * OVERVIEW:  Class histograms of the heap, and heap dumps in the
+ *            binary HPROF format used by standard heap analyzers.
+ *=======================================================================*/
+
+#if ENABLE_HEAP_DUMP
+
+/*=========================================================================
+ * Global variables
+ *=======================================================================*/
+
+/* Set asynchronously (e.g., by a signal handler) to request a dump */
+extern volatile int HeapDumpRequested;
+
+/* Where requested and out-of-memory heap dumps are written */
+extern char* HeapDumpFile;
+
+/* Write a heap dump the first time an allocation fails */
+extern bool_t HeapDumpOnOutOfMemory;
+
+/*=========================================================================
+ * Heap inspection operations
+ *=======================================================================*/
+
+void   printHeapHistogram(FILE* file);
+bool_t writeHeapDump(const char* fileName);
+void   dumpHeapOnRequest(void);
+void   dumpHeapOnOutOfMemory(void);
+
+/*
+ * Must be called regularly at a point where the VM is in a consistent
+ * state; the interpreter does this each time it reschedules threads.
+ */
+#define checkHeapDumpRequest() \
+    if (HeapDumpRequested) { dumpHeapOnRequest(); }
+
+/*
+ * Called by the allocator when it is about to fail even after
+ * a garbage collection.
+ */
+#define checkHeapDumpOnOutOfMemory() \
+    if (HeapDumpOnOutOfMemory) { dumpHeapOnOutOfMemory(); }
+
+#else
+
+#define checkHeapDumpRequest()
+#define checkHeapDumpOnOutOfMemory()
+
+#endif /* ENABLE_HEAP_DUMP */
+
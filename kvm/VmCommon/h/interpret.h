@@ -343,7 +343,22 @@ typedef enum {
 
         CUSTOMCODE            = 0xDF,
 
-        LASTBYTECODE          = 0xDF
+/*=========================================================================
+ * Fast bytecodes that no longer check that the class is initialized
+ * (a *_FAST bytecode is replaced with one of these once the class of
+ * the field, method or object is ready, see cache.h)
+ *=======================================================================*/
+
+        GETSTATIC_READY       = 0xE0,
+        GETSTATICP_READY      = 0xE1,
+        GETSTATIC2_READY      = 0xE2,
+        PUTSTATIC_READY       = 0xE3,
+        PUTSTATIC2_READY      = 0xE4,
+        INVOKESTATIC_READY    = 0xE5,
+        NEW_READY             = 0xE6,
+        ARRAYCOPY_READY       = 0xE7,
+
+        LASTBYTECODE          = 0xE7
 } ByteCode ;
 
 #define BYTE_CODE_NAMES {              \
@@ -571,7 +586,15 @@ typedef enum {
     "MULTIANEWARRAY_FAST",  /*  0xDC */  \
     "CHECKCAST_FAST",       /*  0xDD */  \
     "INSTANCEOF_FAST",      /*  0xDE */  \
-    "CUSTOMCODE"            /*  0xDF */ } 
+    "CUSTOMCODE",           /*  0xDF */  \
+    "GETSTATIC_READY",      /*  0xE0 */  \
+    "GETSTATICP_READY",     /*  0xE1 */  \
+    "GETSTATIC2_READY",     /*  0xE2 */  \
+    "PUTSTATIC_READY",      /*  0xE3 */  \
+    "PUTSTATIC2_READY",     /*  0xE4 */  \
+    "INVOKESTATIC_READY",   /*  0xE5 */  \
+    "NEW_READY",            /*  0xE6 */  \
+    "ARRAYCOPY_READY"       /*  0xE7 */ } 
 
 /*=========================================================================
  * Definitions and declarations
@@ -624,11 +647,13 @@ void InstructionTrace(BYTE *traceip);
 #endif
 
 #if ENABLEPROFILING && ENABLEFASTBYTECODES
-#define IncrInlineCacheHitCounter()  { InlineCacheHitCounter++;  }
-#define IncrInlineCacheMissCounter() { InlineCacheMissCounter++; }
+#define IncrInlineCacheHitCounter()  \
+    { InlineCacheHitCounter++;  incrementMetric(icacheHits);   }
+#define IncrInlineCacheMissCounter() \
+    { InlineCacheMissCounter++; incrementMetric(icacheMisses); }
 #else
-#define IncrInlineCacheHitCounter() /**/
-#define IncrInlineCacheMissCounter() /**/
+#define IncrInlineCacheHitCounter()  { incrementMetric(icacheHits);   }
+#define IncrInlineCacheMissCounter() { incrementMetric(icacheMisses); }
 #endif
 
 /*=========================================================================
@@ -639,3 +664,8 @@ void SlowInterpret(ByteCode token);
 void FastInterpret(void);
 void Interpret(void);
 
+#if ENABLE_JAVA_DEBUGGER
+void DebugInterpret(void);
+extern bool_t DebugInterpreterArmed;
+#endif
+
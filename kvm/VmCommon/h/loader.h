@@ -67,6 +67,17 @@ extern POINTERLIST filePointerRoot;
 /* the virtual machine. */
 extern bool_t loadedReflectively;
 
+#if ENABLE_LAZY_METHOD_LOADING
+
+#if USESTATIC
+#error "ENABLE_LAZY_METHOD_LOADING cannot be used with USESTATIC"
+#endif
+
+/* TRUE if method code is to be loaded on demand (-lazymethods) */
+extern bool_t LazyMethodLoading;
+
+#endif /* ENABLE_LAZY_METHOD_LOADING */
+
 /*=========================================================================
  * Class file verification operations (performed during class loading)
  *=======================================================================*/
@@ -81,6 +92,13 @@ bool_t isValidName(const char* name, enum validName_type);
 void loadClassfile(INSTANCE_CLASS CurrentClass, bool_t fatalErrorIfFail);
 void loadArrayClass(ARRAY_CLASS);
 
+#if ENABLE_LAZY_METHOD_LOADING
+void loadMethodCode(METHOD);
+void loadClassMethodCode(INSTANCE_CLASS);
+#else
+#define loadClassMethodCode(clazz)
+#endif
+
 /*=========================================================================
  * Generic class file reading operations
  *=======================================================================*/
@@ -102,8 +120,28 @@ void           loadBytes(FILEPOINTER_HANDLE, char *buffer, int length);
 void           skipBytes(FILEPOINTER_HANDLE, unsigned long i);
 int            getBytesAvailable(FILEPOINTER_HANDLE);
 
+#if CACHE_VERIFICATION_RESULT || ENABLE_LAZY_METHOD_LOADING
+/* Returns the complete contents of a class file if they are in memory
+ * (e.g., a JAR file entry), or NULL.  The result points into the heap.
+ */
+unsigned char* getClassfileContents(FILEPOINTER_HANDLE, long *lengthP);
+#endif
+
+#if CACHE_VERIFICATION_RESULT
+/* Returns the size and modification time stamp (see getFileStamp_md())
+ * of the JAR file that a class file was read from, or 0.
+ */
+long           getClassfileStamp(FILEPOINTER_HANDLE);
+
+/* Returns a stamp of the names and stamps of all the JAR files on the
+ * class path, in order, or 0 if the class path contains a directory.
+ */
+long           getJarClassPathStamp(void);
+#endif
+
 void           InitializeClassLoading(void);
 void           FinalizeClassLoading();
+void           appendClassPath(const char *classpath);
 
 FILEPOINTER    openClassfile(INSTANCE_CLASS clazz);
 FILEPOINTER    openResourcefile(BYTES resourceName);
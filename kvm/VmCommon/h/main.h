@@ -70,6 +70,22 @@
 #define IMPLEMENTS_FLOAT 1
 #endif
 
+/* Instructs KVM to use SSE2 instructions in the java.lang.Math
+ * functions on x86 processors.  Turn this on only if the compiler
+ * does all double arithmetic in SSE2 registers (always the case on
+ * x86-64, or with gcc -msse2 -mfpmath=sse on i386); with x87
+ * arithmetic the fdlibm code rounds differently to begin with.
+ * Only those operations whose results are bit-for-bit identical to
+ * the fdlibm code in kvm/VmExtra/src/fp are replaced: the square
+ * root (the hardware instruction is correctly rounded, just like
+ * __ieee754_sqrt) and the two independent polynomial halves of
+ * __kernel_tan, which are evaluated in the two lanes of one SSE2
+ * register.
+ */
+#ifndef USE_SSE2_MATH
+#define USE_SSE2_MATH 0
+#endif
+
 /*
  * Turns class prelinking/preloading (JavaCodeCompact) support on or off.
  * If this option is on, KVM can prelink system classes into the
@@ -164,6 +180,15 @@
 #define ENABLE_HEAP_COMPACTION !CHUNKY_HEAP
 #endif
 
+/* Instructs KVM to keep the free space of the heap zeroed.  The
+ * garbage collector zeroes the memory that it reclaims in large
+ * blocks, so that new objects don't have to be cleared one by one
+ * when they are allocated (see CLEAR_NEW_OBJECT in garbage.h).
+ */
+#ifndef ENABLE_PREZEROED_HEAP
+#define ENABLE_PREZEROED_HEAP 0
+#endif
+
 /* This is a special form of ROMIZING (JavaCodeCompacting) that is used
  * only by the Palm. It allows the rom'ed image to be relocatable even
  * after it is built.  The ROMIZING flag is commonly provided
@@ -173,6 +198,30 @@
 #define RELOCATABLE_ROM 0
 #endif
 
+/* Instructs KVM to support class snapshots.  A snapshot is an image
+ * of the permanent space taken after the system classes and the main
+ * class have been loaded, linked and verified.  It is written with
+ * the '-dumpsnapshot' option and mapped back into memory at startup
+ * with the '-snapshot' option instead of loading those classes again.
+ * This option requires heap compaction (a contiguous permanent space)
+ * and the port-specific mapSnapshotImage_md() family of functions.
+ */
+#ifndef ENABLE_CLASS_SNAPSHOT
+#define ENABLE_CLASS_SNAPSHOT 0
+#endif
+
+/* Instructs KVM to support application images.  An application image
+ * is a shared library holding application classes romized by
+ * JavaCodeCompact against the ROM image of this VM (-arch KVM_App).
+ * It is given with the '-appimage' option and linked into the ROM
+ * hashtables at startup instead of loading those classes from the
+ * classpath.  This option requires ROMIZING (but not RELOCATABLE_ROM)
+ * and ENABLE_DYNAMIC_NATIVES, which provides the library loader.
+ */
+#ifndef ENABLE_APP_IMAGE
+#define ENABLE_APP_IMAGE 0
+#endif
+
 /*=========================================================================
  * Memory allocation settings
  *=======================================================================*/
@@ -207,6 +256,17 @@
 #define INLINECACHESIZE   128
 #endif
 
+/* Maximum number of code locations in ROM and application images
+ * that are patched with bytecodes that skip the class initialization
+ * check (the *_READY bytecodes, see cache.h).  Locations in the heap
+ * are not counted.  Once the table is full, further locations in ROM
+ * keep their *_FAST bytecodes.  This macro is meaningful only if the
+ * ENABLEFASTBYTECODES option is turned on.
+ */
+#ifndef READYCACHESIZE
+#define READYCACHESIZE    1024
+#endif
+
 /* The execution stacks of Java threads in KVM grow and shrink
  * at runtime. This value determines the default size of a new
  * stack frame chunk when more space is needed.
@@ -215,6 +275,37 @@
 #define STACKCHUNKSIZE    128
 #endif
 
+/* Stack chunks that are no longer used, e.g. those of threads that
+ * have died, are kept in a pool of this many chunks for reuse by new
+ * threads and frames (see frame.c).  Chunk sizes are rounded up to
+ * STACK_CHUNK_SIZE_CLASSES size classes: STACKCHUNKSIZE, twice that,
+ * four times that, and so on.
+ */
+#ifndef STACK_CHUNK_POOL_SIZE
+#define STACK_CHUNK_POOL_SIZE    8
+#endif
+
+#ifndef STACK_CHUNK_SIZE_CLASSES
+#define STACK_CHUNK_SIZE_CLASSES 4
+#endif
+
+/* The number of buckets in the hash table that binds native methods
+ * to their implementations (see native.c).  The table is allocated
+ * with malloc() the first time a native method is bound.
+ */
+#ifndef NATIVE_REGISTRY_SIZE
+#define NATIVE_REGISTRY_SIZE 256
+#endif
+
+/* The number of lock records that each thread has for locking
+ * objects without allocating a real monitor (see thread.h).
+ * A thread can hold this many uncontended locks at the same time
+ * before any further nested lock needs a monitor object.
+ */
+#ifndef LOCKRECORDSTACKSIZE
+#define LOCKRECORDSTACKSIZE 8
+#endif
+
 /* The size (in bytes) of a statically allocated area that the
  * virtual machine uses internally in various string operations.
  * See global.h and global.c.
@@ -267,6 +358,130 @@
 #define VERIFYCONSTANTPOOLINTEGRITY 1
 #endif
 
+/* Instructs KVM to remember which classes have passed verification.
+ * The results are kept in a cache file named with the '-verifiercache'
+ * option and are keyed by a SHA-256 digest of each class file and the
+ * size and modification time of its JAR file, so that unchanged classes
+ * are not verified again on the next run.  Only classes read from JAR
+ * files are cached, and the cache is discarded as a whole when the VM
+ * itself changes (see verifierCache.c).  The port must provide
+ * getFileStamp_md().
+ */
+#ifndef CACHE_VERIFICATION_RESULT
+#define CACHE_VERIFICATION_RESULT 0
+#endif
+
+/* Instructs KVM to support the '-lazymethods' option.  In that mode
+ * only the frame and stack sizes of each method are read when a class
+ * is loaded.  The bytecodes, exception handlers and stack maps of
+ * all the methods of a class are read from the class file again when
+ * one of them is first invoked or when the class is verified, which
+ * saves time and heap space for classes that are loaded but never
+ * run, as in large libraries.  Only classes read from JAR files are
+ * loaded lazily.  This option cannot be used together with USESTATIC.
+ */
+#ifndef ENABLE_LAZY_METHOD_LOADING
+#define ENABLE_LAZY_METHOD_LOADING 0
+#endif
+
+/* Instructs KVM to remember the outcome of exception handler table
+ * lookups.  Each (method, code offset, exception class) triple that
+ * the exception dispatcher has examined is kept in a small hashed
+ * cache, so that exceptions that are thrown repeatedly from the same
+ * place (e.g., exceptions used for control flow) do not need to
+ * resolve and compare the classes of each handler again.  The size
+ * of the cache must be a power of two.
+ */
+#ifndef CACHE_EXCEPTION_HANDLERS
+#define CACHE_EXCEPTION_HANDLERS 0
+#endif
+
+#ifndef EXCEPTIONHANDLERCACHESIZE
+#define EXCEPTIONHANDLERCACHESIZE 64
+#endif
+
+/* Instructs KVM to support the '-reuseexceptions' option.  In that
+ * mode the exceptions that the interpreter itself raises without a
+ * message (NullPointerException, ArrayIndexOutOfBoundsException,
+ * ArithmeticException and so on) are allocated only once and then
+ * thrown again each time.  Such exceptions have no backtrace.
+ */
+#ifndef ENABLE_PREALLOCATED_EXCEPTIONS
+#define ENABLE_PREALLOCATED_EXCEPTIONS 0
+#endif
+
+/* Instructs KVM to keep a small set of always-on runtime metrics
+ * (garbage collections and their pause times, allocation volume,
+ * classes loaded, thread switches, inline cache hit rate, run queue
+ * and event queue lengths).  Unlike the ENABLEPROFILING counters,
+ * these are cheap enough for production builds.  The metrics can be
+ * read from Java with com.sun.cldc.util.Metrics, and ports can dump
+ * them in JSON format on request (see metrics.c).
+ */
+#ifndef ENABLE_METRICS
+#define ENABLE_METRICS 0
+#endif
+
+/* Instructs KVM to support heap inspection in production builds:
+ * a per-class histogram of the live objects in the heap, and heap
+ * dumps in the binary HPROF format read by standard heap analyzers.
+ * Both can be requested from Java (com.sun.cldc.util.HeapInspector),
+ * by the host platform, or automatically on the first allocation
+ * failure (see heapDump.c).
+ */
+#ifndef ENABLE_HEAP_DUMP
+#define ENABLE_HEAP_DUMP 0
+#endif
+
+/* Instructs KVM to support sampled allocation-site profiling: every
+ * N bytes, the allocator records the method and bytecode index that
+ * allocated the current object, and whether the object survived the
+ * next garbage collection.  The top allocation sites are reported
+ * when the VM exits (see allocSampling.c).  Sampling is off unless
+ * an interval is given at startup.
+ */
+#ifndef ENABLE_ALLOCATION_SAMPLING
+#define ENABLE_ALLOCATION_SAMPLING 0
+#endif
+
+/* Instructs KVM to support a structured log of garbage collections,
+ * with one JSON line per collection giving the duration of each
+ * phase of the collector, the occupancy of the heap before and after
+ * the collection, and the largest free chunk.  The log is cheap
+ * enough for production use, and is only written when a log file
+ * is given at startup (see gcLog.c).  Ports that enable this must
+ * provide CurrentTimeMicros_md().
+ */
+#ifndef ENABLE_GC_LOG
+#define ENABLE_GC_LOG 0
+#endif
+
+/* Instructs KVM to support loading native libraries at startup.
+ * Each library is given with the -nativelib option, and must define
+ * a function "int KVM_OnLoad(void)" that calls registerNatives() for
+ * the classes whose native methods it implements, and returns zero
+ * on success.  Native methods of romized classes can't be replaced
+ * this way.  This allows native methods to ship separately from
+ * the virtual machine.  Ports that enable this must provide
+ * loadNativeLibrary_md() and findNativeLibrarySymbol_md().
+ */
+#ifndef ENABLE_DYNAMIC_NATIVES
+#define ENABLE_DYNAMIC_NATIVES 0
+#endif
+
+/* Instructs KVM to support a zygote for the Java Application Manager.
+ * With "-jam -zygote", the VM is initialized once, up to the point
+ * where the class path of the application is applied, and each
+ * application then runs in a child process forked from the zygote.
+ * The children share the initialized heap and class tables with the
+ * zygote copy-on-write, so that launching an application skips the
+ * startup of the VM.  Ports that enable this must provide
+ * forkProcess_md(), waitForProcess_md() and getMaxRSS_md().
+ */
+#ifndef ENABLE_ZYGOTE
+#define ENABLE_ZYGOTE 0
+#endif
+
 /* This macro makes the virtual machine sleep when it has
  * no better things to do. The default implementation is
  * a busy loop. Most ports usually require a more efficient
@@ -328,6 +543,17 @@
 #define BASETIMESLICE     TIMESLICEFACTOR
 #endif
 
+/* Threads are scheduled strictly by priority, except that every
+ * PRIORITY_AGING_INTERVAL thread switches the runnable thread that
+ * has waited longest gets to run, whatever its priority.  This keeps
+ * low priority threads from starving.  A smaller number gives low
+ * priority threads a larger share of the processor when threads of
+ * higher priority are busy.
+ */
+#ifndef PRIORITY_AGING_INTERVAL
+#define PRIORITY_AGING_INTERVAL 8
+#endif
+
 /* This option will cause the infrequently called Java bytecodes to be 
  * split into a separate interpreter loop. It has been found that 
  * doing so gives a small space and performance benefit on many systems.
@@ -413,6 +639,9 @@
  */
 
 /* Include code that interacts with an external Java debugger.
+ * The interpreter only makes the per-bytecode debugger checks
+ * while a thread is single-stepped or stopped at a breakpoint
+ * (see DebugInterpret() in execute.c).
  */
 #ifndef ENABLE_JAVA_DEBUGGER
 #define ENABLE_JAVA_DEBUGGER 0
@@ -499,3 +728,12 @@ int KVM_Initialize(void);
 int KVM_Start(int argc, char* argv[]);
 void KVM_Cleanup(void);
 
+#if ENABLE_ZYGOTE
+int StartZygote(void);
+int ForkJVM(int argc, char* argv[]);
+void StopZygote(void);
+
+/* TRUE once the zygote has initialized the VM */
+extern bool_t ZygoteWarm;
+#endif
+
@@ -45,6 +45,20 @@
 #define KVM_MSG_MUST_PROVIDE_CLASS_NAME \
         "Must provide class name"
 
+#define KVM_MSG_CANT_START_ZYGOTE \
+        "Unable to initialize the zygote\n"
+
+#define KVM_MSG_CANT_FORK_ZYGOTE \
+        "Unable to fork the zygote\n"
+
+#define KVM_MSG_ZYGOTE_LAUNCH_3PARAMS \
+        "Zygote: %s reached main in %ld us " \
+        "(a cold start also initializes the VM, %ld us)\n"
+
+#define KVM_MSG_ZYGOTE_CHILD_EXIT_2PARAMS \
+        "Zygote: application max RSS %ld KB, " \
+        "of which up to %ld KB is shared with the zygote\n"
+
 /* Messages in bytecodes.c */
 
 #define KVM_MSG_EXPECTED_INITIALIZED_CLASS \
@@ -337,6 +351,9 @@
 #define KVM_MSG_CLASSFILE_SIZE_DOES_NOT_MATCH \
         "Class file size does not match"
 
+#define KVM_MSG_CLASSFILE_CHANGED \
+        "Class file changed after the class was loaded"
+
 #define KVM_MSG_CANNOT_LOAD_CLASS_1PARAM \
         "Unable to load class %s"
 
@@ -384,6 +401,15 @@
 #define KVM_MSG_NATIVE_METHOD_BAD_USE_OF_TEMPORARY_ROOTS \
         "Native method '%s::%s' has used temporary roots incorrectly" 
 
+#define KVM_MSG_CANT_REGISTER_NATIVES_1STRPARAM \
+        "Unable to register the native methods of %s\n"
+
+#define KVM_MSG_CANT_LOAD_NATIVE_LIBRARY_1STRPARAM \
+        "Unable to load native library %s\n"
+
+#define KVM_MSG_NATIVE_LIBRARY_HAS_NO_ONLOAD_2STRPARAMS \
+        "Native library %s does not define %s\n"
+
 /* Messages in pool.c */
 
 #define KVM_MSG_CANNOT_ACCESS_CLASS_FROM_CLASS_2STRPARAMS \
@@ -430,6 +456,9 @@
 #define KVM_MSG_THREAD_NOT_ON_CONDVAR_QUEUE \
         "Thread not on condvar queue"
 
+#define KVM_MSG_LOCK_RECORD_NOT_FOUND \
+        "Lock record not found"
+
 #define KVM_MSG_COLLECTOR_IS_RUNNING_ON_ENTRY_TO_ASYNCFUNCTIONPROLOG \
         "Collector is running on entry to asyncFunctionProlog"
 
@@ -459,6 +488,44 @@
 #define KVM_MSG_STRANGE_VALUE_OF_THISIP \
         "Strange value of thisIP"
 
+/* Messages in snapshot.c */
+
+#define KVM_MSG_CANT_WRITE_CLASS_SNAPSHOT_1STRPARAM \
+        "Unable to write class snapshot %s"
+
+#define KVM_MSG_CLASS_SNAPSHOT_HEAP_REFERENCE \
+        "Class snapshot refers to the dynamic heap"
+
+#define KVM_MSG_CLASS_SNAPSHOT_FOREIGN_REFERENCE \
+        "Class snapshot refers to memory outside the VM binary"
+
+#define KVM_MSG_CLASS_SNAPSHOT_BAD_CLASS_STATE \
+        "Class in unexpected state while writing class snapshot"
+
+#define KVM_MSG_CLASS_SNAPSHOT_IGNORED_1STRPARAM \
+        "Ignoring out-of-date or unreadable class snapshot %s\n"
+
+/* Messages in appImage.c */
+
+#define KVM_MSG_APP_IMAGE_IGNORED_1STRPARAM \
+        "Ignoring application image %s, which does not match this VM\n"
+
+/* Messages in heapDump.c */
+
+#define KVM_MSG_CANT_WRITE_HEAP_DUMP_1STRPARAM \
+        "Unable to write heap dump %s\n"
+
+#define KVM_MSG_HEAP_DUMP_WRITTEN_1STRPARAM \
+        "Heap dump written to %s\n"
+
+#define KVM_MSG_HEAP_INSPECTION_NOT_SUPPORTED \
+        "Heap inspection is not supported"
+
+/* Messages in gcLog.c */
+
+#define KVM_MSG_CANT_OPEN_GC_LOG_1STRPARAM \
+        "Unable to open GC log %s\n"
+
 /*=========================================================================
  * Messages in VmExtra
  *=======================================================================*/
@@ -582,6 +649,9 @@
 #define KVM_MSG_JAR_UNEXPECTED_BIT_CODES \
         "Unexpected bit codes"
 
+#define KVM_MSG_JAR_CODE_TABLE_OVERFLOW \
+        "Code table overflow"
+
 /* Messages in loaderFile.c */
 
 #define KVM_MSG_RESOURCE_NOT_FOUND_1STRPARAM \
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Runtime metrics
+ * FILE:      metrics.h
+ * OVERVIEW:  A small registry of always-on counters that describe
+ *            the behavior of a running virtual machine.  The metrics
+ *            can be read from Java (com.sun.cldc.util.Metrics), or
+ *            dumped in JSON format on request of the host platform.
+ *=======================================================================*/
+
+/*=========================================================================
+ * COMMENTS:
+ * The counters in profiling.h are only available in profiling builds,
+ * and are printed only when the VM exits.  The metrics defined here
+ * are kept in every build that has ENABLE_METRICS turned on, so they
+ * must be cheap to update: each one is a plain increment or addition.
+ * Values that can be computed on demand (heap size, queue lengths)
+ * are not counted at all, but computed when they are read.
+ *
+ * The order of the metric identifiers below must match the constants
+ * in com.sun.cldc.util.Metrics.
+ *=======================================================================*/
+
+/*=========================================================================
+ * Metric identifiers
+ *=======================================================================*/
+
+enum {
+    METRIC_UPTIME,               /* Milliseconds since the VM started */
+    METRIC_GC_COUNT,             /* Number of garbage collections */
+    METRIC_GC_PAUSE_TOTAL,       /* Total GC pause time in milliseconds */
+    METRIC_GC_PAUSE_MAX,         /* Longest GC pause in milliseconds */
+    METRIC_GC_PAUSE_LAST,        /* Most recent GC pause in milliseconds */
+    METRIC_BYTES_ALLOCATED,      /* Bytes of heap allocated since startup */
+    METRIC_OBJECTS_ALLOCATED,    /* Number of heap objects allocated */
+    METRIC_HEAP_SIZE,            /* Size of the heap in bytes */
+    METRIC_HEAP_FREE,            /* Free heap in bytes */
+    METRIC_CLASSES_LOADED,       /* Number of classes loaded */
+    METRIC_THREAD_SWITCHES,      /* Number of thread switches */
+    METRIC_ICACHE_HITS,          /* Number of inline cache hits */
+    METRIC_ICACHE_MISSES,        /* Number of inline cache misses */
+    METRIC_ICACHE_HIT_PERCENT,   /* Inline cache hit rate in percent */
+    METRIC_RUN_QUEUE_LENGTH,     /* Number of threads waiting to run */
+    METRIC_EVENT_QUEUE_DEPTH,    /* Number of events waiting on the queue */
+    METRIC_STACK_HIGH_WATER,     /* Deepest stack use of any thread, bytes */
+    METRIC_STACK_CHUNKS_ALLOCATED, /* Stack chunks allocated in the heap */
+    METRIC_STACK_CHUNKS_REUSED,  /* Stack chunks taken from the pool */
+    METRIC_VERIFIER_CACHE_HITS,  /* Classes found in the verifier cache */
+    METRIC_VERIFIER_CACHE_MISSES, /* Classes not in the verifier cache */
+    METRIC_COUNT
+};
+
+#if ENABLE_METRICS
+
+/*=========================================================================
+ * Metric counters
+ *=======================================================================*/
+
+struct metricsStruct {
+    ulong64 startTime;           /* Time at which the VM was started */
+    ulong64 bytesAllocated;
+    ulong64 gcPauseTotal;
+    long    gcCount;
+    long    gcPauseMax;
+    long    gcPauseLast;
+    long    objectsAllocated;
+    long    classesLoaded;
+    long    threadSwitches;
+    long    icacheHits;
+    long    icacheMisses;
+    long    stackHighWater;      /* In cells */
+    long    stackChunksAllocated;
+    long    stackChunksReused;
+};
+
+extern struct metricsStruct Metrics;
+
+/* Set asynchronously (e.g., by a signal handler) to request a dump */
+extern volatile int MetricsDumpRequested;
+
+/* Name of the file to which the metrics are appended, or NULL */
+extern char* MetricsDumpFile;
+
+#define incrementMetric(field)    (Metrics.field++)
+#define addToMetric(field, value) (Metrics.field += (value))
+
+/*=========================================================================
+ * Metrics operations
+ *=======================================================================*/
+
+void    InitializeMetrics(void);
+long64  getMetric(int metric);
+long    getStackHighWater(THREAD thread);
+const char* getMetricName(int metric);
+void    recordGCPause(ulong64 startTime);
+void    printMetrics(FILE* file);
+void    dumpMetrics(void);
+
+/*
+ * Must be called regularly at a point where the VM is in a consistent
+ * state; the interpreter does this each time it reschedules threads.
+ */
+#define checkMetricsDumpRequest() \
+    if (MetricsDumpRequested) { dumpMetrics(); }
+
+#else
+
+#define incrementMetric(field)
+#define addToMetric(field, value)
+
+#define InitializeMetrics()
+#define recordGCPause(startTime)
+#define checkMetricsDumpRequest()
+
+#endif /* ENABLE_METRICS */
+
@@ -61,9 +61,7 @@ extern METHOD CurrentNativeMethod;
  * Operations on native functions
  *=======================================================================*/
 
-NativeFunctionPtr getNativeFunction(INSTANCE_CLASS clazz,
-                                    const char* methodName,
-                                    const char* methodSignature);
+NativeFunctionPtr getNativeFunction(INSTANCE_CLASS clazz, NameTypeKey key);
 
 void  invokeNativeFunction(METHOD thisMethod);
 void  nativeInitialization(int *argc, char **argv);
@@ -72,6 +70,26 @@ void  nativeInitialization(int *argc, char **argv);
 void printNativeFunctions(void);
 #endif
 
+/*=========================================================================
+ * Native method registry
+ *=======================================================================*/
+
+/* Native methods are bound through a hash table keyed by the class */
+/* and the name and type key of the method.  The table is built from */
+/* nativeImplementations the first time a native method is bound, */
+/* together with the methods given to registerNatives().  Methods */
+/* registered later override the built-in ones, but only for classes */
+/* loaded from class files: the natives of romized classes are bound */
+/* in the ROM image and can't be replaced. */
+
+bool_t registerNatives(const char* className,
+                       const NativeImplementationType* methods);
+void   FinalizeNativeRegistry(void);
+
+#if ENABLE_DYNAMIC_NATIVES
+bool_t loadNativeLibrary(const char* path);
+#endif
+
 /*=========================================================================
  * Native function prototypes
  *=======================================================================*/
@@ -129,6 +147,8 @@ void Java_java_lang_StringBuffer_toString(void);
 void Java_java_lang_Math_randomInt(void);
 void Java_java_lang_ref_WeakReference_initializeWeakReference(void);
 void Java_java_util_Calendar_init(void);
+void Java_com_sun_cldc_util_Arrays_clear(void);
+void Java_com_sun_cldc_util_Arrays_regionEquals(void);
 void Java_com_sun_cldc_io_Waiter_waitForIO(void);
 void Java_com_sun_cldc_io_j2me_socket_Protocol_initializeInternal(void);
 void Java_com_sun_cldc_io_ConsoleOutputStream_write(void);
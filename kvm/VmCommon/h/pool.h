@@ -69,6 +69,9 @@
 #define ACC_DOUBLE        0x4000  /* Field uses two words */
 #define ACC_POINTER       0x8000  /* Field is a pointer   */
 
+/* Method code has not been read from the class file yet */
+#define ACC_LAZY_CODE     0x10000
+
 /*=========================================================================
  * Array types / type indices from JVM Specification (p. 320)
  *=======================================================================*/
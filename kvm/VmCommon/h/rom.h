@@ -39,10 +39,26 @@
  * Palm, where the header word might not even exist.
  */
 
+/* An application image (see appImage.c) is compiled without the class
+ * blocks of the system classes and without the static data of the VM.
+ * The VM fills in the class pointers when it links the image.
+ */
+#if COMPILING_APPIMAGE
+#define ROM_CLASS_CLASS          NULL
+#define ROM_STRING_CLASS         NULL
+#define ROM_CHAR_ARRAY_CLASS     NULL
+#define ROM_STATIC_DATA          AppImage_staticData
+#else
+#define ROM_CLASS_CLASS          &AllClassblocks.java_lang_Class
+#define ROM_STRING_CLASS         &AllClassblocks.java_lang_String
+#define ROM_CHAR_ARRAY_CLASS     &AllClassblocks.manufacturedArrayOfChar
+#define ROM_STATIC_DATA          KVM_staticData
+#endif
+
 /* The layout of an originally created string */
 
 #define KVM_INIT_JAVA_STRING(offset, length, next) \
-    { &AllClassblocks.java_lang_String, { NULL }, \
+    { ROM_STRING_CLASS, { NULL }, \
       (SHORTARRAY)&stringCharArrayInternal, offset, length, \
       (INTERNED_STRING_INSTANCE)next }
 
@@ -54,7 +70,7 @@
     }
 
 #define CHARARRAY_HEADER(len) \
-    &AllClassblocks.manufacturedArrayOfChar, { NULL}, len
+    ROM_CHAR_ARRAY_CLASS, { NULL}, len
 
 /* A hashtable of a specific length, and its header */
 
@@ -95,25 +111,41 @@
 
 #define INSTANCE_INFO(package, base, next, key, access, size, status,   \
                        finalizer, super, methods, fields, constants, intfs)  \
-{ { &AllClassblocks.java_lang_Class, { NULL } , \
+{ { ROM_CLASS_CLASS, { NULL } , \
     (UString)package, (UString)base, (CLASS)next, access, key },        \
     super, (CONSTANTPOOL)constants, (FIELDTABLE)fields,                 \
     (METHODTABLE)methods, (unsigned short*)intfs, NULL /* statics */, size, status, NULL, (NativeFuncPtr)finalizer }
 
 #define RAW_CLASS_INFO(package, base, next, key, access, ignore)        \
-{ { &AllClassblocks.java_lang_Class, { NULL } , \
+{ { ROM_CLASS_CLASS, { NULL } , \
     (UString)package, (UString)base, (CLASS)next, access, key } }
 
 #define ARRAY_OF_PRIMITIVE(package, base, next, key, access, typeName)  \
-{ { &AllClassblocks.java_lang_Class, { NULL } , \
+{ { ROM_CLASS_CLASS, { NULL } , \
     (UString)package, (UString)base, (CLASS)next, access, key },        \
    { (CLASS)(T_ ## typeName) }, SIZEOF_T_ ## typeName, GCT_ARRAY }
 
 #define ARRAY_OF_OBJECT(package, base, next, key, access, elem)         \
-{ { &AllClassblocks.java_lang_Class, { NULL } , \
+{ { ROM_CLASS_CLASS, { NULL } , \
     (UString)package, (UString)base, (CLASS)next, access, key },        \
     { (CLASS)&elem }, SIZEOF_T_CLASS, GCT_OBJECTARRAY }
 
+/* An array class of an application image whose element class is in the */
+/* ROM image of the VM; the element class is filled in by the VM. */
+#define ARRAY_OF_LINKED_OBJECT(package, base, next, key, access, ignore)\
+{ { ROM_CLASS_CLASS, { NULL } , \
+    (UString)package, (UString)base, (CLASS)next, access, key },        \
+    { NULL }, SIZEOF_T_CLASS, GCT_OBJECTARRAY }
+
+/* JavaCodeCompact writes identical bytecode once.  A method with a copy */
+/* of another method's code uses that code, unless the bytecode can be */
+/* rewritten at runtime, in which case each method keeps its own copy. */
+#if ENABLEFASTBYTECODES || ENABLE_JAVA_DEBUGGER
+#define ROM_SHARED_CODE(own, shared)   own
+#else
+#define ROM_SHARED_CODE(own, shared)   shared
+#endif
+
 #ifdef __GNUC__
 #   define METHOD_INFO(class, code, handlers, stackMaps, flags, argSize, frameSize, maxStackSize, codeSize, nameTypeKey) \
         { nameTypeKey, \
@@ -218,12 +250,12 @@ union ROMconstantPoolEntryStruct {
 #   define FIELD_INFO(class, flags, off, nameTypeKey) \
        { nameTypeKey, flags, &AllClassblocks . class, { offset: off} }
 #    define STATIC_FIELD_INFO(class, flags, off, nameTypeKey) \
-       { nameTypeKey, flags, &AllClassblocks . class, { staticAddress: (KVM_staticData + off) } }
+       { nameTypeKey, flags, &AllClassblocks . class, { staticAddress: (ROM_STATIC_DATA + off) } }
 #else
 #   define FIELD_INFO(class, flags, offset, nameTypeKey) \
        { nameTypeKey, flags, &AllClassblocks . class, { offset } }
 #    define STATIC_FIELD_INFO(class, flags, offset, nameTypeKey) \
-       { nameTypeKey, flags, &AllClassblocks . class, { (long)(KVM_staticData + offset) } }
+       { nameTypeKey, flags, &AllClassblocks . class, { (long)(ROM_STATIC_DATA + offset) } }
 #endif /* __GNUC__ */
 
 #define SIZEOF_T_CHAR 2
@@ -59,6 +59,33 @@ unsigned long *Calendar_md(void);
 ulong64 CurrentTime_md(void);
 #endif
 
+#if ENABLE_GC_LOG || ENABLE_ZYGOTE
+#ifndef CurrentTimeMicros_md
+ulong64 CurrentTimeMicros_md(void);
+#endif
+#endif
+
+#if ENABLE_ZYGOTE
+#ifndef forkProcess_md
+int forkProcess_md(void);
+#endif
+#ifndef waitForProcess_md
+int waitForProcess_md(int pid, long* maxRSS);
+#endif
+#ifndef getMaxRSS_md
+long getMaxRSS_md(void);
+#endif
+#endif
+
+#if ENABLE_DYNAMIC_NATIVES
+#ifndef loadNativeLibrary_md
+void *loadNativeLibrary_md(const char *path);
+#endif
+#ifndef findNativeLibrarySymbol_md
+void *findNativeLibrarySymbol_md(void *library, const char *name);
+#endif
+#endif
+
 #ifndef RandomNumber_md
 long RandomNumber_md();
 #endif
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Class snapshots
+ * FILE:      snapshot.h
+ * OVERVIEW:  Writing and mapping images of the permanent space so that
+ *            classes loaded, linked and verified by an earlier run of
+ *            the VM can be reused at startup (see snapshot.c).
+ *=======================================================================*/
+
+/*=========================================================================
+ * Definitions and declarations
+ *=======================================================================*/
+
+#if ENABLE_CLASS_SNAPSHOT
+
+#if !ENABLE_HEAP_COMPACTION
+#error "ENABLE_CLASS_SNAPSHOT requires ENABLE_HEAP_COMPACTION"
+#endif
+
+/* The address at which snapshot images are written and, if possible,
+ * mapped back.  When the image can be mapped at this address and the
+ * VM binary has not moved, no page of the image needs to be touched
+ * at startup and the pages stay shared between all VM processes.
+ */
+#ifndef SNAPSHOT_PREFERRED_ADDRESS
+#define SNAPSHOT_PREFERRED_ADDRESS ((char *)0x48000000)
+#endif
+
+/* File offset alignment of the image; must be a multiple of the
+ * page size of every platform the snapshot may be mapped on.
+ */
+#ifndef SNAPSHOT_IMAGE_ALIGNMENT
+#define SNAPSHOT_IMAGE_ALIGNMENT 0x10000
+#endif
+
+/*=========================================================================
+ * Global variables
+ *=======================================================================*/
+
+/* Snapshot file given on the command line, or NULL */
+extern char*  ClassSnapshotFile;
+
+/* TRUE if the snapshot file is to be written rather than used */
+extern bool_t ClassSnapshotDump;
+
+/* TRUE if the classes of this VM instance come from a snapshot */
+extern bool_t ClassSnapshotRestored;
+
+/* Bounds of the mapped snapshot image */
+extern char*  ClassSnapshotStart;
+extern char*  ClassSnapshotEnd;
+
+#define inClassSnapshot(ptr) \
+    (((char *)(ptr) >= ClassSnapshotStart) && ((char *)(ptr) < ClassSnapshotEnd))
+
+/*=========================================================================
+ * Operations
+ *=======================================================================*/
+
+void InitializeClassSnapshot(void);
+void DumpClassSnapshot(void);
+void FinalizeClassSnapshot(void);
+
+#else /* ENABLE_CLASS_SNAPSHOT */
+
+#define ClassSnapshotDump     FALSE
+#define ClassSnapshotRestored FALSE
+#define inClassSnapshot(ptr)  FALSE
+
+#define InitializeClassSnapshot()
+#define FinalizeClassSnapshot()
+
+#endif /* ENABLE_CLASS_SNAPSHOT */
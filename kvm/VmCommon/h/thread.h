@@ -233,6 +233,19 @@
  * and KVM 1.0.3.
  *=======================================================================*/
 
+/*=========================================================================
+ * RUN QUEUES
+ * ==========
+ *
+ * The single RunnableThreads queue described above has been replaced
+ * by one run queue per Java priority level (see thread.c).  SwitchThread()
+ * runs the first thread of the highest priority queue that isn't empty,
+ * with an occasional turn for the thread that has waited longest so
+ * that low priority threads can't starve.  As described for
+ * resumeThread(), a thread that becomes runnable with a higher priority
+ * than the current thread causes a reschedule at the next opportunity.
+ *=======================================================================*/
+
 /*=========================================================================
  * Global definitions and variables needed for multitasking
  *=======================================================================*/
@@ -244,13 +257,14 @@ extern THREAD CurrentThread;    /* Current thread */
 extern THREAD MainThread;       /* For debugger code to access */
 
 extern THREAD AllThreads;       /* List of all threads */
-extern THREAD RunnableThreads;  /* Queue of all threads that can be run */
+extern int RunnableThreadCount; /* Number of threads that can be run, */
+                                /* not counting the current thread */
 
 extern int AliveThreadCount;    /* Number of alive threads */
 
 extern int Timeslice;           /* Time slice counter for multitasking */
 
-#define areActiveThreads() (CurrentThread != NULL || RunnableThreads != NULL)
+#define areActiveThreads() (CurrentThread != NULL || RunnableThreadCount > 0)
 #define areAliveThreads()  (AliveThreadCount > 0)
 
 #define MAX_PRIORITY  10        /* These constants must be the same */
@@ -306,6 +320,13 @@ struct threadQueue {
     THREAD nextThread;       /* Queue of runnable or waiting threads */
     JAVATHREAD javaThread;   /* Contains Java-level thread information */
     long   timeslice;        /* Calculated from Java-level thread priority */
+    long   runPriority;      /* Run queue the thread is on, while runnable */
+    long   readySince;       /* Number of thread switches done when the */
+                             /* thread was put on its run queue */
+#if ENABLE_METRICS
+    long   stackHighWater;   /* Deepest use of the execution stack, */
+                             /* in cells */
+#endif
     STACK stack;             /* The execution stack of the thread */
 
     /* The following four variables are used for storing the */
@@ -325,10 +346,12 @@ struct threadQueue {
     long   wakeupTime[2];    /* We can't demand 8-byte alignment of heap
                                 objects  */
     void (*wakeupCall)(THREAD); /* Callback when thread's alarm goes off */
-    struct {
-        int depth;
-        long hashCode;
-    } extendedLock;          /* Used by an object with a FASTLOCK */
+    struct lockRecordStruct {
+        OBJECT object;       /* The object locked, or NULL if unused */
+        long   depth;        /* Locking depth of the object */
+        long   hashCode;     /* Hash code of the object */
+    } lockRecords[LOCKRECORDSTACKSIZE]; /* Used by objects with a FASTLOCK */
+    int    lockRecordCount;  /* Top of the lock record stack */
 
     char* pendingException;  /* Name of an exception (class) that the */
                              /* thread is about to throw */
@@ -396,6 +419,7 @@ void   suspendThread(void);
 void   suspendSpecificThread(THREAD);
 void   resumeThread(THREAD);
 void   resumeSpecificThread(THREAD);
+void   threadPriorityChanged(THREAD);
 int    activeThreadCount(void);
 int    isActivated(THREAD);
 THREAD removeFirstRunnableThread(void);
@@ -495,8 +519,8 @@ enum MHC_Tag_TypeCode {
     MHC_SIMPLE_LOCK  = 1,
 
     /* The upper 30 bits are the thread that locks this object.
-     * thread->extendedLock.hashCode & thread->extendedLock->depth
-     * contain this object's hashCode and and locking depth.
+     * One of the thread's lock records contains the object and
+     * its hashCode and locking depth.
      * There is no other contention for this object. */
     MHC_EXTENDED_LOCK = 2,
 
@@ -515,9 +539,16 @@ enum MHC_Tag_TypeCode {
 #define OBJECT_MHC_EXTENDED_THREAD(obj) \
              ((THREAD)(((char *)(obj)->mhc.address) - MHC_EXTENDED_LOCK))
 
-/* Utility macros for checking and setting lock values */
-#define IS_EXTENDED_LOCK_FREE(thread) (thread->extendedLock.depth == 0)
-#define FREE_EXTENDED_LOCK(thread)    (thread->extendedLock.depth = 0)
+/* LOCKRECORD
+ *
+ * Each thread has a small stack of lock records (see THREAD above),
+ * so that nested locking of several objects by the same thread does
+ * not need any real monitors as long as there is no contention.
+ * Records are normally released in the reverse order of allocation;
+ * a record released out of order leaves a hole that is reused before
+ * the stack grows any further.
+ */
+typedef struct lockRecordStruct* LOCKRECORD;
 
 /* MONITOR */
 struct monitorStruct {
@@ -556,6 +587,12 @@ enum MonitorStatusType  monitorNotify(OBJECT object, bool_t wakeAll);
 /* Remove any monitor associated with this object */
 void clearObjectMonitor(OBJECT object);
 
+/* Called by the garbage collector.  If this object has a real monitor
+ * that no thread owns or waits on, detach the monitor so that the object
+ * goes back to lightweight locking and the monitor can be collected.
+ */
+bool_t deflateObjectMonitor(OBJECT object);
+
 /* If this object has a monitor or monitor-like structure associated with it,
  * then return the address of its "hash code" field.  This function may GC
  * if it returns a non-NULL value.
@@ -30,3 +30,22 @@ void InitializeVerifier(void);
 int  verifyClass(INSTANCE_CLASS c);
 void Vfy_verifyMethodOrAbort(const METHOD vMethod);
 
+#if CACHE_VERIFICATION_RESULT
+
+/* Persistent verification cache (see verifierCache.c) */
+extern char* VerifierCacheFile;
+extern long  VerifierCacheHitCounter;
+extern long  VerifierCacheMissCounter;
+
+void InitializeVerifierCache(void);
+void FinalizeVerifierCache(void);
+void registerClassfileDigest(INSTANCE_CLASS, FILEPOINTER_HANDLE);
+
+#else
+
+#define InitializeVerifierCache()
+#define FinalizeVerifierCache()
+#define registerClassfileDigest(clazz, ClassFileH)
+
+#endif /* CACHE_VERIFICATION_RESULT */
+
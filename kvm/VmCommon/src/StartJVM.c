@@ -23,6 +23,19 @@
 
 #include <global.h>
 
+/*=========================================================================
+ * Variables
+ *=======================================================================*/
+
+#if ENABLE_ZYGOTE
+bool_t ZygoteWarm = FALSE;
+
+/* Time taken to initialize the zygote, and the time at which */
+/* the current child was forked, in microseconds */
+static ulong64 ZygoteWarmupTime;
+static ulong64 ZygoteLaunchTime;
+#endif /* ENABLE_ZYGOTE */
+
 /*=========================================================================
  * Functions
  *=======================================================================*/
@@ -88,71 +101,123 @@ loadMainClass(char* className)
 }
 
 /*=========================================================================
- * FUNCTION:      KVM_Start
+ * FUNCTION:      initializeVirtualMachine()
  * TYPE:          private operation
- * OVERVIEW:      Initialize everything.  This operation is called
- *                when the VM is launched.
+ * OVERVIEW:      Initialize all the runtime structures of the VM and
+ *                load the Java system classes, i.e., everything that
+ *                is done before the main class is loaded.
  * INTERFACE:
- *   parameters:  command line parameters
- *   returns:     zero if everything went well, non-zero otherwise
+ *   parameters:  <none>
+ *   returns:     <nothing>
  *=======================================================================*/
 
-int KVM_Start(int argc, char* argv[])
+static void
+initializeVirtualMachine(void)
 {
-    ARRAY arguments;
-    INSTANCE_CLASS mainClass = NULL;
-    volatile int returnValue = 0; /* Needed to make compiler happy */
-
-    TRY {
-        VM_START {
-        
-            /* If ROMIZING and RELOCATABLE_ROM */
-            CreateROMImage();
+    /* If ROMIZING and RELOCATABLE_ROM */
+    CreateROMImage();
 
-            /* Initialize Floating Point Arithmetic */
-            InitializeFloatingPoint();
+    /* Initialize Floating Point Arithmetic */
+    InitializeFloatingPoint();
 
 #if ASYNCHRONOUS_NATIVE_FUNCTIONS
-            /* Initialize asynchronous I/O system */
-            InitalizeAsynchronousIO();
+    /* Initialize asynchronous I/O system */
+    InitalizeAsynchronousIO();
 #endif
 
-            /* Initialize all the essential runtime structures of the VM */
-            InitializeNativeCode();
-            InitializeVM();
+    /* Initialize all the essential runtime structures of the VM */
+    InitializeNativeCode();
+    InitializeVM();
+
+    /* Initialize global variables */
+    InitializeGlobals();
+
+    /* Initialize profiling variables */
+    InitializeProfiling();
+
+    /* Reset the runtime metrics */
+    InitializeMetrics();
+
+    /* Open the GC log, if one was requested */
+    InitializeGCLog();
+
+    /* Initialize the memory system */
+    InitializeMemoryManagement();
+
+    /* Start sampling allocation sites, if requested */
+    InitializeAllocationSampling();
 
-            /* Initialize global variables */
-            InitializeGlobals();
+    /* Map the class snapshot, if one was requested */
+    InitializeClassSnapshot();
 
-            /* Initialize profiling variables */
-            InitializeProfiling();
+    /* Link the application image, if one was requested */
+    InitializeAppImage();
 
-            /* Initialize the memory system */
-            InitializeMemoryManagement();
+    /* Initialize internal hash tables */
+    InitializeHashtables();
 
-            /* Initialize internal hash tables */
-            InitializeHashtables();
+    /* Initialize inline caching structures */
+    InitializeInlineCaching();
 
-            /* Initialize inline caching structures */
-            InitializeInlineCaching();
+    /* Initialize the class loading interface */
+    InitializeClassLoading();
 
-            /* Initialize the class loading interface */
-            InitializeClassLoading();
+    /* Read the verification results of earlier runs */
+    InitializeVerifierCache();
 
-            /* Load and initialize the Java system classes needed by the VM */
-            InitializeJavaSystemClasses();
+    /* Load and initialize the Java system classes needed by the VM */
+    InitializeJavaSystemClasses();
 
-            /* Initialize the class file verifier */
-            InitializeVerifier();
+    /* Initialize the class file verifier */
+    InitializeVerifier();
 
-            /* Initialize the event handling system */
-            InitializeEvents();
+    /* Initialize the event handling system */
+    InitializeEvents();
+}
+
+/*=========================================================================
+ * FUNCTION:      KVM_Start
+ * TYPE:          private operation
+ * OVERVIEW:      Initialize everything.  This operation is called
+ *                when the VM is launched.
+ * INTERFACE:
+ *   parameters:  command line parameters
+ *   returns:     zero if everything went well, non-zero otherwise
+ *=======================================================================*/
+
+int KVM_Start(int argc, char* argv[])
+{
+    ARRAY arguments;
+    INSTANCE_CLASS mainClass = NULL;
+    volatile int returnValue = 0; /* Needed to make compiler happy */
+
+    TRY {
+        VM_START {
+        
+#if ENABLE_ZYGOTE
+            if (ZygoteWarm) {
+                /* Forked from the zygote: the VM is initialized, but */
+                /* the class path of the application is still missing */
+                appendClassPath(UserClassPath);
+            } else
+#endif /* ENABLE_ZYGOTE */
+            {
+                initializeVirtualMachine();
+            }
 
             /* Load the main application class */
             /* If loading fails, we get a C level exception */
             /* and control is transferred to the CATCH block below */
             mainClass = loadMainClass(argv[0]);
 
+#if ENABLE_CLASS_SNAPSHOT
+            /* Save the classes loaded so far instead of running */
+            if (ClassSnapshotDump) {
+                DumpClassSnapshot();
+                VM_EXIT(0);
+            }
+#endif
+
             /* Parse command line arguments */
             arguments = readCommandLineArguments(argc - 1, argv + 1);
 
@@ -192,6 +257,14 @@ int KVM_Start(int argc, char* argv[])
             }
 #endif /* ENABLE_JAVA_DEBUGGER */
 
+#if ENABLE_ZYGOTE
+            if (ZygoteWarm) {
+                fprintf(stderr, KVM_MSG_ZYGOTE_LAUNCH_3PARAMS, argv[0],
+                        (long)(CurrentTimeMicros_md() - ZygoteLaunchTime),
+                        (long)ZygoteWarmupTime);
+            }
+#endif /* ENABLE_ZYGOTE */
+
             /* Start the interpreter */
             Interpret();
 
@@ -239,14 +312,20 @@ void KVM_Cleanup()
         clearAllBreakpoints();
     }
 #endif
+    FinalizeAllocationSampling();
     FinalizeVM();
     FinalizeInlineCaching();
     FinalizeNativeCode();
+    FinalizeNativeRegistry();
     FinalizeJavaSystemClasses();
     FinalizeClassLoading();
+    FinalizeVerifierCache();
     FinalizeMemoryManagement();
+    FinalizeGCLog();
     DestroyROMImage();
     FinalizeHashtables();
+    FinalizeAppImage();
+    FinalizeClassSnapshot();
 }
 
 /*=========================================================================
@@ -273,3 +352,111 @@ int StartJVM(int argc, char* argv[])
     return returnValue;
 }
 
+#if ENABLE_ZYGOTE
+
+/*=========================================================================
+ * FUNCTION:      StartZygote
+ * TYPE:          public global operation
+ * OVERVIEW:      Initialize the VM up to the point where the main class
+ *                would be loaded, i.e., before the class path of an
+ *                application is applied.  Applications are then run
+ *                with ForkJVM().
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     zero if everything went fine, non-zero otherwise.
+ *=======================================================================*/
+
+int StartZygote(void)
+{
+    volatile int returnValue = 0;
+    ulong64 start = CurrentTimeMicros_md();
+
+    /* The class path of the zygote only has the system classes */
+    char* userClassPath = UserClassPath;
+    UserClassPath = "";
+
+    TRY {
+        VM_START {
+            initializeVirtualMachine();
+        } VM_FINISH(value) {
+            returnValue = value;
+        } VM_END_FINISH
+    } CATCH(e) {
+        Log->uncaughtException(e);
+        returnValue = 1;
+    } END_CATCH
+
+    UserClassPath = userClassPath;
+    if (returnValue != 0) {
+        fprintf(stderr, KVM_MSG_CANT_START_ZYGOTE);
+        KVM_Cleanup();
+        return returnValue;
+    }
+    ZygoteWarmupTime = CurrentTimeMicros_md() - start;
+    ZygoteWarm = TRUE;
+    return 0;
+}
+
+/*=========================================================================
+ * FUNCTION:      ForkJVM
+ * TYPE:          public global operation
+ * OVERVIEW:      Run an application in a child process of the zygote,
+ *                and wait for it to finish.  The child shares the heap
+ *                and the class tables of the zygote copy-on-write, and
+ *                only needs to apply the class path of the application
+ *                (UserClassPath) before it loads the main class.  The
+ *                zygote itself is left unchanged.
+ * INTERFACE:
+ *   parameters:  command line arguments, as for StartJVM()
+ *   returns:     the exit code of the child
+ *=======================================================================*/
+
+int ForkJVM(int argc, char* argv[])
+{
+    int pid;
+    int returnValue;
+    long childRSS;
+
+    if (!ZygoteWarm) {
+        return StartJVM(argc, argv);
+    }
+
+    /* Don't let the child print what is buffered in the zygote */
+    fflush(stdout);
+    fflush(stderr);
+
+    ZygoteLaunchTime = CurrentTimeMicros_md();
+    pid = forkProcess_md();
+    if (pid == 0) {
+        exit(StartJVM(argc, argv));
+    }
+    if (pid < 0) {
+        fprintf(stderr, KVM_MSG_CANT_FORK_ZYGOTE);
+        return -1;
+    }
+
+    /* The RSS of this child only, not the maximum over all children */
+    returnValue = waitForProcess_md(pid, &childRSS);
+    fprintf(stderr, KVM_MSG_ZYGOTE_CHILD_EXIT_2PARAMS,
+            childRSS, getMaxRSS_md());
+    return returnValue;
+}
+
+/*=========================================================================
+ * FUNCTION:      StopZygote
+ * TYPE:          public global operation
+ * OVERVIEW:      Shut down the VM of the zygote.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void StopZygote(void)
+{
+    if (ZygoteWarm) {
+        ZygoteWarm = FALSE;
+        KVM_Cleanup();
+    }
+}
+
+#endif /* ENABLE_ZYGOTE */
@@ -0,0 +1,467 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Allocation profiling
+ * FILE:      allocSampling.c
+ * OVERVIEW:  Sampled allocation-site profiling.  Each time another
+ *            AllocationSampleInterval bytes have been allocated, the
+ *            allocator calls recordAllocationSample() with the object
+ *            it has just allocated.  The method and bytecode index of
+ *            the allocating frame are recorded, and the object itself
+ *            is kept in a weak pointer list until the next garbage
+ *            collection, which tells us whether it survived.
+ *=======================================================================*/
+
+/*=========================================================================
+ * COMMENTS:
+ * When a sample is taken, the object has not been initialized yet,
+ * so its class is only looked up at the start of the next garbage
+ * collection (resolveAllocationSamples).  At that point the sample
+ * is added to the table of allocation sites, which is keyed by
+ * method, bytecode index, class and GC type.  After the collection,
+ * the entries of the weak pointer list that are still non-NULL are
+ * the sampled objects that survived (countAllocationSampleSurvivors).
+ *
+ * At most MAXIMUM_PENDING_SAMPLES samples can be waiting for a
+ * collection; further samples are dropped and counted.  The site
+ * table is allocated with malloc() rather than in the Java heap.
+ *=======================================================================*/
+
+/*=========================================================================
+ * Include files
+ *=======================================================================*/
+
+#include <global.h>
+
+#if ENABLE_ALLOCATION_SAMPLING
+
+/*=========================================================================
+ * Global variables
+ *=======================================================================*/
+
+long AllocationSampleInterval;
+long AllocationSampleCountdown;
+
+#define MAXIMUM_PENDING_SAMPLES 256
+#define MAXIMUM_REPORTED_SITES  30
+
+/*  ALLOCATIONSITE */
+typedef struct allocationSiteStruct {
+    METHOD         method;    /* Allocating method, or NULL if the */
+                              /* object was allocated by the VM itself */
+    long           bci;       /* Bytecode index, or -1 if unknown */
+    CLASS          clazz;     /* Class of the objects, or NULL for */
+                              /* VM-internal objects */
+    GCT_ObjectType type;      /* GC type of the objects */
+    long           samples;   /* Number of samples taken at this site */
+    long           bytes;     /* Total size of the sampled objects */
+    long           collected; /* Samples that have been through a GC */
+    long           survived;  /* ...and were still alive after it */
+} *ALLOCATIONSITE;
+
+/*  PENDINGSAMPLE */
+typedef struct pendingSampleStruct {
+    METHOD         method;
+    long           bci;
+    long           size;
+    CLASS          clazz;     /* Filled in by resolveAllocationSamples */
+    GCT_ObjectType type;
+} *PENDINGSAMPLE;
+
+static ALLOCATIONSITE Sites;           /* Open hash table of sites */
+static long           SiteCapacity;    /* Always a power of two */
+static long           SiteCount;
+static bool_t         SiteTableFailed; /* Ran out of malloc memory */
+
+/* The sampled objects that haven't been through a GC yet */
+static WEAKPOINTERLIST           PendingObjects;
+static struct pendingSampleStruct PendingSamples[MAXIMUM_PENDING_SAMPLES];
+static long                      PendingCount;
+static bool_t                    PendingResolved;
+
+static long TotalSamples;
+static long DroppedSamples;
+
+static const char* const GCTypeNames[] = GCT_TYPENAMES;
+
+/*=========================================================================
+ * Allocation site table
+ *=======================================================================*/
+
+static ALLOCATIONSITE
+findAllocationSite(ALLOCATIONSITE sites, long capacity, METHOD method,
+                   long bci, CLASS clazz, GCT_ObjectType type)
+{
+    unsigned long hash = ((unsigned long)method >> 2) * 31
+                       + ((unsigned long)clazz >> 2) * 7 + bci * 3 + type;
+    long index = hash & (capacity - 1);
+
+    for (;;) {
+        ALLOCATIONSITE site = &sites[index];
+        if (site->samples == 0 ||
+              (site->method == method && site->bci == bci &&
+               site->clazz == clazz && site->type == type)) {
+            return site;
+        }
+        index = (index + 1) & (capacity - 1);
+    }
+}
+
+static bool_t growAllocationSites(void)
+{
+    long newCapacity = (SiteCapacity == 0) ? 128 : SiteCapacity * 2;
+    ALLOCATIONSITE newSites = (ALLOCATIONSITE)
+        calloc(newCapacity, sizeof(struct allocationSiteStruct));
+    long i;
+
+    if (newSites == NULL) {
+        return FALSE;
+    }
+    for (i = 0; i < SiteCapacity; i++) {
+        ALLOCATIONSITE site = &Sites[i];
+        if (site->samples != 0) {
+            *findAllocationSite(newSites, newCapacity, site->method,
+                                site->bci, site->clazz, site->type) = *site;
+        }
+    }
+    free(Sites);
+    Sites = newSites;
+    SiteCapacity = newCapacity;
+    return TRUE;
+}
+
+static ALLOCATIONSITE addAllocationSample(PENDINGSAMPLE sample)
+{
+    ALLOCATIONSITE site;
+
+    if (SiteTableFailed) {
+        return NULL;
+    }
+    if ((SiteCount + 1) * 4 > SiteCapacity * 3 && !growAllocationSites()) {
+        SiteTableFailed = TRUE;
+        return NULL;
+    }
+    site = findAllocationSite(Sites, SiteCapacity, sample->method,
+                              sample->bci, sample->clazz, sample->type);
+    if (site->samples == 0) {
+        site->method = sample->method;
+        site->bci = sample->bci;
+        site->clazz = sample->clazz;
+        site->type = sample->type;
+        SiteCount++;
+    }
+    site->samples++;
+    site->bytes += sample->size;
+    return site;
+}
+
+static CLASS getJavaClass(cell* object, GCT_ObjectType type)
+{
+    switch (type) {
+        case GCT_INSTANCE:
+        case GCT_WEAKREFERENCE:
+        case GCT_ARRAY:
+        case GCT_OBJECTARRAY:
+            return ((OBJECT)object)->ofClass;
+        default:
+            return NULL;
+    }
+}
+
+/*=========================================================================
+ * Allocation sampling operations
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      InitializeAllocationSampling
+ * TYPE:          public global operation
+ * OVERVIEW:      Reset the allocation site table, and allocate the
+ *                weak pointer list that holds the pending samples.
+ *                Must be called after the memory system has been
+ *                initialized.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void InitializeAllocationSampling()
+{
+    Sites = NULL;
+    SiteCapacity = 0;
+    SiteCount = 0;
+    SiteTableFailed = FALSE;
+    PendingObjects = NULL;
+    PendingCount = 0;
+    PendingResolved = FALSE;
+    TotalSamples = 0;
+    DroppedSamples = 0;
+
+    if (AllocationSampleInterval <= 0) {
+        AllocationSampleInterval = 0;
+        return;
+    }
+    AllocationSampleCountdown = AllocationSampleInterval;
+
+    makeGlobalRoot((cell **)&PendingObjects);
+    PendingObjects = (WEAKPOINTERLIST)
+        callocObject(SIZEOF_WEAKPOINTERLIST(MAXIMUM_PENDING_SAMPLES),
+                     GCT_WEAKPOINTERLIST);
+    PendingObjects->length = MAXIMUM_PENDING_SAMPLES;
+}
+
+/*=========================================================================
+ * FUNCTION:      FinalizeAllocationSampling
+ * TYPE:          public global operation
+ * OVERVIEW:      Print the allocation site report to stderr, and free
+ *                the site table.  Must be called while the heap and
+ *                the classes still exist.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void FinalizeAllocationSampling()
+{
+    if (AllocationSampleInterval > 0) {
+        printAllocationSites(stderr);
+    }
+    free(Sites);
+    Sites = NULL;
+    SiteCapacity = 0;
+    SiteCount = 0;
+    PendingObjects = NULL;
+    PendingCount = 0;
+    AllocationSampleInterval = 0;
+}
+
+/*=========================================================================
+ * FUNCTION:      recordAllocationSample
+ * TYPE:          public global operation
+ * OVERVIEW:      Take a sample of an object that has just been
+ *                allocated, attributing it to the method and bytecode
+ *                index of the current frame.
+ * INTERFACE:
+ *   parameters:  object: the new object (after the header)
+ *                size: its size in bytes, including the header
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void recordAllocationSample(cell* object, long size)
+{
+    METHOD method = NULL;
+    long bci = -1;
+    PENDINGSAMPLE sample;
+
+    /* Start counting towards the next sample */
+    AllocationSampleCountdown += AllocationSampleInterval;
+    if (AllocationSampleCountdown <= 0) {
+        AllocationSampleCountdown = AllocationSampleInterval;
+    }
+
+    if (PendingObjects == NULL) {
+        /* Still initializing */
+        return;
+    }
+    TotalSamples++;
+    if (PendingCount >= MAXIMUM_PENDING_SAMPLES || PendingResolved) {
+        DroppedSamples++;
+        return;
+    }
+
+    if (CurrentThread != NULL && getFP() != NULL) {
+        method = getFP()->thisMethod;
+        if (method != NULL && (method->accessFlags & ACC_NATIVE) == 0) {
+            BYTE* code = method->u.java.code;
+            if (getIP() >= code && getIP() < code + method->u.java.codeLength) {
+                bci = getIP() - code;
+            }
+        }
+    }
+
+    sample = &PendingSamples[PendingCount];
+    sample->method = method;
+    sample->bci = bci;
+    sample->size = size;
+    sample->clazz = NULL;
+    sample->type = GCT_FREE;
+    PendingObjects->data[PendingCount].cellp = object;
+    PendingCount++;
+}
+
+/*=========================================================================
+ * FUNCTION:      resolveAllocationSamples
+ * TYPE:          public global operation
+ * OVERVIEW:      Called at the start of each garbage collection.  Look
+ *                up the class of each pending sample, whose object is
+ *                now initialized, and add the sample to the table of
+ *                allocation sites.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void resolveAllocationSamples()
+{
+    long i;
+
+    if (PendingObjects == NULL || PendingResolved) {
+        return;
+    }
+    for (i = 0; i < PendingCount; i++) {
+        PENDINGSAMPLE sample = &PendingSamples[i];
+        cell* object = PendingObjects->data[i].cellp;
+        if (object != NULL) {
+            sample->type = (GCT_ObjectType)
+                ((object[-HEADERSIZE] & TYPEMASK) >> TYPE_SHIFT);
+            sample->clazz = getJavaClass(object, sample->type);
+        }
+        addAllocationSample(sample);
+    }
+    PendingResolved = TRUE;
+}
+
+/*=========================================================================
+ * FUNCTION:      countAllocationSampleSurvivors
+ * TYPE:          public global operation
+ * OVERVIEW:      Called at the end of each garbage collection.  Count
+ *                the pending samples whose objects are still alive,
+ *                and start over with an empty list.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void countAllocationSampleSurvivors()
+{
+    long i;
+
+    if (PendingObjects == NULL || !PendingResolved) {
+        return;
+    }
+    for (i = 0; i < PendingCount; i++) {
+        PENDINGSAMPLE sample = &PendingSamples[i];
+        ALLOCATIONSITE site = (Sites == NULL) ? NULL :
+            findAllocationSite(Sites, SiteCapacity, sample->method,
+                               sample->bci, sample->clazz, sample->type);
+        if (site != NULL && site->samples != 0) {
+            site->collected++;
+            if (PendingObjects->data[i].cellp != NULL) {
+                site->survived++;
+            }
+        }
+        PendingObjects->data[i].cellp = NULL;
+    }
+    PendingCount = 0;
+    PendingResolved = FALSE;
+}
+
+/*=========================================================================
+ * Allocation site report
+ *=======================================================================*/
+
+static void printSampleClassName(FILE* file, CLASS clazz)
+{
+    UString packageName = clazz->packageName;
+    int length = clazz->baseName->length
+               + (packageName == NULL ? 0 : packageName->length) + 5;
+    char* name = (char*)malloc(length);
+
+    if (name != NULL) {
+        getClassName_inBuffer(clazz, name);
+        fprintf(file, "%s", name);
+        free(name);
+    }
+}
+
+static int compareAllocationSites(const void* a, const void* b)
+{
+    long samplesA = ((ALLOCATIONSITE)a)->samples;
+    long samplesB = ((ALLOCATIONSITE)b)->samples;
+    return (samplesA < samplesB) ? 1 : (samplesA > samplesB) ? -1 : 0;
+}
+
+/*=========================================================================
+ * FUNCTION:      printAllocationSites
+ * TYPE:          public global operation
+ * OVERVIEW:      Print the allocation sites that were sampled most
+ *                often.  The estimated number of bytes is the number
+ *                of samples times the sampling interval.  The survival
+ *                column counts the sampled objects that were still
+ *                alive after the first GC that followed their
+ *                allocation.
+ * INTERFACE:
+ *   parameters:  file: the stream to print to
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void printAllocationSites(FILE* file)
+{
+    ALLOCATIONSITE sorted;
+    long i, n;
+
+    /* Samples taken since the last GC have no survival data yet */
+    resolveAllocationSamples();
+
+    fprintf(file, "Allocation sites: one sample every %ld bytes, "
+                  "%ld samples, %ld dropped%s\n",
+            AllocationSampleInterval, TotalSamples, DroppedSamples,
+            SiteTableFailed ? " (incomplete)" : "");
+    if (SiteCount == 0) {
+        fflush(file);
+        return;
+    }
+
+    sorted = (ALLOCATIONSITE)
+        malloc(SiteCount * sizeof(struct allocationSiteStruct));
+    if (sorted == NULL) {
+        return;
+    }
+    for (i = 0, n = 0; i < SiteCapacity; i++) {
+        if (Sites[i].samples != 0) {
+            sorted[n++] = Sites[i];
+        }
+    }
+    qsort(sorted, n, sizeof(struct allocationSiteStruct),
+          compareAllocationSites);
+    if (n > MAXIMUM_REPORTED_SITES) {
+        n = MAXIMUM_REPORTED_SITES;
+    }
+
+    fprintf(file, " num   samples  est. bytes   survived  site\n");
+    fprintf(file, "-----------------------------------------------------"
+                  "------------------\n");
+    for (i = 0; i < n; i++) {
+        ALLOCATIONSITE site = &sorted[i];
+        fprintf(file, "%4ld: %8ld %11ld %5ld/%-5ld  ", i + 1,
+                site->samples, site->samples * AllocationSampleInterval,
+                site->survived, site->collected);
+        if (site->method != NULL) {
+            printSampleClassName(file, (CLASS)site->method->ofClass);
+            fprintf(file, ".%s", methodName(site->method));
+            if (site->bci >= 0) {
+                fprintf(file, " @%ld", site->bci);
+            }
+        } else {
+            fprintf(file, "<vm>");
+        }
+        fprintf(file, "  allocates ");
+        if (site->clazz != NULL) {
+            printSampleClassName(file, site->clazz);
+        } else {
+            fprintf(file, "<%s>", GCTypeNames[site->type]);
+        }
+        fprintf(file, "\n");
+    }
+    fflush(file);
+    free(sorted);
+}
+
+#endif /* ENABLE_ALLOCATION_SAMPLING */
+
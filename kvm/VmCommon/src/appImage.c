@@ -0,0 +1,412 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Application images
+ * FILE:      appImage.c
+ * OVERVIEW:  An application image holds the classes of an application
+ *            romized by JavaCodeCompact (-arch KVM_App) against the
+ *            ROM image of a particular VM build.  The image is a
+ *            position-independent shared library that is loaded at
+ *            startup and linked into the ROM hashtables, so that the
+ *            application starts without loading, verifying or
+ *            linking any class file, and the pages of its classes are
+ *            shared between all VM processes running it.
+ *
+ *            The romizer writes references to objects of the base
+ *            ROM image (system classes, their methods and fields,
+ *            names and interned strings) as link records: a slot in
+ *            the image and the key of the object it refers to.  The
+ *            keys are those of the base ROM, which JavaCodeCompact
+ *            writes to a key file (-imageAttribute keys=<file>) when
+ *            it romizes the VM.  The image is ignored, and the classes
+ *            loaded from the classpath as usual, if it was built
+ *            against a different ROM.
+ *=======================================================================*/
+
+/*=========================================================================
+ * Include files
+ *=======================================================================*/
+
+#include <global.h>
+
+#if ENABLE_APP_IMAGE
+
+/*=========================================================================
+ * Variables
+ *=======================================================================*/
+
+char* AppImageFile;
+long* AppImageStaticData;
+
+static HASHTABLE *const appImageTables[APP_TABLE_COUNT] = {
+    &UTFStringTable, &ClassTable, &InternStringTable
+};
+
+/* The loaded image; it stays loaded when the VM is restarted */
+static struct appImageStruct* AppImage;
+static bool_t AppImageLinked;
+
+/*=========================================================================
+ * Static functions (private to this file)
+ *=======================================================================*/
+
+static struct appImageStruct* loadAppImage(void);
+static bool_t checkBaseImage(struct appImageStruct *image);
+static UString findUString(long key);
+static CLASS findClass(FieldTypeKey key);
+static void* findLinkTarget(struct appImageLinkStruct *link);
+
+/*=========================================================================
+ * Helper functions
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      loadAppImage()
+ * TYPE:          private operation
+ * OVERVIEW:      Load the image given by AppImageFile and find its
+ *                descriptor.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     the descriptor of the image, or NULL
+ *=======================================================================*/
+
+static struct appImageStruct*
+loadAppImage(void)
+{
+    void *library = loadNativeLibrary_md(AppImageFile);
+    struct appImageStruct *image;
+
+    if (library == NULL) {
+        return NULL;
+    }
+    image = (struct appImageStruct *)
+        findNativeLibrarySymbol_md(library, "KVM_AppImage");
+    if (image == NULL
+          || image->magic != APP_IMAGE_MAGIC
+          || image->version != APP_IMAGE_VERSION) {
+        return NULL;
+    }
+    return image;
+}
+
+/*=========================================================================
+ * FUNCTION:      checkBaseImage()
+ * TYPE:          private operation
+ * OVERVIEW:      Check that the ROM hashtables are those that the image
+ *                was built against: same sizes, same number of entries,
+ *                and the same entry at the head of each bucket that the
+ *                image adds entries to.
+ * INTERFACE:
+ *   parameters:  image: the image descriptor
+ *   returns:     TRUE if the image can be linked
+ *=======================================================================*/
+
+static bool_t
+checkBaseImage(struct appImageStruct *image)
+{
+    long i;
+
+    for (i = 0; i < APP_TABLE_COUNT; i++) {
+        if ((*appImageTables[i])->count != image->baseCount[i]) {
+            return FALSE;
+        }
+    }
+    for (i = 0; i < image->bucketCount; i++) {
+        struct appImageBucketStruct *bucket = &image->buckets[i];
+        HASHTABLE table;
+        cell *head;
+        long headKey;
+
+        if (bucket->table < 0 || bucket->table >= APP_TABLE_COUNT) {
+            return FALSE;
+        }
+        table = *appImageTables[bucket->table];
+        if (bucket->index < 0 || bucket->index >= table->bucketCount) {
+            return FALSE;
+        }
+        head = table->bucket[bucket->index];
+        if (head == NULL) {
+            headKey = 0;
+        } else if (bucket->table == APP_TABLE_UTF) {
+            headKey = ((UString)head)->key;
+        } else if (bucket->table == APP_TABLE_CLASS) {
+            headKey = ((CLASS)head)->key;
+        } else {
+            /* Strings have no keys; any chain will do */
+            headKey = bucket->headKey;
+        }
+        if (headKey != bucket->headKey) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*=========================================================================
+ * FUNCTION:      findUString()
+ * TYPE:          private operation
+ * OVERVIEW:      Find the UTF string with the given key.
+ * INTERFACE:
+ *   parameters:  key: a name key
+ *   returns:     the string, or NULL if there is none
+ *=======================================================================*/
+
+static UString
+findUString(long key)
+{
+    HASHTABLE table = UTFStringTable;
+    UString string = (UString)table->bucket[key % table->bucketCount];
+
+    for ( ; string != NULL; string = string->next) {
+        if (string->key == key) {
+            return string;
+        }
+    }
+    return NULL;
+}
+
+/*=========================================================================
+ * FUNCTION:      findClass()
+ * TYPE:          private operation
+ * OVERVIEW:      Find the class with the given key.  Unlike
+ *                change_Key_to_CLASS(), this never creates an array class.
+ * INTERFACE:
+ *   parameters:  key: a class key
+ *   returns:     the class, or NULL if there is none
+ *=======================================================================*/
+
+static CLASS
+findClass(FieldTypeKey key)
+{
+    HASHTABLE table = ClassTable;
+    int depth = key >> FIELD_KEY_ARRAY_SHIFT;
+    int index;
+
+    if (depth == 0 || depth == MAX_FIELD_KEY_ARRAY_DEPTH) {
+        return change_Key_to_CLASS(key);
+    }
+
+    /* Array classes with short keys aren't hashed by key */
+    for (index = 0; index < table->bucketCount; index++) {
+        CLASS clazz = (CLASS)table->bucket[index];
+        for ( ; clazz != NULL; clazz = clazz->next) {
+            if (clazz->key == key) {
+                return clazz;
+            }
+        }
+    }
+    return NULL;
+}
+
+/*=========================================================================
+ * FUNCTION:      findLinkTarget()
+ * TYPE:          private operation
+ * OVERVIEW:      Find the object of the base ROM that a link record
+ *                refers to.
+ * INTERFACE:
+ *   parameters:  link: the link record
+ *   returns:     the object, or NULL if the base ROM has no such object
+ *=======================================================================*/
+
+static void*
+findLinkTarget(struct appImageLinkStruct *link)
+{
+    CLASS clazz;
+
+    switch (link->kind) {
+    case APP_LINK_NAME:
+        return findUString(link->key);
+
+    case APP_LINK_STRING: {
+        INTERNED_STRING_INSTANCE string =
+            findInternedString(link->string, link->length);
+        return (string == NULL || inAnyHeap(string)) ? NULL : string;
+    }
+
+    case APP_LINK_CLASS:
+    case APP_LINK_METHOD:
+    case APP_LINK_FIELD:
+        clazz = findClass((FieldTypeKey)link->key);
+        if (clazz == NULL || inAnyHeap(clazz)) {
+            return NULL;
+        }
+        if (link->kind == APP_LINK_CLASS) {
+            return clazz;
+        }
+        if (IS_ARRAY_CLASS(clazz)) {
+            return NULL;
+        }
+        if (link->kind == APP_LINK_METHOD) {
+            FOR_EACH_METHOD(method, ((INSTANCE_CLASS)clazz)->methodTable)
+                if (method->nameTypeKey.nt.nameKey
+                            == link->nameTypeKey.nt.nameKey
+                    && method->nameTypeKey.nt.typeKey
+                            == link->nameTypeKey.nt.typeKey) {
+                    return method;
+                }
+            END_FOR_EACH_METHOD
+        } else {
+            FOR_EACH_FIELD(field, ((INSTANCE_CLASS)clazz)->fieldTable)
+                if (field->nameTypeKey.nt.nameKey
+                            == link->nameTypeKey.nt.nameKey
+                    && field->nameTypeKey.nt.typeKey
+                            == link->nameTypeKey.nt.typeKey) {
+                    return field;
+                }
+            END_FOR_EACH_FIELD
+        }
+        return NULL;
+
+    default:
+        return NULL;
+    }
+}
+
+/*=========================================================================
+ * Application image operations
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      inAppImage()
+ * TYPE:          public debugging operation
+ * OVERVIEW:      Check whether an object is a class or an interned
+ *                string of the linked image.
+ * INTERFACE:
+ *   parameters:  ptr: any pointer
+ *   returns:     TRUE if the object is part of the image
+ *=======================================================================*/
+
+bool_t
+inAppImage(void *ptr)
+{
+    struct appImageStruct *image = AppImage;
+    char *p = (char *)ptr;
+
+    if (!AppImageLinked) {
+        return FALSE;
+    }
+    return (p >= image->classBlocks
+                && p < image->classBlocks + image->classBlocksSize)
+        || (p >= (char *)image->strings
+                && p < (char *)(image->strings + image->stringCount))
+        || (ptr == (void *)image->chars);
+}
+
+/*=========================================================================
+ * FUNCTION:      InitializeAppImage()
+ * TYPE:          public global operation
+ * OVERVIEW:      Load the image given by AppImageFile, if any, resolve
+ *                its link records and put its classes, names and
+ *                strings at the front of the ROM hashtables.  Called
+ *                right after the memory system has been initialized
+ *                and before the hashtables are used.  An image that
+ *                cannot be used is reported and ignored.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void InitializeAppImage(void)
+{
+    struct appImageStruct *image;
+    long i;
+
+    AppImageLinked = FALSE;
+    AppImageStaticData = NULL;
+    if (AppImageFile == NULL) {
+        return;
+    }
+    if (ClassSnapshotDump || ClassSnapshotRestored) {
+        /* Both add entries to the front of the ROM bucket chains */
+        fprintf(stderr, KVM_MSG_APP_IMAGE_IGNORED_1STRPARAM, AppImageFile);
+        return;
+    }
+    if (AppImage == NULL) {
+        AppImage = loadAppImage();
+    }
+    image = AppImage;
+    if (image == NULL || !checkBaseImage(image)) {
+        fprintf(stderr, KVM_MSG_APP_IMAGE_IGNORED_1STRPARAM, AppImageFile);
+        return;
+    }
+
+    /* Nothing outside the image is changed until all links resolve;
+     * the lookups of findLinkTarget() never create strings or classes */
+    for (i = 0; i < image->linkCount; i++) {
+        struct appImageLinkStruct *link = &image->links[i];
+        void *target = findLinkTarget(link);
+        if (target == NULL) {
+            fprintf(stderr, KVM_MSG_APP_IMAGE_IGNORED_1STRPARAM,
+                    AppImageFile);
+            return;
+        }
+        *link->slot = target;
+    }
+
+    /* The system classes are not part of the image */
+    for (i = 0; i < image->classCount; i++) {
+        image->classes[i]->ofClass = JavaLangClass;
+    }
+    for (i = 0; i < image->stringCount; i++) {
+        image->strings[i].ofClass = JavaLangString;
+    }
+    if (image->chars != NULL) {
+        image->chars->ofClass = PrimitiveArrayClasses[T_CHAR];
+    }
+
+    for (i = 0; i < image->bucketCount; i++) {
+        struct appImageBucketStruct *bucket = &image->buckets[i];
+        HASHTABLE table = *appImageTables[bucket->table];
+        *bucket->lastNext = table->bucket[bucket->index];
+        table->bucket[bucket->index] = (cell *)bucket->first;
+    }
+    for (i = 0; i < APP_TABLE_COUNT; i++) {
+        (*appImageTables[i])->count += image->imageCount[i];
+    }
+
+    memcpy(image->staticData, image->masterStaticData, image->staticSize);
+    AppImageStaticData = image->staticData;
+    AppImageLinked = TRUE;
+}
+
+/*=========================================================================
+ * FUNCTION:      FinalizeAppImage()
+ * TYPE:          public global operation
+ * OVERVIEW:      Take the entries of the image out of the ROM hashtables.
+ *                Called after FinalizeROMImage() has removed the entries
+ *                that were added while the VM was running.  The image
+ *                stays loaded, so that a restarted VM can link it again.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void FinalizeAppImage(void)
+{
+    struct appImageStruct *image = AppImage;
+    long i;
+
+    if (!AppImageLinked) {
+        return;
+    }
+    for (i = 0; i < image->bucketCount; i++) {
+        struct appImageBucketStruct *bucket = &image->buckets[i];
+        HASHTABLE table = *appImageTables[bucket->table];
+        table->bucket[bucket->index] = (cell *)*bucket->lastNext;
+    }
+    for (i = 0; i < APP_TABLE_COUNT; i++) {
+        (*appImageTables[i])->count = image->baseCount[i];
+    }
+    AppImageStaticData = NULL;
+    AppImageLinked = FALSE;
+}
+
+#endif /* ENABLE_APP_IMAGE */
+
@@ -2992,6 +2992,12 @@ SELECT2(GETSTATIC_FAST, GETSTATICP_FAST)
             goto reschedulePoint;
         }
 
+        /* Skip the check from now on, unless <clinit> is still running */
+        if (field->ofClass->status == CLASS_READY) {
+            REPLACE_READY_BYTECODE(ip, ((field->accessFlags & ACC_POINTER)
+                                        ? GETSTATICP_READY : GETSTATIC_READY))
+        }
+
         /* Push contents of the field onto the operand stack */
         pushStack(*(cell *)field->u.staticAddress);
 DONE(3)
@@ -3013,6 +3019,10 @@ SELECT(GETSTATIC2_FAST)
             goto reschedulePoint;
         }
 
+        if (field->ofClass->status == CLASS_READY) {
+            REPLACE_READY_BYTECODE(ip, GETSTATIC2_READY)
+        }
+
         oneMore;
         COPY_LONG(sp, field->u.staticAddress);
         oneMore;
@@ -3035,6 +3045,10 @@ SELECT(PUTSTATIC_FAST)
             goto reschedulePoint;
         }
 
+        if (field->ofClass->status == CLASS_READY) {
+            REPLACE_READY_BYTECODE(ip, PUTSTATIC_READY)
+        }
+
         *(cell *)field->u.staticAddress = popStack();
 DONE(3)
 #endif
@@ -3055,6 +3069,10 @@ SELECT(PUTSTATIC2_FAST)
             goto reschedulePoint;
         }
 
+        if (field->ofClass->status == CLASS_READY) {
+            REPLACE_READY_BYTECODE(ip, PUTSTATIC2_READY)
+        }
+
         oneLess;
         COPY_LONG(field->u.staticAddress, sp);
         oneLess;
@@ -3157,6 +3175,11 @@ SELECT(INVOKESTATIC_FAST)
             goto reschedulePoint;
         }
 
+        if (thisMethod->ofClass->status == CLASS_READY) {
+            REPLACE_READY_BYTECODE(ip, (thisMethod == SystemArraycopyMethod)
+                                       ? ARRAYCOPY_READY : INVOKESTATIC_READY)
+        }
+
         /* Get the class of the currently executing method */
         thisObject = (OBJECT)thisMethod->ofClass;
 
@@ -3242,6 +3265,10 @@ SELECT(NEW_FAST)                     /* Create new object (fast version) */
             goto reschedulePoint;
         }
 
+        if (thisClass->status == CLASS_READY) {
+            REPLACE_READY_BYTECODE(ip, NEW_READY)
+        }
+
         /* Instantiate */
         VMSAVE
         newObject = instantiate(thisClass);
@@ -3366,6 +3393,125 @@ SELECT(INSTANCEOF_FAST)
 DONE(3)
 #endif
 
+/* --------------------------------------------------------------------- */
+
+/*=========================================================================
+ * The *_READY bytecodes replace the *_FAST bytecodes above once the
+ * class has been initialized (see cache.h), and skip the check.
+ *=======================================================================*/
+
+#if FASTBYTECODES
+SELECT2(GETSTATIC_READY, GETSTATICP_READY)
+        /* Get single-word static field from initialized class */
+        unsigned int cpIndex = getUShort(ip + 1);
+        FIELD field = (FIELD)cp->entries[cpIndex].cache;
+        pushStack(*(cell *)field->u.staticAddress);
+DONE(3)
+#endif
+
+/* --------------------------------------------------------------------- */
+
+#if FASTBYTECODES
+SELECT(GETSTATIC2_READY)
+        /* Get double-word static field from initialized class */
+        unsigned int cpIndex = getUShort(ip + 1);
+        FIELD field = (FIELD)cp->entries[cpIndex].cache;
+        oneMore;
+        COPY_LONG(sp, field->u.staticAddress);
+        oneMore;
+DONE(3)
+#endif
+
+/* --------------------------------------------------------------------- */
+
+#if FASTBYTECODES
+SELECT(PUTSTATIC_READY)
+        /* Set single-word static field in initialized class */
+        unsigned int cpIndex = getUShort(ip + 1);
+        FIELD field = (FIELD)cp->entries[cpIndex].cache;
+        *(cell *)field->u.staticAddress = popStack();
+DONE(3)
+#endif
+
+/* --------------------------------------------------------------------- */
+
+#if FASTBYTECODES
+SELECT(PUTSTATIC2_READY)
+        /* Set double-word static field in initialized class */
+        unsigned int cpIndex = getUShort(ip + 1);
+        FIELD field = (FIELD)cp->entries[cpIndex].cache;
+        oneLess;
+        COPY_LONG(field->u.staticAddress, sp);
+        oneLess;
+DONE(3)
+#endif
+
+/* --------------------------------------------------------------------- */
+
+#if FASTBYTECODES
+SELECT(INVOKESTATIC_READY)
+        /* Invoke a static method of an initialized class */
+        unsigned int cpIndex = getUShort(ip + 1);
+        thisMethod = (METHOD)cp->entries[cpIndex].cache;
+        thisObject = (OBJECT)thisMethod->ofClass;
+
+        TRACE_METHOD_ENTRY(thisMethod, "fast static");
+        CALL_STATIC_METHOD
+DONEX
+#endif
+
+/* --------------------------------------------------------------------- */
+
+#if FASTBYTECODES
+SELECT(NEW_READY)                /* Create new object of initialized class */
+        unsigned int cpIndex = getUShort(ip + 1);
+        INSTANCE_CLASS thisClass = (INSTANCE_CLASS)(cp->entries[cpIndex].clazz);
+        INSTANCE newObject;
+
+        VMSAVE
+        newObject = instantiate(thisClass);
+        VMRESTORE
+        if (newObject != NULL) {
+            pushStackAsType(INSTANCE, newObject);
+            ip += 3;
+        }
+DONE(0)
+#endif
+
+/* --------------------------------------------------------------------- */
+
+#if FASTBYTECODES
+SELECT(ARRAYCOPY_READY)
+        /* Call System.arraycopy(), copying the arrays right here if */
+        /* they are of the same type and the range is valid */
+        long  length = topStack;
+        long  dstPos = secondStack;
+        ARRAY dst    = thirdStackAsType(ARRAY);
+        long  srcPos = *(sp - 3);
+        ARRAY src    = *(ARRAY *)(sp - 4);
+
+        if (src != NULL && dst != NULL && src->ofClass == dst->ofClass
+              && IS_ARRAY_CLASS((CLASS)src->ofClass)
+              && length >= 0 && srcPos >= 0 && dstPos >= 0
+              && length <= (long)src->length - srcPos
+              && length <= (long)dst->length - dstPos) {
+            long itemSize = src->ofClass->itemSize;
+            memmove(&((BYTEARRAY)dst)->bdata[dstPos * itemSize],
+                    &((BYTEARRAY)src)->bdata[srcPos * itemSize],
+                    itemSize * length);
+            sp -= 5;
+            ip += 3;
+        } else {
+            /* Let the native function throw the exception, or check */
+            /* the type of each element */
+            unsigned int cpIndex = getUShort(ip + 1);
+            thisMethod = (METHOD)cp->entries[cpIndex].cache;
+            thisObject = (OBJECT)thisMethod->ofClass;
+            CALL_STATIC_METHOD
+        }
+DONE(0)
+#endif
+
 /*=========================================================================
  * End of FAST bytecodes
  *=======================================================================*/
@@ -3563,16 +3709,16 @@ NOTIMPLEMENTED(ANEWARRAY_FAST)
 NOTIMPLEMENTED(MULTIANEWARRAY_FAST)
 NOTIMPLEMENTED(CHECKCAST_FAST)
 NOTIMPLEMENTED(INSTANCEOF_FAST)
+NOTIMPLEMENTED(GETSTATIC_READY)
+NOTIMPLEMENTED(GETSTATICP_READY)
+NOTIMPLEMENTED(GETSTATIC2_READY)
+NOTIMPLEMENTED(PUTSTATIC_READY)
+NOTIMPLEMENTED(PUTSTATIC2_READY)
+NOTIMPLEMENTED(INVOKESTATIC_READY)
+NOTIMPLEMENTED(NEW_READY)
+NOTIMPLEMENTED(ARRAYCOPY_READY)
 #endif /* !FASTBYTECODES */
 
-NOTIMPLEMENTED(224)
-NOTIMPLEMENTED(225)
-NOTIMPLEMENTED(226)
-NOTIMPLEMENTED(227)
-NOTIMPLEMENTED(228)
-NOTIMPLEMENTED(229)
-NOTIMPLEMENTED(230)
-NOTIMPLEMENTED(231)
 NOTIMPLEMENTED(232)
 NOTIMPLEMENTED(233)
 NOTIMPLEMENTED(234)
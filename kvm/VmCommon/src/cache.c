@@ -40,7 +40,13 @@ int InlineCachePointer;
 /* Flag telling whether inline cache area is full or not */
 int InlineCacheAreaFull;
 
+/* Code locations outside the heap patched with *_READY bytecodes, */
+/* and the number of entries used (see createReadySiteEntry()) */
+static BYTE* ReadySites[READYCACHESIZE];
+static int ReadySiteCount;
+
 static void releaseInlineCacheEntry(int index);
+static void releaseReadySiteEntry(int index);
 
 /*=========================================================================
  * Constructor/destructors for (re)initializing inline caching
@@ -67,6 +73,7 @@ InitializeInlineCaching(void)
     InlineCachePointer = 0;
     InlineCacheAreaFull = FALSE;
     memset(InlineCache, 0, (SIZEOF_ICACHE*INLINECACHESIZE+1)*sizeof(CELL));
+    ReadySiteCount = 0;
 }
 
 /*=========================================================================
@@ -74,7 +81,9 @@ InitializeInlineCaching(void)
  * TYPE:          destructor (reconstructor, actually)
  * OVERVIEW:      Flush all the existing inline cache entries from the
  *                master inline cache area, patching all the affected
- *                methods with original code.
+ *                methods with original code.  The *_READY bytecodes
+ *                are also put back, since the classes will have to
+ *                be initialized again.
  * INTERFACE:
  *   parameters:  <none>
  *   returns:     <nothing>
@@ -89,6 +98,12 @@ FinalizeInlineCaching(void)
     }
     InlineCachePointer = 0;
     InlineCacheAreaFull = FALSE;
+
+    last = ReadySiteCount;
+    while (--last >= 0) {
+        releaseReadySiteEntry(last);
+    }
+    ReadySiteCount = 0;
 }
 
 /*=========================================================================
@@ -190,6 +205,67 @@ ICACHE getInlineCache(int index)
     return &InlineCache[index];
 }
 
+/*=========================================================================
+ * Code locations that skip the class initialization check
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      releaseReadySiteEntry()
+ * TYPE:          private destructor
+ * OVERVIEW:      Put the *_FAST bytecode back into a code location that
+ *                was patched with a *_READY bytecode.  A location that
+ *                now holds a breakpoint is left alone.
+ * INTERFACE:
+ *   parameters:  ready site entry index
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+static void
+releaseReadySiteEntry(int index)
+{
+    BYTE* codeLoc = ReadySites[index];
+
+    switch (*codeLoc) {
+    case GETSTATIC_READY:    *codeLoc = GETSTATIC_FAST;    break;
+    case GETSTATICP_READY:   *codeLoc = GETSTATICP_FAST;   break;
+    case GETSTATIC2_READY:   *codeLoc = GETSTATIC2_FAST;   break;
+    case PUTSTATIC_READY:    *codeLoc = PUTSTATIC_FAST;    break;
+    case PUTSTATIC2_READY:   *codeLoc = PUTSTATIC2_FAST;   break;
+    case INVOKESTATIC_READY: *codeLoc = INVOKESTATIC_FAST; break;
+    case NEW_READY:          *codeLoc = NEW_FAST;          break;
+    case ARRAYCOPY_READY:    *codeLoc = INVOKESTATIC_FAST; break;
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      createReadySiteEntry()
+ * TYPE:          constructor
+ * OVERVIEW:      Check whether a code location may be patched with a
+ *                *_READY bytecode.  Code in the heap goes away when
+ *                the VM is restarted, so it can always be patched.
+ *                Code outside the heap (ROM and application images)
+ *                survives a restart, so the location is remembered
+ *                to undo the patch.  Entries are never reused: once
+ *                the table is full, such locations keep their *_FAST
+ *                bytecodes.
+ * INTERFACE:
+ *   parameters:  location of the *_FAST bytecode
+ *   returns:     TRUE if the location may be patched
+ *=======================================================================*/
+
+bool_t
+createReadySiteEntry(BYTE* codeLoc)
+{
+    if (inAnyHeap(codeLoc)) {
+        return TRUE;
+    }
+    if (ReadySiteCount == READYCACHESIZE) {
+        return FALSE;
+    }
+    ReadySites[ReadySiteCount++] = codeLoc;
+    return TRUE;
+}
+
 /*=========================================================================
  * End of conditional compilation (ENABLEFASTBYTECODES)
  *=======================================================================*/
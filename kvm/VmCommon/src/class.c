@@ -66,6 +66,7 @@ EXTERN_IF_ROMIZING NameTypeKey mainNameAndType;   /* void main(String[]) */
 EXTERN_IF_ROMIZING ARRAY_CLASS PrimitiveArrayClasses[T_LASTPRIMITIVETYPE + 1];
 
 INSTANCE_CLASS JavaLangOutOfMemoryError;
+METHOD SystemArraycopyMethod;
 THROWABLE_INSTANCE OutOfMemoryObject;
 THROWABLE_INSTANCE StackOverflowObject;
 
@@ -444,10 +445,13 @@ void InitializeJavaSystemClasses()
 
         TRY {
 
-            /* Now we can go back and create these for real. . . .*/
-            loadClassfile(JavaLangObject, TRUE);
-            loadClassfile(JavaLangClass, TRUE);
-            loadClassfile(JavaLangString, TRUE);
+            /* Now we can go back and create these for real. . . .
+             * unless they came from a class snapshot */
+            if (!ClassSnapshotRestored) {
+                loadClassfile(JavaLangObject, TRUE);
+                loadClassfile(JavaLangClass, TRUE);
+                loadClassfile(JavaLangString, TRUE);
+            }
 
             /* Load or initialize some other system classes */
             JavaLangSystem = (INSTANCE_CLASS)getClass("java/lang/System");
@@ -490,6 +494,10 @@ void InitializeJavaSystemClasses()
         RunCustomCodeMethod = getSpecialMethod(JavaLangClass,
                                    getNameAndTypeKey("runCustomCode", "()V"));
 
+#if ENABLE_LAZY_METHOD_LOADING
+        loadMethodCode(RunCustomCodeMethod);
+#endif
+
         /* Patch the bytecode, was a "return" */
         if (RELOCATABLE_ROM) {
             /* Do nothing. Already patched */
@@ -521,6 +529,14 @@ void InitializeJavaSystemClasses()
             (INSTANCE_CLASS)getClass(StackOverflowError));
     */
     makeGlobalRoot((cell **)&StackOverflowObject);
+
+    /* The interpreter copies arrays without calling this method */
+    SystemArraycopyMethod =
+        getSpecialMethod(JavaLangSystem,
+                         getNameAndTypeKey("arraycopy",
+                             "(Ljava/lang/Object;ILjava/lang/Object;II)V"));
+
+    InitializeExceptionHandling();
 }
 
 /*=========================================================================
@@ -1001,7 +1017,7 @@ INSTANCE instantiate(INSTANCE_CLASS thisClass)
     INSTANCE newInstance = (INSTANCE)mallocHeapObject(size, GCT_INSTANCE);
 
     if (newInstance != NULL) {
-        memset(newInstance, 0, size << log2CELL);
+        CLEAR_NEW_OBJECT(newInstance, size << log2CELL);
         /* Initialize the class pointer (zeroeth field in the instance) */
         newInstance->ofClass = thisClass;
     } else {
@@ -1290,7 +1306,7 @@ ARRAY instantiateArray(ARRAY_CLASS arrayClass, long length)
         if (newArray == NULL) {
             THROW(OutOfMemoryObject);
         } else {
-            memset(newArray, 0, arraySize << log2CELL);
+            CLEAR_NEW_OBJECT(newArray, arraySize << log2CELL);
             newArray->ofClass   = arrayClass;
             newArray->length    = length;
         }
@@ -164,6 +164,9 @@ void InitializeHeap(void)
     CurrentHeapEnd = PTR_OFFSET(AllHeapStart, VMHeapSize);
 
 #if !CHUNKY_HEAP
+#if ENABLE_PREZEROED_HEAP
+    memset(CurrentHeap, 0, PTR_DELTA(CurrentHeapEnd, CurrentHeap));
+#endif
     FirstFreeChunk = (CHUNK)CurrentHeap;
     FirstFreeChunk->size =
            (CurrentHeapEnd -CurrentHeap - HEADERSIZE) << TYPEBITS;
@@ -235,6 +238,7 @@ cell* mallocHeapObject(long size, GCT_ObjectType type)
         garbageCollect(realSize); /* So it knows what we need */
         thisChunk = allocateFreeChunk(realSize);
         if (thisChunk == NULL) {
+            checkHeapDumpOnOutOfMemory();
             return NULL;
         }
     }
@@ -259,6 +263,10 @@ cell* mallocHeapObject(long size, GCT_ObjectType type)
     DynamicAllocationCounter += (size+HEADERSIZE)*CELL;
 #endif /* ENABLEPROFILING */
 
+    incrementMetric(objectsAllocated);
+    addToMetric(bytesAllocated, (size+HEADERSIZE)*CELL);
+    sampleAllocation(thisChunk + HEADERSIZE, (size+HEADERSIZE)*CELL);
+
     return thisChunk + HEADERSIZE;
 }
 
@@ -288,6 +296,10 @@ static cell* allocateFreeChunk(long size)
              * lifetime of the allocated object
              */
             *nextChunkPtr = thisChunk->next;
+#if ENABLE_PREZEROED_HEAP
+            /* The rest of the chunk is already zero */
+            thisChunk->next = NULL;
+#endif
             dataArea = (cell *)thisChunk;
             /* Store the size of the object in the object header */
             *dataArea = (size + overhead - HEADERSIZE) << TYPEBITS;
@@ -360,10 +372,15 @@ garbageCollectForReal(int realSize)
 
     /* The actual high-level GC algorithm is here */
     markRootObjects();
+    logGCPhase(GC_PHASE_ROOTS);
     markNonRootObjects();
+    logGCPhase(GC_PHASE_MARK);
     markWeakPointerLists();
     markWeakReferences();
+    logGCPhase(GC_PHASE_WEAK);
     firstFreeChunk = sweepTheHeap(&maximumFreeSize);
+    logGCPhase(GC_PHASE_SWEEP);
+    logGCValue(largestFree, maximumFreeSize * CELL);
 #if ENABLE_HEAP_COMPACTION
     if (realSize > maximumFreeSize) {
         /* We need to compact the heap. */
@@ -374,6 +391,11 @@ garbageCollectForReal(int realSize)
             updateHeapObjects(&currentTable, freeStart);
         }
         if (freeStart < CurrentHeapEnd - 1) {
+#if ENABLE_PREZEROED_HEAP
+            /* Clear the space that the objects moved out of, and the */
+            /* break table */
+            memset(freeStart, 0, PTR_DELTA(CurrentHeapEnd, freeStart));
+#endif
             firstFreeChunk = (CHUNK)freeStart;
             firstFreeChunk->size =
                 (CurrentHeapEnd - freeStart - HEADERSIZE) << TYPEBITS;
@@ -384,6 +406,10 @@ garbageCollectForReal(int realSize)
              */
             firstFreeChunk = NULL;
         }
+        logGCPhase(GC_PHASE_COMPACT);
+        logGCValue(breakTable, currentTable.length);
+        logGCValue(largestFree, (firstFreeChunk == NULL) ? 0 :
+                   (long)(firstFreeChunk->size >> TYPEBITS) * CELL);
     }
 #endif
     FirstFreeChunk = firstFreeChunk;
@@ -456,6 +482,16 @@ markRootObjects(void)
     }
 #endif
 
+#if ENABLE_APP_IMAGE
+    if (AppImageStaticData != NULL) {
+        long *staticPtr = AppImageStaticData;
+        int refCount = staticPtr[0];
+        for( ; refCount > 0; refCount--) {
+            MARK_OBJECT_IF_NON_NULL((cell *)staticPtr[refCount]);
+        }
+    }
+#endif
+
     stringTable = InternStringTable;
     if (ROMIZING || stringTable != NULL) {
         int count = stringTable->bucketCount;
@@ -512,12 +548,22 @@ markRootObjects(void)
     }
 
     for (thread = AllThreads; thread != NULL; thread = thread->nextAliveThread){
+        int i;
         MARK_OBJECT(thread);
         if (thread->javaThread != NULL) {
             MARK_OBJECT(thread->javaThread);
         }
+        for (i = 0; i < thread->lockRecordCount; i++) {
+            MARK_OBJECT_IF_NON_NULL(thread->lockRecords[i].object);
+        }
         if (thread->stack != NULL) {
+#if ENABLE_GC_LOG
+            ulong64 stackStart = GCLogging ? CurrentTimeMicros_md() : 0;
             markThreadStack(thread);
+            addToGCLog(threadStacks, CurrentTimeMicros_md() - stackStart);
+#else
+            markThreadStack(thread);
+#endif
         }
     }
 }
@@ -580,6 +626,16 @@ updateRootObjects(breakTableStruct *currentTable)
     }
 #endif /* ROMIZING */
 
+#if ENABLE_APP_IMAGE
+    if (AppImageStaticData != NULL) {
+        long *staticPtr = AppImageStaticData;
+        int refCount = staticPtr[0];
+        for( ; refCount > 0; refCount--) {
+            updatePointer(&staticPtr[refCount], currentTable);
+        }
+    }
+#endif
+
     stringTable = InternStringTable;
     if (ROMIZING || stringTable != NULL) {
         int count = stringTable->bucketCount;
@@ -690,7 +746,7 @@ markNonRootObjects(void) {
                 markChildren(object, object, MAX_GC_DEPTH);
             }
         }
-        if (ENABLEPROFILING) {
+        if (ENABLEPROFILING || ENABLE_GC_LOG) {
             scans++;
         }
         /* This loop runs exactly once in almost all cases */
@@ -698,6 +754,7 @@ markNonRootObjects(void) {
 #if ENABLEPROFILING
     GarbageCollectionRescans += (scans - 1);
 #endif
+    logGCValue(rescans, scans - 1);
 }
 
 /*=========================================================================
@@ -1052,7 +1109,7 @@ static void checkMonitorAndMark(OBJECT object)
 {
     /* We only need to mark real monitors.  We don't need to mark threads'
      * in the monitor/hashcode slot since they will be marked elsewhere */
-    if (OBJECT_HAS_REAL_MONITOR(object)) {
+    if (OBJECT_HAS_REAL_MONITOR(object) && !deflateObjectMonitor(object)) {
         cell *heapSpace = CurrentHeap;
         cell *heapSpaceEnd = CurrentHeapEnd;
         MONITOR monitor = OBJECT_MHC_MONITOR(object);
@@ -1237,6 +1294,10 @@ updateHeapObjects(breakTableStruct *currentTable, cell* endScanPoint)
 
         case GCT_THREAD: {
             THREAD thread  = (THREAD)object;
+            int i;
+            for (i = 0; i < thread->lockRecordCount; i++) {
+                updatePointer(&thread->lockRecords[i].object, currentTable);
+            }
             updatePointer(&thread->nextAliveThread, currentTable);
             updatePointer(&thread->nextThread, currentTable);
             updatePointer(&thread->javaThread, currentTable);
@@ -1444,6 +1505,7 @@ putDeferredObject(cell *value)
 {
     if (deferredObjectCount >= DEFERRED_OBJECT_TABLE_SIZE) {
         deferredObjectTableOverflow = TRUE;
+        addToGCLog(deferralOverflows, 1);
     } else {
         if (endDeferredObjects == endDeferredObjectTable) {
             endDeferredObjects = deferredObjectTable;
@@ -1495,11 +1557,17 @@ sweepTheHeap(long *maximumFreeSizeP)
     do {
         /* Skip over groups of live objects */
         cell *lastLive;
+#if ENABLE_PREZEROED_HEAP
+        cell *dirty;
+#endif
         while (scanner < endScanPoint && ISKEPT(*scanner)) {
             *scanner &= ~MARKBIT;
             scanner += SIZE(*scanner) + HEADERSIZE;
         }
         lastLive = scanner;
+#if ENABLE_PREZEROED_HEAP
+        dirty = scanner;
+#endif
         /* Skip over all the subsequent dead objects */
         while (scanner < endScanPoint && !ISKEPT(*scanner)) {
 #if INCLUDEDEBUGCODE
@@ -1509,8 +1577,22 @@ sweepTheHeap(long *maximumFreeSizeP)
                     (long)SIZE(*scanner) + HEADERSIZE);
             }
 #endif /* INCLUDEDEBUGCODE */
+#if ENABLE_PREZEROED_HEAP
+            /* Zero the dead objects in one go.  All but the size and */
+            /* the next pointer of an old free chunk is zero already. */
+            if (TYPE(*scanner) == GCT_FREE) {
+                memset(dirty, 0,
+                       PTR_DELTA(scanner, dirty) + sizeof(struct chunkStruct));
+                dirty = scanner + SIZE(*scanner) + HEADERSIZE;
+            }
+#endif
             scanner += SIZE(*scanner) + HEADERSIZE;
         }
+#if ENABLE_PREZEROED_HEAP
+        if (scanner > dirty) {
+            memset(dirty, 0, PTR_DELTA(scanner, dirty));
+        }
+#endif
         if (scanner == endScanPoint) {
             if (scanner == lastLive) {
                 /* The memory ended precisely with a live object. */
@@ -1937,6 +2019,36 @@ long memoryFree(void)
     return available * CELL;
 }
 
+/*=========================================================================
+ * FUNCTION:      forEachHeapObject
+ * TYPE:          public function
+ * OVERVIEW:      Call a function for each object in the dynamic heap.
+ *                Free chunks are skipped.  The function must not
+ *                allocate memory in the heap.
+ * INTERFACE:
+ *   parameters:  function: called with the object, its GC type and
+ *                its size in bytes (including the header)
+ *                closure: passed to the function unchanged
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+#if ENABLE_HEAP_DUMP
+
+void forEachHeapObject(heapObjectFunction function, void* closure)
+{
+    cell* scanner;
+    for (scanner = CurrentHeap; scanner < CurrentHeapEnd;
+             scanner += SIZE(*scanner) + HEADERSIZE) {
+        GCT_ObjectType type = TYPE(*scanner);
+        if (type != GCT_FREE) {
+            function(scanner + HEADERSIZE, type,
+                     (SIZE(*scanner) + HEADERSIZE) * CELL, closure);
+        }
+    }
+}
+
+#endif /* ENABLE_HEAP_DUMP */
+
 /*=========================================================================
  * Debugging and printing operations
  *=======================================================================*/
@@ -2038,6 +2150,16 @@ checkValidHeapPointer(cell *number)
         return;
     }
 
+    if (inClassSnapshot(number)) {
+        /* Object in a mapped class snapshot */
+        return;
+    }
+
+    if (inAppImage(number)) {
+        /* Class or string of the application image */
+        return;
+    }
+
     /* The type field must contain a valid type tag; additionally, */
     /* both static bit and mark bit must be unset. */
     lowbits = OBJECT_HEADER(number);
@@ -145,6 +145,9 @@ void InitializeHeap(void)
     PermanentSpaceFreePtr = AllHeapEnd;
 
     memset((char *)PermanentSpace, 0, PTR_DELTA(AllHeapEnd, PermanentSpace));
+#if ENABLE_PREZEROED_HEAP
+    memset((char *)CurrentHeap, 0, PTR_DELTA(CurrentHeapEnd, CurrentHeap));
+#endif
 
 #if !CHENEY_TWO_SPACE
     /* Protect all of the heaps except for the current one */
@@ -209,6 +212,7 @@ cell* mallocHeapObject(long size, GCT_ObjectType type)
     if (CurrentHeapEnd - CurrentHeapFreePtr < realSize) {
         garbageCollect(0);
         if (CurrentHeapEnd - CurrentHeapFreePtr < realSize) {
+            checkHeapDumpOnOutOfMemory();
             return NULL;
         }
     }
@@ -232,6 +236,10 @@ cell* mallocHeapObject(long size, GCT_ObjectType type)
     DynamicAllocationCounter += (size+HEADERSIZE)*CELL;
 #endif /* ENABLEPROFILING */
 
+    incrementMetric(objectsAllocated);
+    addToMetric(bytesAllocated, (size+HEADERSIZE)*CELL);
+    sampleAllocation(thisChunk + HEADERSIZE, (size+HEADERSIZE)*CELL);
+
     return thisChunk + HEADERSIZE;
 }
 
@@ -291,6 +299,7 @@ garbageCollectForReal(int moreMemory)
     WeakPointers = NULL;
     WeakReferences = NULL;
     copyRootObjects();
+    logGCPhase(GC_PHASE_ROOTS);
 
     /* Mark all the objects pointed at by the root objects, or pointed at
      * by objects that are pointed at by root objects. . . .
@@ -302,8 +311,10 @@ garbageCollectForReal(int moreMemory)
 #endif
 
     copyNonRootObjects();
+    logGCPhase(GC_PHASE_MARK);
     copyWeakPointerLists();
     copyWeakReferences();
+    logGCPhase(GC_PHASE_WEAK);
 
 #if !CHENEY_TWO_SPACE
     protectVirtualMemory_md(CurrentHeap, MEMORY_SIZE, PVM_NoAccess);
@@ -312,6 +323,12 @@ garbageCollectForReal(int moreMemory)
     CurrentHeap        = TargetSpace;
     CurrentHeapFreePtr = TargetSpaceFreePtr;
     CurrentHeapEnd     = PTR_OFFSET(CurrentHeap, nHeapSize);
+#if ENABLE_PREZEROED_HEAP
+    /* The space still holds whatever was there before the last flip */
+    memset((char *)CurrentHeapFreePtr, 0,
+           PTR_DELTA(CurrentHeapEnd, CurrentHeapFreePtr));
+#endif
+    logGCValue(largestFree, PTR_DELTA(CurrentHeapEnd, CurrentHeapFreePtr));
 }
 
 static void
@@ -425,6 +442,19 @@ copyRootObjects(void)
     }
 #endif /* ROMIZING */
 
+#if ENABLE_APP_IMAGE
+    if (AppImageStaticData != NULL) {
+        cell **staticPtrData = (cell **)AppImageStaticData;
+        int refCount = ((int *)staticPtrData)[0];
+        cell **staticPtr = staticPtrData + 1;
+        cell **lastStaticPtr = staticPtr + refCount;
+        while (staticPtr < lastStaticPtr) {
+            updatePointer(staticPtr);
+            staticPtr++;
+        }
+    }
+#endif
+
     if (ROMIZING || ClassTable != NULL) {
         FOR_ALL_CLASSES(clazz)
             updateMonitor((OBJECT)clazz);
@@ -597,6 +627,10 @@ copyNonRootObjects()
 
         case GCT_THREAD: {
             THREAD thread  = (THREAD)object;
+            int i;
+            for (i = 0; i < thread->lockRecordCount; i++) {
+                updatePointer(&thread->lockRecords[i].object);
+            }
             updatePointer(&thread->nextAliveThread);
             updatePointer(&thread->nextThread);
             updatePointer(&thread->javaThread);
@@ -879,6 +913,10 @@ updatePointer(void *ptr)
 static void
 updateMonitor(OBJECT object)
 {
+    if (OBJECT_HAS_REAL_MONITOR(object) && deflateObjectMonitor(object)) {
+        /* The monitor was idle; nothing else refers to it */
+        return;
+    }
     if (OBJECT_HAS_MONITOR(object)) {
         /* The mhc slot contains either a MONITOR or a THREAD,
          * incremented by a small constant, so we will be pointing into the
@@ -955,6 +993,33 @@ long largestFree(void)
     return PTR_DELTA(CurrentHeapEnd, CurrentHeapFreePtr);
 }
 
+/*=========================================================================
+ * FUNCTION:      forEachHeapObject
+ * TYPE:          public function
+ * OVERVIEW:      Call a function for each object in the dynamic heap.
+ *                Free chunks are skipped.  The function must not
+ *                allocate memory in the heap.
+ * INTERFACE:
+ *   parameters:  function: called with the object, its GC type and
+ *                its size in bytes (including the header)
+ *                closure: passed to the function unchanged
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+#if ENABLE_HEAP_DUMP
+
+void forEachHeapObject(heapObjectFunction function, void* closure)
+{
+    cell* scanner;
+    for (scanner = CurrentHeap; scanner < CurrentHeapFreePtr;
+             scanner += SIZE(*scanner) + HEADERSIZE) {
+        function(scanner + HEADERSIZE, TYPE(*scanner),
+                 (SIZE(*scanner) + HEADERSIZE) * CELL, closure);
+    }
+}
+
+#endif /* ENABLE_HEAP_DUMP */
+
 /*=========================================================================
  * Debugging and printing operations
  *=======================================================================*/
@@ -1039,6 +1104,12 @@ checkValidHeapPointer(cell *number)
     if (number >= PermanentSpaceFreePtr && number < AllHeapEnd) {
         return;
     }
+    if (inClassSnapshot(number)) {
+        return;
+    }
+    if (inAppImage(number)) {
+        return;
+    }
     /* The type field must contain a valid type tag; additionally, */
     /* both static bit and mark bit must be unset. */
     lowbits = OBJECT_HEADER(number);
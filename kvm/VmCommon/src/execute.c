@@ -308,316 +308,47 @@ reschedulePoint:
 }
 
 /*=========================================================================
- * TOKEN - Macro to get the current bytecode
- *=======================================================================*/
-
-#if ENABLE_JAVA_DEBUGGER
-#define TOKEN token
-#else
-#define TOKEN (*ip)
-#endif
-
-/*=========================================================================
- * FUNCTION:      FastInterpret()
- * OVERVIEW:      This is the primary interpreter loop.  All the most 
- *                commonly needed bytecodes are defined here.  To 
- *                improve performance, we instruct the C compiler 
- *                to put the VM registers into hardware registers.
- *                The primary interpreter loop can be replaced by
- *                an alternative assembly interpreter loop in some
- *                KVM versions.
- * INTERFACE:
- *   parameters:  <none>
- *   returns:     <nothing>
- *
- * NOTES:         Remember to initialize all virtual machine registers
- *                and the call stack before entering the interpreter.
+ * The primary interpreter loop is defined in file 'interpLoop.c'.  It
+ * is compiled once without any debugger code as FastInterpret(), and
+ * again as DebugInterpret() when the debugger is enabled.  A build with
+ * debugger support therefore runs at full speed until the debugger
+ * arms single stepping or a thread reaches a breakpoint.
  *=======================================================================*/
 
 #if !ALTERNATIVE_FAST_INTERPRETER
-void FastInterpret() {
-
-   /*
-    * Define as locals those machine registers that are appropriate.
-    * Typically you get a lot of bang for the buck simply by making
-    * ip and sp local, but if you can make all the VM registers
-    * (ip, sp, lp, fp and cp) local, that's even better.
-    *
-    * Note: whenever you exit the primary interpreter loop,
-    * you MUST call the VMSAVE-VMRESTORE operations to make
-    * sure that the rest of the VM can use the correct values
-    * of the VM registers!!
-    */
-
-#if IPISLOCAL
-#undef ip
-    register BYTE* ip; /* Instruction pointer (program counter) */
-#endif
-
-#if SPISLOCAL
-#undef sp
-    register cell* sp; /* Execution stack pointer */
-#endif
-
-#if LPISLOCAL
-#undef lp
-    register cell* lp; /* Local variable pointer */
-#endif
-
-#if FPISLOCAL
-#undef fp
-    register FRAME fp; /* Current frame pointer */
-#endif
-
-#if CPISLOCAL
-#undef cp
-    register CONSTANTPOOL  cp; /* Constant pool pointer */
-#endif
-
-#if ENABLE_JAVA_DEBUGGER
-    register BYTE token;
-#endif
 
-   /*
-    * Define other local variables needed by the interpreter
-    */
-    METHOD   thisMethod;
-    OBJECT   thisObject;
-    int      invokerSize;
-    const char *exception;
-
-#if NEED_LONG_ALIGNMENT || NEED_DOUBLE_ALIGNMENT
-    Java8 tdub;
-#endif
+#define INTERPRETERLOOP  FastInterpret
+#define DEBUGINTERPRETER 0
+#define TOKEN            (*ip)
+#define RESCHEDULE       FAST_RESCHEDULE
 
-    VMRESTORE  /** Restore virtual machine registers to local variables **/
+#include "interpLoop.c"
 
-    goto reschedulePoint;
-
-/*************************************************************************
- *              Top of the actual primary interpreter loop               *
- *************************************************************************/
-
-   /*
-    * If RESCHEDULEATBRANCH is not defined then we always test for thread
-    * scheduling before every bytecode. This is like in KVM 1.0.
-    */
-
-#if !RESCHEDULEATBRANCH
-next3:  ip++;
-next2:  ip++;
-next1:  ip++;
-next0:
-reschedulePoint:
-    RESCHEDULE
-#endif
+#undef INTERPRETERLOOP
+#undef DEBUGINTERPRETER
+#undef TOKEN
+#undef RESCHEDULE
 
-   /*
-    * If RESCHEDULEATBRANCH is defined then we only test for thread
-    * scheduling when reschedulePoint is called.
-    */
+#endif /* ALTERNATIVE_FAST_INTERPRETER */
 
-#if RESCHEDULEATBRANCH
-reschedulePoint:
-    RESCHEDULE
 #if ENABLE_JAVA_DEBUGGER
-    goto next0a;
-#else
-    goto next0;
-#endif
 
-next3:  ip++;
-next2:  ip++;
-next1:  ip++;
-next0:
-#if ENABLE_JAVA_DEBUGGER
-    token = *ip;
-    /*
-     * Be careful, there is a goto in this following macro that jumps back
-     * up to a label in the RESCHEDULE macro;  ugly, I know
-     */
-    __doSingleStep()
-next0a:
-#endif
-#endif /* RESCHEDULEATBRANCH */
-
-   /*
-    * Profile the instruction
-    */
-    INSTRUCTIONPROFILE
-
-   /*
-    * Trace the instruction here if the option is enabled
-    */
-    INSTRUCTIONTRACE
-
-   /*
-    * Increment the bytecode counter
-    */
-    INC_BYTECODES
-
-   /*
-    *  Extreme debug option to call the garbage collector before every bytecode
-    */
-    DO_VERY_EXCESSIVE_GARBAGE_COLLECTION
-
-   /*
-    * Dispatch the bytecode
-    */
-#if ENABLE_JAVA_DEBUGGER
-    switch (token) {
-#else
-    switch (((unsigned char)*ip)) {
-#endif
+/* TRUE while some thread needs the checks made by DebugInterpret() */
+bool_t DebugInterpreterArmed;
 
-/*=======================================================================*/
-/* Include bytecode definitions that we need for main interpreter loop   */
-/*=======================================================================*/
-/* Note: There is some serious macro-hackery here.  The actual           */
-/* Java bytecode definitions are in file 'bytecodes.c'.  The macro       */
-/* definitions below determine which bytecodes from 'bytecodes.c         */
-/* get included into the primary interpreter loop.                       */
-/*=======================================================================*/
-
-#define STANDARDBYTECODES 1
-#define FASTBYTECODES     ENABLEFASTBYTECODES
-
-#if SPLITINFREQUENTBYTECODES
-#define INFREQUENTSTANDARDBYTECODES 0
-#define FLOATBYTECODES    0
-#else
-#define INFREQUENTSTANDARDBYTECODES 1
-#define FLOATBYTECODES    IMPLEMENTS_FLOAT
-#endif
-
-#include "bytecodes.c"
-
-#undef STANDARDBYTECODES
-#undef FLOATBYTECODES
-#undef FASTBYTECODES
-#undef INFREQUENTSTANDARDBYTECODES
+#define INTERPRETERLOOP  DebugInterpret
+#define DEBUGINTERPRETER 1
+#define TOKEN            token
+#define RESCHEDULE       DEBUG_RESCHEDULE
 
-/*=======================================================================*/
+#include "interpLoop.c"
 
-   /*
-    * If COMMONBRANCHING is defined then include the code to load ip
-    * See the BRANCHIF macro
-    */
-#if COMMONBRANCHING
-        branchPoint: {
-            INC_BRANCHES
-            ip += getShort(ip + 1);
-            goto reschedulePoint;
-        }
-#endif
-
-        callMethod_interface:
-            invokerSize = 5;       /* Size of the bytecode */
-            goto callMethod_general;
-
-        callMethod_virtual:
-        callMethod_static:
-        callMethod_special:
-            invokerSize = 3;       /* Size of the bytecode */
-
-        callMethod_general: {
-
-            INC_CALLS
-
-            /* Check if the method is a native method */
-            if (thisMethod->accessFlags & ACC_NATIVE) {
-                ip += invokerSize;
-                VMSAVE
-                invokeNativeFunction(thisMethod);
-                VMRESTORE
-                TRACE_METHOD_EXIT(thisMethod);
-                goto reschedulePoint;
-            }
-
-            /* Check if this is an abstract method */
-            if (thisMethod->accessFlags & ACC_ABSTRACT) {
-                VMSAVE
-                raiseExceptionWithMessage(AbstractMethodError, methodName(thisMethod));
-                VMRESTORE
-            }
-
-            thisObjectGCSafe = thisObject;
-            VMSAVE
-            pushFrame(thisMethod);
-            VMRESTORE
-
-            /* Advance to the next instruction on return */
-            fp->previousIp += invokerSize;
-
-            /* Check if this is a synchronized method */
-            if (thisMethod->accessFlags & ACC_SYNCHRONIZED) {
-                VMSAVE
-                monitorEnter(thisObjectGCSafe);
-                VMRESTORE
-                fp->syncObject = thisObjectGCSafe;
-            }
-
-            thisObjectGCSafe = NULL;
-            goto reschedulePoint;
-        }
-
-#if SPLITINFREQUENTBYTECODES
-        callSlowInterpret: {
-            int __token = TOKEN;
-            VMSAVE
-            SlowInterpret(__token);
-            VMRESTORE
-            goto reschedulePoint;        /* test for rescheduling */
-        }
-#endif
-
-        handleNullPointerException: {
-            exception = NullPointerException;
-            goto handleException;
-        }
-
-        handleArrayIndexOutOfBoundsException: {
-            exception = ArrayIndexOutOfBoundsException;
-            goto handleException;
-        }
-
-        handleArithmeticException: {
-            exception = ArithmeticException;
-            goto handleException;
-        }
-
-        handleArrayStoreException: {
-            exception = ArrayStoreException;
-            goto handleException;
-        }
-
-        handleClassCastException: {
-            exception = ClassCastException;
-            goto handleException;
-        }
-
-        handleException: {
-            VMSAVE
-            raiseException(exception);
-            VMRESTORE
-            goto reschedulePoint;
-        }
-
-#if PADTABLE
-        notImplemented:
-#endif
-
-        default: {
-            sprintf(str_buffer, KVM_MSG_ILLEGAL_BYTECODE_1LONGPARAM,
-                    (long)TOKEN);
-            fatalError(str_buffer);
-            break;
-        }
-    }
-    fatalError(KVM_MSG_INTERPRETER_STOPPED);
-}
+#undef INTERPRETERLOOP
+#undef DEBUGINTERPRETER
+#undef TOKEN
+#undef RESCHEDULE
 
-#endif /* ALTERNATIVE_FAST_INTERPRETER */
+#endif /* ENABLE_JAVA_DEBUGGER */
 
 /*************************************************************************
  *                  End of the primary interpreter loop                  *
@@ -644,7 +375,19 @@ startTry:
 
         START_TEMPORARY_ROOTS
             IS_TEMPORARY_ROOT(thisObjectGCSafe, NULL);
+#if ENABLE_JAVA_DEBUGGER
+            /* Each loop returns when the other one is needed, */
+            /* or from reschedule() when the last thread dies  */
+            while (areAliveThreads()) {
+                if (DebugInterpreterArmed) {
+                    DebugInterpret();
+                } else {
+                    FastInterpret();
+                }
+            }
+#else
             FastInterpret();
+#endif
         END_TEMPORARY_ROOTS
 
     } CATCH (e) {
@@ -249,7 +249,7 @@ int getMethodTableSize(METHODTABLE methodTable)
     int size = getObjectSize((cell *)methodTable);
     FOR_EACH_METHOD(entry, methodTable) 
         /*  Add the size of the code segment for a non-native method */
-        if ((entry->accessFlags & ACC_NATIVE) == 0) { 
+        if ((entry->accessFlags & (ACC_NATIVE | ACC_LAZY_CODE)) == 0) { 
             if (entry->u.java.code != NULL) { 
                 size += getObjectSize((cell*)entry->u.java.code);
             }
@@ -344,7 +344,8 @@ printMethod(METHOD thisMethod) {
        fprintf(stdout,"Argument count..: %d\n", thisMethod->argCount);
        fprintf(stdout,"Maximum stack...: %d\n", thisMethod->u.java.maxStack);
 
-       if (thisMethod->u.java.handlers) {
+       if (thisMethod->u.java.handlers &&
+           !(thisMethod->accessFlags & ACC_LAZY_CODE)) {
            printExceptionHandlerTable(thisMethod->u.java.handlers);
        }
        fprintf(stdout,"\n");
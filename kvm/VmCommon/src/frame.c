@@ -131,6 +131,146 @@ static void exceptionCaughtTracing(THROWABLE_INSTANCE_HANDLE exceptionH, HANDLER
 
 #endif /* INCLUDEDEBUGCODE */
 
+/*=========================================================================
+ * Stack chunk pool
+ *=======================================================================*/
+
+/*=========================================================================
+ * COMMENTS:
+ * Stack chunks that are no longer used are kept in a small VM-wide
+ * pool instead of being left to the garbage collector: the chunks of
+ * threads that have died, and cached chunks that were too small for
+ * a new frame.  New threads and new frames take their chunks from the
+ * pool when they can, so thread start and deep recursion don't keep
+ * allocating garbage.
+ *
+ * Chunk sizes are rounded up to size classes of STACKCHUNKSIZE times
+ * a power of two, so that pooled chunks fit a wide range of frames.
+ * Frames that need more than the largest size class get a chunk of
+ * their own size, which is never pooled.  The pool is a pointer list
+ * in the heap, so the garbage collector keeps the pooled chunks alive
+ * and updates the list when it moves them.
+ *=======================================================================*/
+
+static POINTERLIST StackChunkPool;
+
+#define LARGEST_POOLED_STACK_CHUNK \
+    (STACKCHUNKSIZE << (STACK_CHUNK_SIZE_CLASSES - 1))
+
+/*=========================================================================
+ * FUNCTION:      InitializeStackChunkPool()
+ * TYPE:          public global operation
+ * OVERVIEW:      Create the empty stack chunk pool.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void InitializeStackChunkPool(void)
+{
+    StackChunkPool = NULL;
+    makeGlobalRoot((cell **)&StackChunkPool);
+    StackChunkPool = (POINTERLIST)
+        callocObject(SIZEOF_POINTERLIST(STACK_CHUNK_POOL_SIZE),
+                     GCT_POINTERLIST);
+    StackChunkPool->length = STACK_CHUNK_POOL_SIZE;
+}
+
+/*=========================================================================
+ * FUNCTION:      allocateStackChunk()
+ * TYPE:          public stack chunk operation
+ * OVERVIEW:      Get a stack chunk with room for at least the given
+ *                number of cells, from the pool if possible, or else
+ *                from the heap.
+ * INTERFACE:
+ *   parameters:  height: the number of cells needed
+ *   returns:     a stack chunk whose 'next' field is NULL, or NULL if
+ *                there is not enough memory
+ * NOTE:          This operation may cause garbage collection.
+ *=======================================================================*/
+
+STACK allocateStackChunk(int height)
+{
+    STACK chunk = NULL;
+    int size = STACKCHUNKSIZE;
+    int i, best = -1;
+
+    while (size < height && size < LARGEST_POOLED_STACK_CHUNK) {
+        size <<= 1;
+    }
+    if (size < height) {
+        size = height;
+    }
+
+    /* Look for the smallest pooled chunk that is large enough */
+    if (size <= LARGEST_POOLED_STACK_CHUNK) {
+        for (i = 0; i < STACK_CHUNK_POOL_SIZE; i++) {
+            STACK pooled = (STACK)StackChunkPool->data[i].cellp;
+            if (pooled != NULL && pooled->size >= size &&
+                  (best < 0 ||
+                   pooled->size < ((STACK)StackChunkPool->data[best].cellp)->size)) {
+                best = i;
+                if (pooled->size == size) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (best >= 0) {
+        chunk = (STACK)StackChunkPool->data[best].cellp;
+        StackChunkPool->data[best].cellp = NULL;
+        incrementMetric(stackChunksReused);
+    } else {
+        int stacksize = sizeof(struct stackStruct) / CELL +
+                        (size - STACKCHUNKSIZE);
+        chunk = (STACK)mallocHeapObject(stacksize, GCT_EXECSTACK);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunk->size = size;
+        incrementMetric(stackChunksAllocated);
+    }
+
+#if INCLUDEDEBUGCODE
+    /* In debug mode, initialize the new stack chunk to zeros */
+    memset(chunk->cells, 0, chunk->size << log2CELL);
+#endif
+
+    chunk->next = NULL;
+    chunk->base = 0;
+    return chunk;
+}
+
+/*=========================================================================
+ * FUNCTION:      releaseStackChunks()
+ * TYPE:          public stack chunk operation
+ * OVERVIEW:      Put a chain of stack chunks that are no longer used
+ *                back into the pool.  Chunks that don't fit in the
+ *                pool are left to the garbage collector.
+ * INTERFACE:
+ *   parameters:  chunk: the first chunk of the chain
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void releaseStackChunks(STACK chunk)
+{
+    while (chunk != NULL) {
+        STACK next = chunk->next;
+        chunk->next = NULL;
+        if (chunk->size <= LARGEST_POOLED_STACK_CHUNK) {
+            int i;
+            for (i = 0; i < STACK_CHUNK_POOL_SIZE; i++) {
+                if (StackChunkPool->data[i].cellp == NULL) {
+                    StackChunkPool->data[i].cellp = (cell*)chunk;
+                    break;
+                }
+            }
+        }
+        chunk = next;
+    }
+}
+
 /*=========================================================================
  * Operations on stack frames
  *=======================================================================*/
@@ -175,6 +315,15 @@ void pushFrame(METHOD thisMethod)
     FRAME newFrame;
     int i;
     cell* prev_sp = getSP() - thisArgCount; /* Very volatile! */
+
+#if ENABLE_LAZY_METHOD_LOADING
+    if (thisMethod->accessFlags & ACC_LAZY_CODE) {
+        /* Reading the code may cause garbage collection */
+        loadMethodCode(thisMethod);
+        stack = getFP() ? getFP()->stack : CurrentThread->stack;
+        prev_sp = getSP() - thisArgCount;
+    }
+#endif
     
     /* Check if there is enough space in the current stack chunk */
     if (getSP() - stack->cells + thisMethodHeight >= stack->size) {
@@ -183,34 +332,24 @@ void pushFrame(METHOD thisMethod)
         STACK newstack;
         thisMethodHeight += thisArgCount;
 
-        /* Check if we can reuse an existing stack chunk */
+        /* Check if we can reuse an existing stack chunk.  If it is */
+        /* too small, give it back to the pool for other frames */
         if (stack->next && thisMethodHeight > stack->next->size) {
+            releaseStackChunks(stack->next);
             stack->next = NULL;
         }
 
-        /* If next is NULL, we need to create a new stack chunk */
+        /* If next is NULL, we need to get a new stack chunk */
         if (stack->next == NULL) {
-            int size = thisMethodHeight > STACKCHUNKSIZE 
-                     ? thisMethodHeight : STACKCHUNKSIZE;
-            int stacksize = sizeof(struct stackStruct) / CELL + 
-                           (size - STACKCHUNKSIZE);
             START_TEMPORARY_ROOTS
                 DECLARE_TEMPORARY_ROOT(STACK, stackX, stack);
-                newstack = (STACK)mallocHeapObject(stacksize, GCT_EXECSTACK); 
+                newstack = allocateStackChunk(thisMethodHeight);
                 stack = stackX;
                 prev_sp = getSP() - thisArgCount;
             END_TEMPORARY_ROOTS
             if (newstack == NULL) {
                 THROW(StackOverflowObject);
             }
-
-#if INCLUDEDEBUGCODE
-            /* In debug mode, initialize the new stack chunk to zeros */
-            memset(newstack, 0, stacksize << log2CELL);
-#endif
-
-            newstack->next = NULL;
-            newstack->size = size;
             stack->next = newstack;
 
 #if INCLUDEDEBUGCODE
@@ -226,6 +365,12 @@ void pushFrame(METHOD thisMethod)
             newstack = stack->next;
         }
 
+        /* Remember how deep the stack is below the new chunk */
+        {
+            long base = stack->base + (prev_sp + 1 - stack->cells);
+            newstack->base = (short)(base > 0x7FFF ? 0x7FFF : base);
+        }
+
         /* The actual pushFrame operation for a new stack chunk happens here */
         for (i = 0; i < thisArgCount; i++) {
             newstack->cells[i] = prev_sp[i + 1];
@@ -277,6 +422,21 @@ void pushFrame(METHOD thisMethod)
         setIP(thisMethod->u.java.code);
         setCP(thisMethod->ofClass->constPool);
 
+#if ENABLE_METRICS
+        /* Keep track of the deepest stack use of each thread */
+        {
+            STACK frameStack = newFrame->stack;
+            long depth = frameStack->base + (getSP() - frameStack->cells)
+                       + 1 + thisMethod->u.java.maxStack;
+            if (depth > CurrentThread->stackHighWater) {
+                CurrentThread->stackHighWater = depth;
+                if (depth > Metrics.stackHighWater) {
+                    Metrics.stackHighWater = depth;
+                }
+            }
+        }
+#endif /* ENABLE_METRICS */
+
 #if INCLUDEDEBUGCODE
         if (tracemethodcalls || tracemethodcallsverbose) {
             frameTracing(thisMethod, "=>", 0);
@@ -347,19 +507,70 @@ void popFrame()
 /*=========================================================================
  * FUNCTION:      findHandler()
  * TYPE:          exception handler table lookup operation
- * OVERVIEW:      Find a possible handler in the given exception handler
- *                table that catches the given exception in given
- *                code location.
+ * OVERVIEW:      Find a possible handler in the exception handler
+ *                table of the given method that catches the given
+ *                exception in given code location.
  * INTERFACE:
- *   parameters:  handler table, exception object, instruction pointer offset
+ *   parameters:  method, exception object, instruction pointer offset
  *   returns:     handler or NIL if no matching handler is found
  *=======================================================================*/
 
+#if CACHE_EXCEPTION_HANDLERS
+
+/* The outcome of an exception handler lookup.  The handler is stored
+ * as an index, since handler tables may move during compaction.
+ * The cache is flushed at every garbage collection.
+ */
+static struct exceptionHandlerCacheEntry {
+    METHOD         method;
+    INSTANCE_CLASS exceptionClass;
+    unsigned short ipOffset;
+    short          handlerIndex;    /* -1 if there is no handler */
+} ExceptionHandlerCache[EXCEPTIONHANDLERCACHESIZE];
+
+#define EXCEPTION_HANDLER_CACHE_ENTRY(method, clazz, ipOffset)           \
+    (&ExceptionHandlerCache[((((long)(method)) >> 2) ^                   \
+                             (((long)(clazz)) >> 4) ^ (ipOffset))        \
+                            & (EXCEPTIONHANDLERCACHESIZE - 1)])
+
+#if ENABLEPROFILING
+long ExceptionHandlerCacheHitCounter;
+long ExceptionHandlerCacheMissCounter;
+#endif
+
+void flushExceptionHandlerCache(void)
+{
+    memset(ExceptionHandlerCache, 0, sizeof(ExceptionHandlerCache));
+}
+
+#endif /* CACHE_EXCEPTION_HANDLERS */
+
 static HANDLER
-findHandler(INSTANCE_CLASS thisClass, HANDLERTABLE handlerTable, 
-            THROWABLE_INSTANCE_HANDLE exceptionH, unsigned short ipOffset)
+findHandler(METHOD thisMethod, THROWABLE_INSTANCE_HANDLE exceptionH,
+            unsigned short ipOffset)
 {
+    INSTANCE_CLASS thisClass = thisMethod->ofClass;
+    HANDLERTABLE handlerTable = thisMethod->u.java.handlers;
     HANDLER result = NULL;
+#if CACHE_EXCEPTION_HANDLERS
+    INSTANCE_CLASS exceptionClass = unhand(exceptionH)->ofClass;
+    struct exceptionHandlerCacheEntry *entry =
+        EXCEPTION_HANDLER_CACHE_ENTRY(thisMethod, exceptionClass, ipOffset);
+
+    if (entry->method == thisMethod
+          && entry->exceptionClass == exceptionClass
+          && entry->ipOffset == ipOffset) {
+#if ENABLEPROFILING
+        ExceptionHandlerCacheHitCounter++;
+#endif
+        return (entry->handlerIndex < 0)
+            ? NULL : &handlerTable->handlers[entry->handlerIndex];
+    }
+#if ENABLEPROFILING
+    ExceptionHandlerCacheMissCounter++;
+#endif
+#endif /* CACHE_EXCEPTION_HANDLERS */
+
     ASSERTING_NO_ALLOCATION    
         FOR_EACH_HANDLER(thisHandler, handlerTable)
             if (ipOffset < thisHandler->startPC) { 
@@ -387,6 +598,16 @@ findHandler(INSTANCE_CLASS thisClass, HANDLERTABLE handlerTable,
             }
         END_FOR_EACH_HANDLER
     END_ASSERTING_NO_ALLOCATION
+
+#if CACHE_EXCEPTION_HANDLERS
+    /* Only successful lookups get here; a failure to resolve a
+     * handler class is thrown before anything is cached */
+    entry->method = thisMethod;
+    entry->exceptionClass = exceptionClass;
+    entry->ipOffset = ipOffset;
+    entry->handlerIndex = (short)((result == NULL)
+                                  ? -1 : result - handlerTable->handlers);
+#endif /* CACHE_EXCEPTION_HANDLERS */
     return result;
 }
 
@@ -475,10 +696,9 @@ restartOnError:
         if (handlerTable != NULL) { 
             HANDLER thisHandler;
             START_TEMPORARY_ROOTS
-                INSTANCE_CLASS thisClass = thisFP->thisMethod->ofClass ;
                 DECLARE_TEMPORARY_FRAME_ROOT(thisFPx, thisFP);
                 ipOffset = thisIP - thisMethod->u.java.code;
-                thisHandler = findHandler(thisClass, handlerTable, exceptionH,
+                thisHandler = findHandler(thisMethod, exceptionH,
                                           (unsigned short)(ipOffset - ipCorrection));
                 thisFP = thisFPx;
             END_TEMPORARY_ROOTS
@@ -624,6 +844,68 @@ leave:
  * (see the detailed comparison of these operations in frame.h)
  *=======================================================================*/
 
+#if ENABLE_PREALLOCATED_EXCEPTIONS
+
+/* TRUE if exceptions raised by the VM are to be reused (-reuseexceptions) */
+bool_t ReuseVMExceptions;
+
+/* The exceptions that are reused, created when first raised.  The
+ * entries correspond to the names in PreallocatedExceptionNames. */
+static POINTERLIST PreallocatedExceptions;
+
+static const char* const PreallocatedExceptionNames[] = {
+    ArithmeticException,
+    ArrayIndexOutOfBoundsException,
+    ArrayStoreException,
+    ClassCastException,
+    NegativeArraySizeException,
+    NullPointerException
+};
+
+#define PREALLOCATED_EXCEPTION_COUNT \
+    (sizeof(PreallocatedExceptionNames) / sizeof(PreallocatedExceptionNames[0]))
+
+static int
+preallocatedExceptionIndex(const char* name) {
+    int i;
+    if (PreallocatedExceptions != NULL) {
+        for (i = 0; i < (int)PREALLOCATED_EXCEPTION_COUNT; i++) {
+            if (PreallocatedExceptionNames[i] == name) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+#endif /* ENABLE_PREALLOCATED_EXCEPTIONS */
+
+/*=========================================================================
+ * FUNCTION:      InitializeExceptionHandling()
+ * TYPE:          private constructor
+ * OVERVIEW:      Reset the exception handler cache and create the list
+ *                of reusable exceptions for a new VM instance.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void InitializeExceptionHandling(void)
+{
+    flushExceptionHandlerCache();
+
+#if ENABLE_PREALLOCATED_EXCEPTIONS
+    PreallocatedExceptions = NULL;
+    if (ReuseVMExceptions) {
+        PreallocatedExceptions = (POINTERLIST)
+            callocObject(SIZEOF_POINTERLIST(PREALLOCATED_EXCEPTION_COUNT),
+                         GCT_POINTERLIST);
+        PreallocatedExceptions->length = PREALLOCATED_EXCEPTION_COUNT;
+        makeGlobalRoot((cell **)&PreallocatedExceptions);
+    }
+#endif /* ENABLE_PREALLOCATED_EXCEPTIONS */
+}
+
 /*=========================================================================
  * FUNCTION:      getExceptionInstance()
  * TYPE:          internal exception handling operation
@@ -646,6 +928,20 @@ static THROWABLE_INSTANCE getExceptionInstance(const char* name,
 
     INSTANCE_CLASS clazz;
     THROWABLE_INSTANCE exception;
+#if ENABLE_PREALLOCATED_EXCEPTIONS
+    int preallocatedIndex = (msg == NULL) 
+        ? preallocatedExceptionIndex(name) : -1;
+    if (preallocatedIndex >= 0) {
+        exception = (THROWABLE_INSTANCE)
+            PreallocatedExceptions->data[preallocatedIndex].cellp;
+        if (exception != NULL) {
+            /* ATHROW fills in a missing backtrace if the program
+             * rethrows the exception; don't let that one stick */
+            exception->backtrace = NULL;
+            return exception;
+        }
+    }
+#endif /* ENABLE_PREALLOCATED_EXCEPTIONS */
 
     /* 
      * For CLDC 1.0/1.1, we will hardcode the names of some of the 
@@ -718,9 +1014,18 @@ static THROWABLE_INSTANCE getExceptionInstance(const char* name,
         IS_TEMPORARY_ROOT(exception, (THROWABLE_INSTANCE)instantiate(clazz));
         /* The exception object instantiation is successful otherwise we
          * will have already thrown an OutOfMemoryError */
+#if ENABLE_PREALLOCATED_EXCEPTIONS
+        if (preallocatedIndex >= 0) {
+            /* A backtrace would be wrong the next time this is thrown */
+            PreallocatedExceptions->data[preallocatedIndex].cellp =
+                (cell *)exception;
+        } else
+#endif /* ENABLE_PREALLOCATED_EXCEPTIONS */
+        {
 #if PRINT_BACKTRACE
-        fillInStackTrace(&exception);
+            fillInStackTrace(&exception);
 #endif
+        }
     END_TEMPORARY_ROOTS
 
     UnfoundException = NULL;
@@ -980,7 +1285,12 @@ exceptionCaughtTracing(THROWABLE_INSTANCE_HANDLE exceptionH, HANDLER handler) {
 
 #if PRINT_BACKTRACE
 
+/* Most backtraces fit into a buffer of this many frames, so that the
+ * stack needs to be walked only once when filling in a backtrace */
+#define BACKTRACE_BUFFER_FRAMES 32
+
 void fillInStackTrace(THROWABLE_INSTANCE_HANDLE exceptionH) {
+    cellOrPointer buffer[2 * BACKTRACE_BUFFER_FRAMES];
     ARRAY backtrace;
     int i;
     int depth;
@@ -990,11 +1300,23 @@ void fillInStackTrace(THROWABLE_INSTANCE_HANDLE exceptionH) {
     /* Can't do much if we are in VM startup... */
     if (CurrentThread == NULL) return;
 
-    /* Get the number of frames that need to be saved less the current frame */
-    for ( depth = 1, thisFp = getFP(); 
-          thisFp->previousIp != KILLTHREAD; 
-          depth++, thisFp = thisFp->previousFp) 
-        ; /* intentionally empty */
+    /* Count the frames, recording the topmost ones as we go.  Only
+     * the method and the offset are recorded; names are looked up
+     * only if the backtrace is ever printed */
+    thisIp = getIP();
+    thisFp = getFP();
+    for (depth = 0; ; ) {
+        if (depth < BACKTRACE_BUFFER_FRAMES) {
+            buffer[depth*2].cellp = (cell*)thisFp->thisMethod;
+            buffer[depth*2+1].cell = thisIp - thisFp->thisMethod->u.java.code;
+        }
+        depth++;
+        if (thisFp->previousIp == KILLTHREAD) {
+            break;
+        }
+        thisIp = thisFp->previousIp;
+        thisFp = thisFp->previousFp;
+    }
 
     /* We are essentially doing an instantiateArray here, but we don't 
      * want it to throw an error if it runs out of memory.  For now, we
@@ -1003,19 +1325,29 @@ void fillInStackTrace(THROWABLE_INSTANCE_HANDLE exceptionH) {
     unhand(exceptionH)->backtrace = backtrace;
     if (backtrace != NULL) { 
         ASSERTING_NO_ALLOCATION
+            int buffered = (depth < BACKTRACE_BUFFER_FRAMES)
+                         ? depth : BACKTRACE_BUFFER_FRAMES;
+
             /* Make sure all headers are cleared. */
-            memset(backtrace, 0, offsetof(struct arrayStruct, data[0]));
+            CLEAR_NEW_OBJECT(backtrace, offsetof(struct arrayStruct, data[0]));
             backtrace->ofClass = PrimitiveArrayClasses[T_INT];
             backtrace->length = depth * 2;
-            
-            thisIp = getIP();
-            thisFp = getFP();
-            for (i = 0; i < depth; i++) {
-                backtrace->data[i*2].cellp = (cell*)thisFp->thisMethod;
-                backtrace->data[i*2+1].cell = 
-                    thisIp - thisFp->thisMethod->u.java.code;
-                thisIp = thisFp->previousIp;
-                thisFp = thisFp->previousFp;
+            memcpy(&backtrace->data[0], buffer,
+                   buffered * 2 * sizeof(cellOrPointer));
+
+            if (depth > buffered) {
+                /* A deep stack.  Walk it again for the remaining frames */
+                thisIp = getIP();
+                thisFp = getFP();
+                for (i = 0; i < depth; i++) {
+                    if (i >= buffered) {
+                        backtrace->data[i*2].cellp = (cell*)thisFp->thisMethod;
+                        backtrace->data[i*2+1].cell = 
+                            thisIp - thisFp->thisMethod->u.java.code;
+                    }
+                    thisIp = thisFp->previousIp;
+                    thisFp = thisFp->previousFp;
+                }
             }
         END_ASSERTING_NO_ALLOCATION
     }
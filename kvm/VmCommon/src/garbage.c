@@ -60,6 +60,9 @@ garbageCollect(int moreMemory)
     int beforeCollection = 0;
     int afterCollection = 0;
 #endif
+#if ENABLE_METRICS
+    ulong64 startTime = CurrentTime_md();
+#endif
 
     if (gcInProgress != 0) {
         /* 
@@ -91,6 +94,7 @@ garbageCollect(int moreMemory)
 #endif
 
     MonitorCache = NULL;        /* Clear any temporary monitors */
+    flushExceptionHandlerCache();
 
     /* Store virtual machine registers of the currently active thread before
      * garbage collection (must be  done to enable execution stack scanning).
@@ -99,7 +103,11 @@ garbageCollect(int moreMemory)
         storeExecutionEnvironment(CurrentThread);
     }
 
+    resolveAllocationSamples();
+    startGCLogEvent(moreMemory * CELL);
     garbageCollectForReal(moreMemory);
+    endGCLogEvent();
+    countAllocationSampleSurvivors();
 
     if (CurrentThread) {
         loadExecutionEnvironment(CurrentThread);
@@ -123,6 +131,8 @@ garbageCollect(int moreMemory)
     }
 #endif /* INCLUDEDEBUGCODE */
 
+    recordGCPause(startTime);
+
     RestartAsynchronousFunctions();
     /*
      * Reset to indicate end of garbage collection
@@ -186,7 +196,7 @@ cell* callocObject(long size, GCT_ObjectType type)
     }
 
     /* Initialize the area to zero */
-    memset(result, 0, size << log2CELL);
+    CLEAR_NEW_OBJECT(result, size << log2CELL);
 
     return result;
 }
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Garbage collection log
+ * FILE:      gcLog.c
+ * OVERVIEW:  Writes one JSON line per garbage collection to the file
+ *            given with the -gclog option.  Unlike the tracing done
+ *            by log.c, the GC log is available in production builds
+ *            and records the duration of each phase of the collector.
+ *=======================================================================*/
+
+/*=========================================================================
+ * COMMENTS:
+ * The collectors record the time at the end of each phase with
+ * logGCPhase(), and other values with logGCValue() and addToGCLog().
+ * All the durations are in microseconds.  Each line looks like this
+ * (broken up here for readability):
+ *
+ *   {"gc":12,"timeMs":5310,"requested":24,"heapSize":262144,
+ *    "freeBefore":84,"freeAfter":180224,"largestFree":96512,
+ *    "totalUs":1840,"rootsUs":320,"threadStacksUs":95,"markUs":1010,
+ *    "weakUs":12,"sweepUs":498,"compactUs":0,"breakTable":-1,
+ *    "rescans":0,"deferralOverflows":0}
+ *
+ * The log file is opened once at startup and flushed after each line,
+ * so the cost of logging is a few calls to the timer and one fprintf()
+ * per collection.
+ *=======================================================================*/
+
+/*=========================================================================
+ * Include files
+ *=======================================================================*/
+
+#include <global.h>
+
+#if ENABLE_GC_LOG
+
+/*=========================================================================
+ * Global variables
+ *=======================================================================*/
+
+char*   GCLogFile;
+bool_t  GCLogging;
+
+struct gcLogEventStruct GCLogEvent;
+
+static FILE*   GCLogStream;
+static ulong64 GCLogStartTime;
+static long    GCLogCount;
+
+/*=========================================================================
+ * GC log operations
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      InitializeGCLog
+ * TYPE:          public global operation
+ * OVERVIEW:      Open the GC log file, if one was requested.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void InitializeGCLog()
+{
+    GCLogging = FALSE;
+    GCLogCount = 0;
+    GCLogStartTime = CurrentTimeMicros_md();
+    GCLogStream = NULL;
+
+    if (GCLogFile != NULL) {
+        GCLogStream = fopen(GCLogFile, "a");
+        if (GCLogStream == NULL) {
+            fprintf(stderr, KVM_MSG_CANT_OPEN_GC_LOG_1STRPARAM, GCLogFile);
+        }
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      FinalizeGCLog
+ * TYPE:          public global operation
+ * OVERVIEW:      Close the GC log file.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void FinalizeGCLog()
+{
+    if (GCLogStream != NULL) {
+        fclose(GCLogStream);
+        GCLogStream = NULL;
+    }
+    GCLogging = FALSE;
+}
+
+/*=========================================================================
+ * FUNCTION:      startGCLogEvent
+ * TYPE:          public global operation
+ * OVERVIEW:      Called by garbageCollect() just before the collector
+ *                runs.  Starts recording a new collection.
+ * INTERFACE:
+ *   parameters:  requested: the number of bytes the allocator needs
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void startGCLogEvent(long requested)
+{
+    if (GCLogStream == NULL) {
+        return;
+    }
+    memset(&GCLogEvent, 0, sizeof(GCLogEvent));
+    GCLogEvent.requested = requested;
+    GCLogEvent.freeBefore = memoryFree();
+    GCLogEvent.breakTable = -1;
+    GCLogEvent.phaseEnd[GC_PHASE_START] = CurrentTimeMicros_md();
+    GCLogging = TRUE;
+}
+
+/* Duration of a phase; phases that didn't run take no time */
+static long phaseTime(int phase, ulong64* last)
+{
+    ulong64 end = GCLogEvent.phaseEnd[phase];
+    long duration;
+
+    if (end == 0) {
+        return 0;
+    }
+    duration = (long)(end - *last);
+    *last = end;
+    return duration;
+}
+
+/*=========================================================================
+ * FUNCTION:      endGCLogEvent
+ * TYPE:          public global operation
+ * OVERVIEW:      Called by garbageCollect() when the collector is done.
+ *                Writes the log line for the collection.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void endGCLogEvent()
+{
+    ulong64 start = GCLogEvent.phaseEnd[GC_PHASE_START];
+    ulong64 end = CurrentTimeMicros_md();
+    ulong64 last = start;
+    long roots, mark, weak, sweep, compact;
+
+    if (!GCLogging) {
+        return;
+    }
+    GCLogging = FALSE;
+    GCLogCount++;
+    GCLogEvent.freeAfter = memoryFree();
+
+    roots   = phaseTime(GC_PHASE_ROOTS, &last);
+    mark    = phaseTime(GC_PHASE_MARK, &last);
+    weak    = phaseTime(GC_PHASE_WEAK, &last);
+    sweep   = phaseTime(GC_PHASE_SWEEP, &last);
+    compact = phaseTime(GC_PHASE_COMPACT, &last);
+
+    fprintf(GCLogStream,
+            "{\"gc\":%ld,\"timeMs\":%ld,\"requested\":%ld,"
+            "\"heapSize\":%ld,\"freeBefore\":%ld,\"freeAfter\":%ld,"
+            "\"largestFree\":%ld,\"totalUs\":%ld,\"rootsUs\":%ld,"
+            "\"threadStacksUs\":%ld,\"markUs\":%ld,\"weakUs\":%ld,"
+            "\"sweepUs\":%ld,\"compactUs\":%ld,\"breakTable\":%ld,"
+            "\"rescans\":%ld,\"deferralOverflows\":%ld}\n",
+            GCLogCount, (long)((start - GCLogStartTime) / 1000),
+            GCLogEvent.requested, (long)getHeapSize(),
+            GCLogEvent.freeBefore, GCLogEvent.freeAfter,
+            GCLogEvent.largestFree, (long)(end - start), roots,
+            (long)GCLogEvent.threadStacks, mark, weak, sweep, compact,
+            GCLogEvent.breakTable, GCLogEvent.rescans,
+            GCLogEvent.deferralOverflows);
+    fflush(GCLogStream);
+}
+
+#endif /* ENABLE_GC_LOG */
+
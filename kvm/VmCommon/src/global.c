@@ -47,6 +47,7 @@ bool_t vmDebugReady = FALSE;
 /*  Flags for toggling certain global modes on and off */
 bool_t JamEnabled;
 bool_t JamRepeat;
+bool_t JamZygote;
 
 /*========================================================================
  * Runtime flags for choosing different tracing/debugging options.
@@ -74,7 +74,8 @@ createHashTable(HASHTABLE *tablePtr, int bucketCount) {
  *=======================================================================*/
 
 void InitializeHashtables() { 
-    if (!ROMIZING) { 
+    /* A class snapshot brings its own tables */
+    if (!ROMIZING && !ClassSnapshotRestored) { 
         createHashTable(&UTFStringTable, UTF_TABLE_SIZE);
         createHashTable(&InternStringTable, INTERN_TABLE_SIZE);
         createHashTable(&ClassTable, CLASS_TABLE_SIZE);
@@ -234,28 +235,24 @@ getUStringX(CONST_CHAR_HANDLE nameH, int offset, int stringLength)
 }
 
 /*=========================================================================
- * FUNCTION:      internString
- * OVERVIEW:      Returns a unique Java String that corresponds to a
- *                particular char* C string
+ * FUNCTION:      findInternedString, findInternedStringInBucket
+ * OVERVIEW:      Returns the Java String that has been interned for a
+ *                particular char* C string, without creating one
  * INTERFACE:
  *   parameters:  string:  A C string
- *   returns:     A unique Java String, such that if strcmp(x,y) == 0, then
- *                internString(x) == internString(y).
+ *                index:   The bucket of the string in InternStringTable
+ *   returns:     The interned Java String, or NULL if there is none
  *=======================================================================*/
 
-INTERNED_STRING_INSTANCE
-internString(const char *utf8string, int length)
+static INTERNED_STRING_INSTANCE
+findInternedStringInBucket(const char *utf8string, int length,
+                           unsigned int index)
 { 
-    HASHTABLE table = InternStringTable;
-    unsigned int hash = stringHash(utf8string, length);
-    unsigned int index = hash % table->bucketCount;
     unsigned int utfLength = utfStringLength(utf8string, length);
+    INTERNED_STRING_INSTANCE string =
+        (INTERNED_STRING_INSTANCE)InternStringTable->bucket[index];
 
-    INTERNED_STRING_INSTANCE string, *stringPtr;
-
-    stringPtr = (INTERNED_STRING_INSTANCE *)&table->bucket[index];
-    
-    for (string = *stringPtr; string != NULL; string = string->next) { 
+    for ( ; string != NULL; string = string->next) { 
         if (string->length == utfLength) { 
             SHORTARRAY chars = string->array;
             int offset = string->offset;
@@ -268,17 +265,52 @@ internString(const char *utf8string, int length)
                     goto continueOuterLoop;
                 }
             }
-            if (EXCESSIVE_GARBAGE_COLLECTION && !ASYNCHRONOUS_NATIVE_FUNCTIONS){
-                /* We might garbage collect, so we do  */
-                garbageCollect(0);
-            }
             return string;
         }
     continueOuterLoop:
         ;
     }
+    return NULL;
+}
+
+INTERNED_STRING_INSTANCE
+findInternedString(const char *utf8string, int length)
+{
+    unsigned int hash = stringHash(utf8string, length);
+    return findInternedStringInBucket(utf8string, length,
+                                      hash % InternStringTable->bucketCount);
+}
+
+/*=========================================================================
+ * FUNCTION:      internString
+ * OVERVIEW:      Returns a unique Java String that corresponds to a
+ *                particular char* C string
+ * INTERFACE:
+ *   parameters:  string:  A C string
+ *   returns:     A unique Java String, such that if strcmp(x,y) == 0, then
+ *                internString(x) == internString(y).
+ *=======================================================================*/
+
+INTERNED_STRING_INSTANCE
+internString(const char *utf8string, int length)
+{ 
+    HASHTABLE table = InternStringTable;
+    unsigned int hash = stringHash(utf8string, length);
+    unsigned int index = hash % table->bucketCount;
+
+    INTERNED_STRING_INSTANCE string, *stringPtr;
+
+    stringPtr = (INTERNED_STRING_INSTANCE *)&table->bucket[index];
+
+    string = findInternedStringInBucket(utf8string, length, index);
+    if (string != NULL) {
+        if (EXCESSIVE_GARBAGE_COLLECTION && !ASYNCHRONOUS_NATIVE_FUNCTIONS){
+            /* We might garbage collect, so we do  */
+            garbageCollect(0);
+        }
+        return string;
+    }
 
-    
     string = instantiateInternedString(utf8string, length);
     string->next = *stringPtr;
     *stringPtr = string;
@@ -0,0 +1,834 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Heap inspection
+ * FILE:      heapDump.c
+ * OVERVIEW:  Class histograms of the heap, and heap dumps in the
+ *            binary HPROF format (version 1.0.2) used by standard
+ *            heap analyzers, plus the native functions of class
+ *            com.sun.cldc.util.HeapInspector.
+ *=======================================================================*/
+
+/*=========================================================================
+ * COMMENTS:
+ * Neither the histogram nor the heap dump allocate memory in the
+ * Java heap, so both can be used when the heap is exhausted.  Their
+ * temporary tables are allocated with malloc() and freed afterwards.
+ *
+ * The heap dump contains every Java object in the dynamic heap
+ * (instances and arrays) and every loaded class, with its static
+ * fields.  VM-internal heap objects, such as execution stacks and
+ * method tables, have no Java class; they are counted in the
+ * histogram but left out of the dump.  Since KVM does not keep
+ * exact stack maps for all frames, the execution stacks of threads
+ * are scanned conservatively: each stack slot that holds the address
+ * of an object in the heap is reported as a Java frame root.
+ *=======================================================================*/
+
+/*=========================================================================
+ * Include files
+ *=======================================================================*/
+
+#include <global.h>
+
+#if ENABLE_HEAP_DUMP
+
+/*=========================================================================
+ * Global variables
+ *=======================================================================*/
+
+volatile int HeapDumpRequested;
+char*        HeapDumpFile;
+bool_t       HeapDumpOnOutOfMemory;
+
+#define DEFAULT_HEAP_DUMP_FILE "kvm.hprof"
+
+/*=========================================================================
+ * Histogram
+ *=======================================================================*/
+
+/*  HISTOGRAMENTRY */
+typedef struct histogramEntryStruct {
+    CLASS          clazz;     /* Class of the objects, or NULL for */
+                              /* VM-internal objects */
+    GCT_ObjectType type;      /* GC type of the objects */
+    long           count;     /* Number of objects */
+    long           bytes;     /* Total size of the objects, with headers */
+} *HISTOGRAMENTRY;
+
+typedef struct histogramStruct {
+    HISTOGRAMENTRY entries;   /* Open hash table of entries */
+    long           capacity;  /* Always a power of two */
+    long           used;
+    bool_t         failed;    /* Set if we ran out of malloc memory */
+} *HISTOGRAM;
+
+static const char* const GCTypeNames[] = GCT_TYPENAMES;
+
+static CLASS getJavaClass(cell* object, GCT_ObjectType type)
+{
+    switch (type) {
+        case GCT_INSTANCE:
+        case GCT_WEAKREFERENCE:
+        case GCT_ARRAY:
+        case GCT_OBJECTARRAY:
+            return ((OBJECT)object)->ofClass;
+        default:
+            return NULL;
+    }
+}
+
+static HISTOGRAMENTRY
+findHistogramEntry(HISTOGRAMENTRY entries, long capacity,
+                   CLASS clazz, GCT_ObjectType type)
+{
+    unsigned long hash = (((unsigned long)clazz >> 2) * 31) + type;
+    long index = hash & (capacity - 1);
+
+    for (;;) {
+        HISTOGRAMENTRY entry = &entries[index];
+        if (entry->count == 0 ||
+              (entry->clazz == clazz && entry->type == type)) {
+            return entry;
+        }
+        index = (index + 1) & (capacity - 1);
+    }
+}
+
+static bool_t growHistogram(HISTOGRAM histogram)
+{
+    long newCapacity = histogram->capacity * 2;
+    HISTOGRAMENTRY newEntries = (HISTOGRAMENTRY)
+        calloc(newCapacity, sizeof(struct histogramEntryStruct));
+    long i;
+
+    if (newEntries == NULL) {
+        return FALSE;
+    }
+    for (i = 0; i < histogram->capacity; i++) {
+        HISTOGRAMENTRY entry = &histogram->entries[i];
+        if (entry->count != 0) {
+            *findHistogramEntry(newEntries, newCapacity,
+                                entry->clazz, entry->type) = *entry;
+        }
+    }
+    free(histogram->entries);
+    histogram->entries = newEntries;
+    histogram->capacity = newCapacity;
+    return TRUE;
+}
+
+static void
+countObject(cell* object, GCT_ObjectType type, long size, void* closure)
+{
+    HISTOGRAM histogram = (HISTOGRAM)closure;
+    CLASS clazz = getJavaClass(object, type);
+    HISTOGRAMENTRY entry;
+
+    if (histogram->failed) {
+        return;
+    }
+    entry = findHistogramEntry(histogram->entries, histogram->capacity,
+                               clazz, type);
+    if (entry->count == 0) {
+        if (histogram->used * 4 >= histogram->capacity * 3) {
+            if (!growHistogram(histogram)) {
+                histogram->failed = TRUE;
+                return;
+            }
+            entry = findHistogramEntry(histogram->entries,
+                                       histogram->capacity, clazz, type);
+        }
+        entry->clazz = clazz;
+        entry->type = type;
+        histogram->used++;
+    }
+    entry->count++;
+    entry->bytes += size;
+}
+
+static int compareHistogramEntries(const void* a, const void* b)
+{
+    long bytesA = ((HISTOGRAMENTRY)a)->bytes;
+    long bytesB = ((HISTOGRAMENTRY)b)->bytes;
+    return (bytesA < bytesB) ? 1 : (bytesA > bytesB) ? -1 : 0;
+}
+
+static void printHistogramClassName(FILE* file, CLASS clazz)
+{
+    UString packageName = clazz->packageName;
+    int length = clazz->baseName->length
+               + (packageName == NULL ? 0 : packageName->length) + 5;
+    char* name = (char*)malloc(length);
+
+    if (name != NULL) {
+        getClassName_inBuffer(clazz, name);
+        fprintf(file, "%s", name);
+        free(name);
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      printHeapHistogram
+ * TYPE:          public heap inspection operation
+ * OVERVIEW:      Print the number and total size of the objects in the
+ *                heap, grouped by class and GC type, largest first.
+ *                Objects that have no Java class are grouped by GC
+ *                type alone.
+ * INTERFACE:
+ *   parameters:  file: the stream to print to
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void printHeapHistogram(FILE* file)
+{
+    struct histogramStruct histogram;
+    long totalCount = 0;
+    long totalBytes = 0;
+    long i, n;
+
+    histogram.capacity = 256;
+    histogram.used = 0;
+    histogram.failed = FALSE;
+    histogram.entries = (HISTOGRAMENTRY)
+        calloc(histogram.capacity, sizeof(struct histogramEntryStruct));
+    if (histogram.entries == NULL) {
+        return;
+    }
+
+    forEachHeapObject(countObject, &histogram);
+
+    /* Compact the used entries to the front of the table, and sort them */
+    for (i = 0, n = 0; i < histogram.capacity; i++) {
+        if (histogram.entries[i].count != 0) {
+            histogram.entries[n++] = histogram.entries[i];
+        }
+    }
+    qsort(histogram.entries, n, sizeof(struct histogramEntryStruct),
+          compareHistogramEntries);
+
+    fprintf(file, " num   #instances      #bytes  gc type          class\n");
+    fprintf(file, "-----------------------------------------------------"
+                  "------------------\n");
+    for (i = 0; i < n; i++) {
+        HISTOGRAMENTRY entry = &histogram.entries[i];
+        fprintf(file, "%4ld: %12ld %11ld  %-15s  ", i + 1,
+                entry->count, entry->bytes, GCTypeNames[entry->type]);
+        if (entry->clazz != NULL) {
+            printHistogramClassName(file, entry->clazz);
+        } else {
+            fprintf(file, "<%s>", GCTypeNames[entry->type]);
+        }
+        fprintf(file, "\n");
+        totalCount += entry->count;
+        totalBytes += entry->bytes;
+    }
+    fprintf(file, "Total %12ld %11ld%s\n", totalCount, totalBytes,
+            histogram.failed ? "  (incomplete)" : "");
+    fflush(file);
+
+    free(histogram.entries);
+}
+
+/*=========================================================================
+ * HPROF heap dump
+ *=======================================================================*/
+
+/* Top-level record tags */
+#define HPROF_UTF8                0x01
+#define HPROF_LOAD_CLASS          0x02
+#define HPROF_TRACE               0x05
+#define HPROF_HEAP_DUMP_SEGMENT   0x1C
+#define HPROF_HEAP_DUMP_END       0x2C
+
+/* Heap dump sub-record tags */
+#define HPROF_GC_ROOT_UNKNOWN     0xFF
+#define HPROF_GC_ROOT_JAVA_FRAME  0x03
+#define HPROF_GC_ROOT_STICKY_CLASS 0x05
+#define HPROF_GC_ROOT_THREAD_OBJ  0x08
+#define HPROF_GC_CLASS_DUMP       0x20
+#define HPROF_GC_INSTANCE_DUMP    0x21
+#define HPROF_GC_OBJ_ARRAY_DUMP   0x22
+#define HPROF_GC_PRIM_ARRAY_DUMP  0x23
+
+/* Basic types; the primitive types are the same as the T_* constants */
+#define HPROF_OBJECT              2
+
+/* The only (empty) stack trace in the dump */
+#define HPROF_TRACE_SERIAL        1
+
+#define HPROF_ID_SIZE             ((int)sizeof(void*))
+
+static FILE*  hprofFile;
+static unsigned char* validObjects;   /* Bitmap of object addresses */
+
+static void writeU1(int value)
+{
+    putc(value & 0xFF, hprofFile);
+}
+
+static void writeU2(unsigned long value)
+{
+    writeU1((int)(value >> 8));
+    writeU1((int)value);
+}
+
+static void writeU4(unsigned long value)
+{
+    writeU2((value >> 16) & 0xFFFF);
+    writeU2(value & 0xFFFF);
+}
+
+static void writeU8(ulong64 value)
+{
+    writeU4((unsigned long)(value >> 32));
+    writeU4((unsigned long)(value & 0xFFFFFFFF));
+}
+
+static void writeID(const void* pointer)
+{
+    if (HPROF_ID_SIZE == 8) {
+        writeU8((ulong64)(unsigned long)pointer);
+    } else {
+        writeU4((unsigned long)pointer);
+    }
+}
+
+static void writeRecordHeader(int tag, unsigned long length)
+{
+    writeU1(tag);
+    writeU4(0);                 /* Microseconds since the header time */
+    writeU4(length);
+}
+
+static void writeUTF8Record(const void* id, const char* string, int length)
+{
+    writeRecordHeader(HPROF_UTF8, HPROF_ID_SIZE + length);
+    writeID(id);
+    fwrite(string, 1, length, hprofFile);
+}
+
+static bool_t isHeapObject(cell* pointer)
+{
+    long index;
+    if (pointer < CurrentHeap || pointer >= CurrentHeapEnd) {
+        return FALSE;
+    }
+    index = pointer - CurrentHeap;
+    return (validObjects[index >> 3] & (1 << (index & 7))) != 0;
+}
+
+static void
+markValidObject(cell* object, GCT_ObjectType type, long size, void* closure)
+{
+    long index = object - CurrentHeap;
+    validObjects[index >> 3] |= (1 << (index & 7));
+}
+
+static bool_t isDumpedClass(CLASS clazz)
+{
+    return IS_ARRAY_CLASS(clazz)
+        || ((INSTANCE_CLASS)clazz)->status >= CLASS_LOADED;
+}
+
+/* HPROF basic type of a field */
+static int getFieldType(FIELD field)
+{
+    FieldTypeKey key = field->nameTypeKey.nt.typeKey;
+    switch (key) {
+        case 'Z': return T_BOOLEAN;
+        case 'C': return T_CHAR;
+        case 'F': return T_FLOAT;
+        case 'D': return T_DOUBLE;
+        case 'B': return T_BYTE;
+        case 'S': return T_SHORT;
+        case 'I': return T_INT;
+        case 'J': return T_LONG;
+        default:  return HPROF_OBJECT;
+    }
+}
+
+static int getTypeSize(int type)
+{
+    switch (type) {
+        case T_BOOLEAN: case T_BYTE:  return 1;
+        case T_CHAR:    case T_SHORT: return 2;
+        case T_FLOAT:   case T_INT:   return 4;
+        case T_DOUBLE:  case T_LONG:  return 8;
+        default:                      return HPROF_ID_SIZE;
+    }
+}
+
+/* Write the value of a field stored at the given address */
+static void writeValue(int type, cell* slot)
+{
+    switch (type) {
+        case T_BOOLEAN: case T_BYTE:
+            writeU1((int)*slot);
+            break;
+        case T_CHAR: case T_SHORT:
+            writeU2(*slot & 0xFFFF);
+            break;
+        case T_FLOAT: case T_INT:
+            writeU4(*slot);
+            break;
+        case T_LONG: case T_DOUBLE: {
+            /* The two cells of the value, which may not be aligned */
+            ulong64 bits;
+            memcpy(&bits, slot, sizeof(bits));
+            writeU8(bits);
+            break;
+        }
+        default:
+            writeID(*(cell**)slot);
+            break;
+    }
+}
+
+/* Number of bytes of field values in an INSTANCE_DUMP of the class */
+static unsigned long getInstanceDumpSize(INSTANCE_CLASS clazz)
+{
+    unsigned long size = 0;
+    for ( ; clazz != NULL; clazz = clazz->superClass) {
+        FOR_EACH_FIELD(field, clazz->fieldTable)
+            if (!(field->accessFlags & ACC_STATIC)) {
+                size += getTypeSize(getFieldType(field));
+            }
+        END_FOR_EACH_FIELD
+    }
+    return size;
+}
+
+static void writeStrings(void)
+{
+    FOR_ALL_CLASSES(clazz)
+        if (isDumpedClass(clazz)) {
+            UString packageName = clazz->packageName;
+            int length = clazz->baseName->length
+                + (packageName == NULL ? 0 : packageName->length) + 5;
+            char* name = (char*)malloc(length);
+            if (name != NULL) {
+                /* Class names are identified by their class */
+                char* end = getClassName_inBuffer(clazz, name);
+                writeUTF8Record(clazz, name, end - name);
+                free(name);
+            }
+            if (!IS_ARRAY_CLASS(clazz)) {
+                /* Field names are identified by their unique UTF string */
+                FOR_EACH_FIELD(field, ((INSTANCE_CLASS)clazz)->fieldTable)
+                    int nameLength;
+                    char* fieldName = change_Key_to_Name(
+                        field->nameTypeKey.nt.nameKey, &nameLength);
+                    writeUTF8Record(fieldName, fieldName, nameLength);
+                END_FOR_EACH_FIELD
+            }
+        }
+    END_FOR_ALL_CLASSES
+}
+
+static void writeLoadClassRecords(void)
+{
+    unsigned long serial = 0;
+    FOR_ALL_CLASSES(clazz)
+        if (isDumpedClass(clazz)) {
+            writeRecordHeader(HPROF_LOAD_CLASS, 8 + 2 * HPROF_ID_SIZE);
+            writeU4(++serial);
+            writeID(clazz);
+            writeU4(HPROF_TRACE_SERIAL);
+            writeID(clazz);         /* The class name */
+        }
+    END_FOR_ALL_CLASSES
+
+    writeRecordHeader(HPROF_TRACE, 12);
+    writeU4(HPROF_TRACE_SERIAL);
+    writeU4(0);                 /* Thread serial number */
+    writeU4(0);                 /* Number of frames */
+}
+
+static void writeRoots(void)
+{
+    unsigned long threadSerial = 0;
+    THREAD thread;
+    int i;
+
+    /* Every class is a root, since KVM never unloads classes */
+    FOR_ALL_CLASSES(clazz)
+        if (isDumpedClass(clazz)) {
+            writeU1(HPROF_GC_ROOT_STICKY_CLASS);
+            writeID(clazz);
+        }
+    END_FOR_ALL_CLASSES
+
+    for (i = 0; i < GlobalRootsLength; i++) {
+        cell* object = *GlobalRoots[i].cellpp;
+        if (isHeapObject(object)) {
+            writeU1(HPROF_GC_ROOT_UNKNOWN);
+            writeID(object);
+        }
+    }
+
+    for (thread = AllThreads; thread != NULL; thread = thread->nextAliveThread) {
+        STACK stack;
+        threadSerial++;
+        if (isHeapObject((cell*)thread->javaThread)) {
+            writeU1(HPROF_GC_ROOT_THREAD_OBJ);
+            writeID(thread->javaThread);
+            writeU4(threadSerial);
+            writeU4(HPROF_TRACE_SERIAL);
+        }
+        if (thread->spStore == NULL) {
+            /* The thread hasn't been started yet */
+            continue;
+        }
+        for (stack = thread->stack; stack != NULL; stack = stack->next) {
+            bool_t isLast = STACK_CONTAINS(stack, thread->spStore);
+            cell* end = isLast ? thread->spStore + 1
+                               : stack->cells + stack->size;
+            cell* slot;
+            for (slot = stack->cells; slot < end; slot++) {
+                if (isHeapObject((cell*)*slot)) {
+                    writeU1(HPROF_GC_ROOT_JAVA_FRAME);
+                    writeID((cell*)*slot);
+                    writeU4(threadSerial);
+                    writeU4(0xFFFFFFFF);    /* Frame number unknown */
+                }
+            }
+            if (isLast) {
+                break;
+            }
+        }
+    }
+}
+
+static void writeClassDump(CLASS clazz)
+{
+    INSTANCE_CLASS superClass;
+    unsigned long instanceSize;
+    int staticCount = 0;
+    int fieldCount = 0;
+
+    if (IS_ARRAY_CLASS(clazz)) {
+        superClass = JavaLangObject;
+        instanceSize = 0;
+    } else {
+        INSTANCE_CLASS iclazz = (INSTANCE_CLASS)clazz;
+        superClass = iclazz->superClass;
+        instanceSize =
+            (SIZEOF_INSTANCE(iclazz->instSize) + HEADERSIZE) * CELL;
+        FOR_EACH_FIELD(field, iclazz->fieldTable)
+            if (field->accessFlags & ACC_STATIC) {
+                staticCount++;
+            } else {
+                fieldCount++;
+            }
+        END_FOR_EACH_FIELD
+    }
+
+    writeU1(HPROF_GC_CLASS_DUMP);
+    writeID(clazz);
+    writeU4(HPROF_TRACE_SERIAL);
+    writeID(superClass);
+    writeID(NULL);              /* Class loader */
+    writeID(NULL);              /* Signers */
+    writeID(NULL);              /* Protection domain */
+    writeID(NULL);              /* Reserved */
+    writeID(NULL);              /* Reserved */
+    writeU4(instanceSize);
+    writeU2(0);                 /* Constant pool entries */
+
+    writeU2(staticCount);
+    if (staticCount > 0) {
+        FOR_EACH_FIELD(field, ((INSTANCE_CLASS)clazz)->fieldTable)
+            if (field->accessFlags & ACC_STATIC) {
+                int type = getFieldType(field);
+                writeID(change_Key_to_Name(field->nameTypeKey.nt.nameKey, NULL));
+                writeU1(type);
+                writeValue(type, (cell*)field->u.staticAddress);
+            }
+        END_FOR_EACH_FIELD
+    }
+
+    writeU2(fieldCount);
+    if (fieldCount > 0) {
+        FOR_EACH_FIELD(field, ((INSTANCE_CLASS)clazz)->fieldTable)
+            if (!(field->accessFlags & ACC_STATIC)) {
+                writeID(change_Key_to_Name(field->nameTypeKey.nt.nameKey, NULL));
+                writeU1(getFieldType(field));
+            }
+        END_FOR_EACH_FIELD
+    }
+}
+
+static void writeInstanceDump(INSTANCE instance)
+{
+    INSTANCE_CLASS clazz;
+
+    writeU1(HPROF_GC_INSTANCE_DUMP);
+    writeID(instance);
+    writeU4(HPROF_TRACE_SERIAL);
+    writeID(instance->ofClass);
+    writeU4(getInstanceDumpSize(instance->ofClass));
+
+    /* The fields of the class itself come first, then its superclasses */
+    for (clazz = instance->ofClass; clazz != NULL; clazz = clazz->superClass) {
+        FOR_EACH_FIELD(field, clazz->fieldTable)
+            if (!(field->accessFlags & ACC_STATIC)) {
+                writeValue(getFieldType(field),
+                           &instance->data[field->u.offset].cell);
+            }
+        END_FOR_EACH_FIELD
+    }
+}
+
+static void writeArrayDump(ARRAY array, GCT_ObjectType type)
+{
+    long length = array->length;
+    long i;
+
+    if (type == GCT_OBJECTARRAY) {
+        writeU1(HPROF_GC_OBJ_ARRAY_DUMP);
+        writeID(array);
+        writeU4(HPROF_TRACE_SERIAL);
+        writeU4(length);
+        writeID(array->ofClass);
+        for (i = 0; i < length; i++) {
+            writeID(array->data[i].cellp);
+        }
+    } else {
+        ARRAY_CLASS arrayClass = array->ofClass;
+        int elementType = (int)arrayClass->u.primType;
+        char* elements = (char*)((BYTEARRAY)array)->bdata;
+
+        writeU1(HPROF_GC_PRIM_ARRAY_DUMP);
+        writeID(array);
+        writeU4(HPROF_TRACE_SERIAL);
+        writeU4(length);
+        writeU1(elementType);
+        for (i = 0; i < length; i++) {
+            char* element = elements + i * arrayClass->itemSize;
+            switch (arrayClass->itemSize) {
+                case 1:
+                    writeU1(*element);
+                    break;
+                case 2:
+                    writeU2(*(unsigned short*)element);
+                    break;
+                case 4:
+                    writeU4(*(unsigned int*)element);
+                    break;
+                default:
+                    writeValue(elementType, (cell*)element);
+                    break;
+            }
+        }
+    }
+}
+
+static void
+writeObjectDump(cell* object, GCT_ObjectType type, long size, void* closure)
+{
+    switch (type) {
+        case GCT_INSTANCE:
+        case GCT_WEAKREFERENCE:
+            writeInstanceDump((INSTANCE)object);
+            break;
+        case GCT_ARRAY:
+        case GCT_OBJECTARRAY:
+            writeArrayDump((ARRAY)object, type);
+            break;
+        default:
+            /* VM-internal object */
+            break;
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      writeHeapDump
+ * TYPE:          public heap inspection operation
+ * OVERVIEW:      Write the contents of the heap to a file in the
+ *                binary HPROF format.  The caller decides whether to
+ *                garbage collect first.
+ * INTERFACE:
+ *   parameters:  fileName: the name of the file to write
+ *   returns:     TRUE if the dump was written successfully
+ *=======================================================================*/
+
+bool_t writeHeapDump(const char* fileName)
+{
+    static const char hprofHeader[] = "JAVA PROFILE 1.0.2";
+    long heapCells = CurrentHeapEnd - CurrentHeap;
+    long segmentStart, segmentEnd;
+    bool_t ok;
+
+    validObjects = (unsigned char*)calloc((heapCells + 7) >> 3, 1);
+    if (validObjects == NULL) {
+        return FALSE;
+    }
+    hprofFile = fopen(fileName, "wb");
+    if (hprofFile == NULL) {
+        free(validObjects);
+        return FALSE;
+    }
+
+    /* Make sure the stack pointer of the current thread is up to date */
+    if (CurrentThread != NULL) {
+        storeExecutionEnvironment(CurrentThread);
+    }
+    forEachHeapObject(markValidObject, NULL);
+
+    fwrite(hprofHeader, 1, sizeof(hprofHeader), hprofFile);
+    writeU4(HPROF_ID_SIZE);
+    writeU8(CurrentTime_md());
+
+    writeStrings();
+    writeLoadClassRecords();
+
+    /* A single heap dump segment, whose length is filled in at the end */
+    writeRecordHeader(HPROF_HEAP_DUMP_SEGMENT, 0);
+    segmentStart = ftell(hprofFile);
+
+    writeRoots();
+    FOR_ALL_CLASSES(clazz)
+        if (isDumpedClass(clazz)) {
+            writeClassDump(clazz);
+        }
+    END_FOR_ALL_CLASSES
+    forEachHeapObject(writeObjectDump, NULL);
+
+    segmentEnd = ftell(hprofFile);
+    fseek(hprofFile, segmentStart - 4, SEEK_SET);
+    writeU4(segmentEnd - segmentStart);
+    fseek(hprofFile, segmentEnd, SEEK_SET);
+
+    writeRecordHeader(HPROF_HEAP_DUMP_END, 0);
+
+    ok = !ferror(hprofFile);
+    ok = (fclose(hprofFile) == 0) && ok;
+    hprofFile = NULL;
+    free(validObjects);
+    validObjects = NULL;
+    return ok;
+}
+
+static void writeHeapDumpToDefaultFile(void)
+{
+    const char* fileName =
+        (HeapDumpFile != NULL) ? HeapDumpFile : DEFAULT_HEAP_DUMP_FILE;
+
+    if (writeHeapDump(fileName)) {
+        fprintf(stderr, KVM_MSG_HEAP_DUMP_WRITTEN_1STRPARAM, fileName);
+    } else {
+        fprintf(stderr, KVM_MSG_CANT_WRITE_HEAP_DUMP_1STRPARAM, fileName);
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      dumpHeapOnRequest
+ * TYPE:          public heap inspection operation
+ * OVERVIEW:      Handle a pending dump request: collect the garbage,
+ *                print the histogram to stderr, and write a heap dump
+ *                to the file given with -heapdumpfile.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void dumpHeapOnRequest(void)
+{
+    HeapDumpRequested = FALSE;
+
+    garbageCollect(0);
+    printHeapHistogram(stderr);
+    writeHeapDumpToDefaultFile();
+}
+
+/*=========================================================================
+ * FUNCTION:      dumpHeapOnOutOfMemory
+ * TYPE:          public heap inspection operation
+ * OVERVIEW:      Called by the allocator when an allocation fails even
+ *                after a garbage collection.  The heap is dumped only
+ *                the first time, since later failures usually have the
+ *                same cause.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void dumpHeapOnOutOfMemory(void)
+{
+    HeapDumpOnOutOfMemory = FALSE;
+    writeHeapDumpToDefaultFile();
+}
+
+#endif /* ENABLE_HEAP_DUMP */
+
+/*=========================================================================
+ * Native functions of class com.sun.cldc.util.HeapInspector
+ *=======================================================================*/
+
+void Java_com_sun_cldc_util_HeapInspector_printHistogram(void);
+void Java_com_sun_cldc_util_HeapInspector_dumpHeap(void);
+
+/*=========================================================================
+ * FUNCTION:      printHistogram()V (STATIC)
+ * CLASS:         com.sun.cldc.util.HeapInspector
+ * TYPE:          static native function
+ * OVERVIEW:      Collect the garbage, and print a class histogram of
+ *                the heap to the standard output.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void Java_com_sun_cldc_util_HeapInspector_printHistogram(void)
+{
+#if ENABLE_HEAP_DUMP
+    garbageCollect(0);
+    printHeapHistogram(stdout);
+#else
+    raiseExceptionWithMessage(RuntimeException,
+        KVM_MSG_HEAP_INSPECTION_NOT_SUPPORTED);
+#endif
+}
+
+/*=========================================================================
+ * FUNCTION:      dumpHeap(Ljava/lang/String;)V (STATIC)
+ * CLASS:         com.sun.cldc.util.HeapInspector
+ * TYPE:          static native function
+ * OVERVIEW:      Collect the garbage, and write a heap dump in HPROF
+ *                format to the given file.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  the name of the file
+ *   returns:     <nothing>
+ * NOTE:          Throws IOException if the file can't be written.
+ *=======================================================================*/
+
+void Java_com_sun_cldc_util_HeapInspector_dumpHeap(void)
+{
+#if ENABLE_HEAP_DUMP
+    STRING_INSTANCE string = popStackAsType(STRING_INSTANCE);
+    char fileName[256];
+
+    if (string == NULL) {
+        raiseException(NullPointerException);
+    }
+    getStringContentsSafely(string, fileName, sizeof(fileName));
+
+    garbageCollect(0);
+    if (!writeHeapDump(fileName)) {
+        raiseExceptionWithMessage(IOException, fileName);
+    }
+#else
+    oneLess;
+    raiseExceptionWithMessage(RuntimeException,
+        KVM_MSG_HEAP_INSPECTION_NOT_SUPPORTED);
+#endif
+}
+
@@ -0,0 +1,352 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Bytecode interpreter
+ * FILE:      interpLoop.c
+ * OVERVIEW:  This file defines the primary interpreter loop.  It is
+ *            not compiled on its own, but included by execute.c once
+ *            for each variant of the loop that the VM needs.  The
+ *            following macros must be defined before inclusion:
+ *
+ *            INTERPRETERLOOP  - the name of the function to define
+ *            DEBUGINTERPRETER - 1 to include the debugger checks
+ *                               that run before every bytecode
+ *            TOKEN            - the current bytecode
+ *            RESCHEDULE       - the thread rescheduling check
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      FastInterpret(), DebugInterpret()
+ * OVERVIEW:      This is the primary interpreter loop.  All the most 
+ *                commonly needed bytecodes are defined here.  To 
+ *                improve performance, we instruct the C compiler 
+ *                to put the VM registers into hardware registers.
+ *                The primary interpreter loop can be replaced by
+ *                an alternative assembly interpreter loop in some
+ *                KVM versions.
+ *
+ *                FastInterpret() has no debugger code in the path
+ *                of each bytecode.  DebugInterpret() is only used
+ *                while the debugger single-steps a thread or a
+ *                thread is stopped at a breakpoint.  Each loop
+ *                returns at a reschedule point when the other one
+ *                is needed; see Interpret() in execute.c.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *
+ * NOTES:         Remember to initialize all virtual machine registers
+ *                and the call stack before entering the interpreter.
+ *=======================================================================*/
+
+void INTERPRETERLOOP() {
+
+   /*
+    * Define as locals those machine registers that are appropriate.
+    * Typically you get a lot of bang for the buck simply by making
+    * ip and sp local, but if you can make all the VM registers
+    * (ip, sp, lp, fp and cp) local, that's even better.
+    *
+    * Note: whenever you exit the primary interpreter loop,
+    * you MUST call the VMSAVE-VMRESTORE operations to make
+    * sure that the rest of the VM can use the correct values
+    * of the VM registers!!
+    */
+
+#if IPISLOCAL
+#undef ip
+    register BYTE* ip; /* Instruction pointer (program counter) */
+#endif
+
+#if SPISLOCAL
+#undef sp
+    register cell* sp; /* Execution stack pointer */
+#endif
+
+#if LPISLOCAL
+#undef lp
+    register cell* lp; /* Local variable pointer */
+#endif
+
+#if FPISLOCAL
+#undef fp
+    register FRAME fp; /* Current frame pointer */
+#endif
+
+#if CPISLOCAL
+#undef cp
+    register CONSTANTPOOL  cp; /* Constant pool pointer */
+#endif
+
+#if DEBUGINTERPRETER
+    register BYTE token;
+#endif
+
+   /*
+    * Define other local variables needed by the interpreter
+    */
+    METHOD   thisMethod;
+    OBJECT   thisObject;
+    int      invokerSize;
+    const char *exception;
+
+#if NEED_LONG_ALIGNMENT || NEED_DOUBLE_ALIGNMENT
+    Java8 tdub;
+#endif
+
+    VMRESTORE  /** Restore virtual machine registers to local variables **/
+
+    goto reschedulePoint;
+
+/*************************************************************************
+ *              Top of the actual primary interpreter loop               *
+ *************************************************************************/
+
+   /*
+    * If RESCHEDULEATBRANCH is not defined then we always test for thread
+    * scheduling before every bytecode. This is like in KVM 1.0.
+    */
+
+#if !RESCHEDULEATBRANCH
+next3:  ip++;
+next2:  ip++;
+next1:  ip++;
+next0:
+reschedulePoint:
+    RESCHEDULE
+#endif
+
+   /*
+    * If RESCHEDULEATBRANCH is defined then we only test for thread
+    * scheduling when reschedulePoint is called.
+    */
+
+#if RESCHEDULEATBRANCH
+reschedulePoint:
+    RESCHEDULE
+#if DEBUGINTERPRETER
+    goto next0a;
+#else
+    goto next0;
+#endif
+
+next3:  ip++;
+next2:  ip++;
+next1:  ip++;
+next0:
+#if DEBUGINTERPRETER
+    token = *ip;
+    /*
+     * Be careful, there is a goto in this following macro that jumps back
+     * up to a label in the RESCHEDULE macro;  ugly, I know
+     */
+    __doSingleStep()
+next0a:
+#endif
+#endif /* RESCHEDULEATBRANCH */
+
+   /*
+    * Profile the instruction
+    */
+    INSTRUCTIONPROFILE
+
+   /*
+    * Trace the instruction here if the option is enabled
+    */
+    INSTRUCTIONTRACE
+
+   /*
+    * Increment the bytecode counter
+    */
+    INC_BYTECODES
+
+   /*
+    *  Extreme debug option to call the garbage collector before every bytecode
+    */
+    DO_VERY_EXCESSIVE_GARBAGE_COLLECTION
+
+   /*
+    * Dispatch the bytecode
+    */
+#if DEBUGINTERPRETER
+    switch (token) {
+#else
+    switch (((unsigned char)*ip)) {
+#endif
+
+/*=======================================================================*/
+/* Include bytecode definitions that we need for main interpreter loop   */
+/*=======================================================================*/
+/* Note: There is some serious macro-hackery here.  The actual           */
+/* Java bytecode definitions are in file 'bytecodes.c'.  The macro       */
+/* definitions below determine which bytecodes from 'bytecodes.c         */
+/* get included into the primary interpreter loop.                       */
+/*=======================================================================*/
+
+#define STANDARDBYTECODES 1
+#define FASTBYTECODES     ENABLEFASTBYTECODES
+
+#if SPLITINFREQUENTBYTECODES
+#define INFREQUENTSTANDARDBYTECODES 0
+#define FLOATBYTECODES    0
+#else
+#define INFREQUENTSTANDARDBYTECODES 1
+#define FLOATBYTECODES    IMPLEMENTS_FLOAT
+#endif
+
+#include "bytecodes.c"
+
+#undef STANDARDBYTECODES
+#undef FLOATBYTECODES
+#undef FASTBYTECODES
+#undef INFREQUENTSTANDARDBYTECODES
+
+/*=======================================================================*/
+
+   /*
+    * If COMMONBRANCHING is defined then include the code to load ip
+    * See the BRANCHIF macro
+    */
+#if COMMONBRANCHING
+        branchPoint: {
+            INC_BRANCHES
+            ip += getShort(ip + 1);
+            goto reschedulePoint;
+        }
+#endif
+
+        callMethod_interface:
+            invokerSize = 5;       /* Size of the bytecode */
+            goto callMethod_general;
+
+        callMethod_virtual:
+        callMethod_static:
+        callMethod_special:
+            invokerSize = 3;       /* Size of the bytecode */
+
+        callMethod_general: {
+
+            INC_CALLS
+
+            /* Check if the method is a native method */
+            if (thisMethod->accessFlags & ACC_NATIVE) {
+                ip += invokerSize;
+                VMSAVE
+                invokeNativeFunction(thisMethod);
+                VMRESTORE
+                TRACE_METHOD_EXIT(thisMethod);
+                goto reschedulePoint;
+            }
+
+            /* Check if this is an abstract method */
+            if (thisMethod->accessFlags & ACC_ABSTRACT) {
+                VMSAVE
+                raiseExceptionWithMessage(AbstractMethodError, methodName(thisMethod));
+                VMRESTORE
+            }
+
+            thisObjectGCSafe = thisObject;
+            VMSAVE
+            pushFrame(thisMethod);
+            VMRESTORE
+
+            /* Advance to the next instruction on return */
+            fp->previousIp += invokerSize;
+
+            /* Check if this is a synchronized method */
+            if (thisMethod->accessFlags & ACC_SYNCHRONIZED) {
+                VMSAVE
+                monitorEnter(thisObjectGCSafe);
+                VMRESTORE
+                fp->syncObject = thisObjectGCSafe;
+            }
+
+            thisObjectGCSafe = NULL;
+            goto reschedulePoint;
+        }
+
+#if SPLITINFREQUENTBYTECODES
+        callSlowInterpret: {
+            int __token = TOKEN;
+            VMSAVE
+            SlowInterpret(__token);
+            VMRESTORE
+            goto reschedulePoint;        /* test for rescheduling */
+        }
+#endif
+
+        handleNullPointerException: {
+            exception = NullPointerException;
+            goto handleException;
+        }
+
+        handleArrayIndexOutOfBoundsException: {
+            exception = ArrayIndexOutOfBoundsException;
+            goto handleException;
+        }
+
+        handleArithmeticException: {
+            exception = ArithmeticException;
+            goto handleException;
+        }
+
+        handleArrayStoreException: {
+            exception = ArrayStoreException;
+            goto handleException;
+        }
+
+        handleClassCastException: {
+            exception = ClassCastException;
+            goto handleException;
+        }
+
+        handleException: {
+            VMSAVE
+            raiseException(exception);
+            VMRESTORE
+            goto reschedulePoint;
+        }
+
+#if PADTABLE
+        notImplemented:
+#endif
+
+        default: {
+            sprintf(str_buffer, KVM_MSG_ILLEGAL_BYTECODE_1LONGPARAM,
+                    (long)TOKEN);
+            fatalError(str_buffer);
+            break;
+        }
+    }
+    fatalError(KVM_MSG_INTERPRETER_STOPPED);
+}
+
+
+/*=========================================================================
+ * Restore the global definitions of the registers made local above
+ *=======================================================================*/
+
+#if IPISLOCAL
+#define ip ip_global
+#endif
+
+#if SPISLOCAL
+#define sp sp_global
+#endif
+
+#if LPISLOCAL
+#define lp lp_global
+#endif
+
+#if FPISLOCAL
+#define fp fp_global
+#endif
+
+#if CPISLOCAL
+#define cp cp_global
+#endif
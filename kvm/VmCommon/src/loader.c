@@ -64,6 +64,22 @@
 /* the virtual machine. */
 bool_t loadedReflectively;
 
+#if ENABLE_LAZY_METHOD_LOADING
+
+/* TRUE if method code is to be loaded on demand (-lazymethods) */
+bool_t LazyMethodLoading;
+
+/* Set while the methods of a class are loaded without their code */
+static bool_t loadingCodeLazily;
+static long lazyClassfileLength;
+static unsigned long lazyClassfileChecksum;
+
+#else
+
+#define loadingCodeLazily FALSE
+
+#endif /* ENABLE_LAZY_METHOD_LOADING */
+
 /*=========================================================================
  * Static functions (used only in this file)
  *=======================================================================*/
@@ -77,6 +93,14 @@ static void moveClassFieldsToStatic(INSTANCE_CLASS CurrentClass);
 static void ignoreAttributes(FILEPOINTER_HANDLE ClassFile,
                              POINTERLIST_HANDLE StringPool);
 
+#if ENABLE_LAZY_METHOD_LOADING
+static void startLazyCodeLoading(FILEPOINTER_HANDLE ClassFile);
+static void recordLazyCode(FILEPOINTER_HANDLE ClassFile,
+                           METHOD_HANDLE thisMethod);
+#else
+# define recordLazyCode(ClassFile, thisMethod)
+#endif
+
 /*=========================================================================
  * Class file verification operations (performed during class loading)
  *=======================================================================*/
@@ -548,7 +572,9 @@ verifyConstantPoolEntry(INSTANCE_CLASS CurrentClass,
         raiseExceptionWithMessage(ClassFormatError, KVM_MSG_BAD_CONSTANT_INDEX);
     }
 
-    tag2 = CONSTANTPOOL_TAGS(ConstantPool)[index];
+    /* Class entries may have been resolved already if the method */
+    /* code is loaded lazily */
+    tag2 = CONSTANTPOOL_TAGS(ConstantPool)[index] & CP_CACHEMASK;
     if (tag2 != tag) {
         raiseExceptionWithMessage(ClassFormatError, KVM_MSG_BAD_CONSTANT_TAG);
     }
@@ -1541,21 +1567,32 @@ loadCodeAttribute(FILEPOINTER_HANDLE ClassFileH,
             KVM_MSG_TOO_MANY_LOCALS_AND_STACK);
     }
 
-    /* Allocate memory for storing the bytecode array */
-    if (USESTATIC && !ENABLEFASTBYTECODES) {
-        code = (BYTE *)mallocBytes(codeLength);
+    if (loadingCodeLazily) {
+        /* Only remember where the code is (see loadMethodCode()) */
+        unsigned short numberOfHandlers;
+        thisMethod->u.java.codeLength = codeLength;
+        recordLazyCode(ClassFileH, thisMethodH);
+        skipBytes(ClassFileH, codeLength);
+        numberOfHandlers = loadShort(ClassFileH);
+        skipBytes(ClassFileH, numberOfHandlers * 8);
+        actualAttrLength = 2 + 2 + 4 + codeLength + 2 + numberOfHandlers * 8;
     } else {
-        code = (BYTE *)callocPermanentObject(ByteSizeToCellSize(codeLength));
-    }
-    thisMethod = unhand(thisMethodH);
-    thisMethod->u.java.code = code;
+        /* Allocate memory for storing the bytecode array */
+        if (USESTATIC && !ENABLEFASTBYTECODES) {
+            code = (BYTE *)mallocBytes(codeLength);
+        } else {
+            code = (BYTE *)callocPermanentObject(ByteSizeToCellSize(codeLength));
+        }
+        thisMethod = unhand(thisMethodH);
+        thisMethod->u.java.code = code;
 
-    thisMethod->u.java.codeLength = codeLength;
-    loadBytes(ClassFileH, (char *)thisMethod->u.java.code, codeLength);
-    actualAttrLength = 2 + 2 + 4 + codeLength;
+        thisMethod->u.java.codeLength = codeLength;
+        loadBytes(ClassFileH, (char *)thisMethod->u.java.code, codeLength);
+        actualAttrLength = 2 + 2 + 4 + codeLength;
 
-    /* Load exception handlers associated with the method */
-    actualAttrLength += loadExceptionHandlers(ClassFileH, thisMethodH);
+        /* Load exception handlers associated with the method */
+        actualAttrLength += loadExceptionHandlers(ClassFileH, thisMethodH);
+    }
 
     nCodeAttrs = loadShort(ClassFileH);
     actualAttrLength += 2;
@@ -1571,10 +1608,14 @@ loadCodeAttribute(FILEPOINTER_HANDLE ClassFileH,
                     KVM_MSG_DUPLICATE_STACKMAP_ATTRIBUTE);
             }
             needStackMap = FALSE;
-            stackMapAttrSize = loadStackMaps(ClassFileH, thisMethodH);
-            if (stackMapAttrSize != codeAttrLength) {
-                raiseExceptionWithMessage(ClassFormatError,
-                    KVM_MSG_BAD_ATTRIBUTE_SIZE);
+            if (loadingCodeLazily) {
+                skipBytes(ClassFileH, codeAttrLength);
+            } else {
+                stackMapAttrSize = loadStackMaps(ClassFileH, thisMethodH);
+                if (stackMapAttrSize != codeAttrLength) {
+                    raiseExceptionWithMessage(ClassFormatError,
+                        KVM_MSG_BAD_ATTRIBUTE_SIZE);
+                }
             }
         } else {
             skipBytes(ClassFileH, codeAttrLength);
@@ -1755,10 +1796,14 @@ loadOneMethod(FILEPOINTER_HANDLE ClassFileH, INSTANCE_CLASS CurrentClass,
         }
 
         if (accessFlags & ACC_NATIVE) {
-            /* Store native function pointer in the code field */
+            /* Store native function pointer in the code field. */
+            /* Binding the first native method builds the native */
+            /* method registry, so garbage collection may happen */
+            NativeFunctionPtr native =
+                getNativeFunction(CurrentClass, thisMethod->nameTypeKey);
+            thisMethod = unhand(thisMethodH);
             thisMethod->u.native.info = NULL;
-            thisMethod->u.native.code =
-                getNativeFunction(CurrentClass, methodName, signature);
+            thisMethod->u.native.code = native;
 
            /* Check for finalizers, skipping java.lang.Object */
            if (CurrentClass->superClass != NULL) {
@@ -1839,6 +1884,329 @@ loadMethods(FILEPOINTER_HANDLE ClassFileH, INSTANCE_CLASS CurrentClass,
 
 }
 
+/*=========================================================================
+ * Lazy method loading operations
+ *=======================================================================*/
+
+#if ENABLE_LAZY_METHOD_LOADING
+
+/*=========================================================================
+ * FUNCTION:      checksumClassfile()
+ * TYPE:          private lazy method loading operation
+ * OVERVIEW:      Compute a 32-bit FNV-1a checksum of the contents of a
+ *                class file.  The checksum is only used for noticing
+ *                class files that have been replaced while the VM is
+ *                running; it is no protection against tampering.
+ * INTERFACE:
+ *   parameters:  class file contents and length
+ *   returns:     the checksum
+ *=======================================================================*/
+
+static unsigned long
+checksumClassfile(const unsigned char* contents, long length)
+{
+    unsigned long checksum = 2166136261UL;
+    long i;
+    for (i = 0; i < length; i++) {
+        checksum = ((checksum ^ contents[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return checksum;
+}
+
+/*=========================================================================
+ * FUNCTION:      findClassfileUTF8()
+ * TYPE:          private lazy method loading operation
+ * OVERVIEW:      Find the index of a CONSTANT_Utf8 entry in the raw
+ *                constant pool of a class file.  The class file must
+ *                already have been loaded successfully once.
+ * INTERFACE:
+ *   parameters:  class file contents and length, string to look for
+ *   returns:     the constant pool index, or 0 if there is none
+ *=======================================================================*/
+
+static unsigned short
+findClassfileUTF8(const unsigned char* contents, long length,
+                  const char* string)
+{
+    unsigned short stringLength = (unsigned short)strlen(string);
+    unsigned short constantCount;
+    unsigned short cpIndex;
+    long pos;
+
+    if (length < 10) {
+        return 0;
+    }
+    constantCount = (contents[8] << 8) | contents[9];
+    pos = 10;
+
+    for (cpIndex = 1; cpIndex < constantCount && pos < length; cpIndex++) {
+        switch (contents[pos]) {
+            case CONSTANT_Utf8: {
+                unsigned short utfLength =
+                    (contents[pos + 1] << 8) | contents[pos + 2];
+                if (utfLength == stringLength &&
+                    pos + 3 + utfLength <= length &&
+                    memcmp(contents + pos + 3, string, utfLength) == 0) {
+                    return cpIndex;
+                }
+                pos += 3 + utfLength;
+                break;
+            }
+
+            case CONSTANT_String:
+            case CONSTANT_Class:
+                pos += 3;
+                break;
+
+            case CONSTANT_Integer:
+            case CONSTANT_Float:
+            case CONSTANT_Fieldref:
+            case CONSTANT_Methodref:
+            case CONSTANT_InterfaceMethodref:
+            case CONSTANT_NameAndType:
+                pos += 5;
+                break;
+
+            case CONSTANT_Long:
+            case CONSTANT_Double:
+                pos += 9;
+                cpIndex++;
+                break;
+
+            default:
+                return 0;
+        }
+    }
+    return 0;
+}
+
+/*=========================================================================
+ * FUNCTION:      startLazyCodeLoading()
+ * TYPE:          private lazy method loading operation
+ * OVERVIEW:      Decide whether the code of the methods of the class
+ *                being loaded is read now or on demand.  Code is only
+ *                loaded lazily if the whole class file is in memory
+ *                (i.e., it comes from a JAR file), because the class
+ *                file is checksummed so that loadMethodCode() can
+ *                tell whether it still reads the same file.
+ * INTERFACE:
+ *   parameters:  classfile pointer
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+static void
+startLazyCodeLoading(FILEPOINTER_HANDLE ClassFileH)
+{
+    unsigned char* contents;
+
+    loadingCodeLazily = FALSE;
+    if (!LazyMethodLoading || ClassSnapshotDump) {
+        return;
+    }
+#if ENABLE_JAVA_DEBUGGER
+    /* The debugger expects to find the code of every method */
+    if (debuggerActive) {
+        return;
+    }
+#endif
+
+    contents = getClassfileContents(ClassFileH, &lazyClassfileLength);
+    if (contents != NULL) {
+        lazyClassfileChecksum =
+            checksumClassfile(contents, lazyClassfileLength);
+        loadingCodeLazily = TRUE;
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      recordLazyCode()
+ * TYPE:          private lazy method loading operation
+ * OVERVIEW:      Remember where the code of a method is in its class
+ *                file.  The class file must be positioned at the first
+ *                bytecode of the method.
+ * INTERFACE:
+ *   parameters:  classfile pointer, method pointer
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+static void
+recordLazyCode(FILEPOINTER_HANDLE ClassFileH, METHOD_HANDLE thisMethodH)
+{
+    METHOD thisMethod = unhand(thisMethodH);
+    thisMethod->accessFlags |= ACC_LAZY_CODE;
+    thisMethod->u.lazy.codeOffset =
+        lazyClassfileLength - getBytesAvailable(ClassFileH);
+    thisMethod->u.lazy.classfileChecksum = lazyClassfileChecksum;
+}
+
+/*=========================================================================
+ * FUNCTION:      loadLazyCode()
+ * TYPE:          private lazy method loading operation
+ * OVERVIEW:      Load the bytecodes, exception handlers and stack maps
+ *                of a method whose code was skipped when its class was
+ *                loaded.  The class file must be positioned at the first
+ *                bytecode of the method.
+ * INTERFACE:
+ *   parameters:  classfile pointer, method pointer, constant pool index
+ *                of the "StackMap" attribute name
+ *   returns:     <nothing>
+ *   throws:      ClassFormatError if any part of the code is invalid
+ *=======================================================================*/
+
+static void
+loadLazyCode(FILEPOINTER_HANDLE ClassFileH, METHOD thisMethod,
+             unsigned short stackMapNameIndex)
+{
+    /* The code is read into a copy of the method, so that the method
+     * is left untouched if an error is found.  The verifier stack maps
+     * are not reachable from the copy, which is why there must not be
+     * any allocation between reading them and copying the code back.
+     */
+    struct methodStruct lazyMethod = *thisMethod;
+    METHOD lazyMethodPtr = &lazyMethod;
+    int codeLength = thisMethod->u.java.codeLength;
+    bool_t needStackMap = TRUE;
+    int nCodeAttrs;
+    int codeAttrIndex;
+
+    lazyMethod.u.java.code =
+        (BYTE *)callocPermanentObject(ByteSizeToCellSize(codeLength));
+    lazyMethod.u.java.handlers = NIL;
+    lazyMethod.u.java.stackMaps.verifierMap = NIL;
+    loadBytes(ClassFileH, (char *)lazyMethod.u.java.code, codeLength);
+    loadExceptionHandlers(ClassFileH, &lazyMethodPtr);
+
+    nCodeAttrs = loadShort(ClassFileH);
+    for (codeAttrIndex = 0; codeAttrIndex < nCodeAttrs; codeAttrIndex++) {
+        unsigned short codeAttrNameIndex = loadShort(ClassFileH);
+        unsigned int   codeAttrLength    = loadCell(ClassFileH);
+        if (codeAttrNameIndex == stackMapNameIndex && needStackMap) {
+            needStackMap = FALSE;
+            if (loadStackMaps(ClassFileH, &lazyMethodPtr) != codeAttrLength) {
+                raiseExceptionWithMessage(ClassFormatError,
+                    KVM_MSG_BAD_ATTRIBUTE_SIZE);
+            }
+        } else {
+            skipBytes(ClassFileH, codeAttrLength);
+        }
+    }
+
+    ASSERTING_NO_ALLOCATION
+        thisMethod->u.java.code      = lazyMethod.u.java.code;
+        thisMethod->u.java.handlers  = lazyMethod.u.java.handlers;
+        thisMethod->u.java.stackMaps = lazyMethod.u.java.stackMaps;
+        thisMethod->accessFlags     &= ~ACC_LAZY_CODE;
+    END_ASSERTING_NO_ALLOCATION
+
+    /* If the class has been verified already (most likely because the
+     * result was cached), the stack maps are needed by the garbage
+     * collector only.
+     */
+    if (thisMethod->ofClass->status >= CLASS_VERIFIED &&
+        thisMethod->u.java.stackMaps.verifierMap != NULL) {
+        STACKMAP pointerMap = rewriteVerifierStackMapsAsPointerMaps(thisMethod);
+        thisMethod->u.java.stackMaps.pointerMap = pointerMap;
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      loadLazyMethods()
+ * TYPE:          private lazy method loading operation
+ * OVERVIEW:      Open the class file of a class again and load the code
+ *                of all of its methods that was skipped when the class
+ *                was loaded.  Reopening, inflating and checksumming the
+ *                class file costs as much as reading all of the code,
+ *                so it is done once per class rather than per method.
+ * INTERFACE:
+ *   parameters:  class pointer
+ *   returns:     <nothing>
+ *   throws:      ClassFormatError if the class file has changed or any
+ *                part of the code is invalid
+ *=======================================================================*/
+
+static void
+loadLazyMethods(INSTANCE_CLASS clazz)
+{
+    METHOD firstMethod = NULL;
+    FOR_EACH_METHOD(thisMethod, clazz->methodTable)
+        if (thisMethod->accessFlags & ACC_LAZY_CODE) {
+            firstMethod = thisMethod;
+            break;
+        }
+    END_FOR_EACH_METHOD
+    if (firstMethod == NULL) {
+        return;
+    }
+
+    START_TEMPORARY_ROOTS
+        DECLARE_TEMPORARY_ROOT(FILEPOINTER, ClassFile, openClassfile(clazz));
+        unsigned short stackMapNameIndex;
+        long length = 0;
+        unsigned char* contents = (ClassFile == NULL) ? NULL
+            : getClassfileContents(&ClassFile, &length);
+
+#if INCLUDEDEBUGCODE
+        if (traceclassloadingverbose) {
+            getClassName_inBuffer((CLASS)clazz, str_buffer);
+            fprintf(stdout, "Loading code of %s\n", str_buffer);
+        }
+#endif /* INCLUDEDEBUGCODE */
+
+        if (contents == NULL ||
+            checksumClassfile(contents, length) !=
+                firstMethod->u.lazy.classfileChecksum) {
+            raiseExceptionWithMessage(ClassFormatError,
+                KVM_MSG_CLASSFILE_CHANGED);
+        }
+        stackMapNameIndex = findClassfileUTF8(contents, length, "StackMap");
+
+        /* The methods are in class file order, so the file is only */
+        /* read forward */
+        FOR_EACH_METHOD(thisMethod, clazz->methodTable)
+            if (thisMethod->accessFlags & ACC_LAZY_CODE) {
+                unsigned long offset = thisMethod->u.lazy.codeOffset;
+                unsigned long position = length - getBytesAvailable(&ClassFile);
+                if (offset < position) {
+                    raiseExceptionWithMessage(ClassFormatError,
+                        KVM_MSG_CLASSFILE_CHANGED);
+                }
+                skipBytes(&ClassFile, offset - position);
+                loadLazyCode(&ClassFile, thisMethod, stackMapNameIndex);
+            }
+        END_FOR_EACH_METHOD
+        closeClassfile(&ClassFile);
+    END_TEMPORARY_ROOTS
+}
+
+/*=========================================================================
+ * FUNCTION:      loadMethodCode()
+ *                loadClassMethodCode()
+ * TYPE:          public lazy method loading operation
+ * OVERVIEW:      Load the code of all the methods of a class (the class
+ *                of the given method) that was skipped when the class
+ *                was loaded with -lazymethods.  Called before a method
+ *                is first invoked and before its class is verified.
+ * INTERFACE:
+ *   parameters:  method pointer / class pointer
+ *   returns:     <nothing>
+ *   throws:      ClassFormatError if the class file has changed or any
+ *                part of the code is invalid
+ *=======================================================================*/
+
+void loadMethodCode(METHOD thisMethod)
+{
+    if (thisMethod->accessFlags & ACC_LAZY_CODE) {
+        loadLazyMethods(thisMethod->ofClass);
+    }
+}
+
+void loadClassMethodCode(INSTANCE_CLASS clazz)
+{
+    loadLazyMethods(clazz);
+}
+
+#endif /* ENABLE_LAZY_METHOD_LOADING */
+
 /*=========================================================================
  * FUNCTION:      ignoreAttributes()
  * TYPE:          private class file load operation
@@ -1959,6 +2327,9 @@ static void loadRawClass(INSTANCE_CLASS CurrentClass, bool_t fatalErrorIfFail)
             /* cause a different exception to be thrown */
             loadedReflectively = FALSE;
 
+            /* Let the verification cache know what this class is */
+            registerClassfileDigest(CurrentClass, &ClassFile);
+
             /* Load version info and magic value */
             loadVersionInfo(&ClassFile);
 
@@ -1976,7 +2347,13 @@ static void loadRawClass(INSTANCE_CLASS CurrentClass, bool_t fatalErrorIfFail)
             loadFields(&ClassFile, CurrentClass, &StringPool);
 
             /* Load method information */
+#if ENABLE_LAZY_METHOD_LOADING
+            startLazyCodeLoading(&ClassFile);
             loadMethods(&ClassFile, CurrentClass, &StringPool);
+            loadingCodeLazily = FALSE;
+#else
+            loadMethods(&ClassFile, CurrentClass, &StringPool);
+#endif
 
             /* Load the possible extra attributes (e.g., debug info) */
             ignoreAttributes(&ClassFile, &StringPool);
@@ -2082,6 +2459,7 @@ loadClassfile(INSTANCE_CLASS InitiatingClass, bool_t fatalErrorIfFail)
                 return;
             }
             clazz->status = CLASS_LOADED;
+            incrementMetric(classesLoaded);
 
             /*
              * Now go up to the superclass.
@@ -0,0 +1,373 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Runtime metrics
+ * FILE:      metrics.c
+ * OVERVIEW:  A small registry of always-on counters that describe
+ *            the behavior of a running virtual machine, the native
+ *            functions of com.sun.cldc.util.Metrics, and a JSON dump
+ *            of all the metrics.
+ *=======================================================================*/
+
+/*=========================================================================
+ * Include files
+ *=======================================================================*/
+
+#include <global.h>
+
+/*=========================================================================
+ * Metric names, in the order of the identifiers in metrics.h
+ *=======================================================================*/
+
+static const char* const MetricNames[METRIC_COUNT] = {
+    "uptimeMs",
+    "gcCount",
+    "gcPauseTotalMs",
+    "gcPauseMaxMs",
+    "gcPauseLastMs",
+    "bytesAllocated",
+    "objectsAllocated",
+    "heapSize",
+    "heapFree",
+    "classesLoaded",
+    "threadSwitches",
+    "icacheHits",
+    "icacheMisses",
+    "icacheHitPercent",
+    "runQueueLength",
+    "eventQueueDepth",
+    "stackHighWater",
+    "stackChunksAllocated",
+    "stackChunksReused",
+    "verifierCacheHits",
+    "verifierCacheMisses"
+};
+
+#if ENABLE_METRICS
+
+/*=========================================================================
+ * Metric counters
+ *=======================================================================*/
+
+struct metricsStruct Metrics;
+
+volatile int MetricsDumpRequested;
+
+char* MetricsDumpFile;
+
+/*=========================================================================
+ * Metrics operations
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      InitializeMetrics
+ * TYPE:          public global operation
+ * OVERVIEW:      Reset all the metric counters, and remember the time
+ *                at which the VM was started.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void InitializeMetrics()
+{
+    memset(&Metrics, 0, sizeof(Metrics));
+    Metrics.startTime = CurrentTime_md();
+    MetricsDumpRequested = FALSE;
+}
+
+/*=========================================================================
+ * FUNCTION:      recordGCPause
+ * TYPE:          public global operation
+ * OVERVIEW:      Called at the end of each garbage collection to count
+ *                the collection and its pause time.
+ * INTERFACE:
+ *   parameters:  startTime: the value of CurrentTime_md() at the start
+ *                of the collection
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void recordGCPause(ulong64 startTime)
+{
+    long pause = (long)(CurrentTime_md() - startTime);
+
+    Metrics.gcCount++;
+    Metrics.gcPauseTotal += pause;
+    Metrics.gcPauseLast = pause;
+    if (pause > Metrics.gcPauseMax) {
+        Metrics.gcPauseMax = pause;
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      getMetric
+ * TYPE:          public global operation
+ * OVERVIEW:      Return the current value of a metric.
+ * INTERFACE:
+ *   parameters:  metric: one of the METRIC_* identifiers
+ *   returns:     the value of the metric
+ *=======================================================================*/
+
+long64 getMetric(int metric)
+{
+    switch (metric) {
+        case METRIC_UPTIME:
+            return (long64)(CurrentTime_md() - Metrics.startTime);
+        case METRIC_GC_COUNT:
+            return Metrics.gcCount;
+        case METRIC_GC_PAUSE_TOTAL:
+            return (long64)Metrics.gcPauseTotal;
+        case METRIC_GC_PAUSE_MAX:
+            return Metrics.gcPauseMax;
+        case METRIC_GC_PAUSE_LAST:
+            return Metrics.gcPauseLast;
+        case METRIC_BYTES_ALLOCATED:
+            return (long64)Metrics.bytesAllocated;
+        case METRIC_OBJECTS_ALLOCATED:
+            return Metrics.objectsAllocated;
+        case METRIC_HEAP_SIZE:
+            return getHeapSize();
+        case METRIC_HEAP_FREE:
+            return memoryFree();
+        case METRIC_CLASSES_LOADED:
+            return Metrics.classesLoaded;
+        case METRIC_THREAD_SWITCHES:
+            return Metrics.threadSwitches;
+        case METRIC_ICACHE_HITS:
+            return Metrics.icacheHits;
+        case METRIC_ICACHE_MISSES:
+            return Metrics.icacheMisses;
+        case METRIC_ICACHE_HIT_PERCENT: {
+            long64 total = (long64)Metrics.icacheHits + Metrics.icacheMisses;
+            return (total == 0) ? 0 : (Metrics.icacheHits * (long64)100) / total;
+        }
+        case METRIC_RUN_QUEUE_LENGTH:
+            return RunnableThreadCount;
+        case METRIC_EVENT_QUEUE_DEPTH:
+            return eventCount;
+        case METRIC_STACK_HIGH_WATER:
+            return Metrics.stackHighWater * CELL;
+        case METRIC_STACK_CHUNKS_ALLOCATED:
+            return Metrics.stackChunksAllocated;
+        case METRIC_STACK_CHUNKS_REUSED:
+            return Metrics.stackChunksReused;
+#if CACHE_VERIFICATION_RESULT
+        case METRIC_VERIFIER_CACHE_HITS:
+            return VerifierCacheHitCounter;
+        case METRIC_VERIFIER_CACHE_MISSES:
+            return VerifierCacheMissCounter;
+#endif
+        default:
+            return 0;
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      getStackHighWater
+ * TYPE:          public global operation
+ * OVERVIEW:      Return the deepest use of the execution stack of a
+ *                thread so far.
+ * INTERFACE:
+ *   parameters:  thread: a VM-level thread
+ *   returns:     the stack high-water mark of the thread in bytes
+ *=======================================================================*/
+
+long getStackHighWater(THREAD thread)
+{
+    return thread->stackHighWater * CELL;
+}
+
+/*=========================================================================
+ * FUNCTION:      getMetricName
+ * TYPE:          public global operation
+ * OVERVIEW:      Return the name of a metric, as used in the JSON dump.
+ * INTERFACE:
+ *   parameters:  metric: one of the METRIC_* identifiers
+ *   returns:     the name of the metric
+ *=======================================================================*/
+
+const char* getMetricName(int metric)
+{
+    return MetricNames[metric];
+}
+
+/* Not all C libraries can print 64-bit integers, so we do it ourselves */
+static char* long64ToString(long64 value, char* buffer, int length)
+{
+    char* p = buffer + length - 1;
+    bool_t negative = value < 0;
+    ulong64 magnitude = negative ? -(ulong64)value : (ulong64)value;
+
+    *p = '\0';
+    do {
+        *--p = (char)('0' + (int)(magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (negative) {
+        *--p = '-';
+    }
+    return p;
+}
+
+/*=========================================================================
+ * FUNCTION:      printMetrics
+ * TYPE:          public global operation
+ * OVERVIEW:      Print all the metrics as a single line JSON object.
+ * INTERFACE:
+ *   parameters:  file: the stream to print to
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void printMetrics(FILE* file)
+{
+    char buffer[24];
+    int metric;
+
+    fprintf(file, "{");
+    for (metric = 0; metric < METRIC_COUNT; metric++) {
+        fprintf(file, "%s\"%s\":%s", (metric == 0) ? "" : ",",
+                MetricNames[metric],
+                long64ToString(getMetric(metric), buffer, sizeof(buffer)));
+    }
+    fprintf(file, "}\n");
+    fflush(file);
+}
+
+/*=========================================================================
+ * FUNCTION:      dumpMetrics
+ * TYPE:          public global operation
+ * OVERVIEW:      Handle a pending dump request by appending the metrics
+ *                to the file given with -metricsfile, or by printing
+ *                them to stderr.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void dumpMetrics()
+{
+    MetricsDumpRequested = FALSE;
+
+    if (MetricsDumpFile != NULL) {
+        FILE* file = fopen(MetricsDumpFile, "a");
+        if (file != NULL) {
+            printMetrics(file);
+            fclose(file);
+            return;
+        }
+    }
+    printMetrics(stderr);
+}
+
+#endif /* ENABLE_METRICS */
+
+/*=========================================================================
+ * Native functions of class com.sun.cldc.util.Metrics
+ *=======================================================================*/
+
+void Java_com_sun_cldc_util_Metrics_count(void);
+void Java_com_sun_cldc_util_Metrics_get(void);
+void Java_com_sun_cldc_util_Metrics_getName(void);
+void Java_com_sun_cldc_util_Metrics_getStackHighWater(void);
+
+/*=========================================================================
+ * FUNCTION:      count()I (STATIC)
+ * CLASS:         com.sun.cldc.util.Metrics
+ * TYPE:          static native function
+ * OVERVIEW:      Return the number of metrics supported by the VM.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  <none>
+ *   returns:     the number of metrics, or 0 if metrics are not kept
+ *=======================================================================*/
+
+void Java_com_sun_cldc_util_Metrics_count(void)
+{
+    pushStack(ENABLE_METRICS ? METRIC_COUNT : 0);
+}
+
+/*=========================================================================
+ * FUNCTION:      get(I)J (STATIC)
+ * CLASS:         com.sun.cldc.util.Metrics
+ * TYPE:          static native function
+ * OVERVIEW:      Return the current value of a metric.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  the metric identifier
+ *   returns:     the value of the metric as long
+ * NOTE:          Throws IllegalArgumentException if the metric is not
+ *                supported.
+ *=======================================================================*/
+
+void Java_com_sun_cldc_util_Metrics_get(void)
+{
+    int metric = popStack();
+    long64 value;
+
+    if (!ENABLE_METRICS || metric < 0 || metric >= METRIC_COUNT) {
+        raiseException(IllegalArgumentException);
+    }
+#if ENABLE_METRICS
+    value = getMetric(metric);
+#else
+    value = 0;
+#endif
+    pushLong(value);
+}
+
+/*=========================================================================
+ * FUNCTION:      getName(I)Ljava/lang/String; (STATIC)
+ * CLASS:         com.sun.cldc.util.Metrics
+ * TYPE:          static native function
+ * OVERVIEW:      Return the name of a metric.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  the metric identifier
+ *   returns:     the name of the metric
+ * NOTE:          Throws IllegalArgumentException if the metric is not
+ *                supported.
+ *=======================================================================*/
+
+void Java_com_sun_cldc_util_Metrics_getName(void)
+{
+    int metric = topStack;
+
+    if (!ENABLE_METRICS || metric < 0 || metric >= METRIC_COUNT) {
+        raiseException(IllegalArgumentException);
+    }
+    topStackAsType(STRING_INSTANCE) =
+        instantiateString(MetricNames[metric], strlen(MetricNames[metric]));
+}
+
+/*=========================================================================
+ * FUNCTION:      getStackHighWater(Ljava/lang/Thread;)I (STATIC)
+ * CLASS:         com.sun.cldc.util.Metrics
+ * TYPE:          static native function
+ * OVERVIEW:      Return the deepest use of the execution stack of a
+ *                thread so far.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  a thread
+ *   returns:     the stack high-water mark of the thread in bytes, or 0
+ *                if the thread has not been started or metrics are
+ *                not kept
+ * NOTE:          Throws NullPointerException if the thread is null.
+ *=======================================================================*/
+
+void Java_com_sun_cldc_util_Metrics_getStackHighWater(void)
+{
+    JAVATHREAD javaThread = topStackAsType(JAVATHREAD);
+
+    if (javaThread == NULL) {
+        raiseException(NullPointerException);
+    }
+#if ENABLE_METRICS
+    topStack = (javaThread->VMthread == NULL)
+        ? 0 : getStackHighWater(javaThread->VMthread);
+#else
+    topStack = 0;
+#endif
+}
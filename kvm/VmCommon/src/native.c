@@ -41,75 +41,314 @@ METHOD CurrentNativeMethod;
  * Operations on native functions
  *=======================================================================*/
 
-int xstrcmp(const char *s1, const char *s2) {
-    if (s1 == NULL) {
-        s1 = "";
+/*=========================================================================
+ * Native method registry
+ *=======================================================================*/
+
+/* An entry of the native method registry.  The class is identified */
+/* by its interned package and base names, so that entries can be */
+/* created before the class itself is loaded. */
+typedef struct nativeRegistryEntryStruct* NATIVE_REGISTRY_ENTRY;
+
+struct nativeRegistryEntryStruct {
+    NATIVE_REGISTRY_ENTRY next;
+    UString packageName;        /* NULL for the unnamed package */
+    UString baseName;
+    NameTypeKey key;
+    bool_t anySignature;        /* The method isn't overloaded, so */
+                                /* the type key is not compared */
+    NativeFunctionPtr implementation;
+};
+
+/* Methods given to registerNatives().  The list is kept in the order */
+/* of registration, and survives restarts of the VM. */
+typedef struct registeredNativesStruct* REGISTERED_NATIVES;
+
+struct registeredNativesStruct {
+    REGISTERED_NATIVES next;
+    const char* className;
+    const NativeImplementationType* methods;
+};
+
+static NATIVE_REGISTRY_ENTRY* NativeRegistry;
+static REGISTERED_NATIVES     RegisteredNatives;
+static REGISTERED_NATIVES*    RegisteredNativesTail = &RegisteredNatives;
+
+/* The names are interned, so their addresses identify them */
+#define NATIVE_REGISTRY_BUCKET(packageName, baseName, nameKey)     \
+    ((((unsigned long)(packageName) >> 2) * 31 +                   \
+      ((unsigned long)(baseName) >> 2) + (nameKey))                \
+     % NATIVE_REGISTRY_SIZE)
+
+/*=========================================================================
+ * FUNCTION:      addNativesToRegistry()
+ * TYPE:          private operation
+ * OVERVIEW:      Enter the native methods of a class into the registry.
+ *                Since new entries are put in front of the old ones,
+ *                the most recently added implementation of a method
+ *                is the one that is found.
+ * INTERFACE:
+ *   parameters:  interned package name (NULL for the unnamed package)
+ *                and base name of the class, NULL-terminated list of
+ *                native methods
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+static void
+addNativesToRegistry(UString packageName, UString baseName,
+                     const NativeImplementationType* methods)
+{
+    const NativeImplementationType *mptr;
+
+    for (mptr = methods; mptr->name != NULL; mptr++) {
+        const char *signature = mptr->signature;
+        NATIVE_REGISTRY_ENTRY entry;
+        int bucket;
+
+        entry = (NATIVE_REGISTRY_ENTRY)
+            malloc(sizeof(struct nativeRegistryEntryStruct));
+        if (entry == NULL) {
+            fatalError(KVM_MSG_NOT_ENOUGH_MEMORY);
+        }
+        entry->packageName = packageName;
+        entry->baseName = baseName;
+        entry->key.nt.nameKey = getUString(mptr->name)->key;
+        if (signature == NULL) {
+            entry->key.nt.typeKey = 0;
+            entry->anySignature = TRUE;
+        } else {
+            entry->key.nt.typeKey =
+                change_MethodSignature_to_Key(&signature, 0,
+                                              strlen(signature));
+            entry->anySignature = FALSE;
+        }
+        entry->implementation = mptr->implementation;
+
+        bucket = NATIVE_REGISTRY_BUCKET(packageName, baseName,
+                                        entry->key.nt.nameKey);
+        entry->next = NativeRegistry[bucket];
+        NativeRegistry[bucket] = entry;
     }
-    if (s2 == NULL) {
-       s2 = "";
+}
+
+/*=========================================================================
+ * FUNCTION:      addRegisteredNatives()
+ * TYPE:          private operation
+ * OVERVIEW:      Enter the native methods given to registerNatives()
+ *                into the registry.
+ * INTERFACE:
+ *   parameters:  registration
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+static void
+addRegisteredNatives(REGISTERED_NATIVES natives)
+{
+    const char *className = natives->className;
+    const char *lastSlash = strrchr(className, '/');
+    UString packageName = NULL;
+    UString baseName;
+
+    if (lastSlash == NULL) {
+        baseName = getUString(className);
+    } else {
+        packageName = getUStringX(&className, 0, lastSlash - className);
+        baseName = getUString(lastSlash + 1);
     }
-    return strcmp(s1, s2);
+    addNativesToRegistry(packageName, baseName, natives->methods);
 }
 
 /*=========================================================================
- * FUNCTION:      getNativeFunction()
- * TYPE:          lookup operation
- * OVERVIEW:      Given a function name as a string, try to find
- *                a corresponding native function and return a
- *                a pointer to it if found.
+ * FUNCTION:      buildNativeRegistry()
+ * TYPE:          private operation
+ * OVERVIEW:      Create the native method registry from the native
+ *                function table generated by JCC and the natives that
+ *                have been registered at runtime.  This is done the
+ *                first time a native method is bound, since the names
+ *                and keys can only be interned once the hash tables
+ *                of the VM have been initialized.
  * INTERFACE:
- *   parameters:  class name, method name
- *   returns:     function pointer or NIL if not found.
+ *   parameters:  <none>
+ *   returns:     <nothing>
  *=======================================================================*/
 
-NativeFunctionPtr
-getNativeFunction(INSTANCE_CLASS clazz, const char* methodName, 
-                                        const char *methodSignature)
+static void
+buildNativeRegistry(void)
 {
+    REGISTERED_NATIVES natives;
 #if !ROMIZING
     const ClassNativeImplementationType *cptr;
-    const NativeImplementationType *mptr;
-    UString UBaseName    = clazz->clazz.baseName;
-    UString UPackageName = clazz->clazz.packageName;
-    char* baseName;
-    char* packageName;
-
-    /* Package names can be NULL -> must do an explicit check */
-    /* to ensure that string comparison below will not fail */
-    if (UPackageName == NULL) {
-        packageName = "";
-    } else {
-        packageName = UStringInfo(UPackageName);
+#endif
+
+    NativeRegistry = (NATIVE_REGISTRY_ENTRY*)
+        calloc(NATIVE_REGISTRY_SIZE, sizeof(NATIVE_REGISTRY_ENTRY));
+    if (NativeRegistry == NULL) {
+        fatalError(KVM_MSG_NOT_ENOUGH_MEMORY);
     }
 
-    if (UBaseName == NULL) {
-        baseName = "";
-    } else {
-        baseName = UStringInfo(UBaseName);
+#if !ROMIZING
+    /* In a romized VM, the natives of the system classes */
+    /* were bound by JCC when the ROM image was created */
+    for (cptr = nativeImplementations; cptr->baseName != NULL; cptr++) {
+        const char *packageName = cptr->packageName;
+        addNativesToRegistry(
+            (packageName == NULL || packageName[0] == '\0')
+                ? NULL : getUString(packageName),
+            getUString(cptr->baseName), cptr->implementation);
     }
+#endif /* !ROMIZING */
 
-    for (cptr = nativeImplementations; cptr->baseName != NULL ; cptr++) {                 
-        if (   (xstrcmp(cptr->packageName, packageName) == 0) 
-            && (xstrcmp(cptr->baseName, baseName) == 0)) { 
-            break;
-        }
+    for (natives = RegisteredNatives; natives != NULL;
+                                      natives = natives->next) {
+        addRegisteredNatives(natives);
     }
+}
 
-    for (mptr = cptr->implementation; mptr != NULL ; mptr++) {
-        const char *name = mptr->name;
-        if (name == NULL) {
-            return NULL;
-        }
-        if (strcmp(name, methodName) == 0) {
-            const char *signature = mptr->signature;
-            /* The signature is NULL for non-overloaded native methods. */
-            if (signature == NULL || (xstrcmp(signature, methodSignature) == 0)){
-                return mptr->implementation;
-            }
+/*=========================================================================
+ * FUNCTION:      FinalizeNativeRegistry()
+ * TYPE:          public global operation
+ * OVERVIEW:      Free the native method registry.  It must be freed
+ *                before the hash tables of the VM, since its keys are
+ *                only valid until then.  The registrations themselves
+ *                are kept, so the registry is rebuilt the next time
+ *                the VM is started.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void FinalizeNativeRegistry()
+{
+    int i;
+
+    if (NativeRegistry == NULL) {
+        return;
+    }
+    for (i = 0; i < NATIVE_REGISTRY_SIZE; i++) {
+        NATIVE_REGISTRY_ENTRY entry = NativeRegistry[i];
+        while (entry != NULL) {
+            NATIVE_REGISTRY_ENTRY next = entry->next;
+            free(entry);
+            entry = next;
         }
     }
-#endif /* !ROMIZING */
+    free(NativeRegistry);
+    NativeRegistry = NULL;
+}
+
+/*=========================================================================
+ * FUNCTION:      registerNatives()
+ * TYPE:          public global operation
+ * OVERVIEW:      Register the implementations of the native methods
+ *                of a class.  This can be done before the VM is
+ *                started, typically by the KVM_OnLoad() function of a
+ *                native library, or while it is running.  Methods that
+ *                were loaded before their implementation was registered
+ *                are bound the first time they are called.  The natives
+ *                of romized classes were bound when the ROM image was
+ *                created, and are not affected.
+ * INTERFACE:
+ *   parameters:  className: fully qualified class name, with slashes
+ *                           separating the package name components
+ *                methods:   list of native methods, terminated by
+ *                           NATIVE_END_OF_LIST.  The signature of a
+ *                           method can be NULL if it isn't overloaded.
+ *                           The list must stay valid while the VM runs.
+ *   returns:     TRUE if successful, FALSE if out of memory
+ *=======================================================================*/
+
+bool_t
+registerNatives(const char* className,
+                const NativeImplementationType* methods)
+{
+    REGISTERED_NATIVES natives = (REGISTERED_NATIVES)
+        malloc(sizeof(struct registeredNativesStruct));
+    if (natives == NULL) {
+        fprintf(stderr, KVM_MSG_CANT_REGISTER_NATIVES_1STRPARAM, className);
+        return FALSE;
+    }
+    natives->next = NULL;
+    natives->className = className;
+    natives->methods = methods;
+    *RegisteredNativesTail = natives;
+    RegisteredNativesTail = &natives->next;
+
+    if (NativeRegistry != NULL) {
+        addRegisteredNatives(natives);
+    }
+    return TRUE;
+}
+
+#if ENABLE_DYNAMIC_NATIVES
+
+/*=========================================================================
+ * FUNCTION:      loadNativeLibrary()
+ * TYPE:          public global operation
+ * OVERVIEW:      Load a native library and call its KVM_OnLoad()
+ *                function, which registers the native methods that the
+ *                library implements.
+ * INTERFACE:
+ *   parameters:  path of the library
+ *   returns:     TRUE if successful, FALSE otherwise
+ *=======================================================================*/
 
+bool_t
+loadNativeLibrary(const char* path)
+{
+    void *library = loadNativeLibrary_md(path);
+    int (*onLoad)(void);
+
+    if (library == NULL) {
+        fprintf(stderr, KVM_MSG_CANT_LOAD_NATIVE_LIBRARY_1STRPARAM, path);
+        return FALSE;
+    }
+    onLoad = (int (*)(void))findNativeLibrarySymbol_md(library, "KVM_OnLoad");
+    if (onLoad == NULL) {
+        fprintf(stderr, KVM_MSG_NATIVE_LIBRARY_HAS_NO_ONLOAD_2STRPARAMS,
+                path, "KVM_OnLoad");
+        return FALSE;
+    }
+    if (onLoad() != 0) {
+        fprintf(stderr, KVM_MSG_CANT_LOAD_NATIVE_LIBRARY_1STRPARAM, path);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+#endif /* ENABLE_DYNAMIC_NATIVES */
+
+/*=========================================================================
+ * FUNCTION:      getNativeFunction()
+ * TYPE:          lookup operation
+ * OVERVIEW:      Given a class and the name and type key of one of
+ *                its native methods, find the implementation of the
+ *                method in the native method registry.
+ * INTERFACE:
+ *   parameters:  class, name and type key of the method
+ *   returns:     function pointer or NIL if not found.
+ *=======================================================================*/
+
+NativeFunctionPtr
+getNativeFunction(INSTANCE_CLASS clazz, NameTypeKey key)
+{
+    UString packageName = clazz->clazz.packageName;
+    UString baseName = clazz->clazz.baseName;
+    NATIVE_REGISTRY_ENTRY entry;
+
+    if (NativeRegistry == NULL) {
+        buildNativeRegistry();
+    }
+
+    entry = NativeRegistry[NATIVE_REGISTRY_BUCKET(packageName, baseName,
+                                                  key.nt.nameKey)];
+    for ( ; entry != NULL; entry = entry->next) {
+        if (   entry->key.nt.nameKey == key.nt.nameKey
+            && entry->baseName == baseName
+            && entry->packageName == packageName
+            && (entry->anySignature || entry->key.nt.typeKey == key.nt.typeKey)) {
+            return entry->implementation;
+        }
+    }
     return NULL;
 }
 
@@ -133,6 +372,14 @@ void invokeNativeFunction(METHOD thisMethod)
 #endif
     NativeFunctionPtr native = thisMethod->u.native.code;
 
+    if (native == NULL) {
+        /* The implementation may have been registered after the */
+        /* class was loaded */
+        native = getNativeFunction(thisMethod->ofClass,
+                                   thisMethod->nameTypeKey);
+        thisMethod->u.native.code = native;
+    }
+
     if (native == NULL) {
         /* Native function not found; throw error */
 
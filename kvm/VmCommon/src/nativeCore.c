@@ -652,6 +652,8 @@ void Java_java_lang_Thread_setPriority0(void)
         /* The actual VM-level timeslice of the thread is calculated by
          * multiplying the given priority */
         VMthread->timeslice = javaThread->priority * TIMESLICEFACTOR;
+        /* Move the thread to the run queue of its new priority */
+        threadPriorityChanged(VMthread);
     END_TEMPORARY_ROOTS
 }
 
@@ -830,16 +832,22 @@ void Java_java_lang_System_arraycopy(void)
         CLASS dstElementClass = dstClass->u.elemClass;
         if (!isAssignableTo(srcElementClass, dstElementClass)) {
             /* We have to check each element to make sure it can be
-             * put into an array of dstElementClass */
+             * put into an array of dstElementClass.  The elements are
+             * usually all of the same class, so remember the last
+             * class that passed the check.
+             */
+            CLASS checkedClass = dstElementClass;
             long i;
             for (i = 0; i < length; i++) {
                 OBJECT item = (OBJECT)src->data[srcPos + i].cellp;
-                if ((item != NULL) && !isAssignableTo(item->ofClass, dstElementClass)) {
-                    raiseException(ArrayStoreException);
-                    break;
-                } else {
-                    dst->data[dstPos + i].cellp = (cell *)item;
+                if ((item != NULL) && (item->ofClass != checkedClass)) {
+                    if (!isAssignableTo(item->ofClass, dstElementClass)) {
+                        raiseException(ArrayStoreException);
+                        break;
+                    }
+                    checkedClass = item->ofClass;
                 }
+                dst->data[dstPos + i].cellp = (cell *)item;
             }
         } else {
             memmove(&dst->data[dstPos], &src->data[srcPos],
@@ -848,6 +856,78 @@ void Java_java_lang_System_arraycopy(void)
     }
 }
 
+/*=========================================================================
+ * FUNCTION:      clear(Ljava/lang/Object;II)V (STATIC)
+ * CLASS:         com.sun.cldc.util.Arrays
+ * TYPE:          static native function
+ * OVERVIEW:      Set the elements from..to-1 of an array to zero, or
+ *                to null in an array of objects, with a single range
+ *                check and a single memset.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  array, from, to
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void Java_com_sun_cldc_util_Arrays_clear(void)
+{
+    long  to    = popStack();
+    long  from  = popStack();
+    ARRAY array = popStackAsType(ARRAY);
+
+    if (array == NULL) {
+        raiseException(NullPointerException);
+    } else if (!IS_ARRAY_CLASS((CLASS)array->ofClass)) {
+        raiseException(IllegalArgumentException);
+    } else if (from < 0 || from > to || to > (long)array->length) {
+        raiseException(ArrayIndexOutOfBoundsException);
+    } else {
+        long itemSize = array->ofClass->itemSize;
+        memset(&((BYTEARRAY)array)->bdata[from * itemSize], 0,
+               (to - from) * itemSize);
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      regionEquals(Ljava/lang/Object;ILjava/lang/Object;II)Z
+ *                (STATIC)
+ * CLASS:         com.sun.cldc.util.Arrays
+ * TYPE:          static native function
+ * OVERVIEW:      Compare length elements of two arrays of the same
+ *                type, starting at aPos and bPos, with a single range
+ *                check and a single memcmp.  Elements of arrays of
+ *                objects are equal if they are the same object.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  a, aPos, b, bPos, length
+ *   returns:     true if the elements are equal
+ *=======================================================================*/
+
+void Java_com_sun_cldc_util_Arrays_regionEquals(void)
+{
+    long  length = popStack();
+    long  bPos   = popStack();
+    ARRAY b      = popStackAsType(ARRAY);
+    long  aPos   = popStack();
+    ARRAY a      = popStackAsType(ARRAY);
+    bool_t result = FALSE;
+
+    if (a == NULL || b == NULL) {
+        raiseException(NullPointerException);
+    } else if (a->ofClass != b->ofClass
+                 || !IS_ARRAY_CLASS((CLASS)a->ofClass)) {
+        raiseException(IllegalArgumentException);
+    } else if (length < 0 || aPos < 0 || bPos < 0
+                 || length > (long)a->length - aPos
+                 || length > (long)b->length - bPos) {
+        raiseException(ArrayIndexOutOfBoundsException);
+    } else {
+        long itemSize = a->ofClass->itemSize;
+        result = (memcmp(&((BYTEARRAY)a)->bdata[aPos * itemSize],
+                         &((BYTEARRAY)b)->bdata[bPos * itemSize],
+                         length * itemSize) == 0);
+    }
+    pushStack(result);
+}
+
 /*=========================================================================
  * FUNCTION:      currentTimeMillis()I (STATIC)
  * CLASS:         java.lang.System
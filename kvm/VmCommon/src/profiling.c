@@ -85,6 +85,11 @@ void InitializeProfiling()
     MaxStackCounter            = 0;
 #endif
 
+#if CACHE_EXCEPTION_HANDLERS
+    ExceptionHandlerCacheHitCounter  = 0;
+    ExceptionHandlerCacheMissCounter = 0;
+#endif
+
 #if USESTATIC
     StaticObjectCounter        = 0;
     StaticAllocationCounter    = 0;
@@ -118,6 +123,16 @@ void printProfileInfo()
             (long)GarbageCollectionCounter);
     fprintf(stdout, "(%ld bytes collected)\n",
             (long)DynamicDeallocationCounter);
+#if CACHE_EXCEPTION_HANDLERS
+    fprintf(stdout, "%ld exception handler cache hits, %ld misses\n",
+            ExceptionHandlerCacheHitCounter, ExceptionHandlerCacheMissCounter);
+#endif
+#if CACHE_VERIFICATION_RESULT
+    if (VerifierCacheFile != NULL) {
+        fprintf(stdout, "%ld verifier cache hits, %ld misses\n",
+                VerifierCacheHitCounter, VerifierCacheMissCounter);
+    }
+#endif
 
 /* This info is too detailed for most users:
     fprintf(stdout, "%ld objects deferred in GC\n", (long)TotalGCDeferrals);
@@ -0,0 +1,830 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Class snapshots
+ * FILE:      snapshot.c
+ * OVERVIEW:  A class snapshot is a copy of the permanent space of the
+ *            heap taken right after the main class has been loaded.
+ *            Before the copy is written, every loaded class is verified
+ *            so that the image contains classes that are ready to be
+ *            initialized, along with their constant pools, methods,
+ *            stack maps, UTF strings and interned strings.
+ *
+ *            The image is written as if it lived at a preferred
+ *            address.  Each pointer slot in the image is listed in a
+ *            relocation table, tagged as pointing either into the
+ *            image itself or into the VM binary (ROM classes, native
+ *            functions).  A snapshot can't be written if any pointer
+ *            points elsewhere, e.g. into a native library.  At startup the image is mapped copy-on-write
+ *            outside the Java heap, where the garbage collector treats
+ *            it like ROM.  Relocations are applied only when the image
+ *            or the binary did not end up where they were at dump time.
+ *
+ *            The snapshot is ignored (and the classes loaded from the
+ *            classpath as usual) if the VM binary or the classpath
+ *            changed since the snapshot was written, or if a pointer
+ *            that has to be relocated does not end up in the image
+ *            or the binary.
+ *=======================================================================*/
+
+/*=========================================================================
+ * Include files
+ *=======================================================================*/
+
+#include <global.h>
+
+#if ENABLE_CLASS_SNAPSHOT
+
+/*=========================================================================
+ * Definitions and declarations
+ *=======================================================================*/
+
+#define SNAPSHOT_MAGIC    0x4B564D53   /* "KVMS" */
+#define SNAPSHOT_VERSION  1
+
+/* Relocation kinds, stored in the low bit of each relocation entry.
+ * The rest of the entry is the byte offset of the slot in the image.
+ */
+#define SNAPSHOT_RELOC_IMAGE  0
+#define SNAPSHOT_RELOC_BINARY 1
+
+/* The hashtables whose contents are saved in the snapshot */
+#define SNAPSHOT_TABLE_COUNT 3
+
+typedef struct snapshotHeaderStruct {
+    unsigned long magic;
+    unsigned long version;
+    char          buildStamp[32];    /* Identifies the VM binary */
+    unsigned long classPathStamp;    /* See getClassPathStamp() */
+    char*         imageBase;         /* Address the image was written for */
+    long          imageSize;         /* In bytes */
+    long          imageOffset;       /* Offset of the image in the file */
+    char*         binaryAnchor;      /* Address of snapshotAnchor */
+    long          relocationCount;
+    long          rootCount;
+    long          bucketCount[SNAPSHOT_TABLE_COUNT];
+    long          tableCount[SNAPSHOT_TABLE_COUNT];
+} snapshotHeader;
+
+/* The hashtables are the only way into the image.  In non-romized
+ * builds the tables themselves are part of the image and a root is
+ * the address of a table.  In romized builds the tables are in ROM,
+ * the image entries sit at the front of each bucket chain, and there
+ * is one root per bucket.
+ */
+typedef struct snapshotRootStruct {
+    long  kind;
+    char* value;
+} snapshotRoot;
+
+/*=========================================================================
+ * Variables
+ *=======================================================================*/
+
+char*  ClassSnapshotFile;
+bool_t ClassSnapshotDump;
+bool_t ClassSnapshotRestored;
+
+/* Any address in the VM binary will do.  Its movement between the
+ * dump and the restore is the relocation delta of binary pointers.
+ */
+static const char snapshotAnchor[] = "KVM class snapshot";
+
+static HASHTABLE *const snapshotTables[SNAPSHOT_TABLE_COUNT] = {
+    &ClassTable, &UTFStringTable, &InternStringTable
+};
+
+/* Mapped image and the ROM bucket heads that it replaced */
+char*         ClassSnapshotStart;
+char*         ClassSnapshotEnd;
+#if ROMIZING
+static cell** savedBuckets;
+static long   savedCounts[SNAPSHOT_TABLE_COUNT];
+#endif
+
+/* State used while writing a snapshot */
+static char*          dumpStart;
+static char*          dumpEnd;
+static char*          dumpCopy;
+static unsigned long* dumpRelocations;
+static long           dumpRelocationCount;
+static long           dumpRelocationLimit;
+
+#define inDumpImage(ptr) \
+    (((char *)(ptr) >= dumpStart) && ((char *)(ptr) < dumpEnd))
+
+/* Bounds of the code and data of the VM binary */
+static char*          binaryStart;
+static char*          binaryEnd;
+
+#define inBinary(ptr) \
+    (((char *)(ptr) >= binaryStart) && ((char *)(ptr) < binaryEnd))
+
+/*=========================================================================
+ * Static functions (private to this file)
+ *=======================================================================*/
+
+static void cantWriteSnapshot(void);
+static void fillBuildStamp(char *buffer);
+static unsigned long getClassPathStamp(void);
+static void verifyLoadedClasses(void);
+static void addRelocation(long offset, int kind);
+static void relocateSlot(void *slot);
+static void checkNoMonitor(OBJECT object);
+static void relocateClass(CLASS clazz);
+static void relocateInstanceClass(INSTANCE_CLASS clazz);
+static long makeRoots(snapshotRoot *roots);
+static void writeSnapshot(snapshotHeader *header, snapshotRoot *roots);
+static bool_t relocateImage(snapshotHeader *header, snapshotRoot *roots,
+                            unsigned long *relocations);
+
+/*=========================================================================
+ * Helper functions
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      cantWriteSnapshot()
+ * TYPE:          private operation
+ * OVERVIEW:      Report a failure to write the snapshot file and stop.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     does not return
+ *=======================================================================*/
+
+static void
+cantWriteSnapshot(void)
+{
+    sprintf(str_buffer, KVM_MSG_CANT_WRITE_CLASS_SNAPSHOT_1STRPARAM,
+            ClassSnapshotFile);
+    fatalError(str_buffer);
+}
+
+/*=========================================================================
+ * FUNCTION:      fillBuildStamp(), getClassPathStamp()
+ * TYPE:          private operations
+ * OVERVIEW:      Compute the values that must match between the VM that
+ *                wrote a snapshot and the VM that uses it.
+ *
+ *                Each classpath entry is stamped with the size and
+ *                modification time reported by the platform.  Note that
+ *                for directories this is the time of the directory
+ *                itself, so class files modified in place inside a
+ *                directory are not detected.  Use JAR files for
+ *                applications that are snapshotted.
+ * INTERFACE:
+ *   parameters:  buffer: 32 bytes for the build stamp
+ *   returns:     classpath stamp
+ *=======================================================================*/
+
+static void
+fillBuildStamp(char *buffer)
+{
+    memset(buffer, 0, 32);
+    sprintf(buffer, "%.20s %d %d %d",
+            __DATE__ " " __TIME__, ROMIZING, (int)CELL,
+            (int)SIZEOF_INSTANCE_CLASS);
+}
+
+static unsigned long
+getClassPathStamp(void)
+{
+    const char *classpath = UserClassPath != NULL ? UserClassPath : "";
+    int length = strlen(classpath);
+    char *entry = malloc(length + 1);
+    unsigned long stamp = 0;
+    int i, start;
+
+    if (entry == NULL) {
+        return 0;
+    }
+    for (i = 0, start = 0; i <= length; i++) {
+        if (classpath[i] == PATH_SEPARATOR || classpath[i] == '\0') {
+            memcpy(entry, classpath + start, i - start);
+            entry[i - start] = '\0';
+            stamp = stamp * 31 + (unsigned long)getFileStamp_md(entry);
+            start = i + 1;
+        } else {
+            stamp = stamp * 37 + (unsigned char)classpath[i];
+        }
+    }
+    free(entry);
+    return stamp;
+}
+
+/*=========================================================================
+ * Snapshot writing
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      verifyLoadedClasses()
+ * TYPE:          private operation
+ * OVERVIEW:      Verify every linked class so that the snapshot holds
+ *                pointer maps in the permanent space rather than the
+ *                verifier stack maps kept in the dynamic heap.
+ *                Verification may load more classes, so we repeat
+ *                until there is nothing left to do.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>; throws VerifyError on failure
+ *=======================================================================*/
+
+static void
+verifyLoadedClasses(void)
+{
+    bool_t verified;
+    do {
+        verified = FALSE;
+        FOR_ALL_CLASSES(clazz)
+            if (!IS_ARRAY_CLASS(clazz)
+                  && ((INSTANCE_CLASS)clazz)->status == CLASS_LINKED) {
+                verifyClass((INSTANCE_CLASS)clazz);
+                verified = TRUE;
+            }
+        END_FOR_ALL_CLASSES
+    } while (verified);
+}
+
+/*=========================================================================
+ * FUNCTION:      addRelocation(), relocateSlot()
+ * TYPE:          private operations
+ * OVERVIEW:      Record a pointer slot of the permanent space in the
+ *                relocation table, and rewrite the copy of the slot so
+ *                that image pointers are relative to the preferred
+ *                address.  Slots outside the permanent space belong to
+ *                ROM structures and are left alone.
+ * INTERFACE:
+ *   parameters:  slot: address of the pointer in the live permanent space
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+static void
+addRelocation(long offset, int kind)
+{
+    if (dumpRelocationCount == dumpRelocationLimit) {
+        dumpRelocationLimit = dumpRelocationLimit * 2 + 1024;
+        dumpRelocations = realloc(dumpRelocations,
+                             dumpRelocationLimit * sizeof(unsigned long));
+        if (dumpRelocations == NULL) {
+            cantWriteSnapshot();
+        }
+    }
+    dumpRelocations[dumpRelocationCount++] = (unsigned long)offset | kind;
+}
+
+static void
+relocateSlot(void *slot)
+{
+    char *value = *(char **)slot;
+    long offset;
+
+    if (value == NULL || !inDumpImage(slot)) {
+        return;
+    }
+    offset = (char *)slot - dumpStart;
+    if (inDumpImage(value)) {
+        *(char **)(dumpCopy + offset) =
+            SNAPSHOT_PREFERRED_ADDRESS + (value - dumpStart);
+        addRelocation(offset, SNAPSHOT_RELOC_IMAGE);
+    } else if (inAnyHeap(value)) {
+        fatalError(KVM_MSG_CLASS_SNAPSHOT_HEAP_REFERENCE);
+    } else if (inBinary(value)) {
+        addRelocation(offset, SNAPSHOT_RELOC_BINARY);
+    } else {
+        fatalError(KVM_MSG_CLASS_SNAPSHOT_FOREIGN_REFERENCE);
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      checkNoMonitor(), relocateClass(),
+ *                relocateInstanceClass()
+ * TYPE:          private operations
+ * OVERVIEW:      Record all the pointer slots of a class and of the
+ *                structures hanging off it.
+ * INTERFACE:
+ *   parameters:  clazz: the class
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+static void
+checkNoMonitor(OBJECT object)
+{
+    /* Monitors live in the dynamic heap, and hash codes have not been
+     * handed out this early in the life of the VM.
+     */
+    if (inDumpImage(object) && object->mhc.hashCode != 0) {
+        fatalError(KVM_MSG_CLASS_SNAPSHOT_BAD_CLASS_STATE);
+    }
+}
+
+static void
+relocateClass(CLASS clazz)
+{
+    if (!inDumpImage(clazz)) {
+        /* ROM class */
+        return;
+    }
+    checkNoMonitor((OBJECT)clazz);
+    relocateSlot(&clazz->ofClass);
+    relocateSlot(&clazz->packageName);
+    relocateSlot(&clazz->baseName);
+    relocateSlot(&clazz->next);
+
+    if (IS_ARRAY_CLASS(clazz)) {
+        ARRAY_CLASS arrayClass = (ARRAY_CLASS)clazz;
+        if (arrayClass->gcType == GCT_OBJECTARRAY) {
+            relocateSlot(&arrayClass->u.elemClass);
+        }
+    } else {
+        relocateInstanceClass((INSTANCE_CLASS)clazz);
+    }
+}
+
+static void
+relocateInstanceClass(INSTANCE_CLASS clazz)
+{
+    CONSTANTPOOL constPool = clazz->constPool;
+    FIELDTABLE fieldTable = clazz->fieldTable;
+    METHODTABLE methodTable = clazz->methodTable;
+    POINTERLIST statics = clazz->staticFields;
+
+    if ((clazz->status != CLASS_RAW && clazz->status != CLASS_VERIFIED)
+          || clazz->initThread != NULL) {
+        fatalError(KVM_MSG_CLASS_SNAPSHOT_BAD_CLASS_STATE);
+    }
+
+    relocateSlot(&clazz->superClass);
+    relocateSlot(&clazz->constPool);
+    relocateSlot(&clazz->fieldTable);
+    relocateSlot(&clazz->methodTable);
+    relocateSlot(&clazz->ifaceTable);
+    relocateSlot(&clazz->staticFields);
+    relocateSlot(&clazz->finalizer);
+
+    if (constPool != NULL && inDumpImage(constPool)) {
+        int length = CONSTANTPOOL_LENGTH(constPool);
+        int i;
+        for (i = 1; i < length; i++) {
+            unsigned char tag = CONSTANTPOOL_TAG(constPool, i);
+            if ((tag & CP_CACHEBIT) || tag == CONSTANT_Class
+                                    || tag == CONSTANT_String) {
+                relocateSlot(&constPool->entries[i].cache);
+            }
+        }
+    }
+
+    FOR_EACH_FIELD(thisField, fieldTable)
+        relocateSlot(&thisField->ofClass);
+        if (thisField->accessFlags & ACC_STATIC) {
+            relocateSlot(&thisField->u.staticAddress);
+        }
+    END_FOR_EACH_FIELD
+
+    FOR_EACH_METHOD(thisMethod, methodTable)
+        relocateSlot(&thisMethod->ofClass);
+        if (thisMethod->accessFlags & ACC_NATIVE) {
+            relocateSlot(&thisMethod->u.native.code);
+            relocateSlot(&thisMethod->u.native.info);
+        } else {
+            relocateSlot(&thisMethod->u.java.code);
+            relocateSlot(&thisMethod->u.java.handlers);
+            relocateSlot(&thisMethod->u.java.stackMaps.pointerMap);
+        }
+    END_FOR_EACH_METHOD
+
+    /* Only String constants can have been stored in pointer statics */
+    if (statics != NULL) {
+        int i;
+        for (i = 0; i < statics->length; i++) {
+            relocateSlot(&statics->data[i].cellp);
+        }
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      makeRoots()
+ * TYPE:          private operation
+ * OVERVIEW:      Fill in the roots of the image (see snapshotRoot).
+ * INTERFACE:
+ *   parameters:  roots: array to fill in, or NULL to count the roots
+ *   returns:     the number of roots
+ *=======================================================================*/
+
+static long
+makeRoots(snapshotRoot *roots)
+{
+    long count = 0;
+    int i;
+
+    for (i = 0; i < SNAPSHOT_TABLE_COUNT; i++) {
+        HASHTABLE table = *snapshotTables[i];
+#if ROMIZING
+        int bucketCount = table->bucketCount;
+        int j;
+        for (j = 0; j < bucketCount; j++, count++) {
+            if (roots != NULL) {
+                roots[count].value = (char *)table->bucket[j];
+            }
+        }
+#else
+        if (roots != NULL) {
+            roots[count].value = (char *)table;
+        }
+        count++;
+#endif /* ROMIZING */
+    }
+
+    if (roots != NULL) {
+        long j;
+        for (j = 0; j < count; j++) {
+            char *value = roots[j].value;
+            if (inDumpImage(value)) {
+                roots[j].kind  = SNAPSHOT_RELOC_IMAGE;
+                roots[j].value = SNAPSHOT_PREFERRED_ADDRESS
+                               + (value - dumpStart);
+            } else if (value == NULL || inBinary(value)) {
+                roots[j].kind  = SNAPSHOT_RELOC_BINARY;
+            } else {
+                fatalError(KVM_MSG_CLASS_SNAPSHOT_FOREIGN_REFERENCE);
+            }
+        }
+    }
+    return count;
+}
+
+/*=========================================================================
+ * FUNCTION:      writeSnapshot()
+ * TYPE:          private operation
+ * OVERVIEW:      Write the header, roots, relocations and image to the
+ *                snapshot file.
+ * INTERFACE:
+ *   parameters:  header, roots: as computed by DumpClassSnapshot()
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+static void
+writeSnapshot(snapshotHeader *header, snapshotRoot *roots)
+{
+    FILE *file = fopen(ClassSnapshotFile, "wb");
+    bool_t ok = file != NULL;
+    long position;
+
+    if (ok) {
+        ok = fwrite(header, sizeof(*header), 1, file) == 1
+          && fwrite(roots, sizeof(*roots), header->rootCount, file)
+                 == (size_t)header->rootCount
+          && fwrite(dumpRelocations, sizeof(unsigned long),
+                    header->relocationCount, file)
+                 == (size_t)header->relocationCount;
+    }
+    if (ok) {
+        for (position = ftell(file);
+             position < header->imageOffset; position++) {
+            putc(0, file);
+        }
+        ok = fwrite(dumpCopy, 1, header->imageSize, file)
+                 == (size_t)header->imageSize;
+    }
+    if (file != NULL && fclose(file) != 0) {
+        ok = FALSE;
+    }
+    if (!ok) {
+        cantWriteSnapshot();
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      DumpClassSnapshot()
+ * TYPE:          public operation
+ * OVERVIEW:      Write a snapshot of the classes loaded so far to the
+ *                file given by ClassSnapshotFile.  Called by KVM_Start
+ *                once the main class has been loaded, before any
+ *                class has been initialized.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void DumpClassSnapshot(void)
+{
+    snapshotHeader header;
+    snapshotRoot *roots;
+    long headerSize;
+    int i;
+
+    verifyLoadedClasses();
+    getBinaryBounds_md(&binaryStart, &binaryEnd);
+
+    /* Nothing may be allocated from here on */
+    dumpStart = (char *)PermanentSpaceFreePtr;
+    dumpEnd   = (char *)AllHeapEnd;
+    dumpCopy  = malloc(dumpEnd - dumpStart);
+    if (dumpCopy == NULL) {
+        cantWriteSnapshot();
+    }
+    memcpy(dumpCopy, dumpStart, dumpEnd - dumpStart);
+
+    FOR_ALL_CLASSES(clazz)
+        relocateClass(clazz);
+    END_FOR_ALL_CLASSES
+
+    for (i = 0; i < UTFStringTable->bucketCount; i++) {
+        UString string = (UString)UTFStringTable->bucket[i];
+        for ( ; string != NULL; string = string->next) {
+            relocateSlot(&string->next);
+        }
+    }
+
+    for (i = 0; i < InternStringTable->bucketCount; i++) {
+        INTERNED_STRING_INSTANCE string =
+            (INTERNED_STRING_INSTANCE)InternStringTable->bucket[i];
+        for ( ; string != NULL; string = string->next) {
+            checkNoMonitor((OBJECT)string);
+            relocateSlot(&string->ofClass);
+            relocateSlot(&string->array);
+            relocateSlot(&string->next);
+            if (string->array != NULL) {
+                checkNoMonitor((OBJECT)string->array);
+                relocateSlot(&string->array->ofClass);
+            }
+        }
+    }
+
+    if (!ROMIZING) {
+        for (i = 0; i < SNAPSHOT_TABLE_COUNT; i++) {
+            HASHTABLE table = *snapshotTables[i];
+            int j;
+            for (j = 0; j < table->bucketCount; j++) {
+                relocateSlot(&table->bucket[j]);
+            }
+        }
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic           = SNAPSHOT_MAGIC;
+    header.version         = SNAPSHOT_VERSION;
+    fillBuildStamp(header.buildStamp);
+    header.classPathStamp  = getClassPathStamp();
+    header.imageBase       = SNAPSHOT_PREFERRED_ADDRESS;
+    header.imageSize       = dumpEnd - dumpStart;
+    header.binaryAnchor    = (char *)snapshotAnchor;
+    header.relocationCount = dumpRelocationCount;
+    header.rootCount       = makeRoots(NULL);
+    for (i = 0; i < SNAPSHOT_TABLE_COUNT; i++) {
+        header.bucketCount[i] = (*snapshotTables[i])->bucketCount;
+        header.tableCount[i]  = (*snapshotTables[i])->count;
+    }
+
+    headerSize = sizeof(header)
+               + header.rootCount * sizeof(snapshotRoot)
+               + header.relocationCount * sizeof(unsigned long);
+    header.imageOffset = (headerSize + SNAPSHOT_IMAGE_ALIGNMENT - 1)
+                       & ~(SNAPSHOT_IMAGE_ALIGNMENT - 1);
+
+    roots = malloc(header.rootCount * sizeof(snapshotRoot));
+    if (roots == NULL) {
+        cantWriteSnapshot();
+    }
+    makeRoots(roots);
+
+    writeSnapshot(&header, roots);
+
+    free(roots);
+    free(dumpRelocations);
+    free(dumpCopy);
+    dumpRelocations = NULL;
+    dumpRelocationCount = dumpRelocationLimit = 0;
+    dumpCopy = NULL;
+}
+
+/*=========================================================================
+ * Snapshot mapping
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      relocateImage()
+ * TYPE:          private operation
+ * OVERVIEW:      Apply the relocations of a freshly mapped image and
+ *                relocate its roots.  Every relocated pointer must end
+ *                up in the image or in the VM binary.  When neither has
+ *                moved, the pointers are the ones checked when the
+ *                snapshot was written for this very binary, and the
+ *                image is used as is.
+ * INTERFACE:
+ *   parameters:  header, roots and relocations read from the file
+ *   returns:     FALSE if the snapshot is invalid
+ *=======================================================================*/
+
+static bool_t
+relocateImage(snapshotHeader *header, snapshotRoot *roots,
+              unsigned long *relocations)
+{
+    long permDelta   = ClassSnapshotStart - header->imageBase;
+    long binaryDelta = (char *)snapshotAnchor - header->binaryAnchor;
+    long i;
+
+    getBinaryBounds_md(&binaryStart, &binaryEnd);
+
+    /* Usually both deltas are zero */
+    if (permDelta != 0 || binaryDelta != 0) {
+        for (i = 0; i < header->relocationCount; i++) {
+            unsigned long entry = relocations[i];
+            unsigned long offset = entry & ~SNAPSHOT_RELOC_BINARY;
+            char **slot;
+            if (offset > header->imageSize - sizeof(char *)) {
+                return FALSE;
+            }
+            slot = (char **)(ClassSnapshotStart + offset);
+            if (entry & SNAPSHOT_RELOC_BINARY) {
+                *slot += binaryDelta;
+                if (!inBinary(*slot)) {
+                    return FALSE;
+                }
+            } else {
+                *slot += permDelta;
+                if (!inClassSnapshot(*slot)) {
+                    return FALSE;
+                }
+            }
+        }
+    }
+    for (i = 0; i < header->rootCount; i++) {
+        if (roots[i].value == NULL) {
+            continue;
+        }
+        if (roots[i].kind == SNAPSHOT_RELOC_BINARY) {
+            roots[i].value += binaryDelta;
+            if (!inBinary(roots[i].value)) {
+                return FALSE;
+            }
+        } else {
+            roots[i].value += permDelta;
+            if (!inClassSnapshot(roots[i].value)) {
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+}
+
+/*=========================================================================
+ * FUNCTION:      InitializeClassSnapshot()
+ * TYPE:          public global operation
+ * OVERVIEW:      Map the snapshot given by ClassSnapshotFile, if any,
+ *                and install its classes in the class, UTF and string
+ *                hashtables.  Called right after the memory system has
+ *                been initialized and before the hashtables are used.
+ *                A snapshot that cannot be used is reported and
+ *                ignored.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void InitializeClassSnapshot(void)
+{
+    snapshotHeader header;
+    char buildStamp[32];
+    snapshotRoot *roots = NULL;
+    unsigned long *relocations = NULL;
+    FILE *file;
+    bool_t ok;
+    long i;
+
+    ClassSnapshotRestored = FALSE;
+    if (ClassSnapshotFile == NULL || ClassSnapshotDump) {
+        return;
+    }
+
+    file = fopen(ClassSnapshotFile, "rb");
+    ok = file != NULL && fread(&header, sizeof(header), 1, file) == 1;
+    if (ok) {
+        fillBuildStamp(buildStamp);
+        ok = header.magic == SNAPSHOT_MAGIC
+          && header.version == SNAPSHOT_VERSION
+          && memcmp(header.buildStamp, buildStamp, sizeof(buildStamp)) == 0
+          && header.classPathStamp == getClassPathStamp();
+        for (i = 0; ok && i < SNAPSHOT_TABLE_COUNT; i++) {
+            ok = ROMIZING ? header.bucketCount[i]
+                                == (*snapshotTables[i])->bucketCount
+                          : *snapshotTables[i] == NULL;
+        }
+    }
+    if (ok) {
+        roots = malloc(header.rootCount * sizeof(snapshotRoot));
+        relocations = malloc(header.relocationCount * sizeof(unsigned long));
+        ok = roots != NULL && relocations != NULL
+          && fread(roots, sizeof(snapshotRoot), header.rootCount, file)
+                 == (size_t)header.rootCount
+          && fread(relocations, sizeof(unsigned long),
+                   header.relocationCount, file)
+                 == (size_t)header.relocationCount;
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+    if (ok) {
+        ClassSnapshotStart = mapSnapshotImage_md(ClassSnapshotFile,
+                                 header.imageOffset, header.imageSize,
+                                 header.imageBase);
+        ok = ClassSnapshotStart != NULL && !inAnyHeap(ClassSnapshotStart);
+    }
+    if (!ok) {
+        if (ClassSnapshotStart != NULL) {
+            unmapSnapshotImage_md(ClassSnapshotStart, header.imageSize);
+            ClassSnapshotStart = NULL;
+        }
+        free(roots);
+        free(relocations);
+        fprintf(stderr, KVM_MSG_CLASS_SNAPSHOT_IGNORED_1STRPARAM,
+                ClassSnapshotFile);
+        return;
+    }
+
+    ClassSnapshotEnd = ClassSnapshotStart + header.imageSize;
+    if (!relocateImage(&header, roots, relocations)) {
+        unmapSnapshotImage_md(ClassSnapshotStart, header.imageSize);
+        ClassSnapshotStart = ClassSnapshotEnd = NULL;
+        free(roots);
+        free(relocations);
+        fprintf(stderr, KVM_MSG_CLASS_SNAPSHOT_IGNORED_1STRPARAM,
+                ClassSnapshotFile);
+        return;
+    }
+
+#if ROMIZING
+    {
+        long total = 0;
+        int j;
+        for (i = 0; i < SNAPSHOT_TABLE_COUNT; i++) {
+            total += header.bucketCount[i];
+        }
+        savedBuckets = malloc(total * sizeof(cell *));
+        if (savedBuckets == NULL) {
+            fatalError(KVM_MSG_CLASS_SNAPSHOT_BAD_CLASS_STATE);
+        }
+        for (i = 0, total = 0; i < SNAPSHOT_TABLE_COUNT; i++) {
+            HASHTABLE table = *snapshotTables[i];
+            savedCounts[i] = table->count;
+            for (j = 0; j < table->bucketCount; j++, total++) {
+                savedBuckets[total] = table->bucket[j];
+                table->bucket[j] = (cell *)roots[total].value;
+            }
+            table->count = header.tableCount[i];
+        }
+    }
+#else
+    for (i = 0; i < SNAPSHOT_TABLE_COUNT; i++) {
+        *snapshotTables[i] = (HASHTABLE)roots[i].value;
+    }
+#endif /* ROMIZING */
+
+    free(roots);
+    free(relocations);
+    ClassSnapshotRestored = TRUE;
+}
+
+/*=========================================================================
+ * FUNCTION:      FinalizeClassSnapshot()
+ * TYPE:          public global operation
+ * OVERVIEW:      Put the ROM hashtables back the way they were before
+ *                the snapshot was installed, and unmap the snapshot.
+ *                Called once all other VM structures are finalized.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void FinalizeClassSnapshot(void)
+{
+    if (!ClassSnapshotRestored) {
+        return;
+    }
+#if ROMIZING
+    {
+        long total = 0;
+        int i, j;
+        for (i = 0; i < SNAPSHOT_TABLE_COUNT; i++) {
+            HASHTABLE table = *snapshotTables[i];
+            for (j = 0; j < table->bucketCount; j++, total++) {
+                table->bucket[j] = savedBuckets[total];
+            }
+            table->count = savedCounts[i];
+        }
+        free(savedBuckets);
+        savedBuckets = NULL;
+    }
+#endif /* ROMIZING */
+    unmapSnapshotImage_md(ClassSnapshotStart,
+                          ClassSnapshotEnd - ClassSnapshotStart);
+    ClassSnapshotStart = ClassSnapshotEnd = NULL;
+    ClassSnapshotRestored = FALSE;
+}
+
+#endif /* ENABLE_CLASS_SNAPSHOT */
@@ -193,7 +193,7 @@ again:
 
                 /* These push a non-pointer onto the stack */
             case SIPUSH:
-            case GETSTATIC_FAST:
+            case GETSTATIC_FAST: case GETSTATIC_READY:
                 thisIP++;
             case ILOAD:  case FLOAD:  case BIPUSH:
                 thisIP++;
@@ -210,7 +210,7 @@ again:
                 break;
 
                 /* These push two non-pointers onto the stack */
-            case GETSTATIC2_FAST: case LDC2_W:
+            case GETSTATIC2_FAST: case GETSTATIC2_READY: case LDC2_W:
                 thisIP++;
             case LLOAD:    case DLOAD:
                 thisIP++;
@@ -225,8 +225,8 @@ again:
                 break;
 
                 /* These push a pointer onto the stack */
-            case NEW: case NEW_FAST:
-            case GETSTATICP_FAST:
+            case NEW: case NEW_FAST: case NEW_READY:
+            case GETSTATICP_FAST: case GETSTATICP_READY:
                 thisIP++;
             case ALOAD:
                 thisIP++;
@@ -239,7 +239,7 @@ again:
                 /* These pop an item off the stack */
             case IFEQ: case IFNE: case IFLT: case IFGE:
             case IFGT: case IFLE: case IFNULL: case IFNONNULL:
-            case PUTSTATIC_FAST:
+            case PUTSTATIC_FAST: case PUTSTATIC_READY:
                 thisIP += 2;
             case POP:  case IADD: case FADD: case ISUB: case FSUB:
             case IMUL: case FMUL: case IDIV: case FDIV: case IREM:
@@ -283,7 +283,7 @@ again:
             case IF_ICMPEQ: case IF_ICMPNE: case IF_ICMPLT: case IF_ICMPGE:
             case IF_ICMPGT: case IF_ICMPLE: case IF_ACMPEQ: case IF_ACMPNE:
             case PUTFIELD_FAST:
-            case PUTSTATIC2_FAST:
+            case PUTSTATIC2_FAST: case PUTSTATIC2_READY:
                 thisIP += 2;
             case POP2:
             case LADD: case DADD: case LSUB: case DSUB: case LMUL: case DMUL:
@@ -489,6 +489,8 @@ again:
 #if ENABLEFASTBYTECODES
             case INVOKESPECIAL_FAST:
             case INVOKESTATIC_FAST:
+            case INVOKESTATIC_READY:
+            case ARRAYCOPY_READY:
 #endif
             case INVOKEVIRTUAL:
             case INVOKESPECIAL:
@@ -36,13 +36,30 @@ THREAD CurrentThread;   /* Current thread pointer */
 THREAD MainThread;      /* Global so debugger code can create a name */
 
 THREAD AllThreads;      /* List of all threads */
-THREAD RunnableThreads;  /* Runnable thread list */
+
+int RunnableThreadCount; /* Number of threads on the run queues */
 
 /* NOTE:
- * RunnableThreads is a circular queue of threads.  RunnableThreads
- * is either NULL or points to the >>last<< element of the list.
- * This makes it easier to add to either end of the list *
+ * There is one run queue per Java priority level.  Each run queue is
+ * a circular queue of threads, which is either NULL or points to the
+ * >>last<< element of the list.  This makes it easier to add to either
+ * end of the list.  The queues are kept in a pointer list in the heap,
+ * so that the garbage collector updates them when it moves threads.
+ *
+ * Bit p of RunQueueMask is set when the queue of priority p is not
+ * empty, so the highest priority runnable thread is found without
+ * looking at any other thread.  To keep low priority threads from
+ * starving, every PRIORITY_AGING_INTERVAL thread switches the thread
+ * that has waited longest is run instead, whatever its priority.
  */
+static POINTERLIST RunQueues;
+static long RunQueueMask;
+static long ScheduleCount;
+
+/* Each run queue points to the last thread of a circular list */
+#define RUN_QUEUE(priority) ((THREAD)RunQueues->data[priority].cellp)
+#define SET_RUN_QUEUE(priority, thread) \
+    (RunQueues->data[priority].cellp = (cell *)(thread))
 
 int AliveThreadCount;   /* Number of alive threads in AllThreads.  This count
                          * does >>not<< include threads that haven't yet been
@@ -75,7 +92,12 @@ typedef enum { AT_START, AT_END } queueWhere;
 static void   addThreadToQueue(THREAD *queue, THREAD, queueWhere where);
 static THREAD removeQueueStart(THREAD *queue);
 static bool_t removeFromQueue(THREAD *queue, THREAD waiter);
-static int    queueLength(THREAD queue);
+
+/* Run queue operations */
+static void   addRunnableThread(THREAD thisThread, queueWhere where);
+static THREAD removeNextRunnableThread(void);
+static bool_t removeRunnableThread(THREAD thisThread);
+static int    threadPriority(THREAD thisThread);
 
 static void   monitorWaitAlarm(THREAD thread);
 
@@ -160,7 +182,7 @@ bool_t SwitchThread(void)
         if (CurrentThread->state == THREAD_ACTIVE) {
             /* If there is only one thread, or we can't switch threads then
                just return */
-            if (RunnableThreads == NULL) {
+            if (RunnableThreadCount == 0) {
                 /* Nothing else to run */
                 Timeslice = CurrentThread->timeslice;
                 return TRUE;
@@ -176,22 +198,27 @@ bool_t SwitchThread(void)
         }
     }
 
-    /* Try and find a thread */
-    CurrentThread = removeQueueStart(&RunnableThreads);
-
-    /* If there was a thread to add then do so */
+    /* If there was a thread to add then do so.  This is done before */
+    /* picking the next thread, so that the current thread keeps */
+    /* running if no thread of the same or higher priority is ready */
     if (threadToAdd != NIL) {
-        addThreadToQueue(&RunnableThreads, threadToAdd, AT_END);
+        addRunnableThread(threadToAdd, AT_END);
     }
 
+    /* Try and find a thread */
+    CurrentThread = removeNextRunnableThread();
+
     /* If nothing can run then return FALSE */
     if (CurrentThread == NIL) {
         return FALSE;
     }
 
+    if (CurrentThread != threadToAdd) {
 #if ENABLEPROFILING
-    ThreadSwitchCounter++;
+        ThreadSwitchCounter++;
 #endif
+        incrementMetric(threadSwitches);
+    }
     /* Load the VM registers of the new thread */
     loadExecutionEnvironment(CurrentThread);
 
@@ -243,10 +270,10 @@ static THREAD BuildThread(JAVATHREAD_HANDLE javaThreadH)
     START_TEMPORARY_ROOTS
         DECLARE_TEMPORARY_ROOT(THREAD, newThreadX,
                                (THREAD)callocObject(SIZEOF_THREAD, GCT_THREAD));
-        STACK newStack = (STACK)callocObject(sizeof(struct stackStruct)
-                                                     / CELL, GCT_EXECSTACK);
-        /* newStack->next = NULL;  Already zero from calloc */
-        newStack->size = STACKCHUNKSIZE;
+        STACK newStack = allocateStackChunk(STACKCHUNKSIZE);
+        if (newStack == NULL) {
+            THROW(OutOfMemoryObject);
+        }
         newThreadX->stack = newStack;
 
 #if INCLUDEDEBUGCODE
@@ -256,7 +283,7 @@ static THREAD BuildThread(JAVATHREAD_HANDLE javaThreadH)
         if (tracestackchunks) {
             fprintf(stdout,
                 "Created a new stack (thread: %lx, first chunk: %lx, chunk size: %ld\n",
-                (long)newThreadX, (long)newStack, (long)STACKCHUNKSIZE);
+                (long)newThreadX, (long)newStack, (long)newStack->size);
         }
 #endif /* INCLUDEDEBUGCODE */
 
@@ -326,6 +353,8 @@ DismantleThread(THREAD thisThread)
         prevThread->nextAliveThread = thisThread->nextAliveThread;
     }
     thisThread->nextAliveThread = NULL;
+    /* The stack chunks of a dead thread can be used by other threads */
+    releaseStackChunks(thisThread->stack);
     thisThread->stack = NULL;
     thisThread->fpStore = NULL;
     thisThread->spStore = NULL;
@@ -362,15 +391,26 @@ void InitializeThreading(INSTANCE_CLASS mainClass, ARRAY argumentsArg)
         MainThread = NULL;
         MonitorCache = NULL;
         makeGlobalRoot((cell **)&CurrentThread);
-        makeGlobalRoot((cell **)&RunnableThreads);
+        makeGlobalRoot((cell **)&RunQueues);
+        RunQueues = NULL;
         makeGlobalRoot((cell **)&TimerQueue);
 
+        /* Stack chunks of dead threads are recycled through this pool */
+        InitializeStackChunkPool();
+
         /* Initialize the field of the Java-level thread structure */
         javaThread->priority = 5;
 
         /* Initialize the name of the system thread (since CLDC 1.1) */
         javaThread->name = createCharArray("Thread-0", 8, &unused, FALSE);
 
+        /* Allocated before there is a current thread, whose registers */
+        /* the garbage collector would otherwise save and scan */
+        RunQueues = (POINTERLIST)
+            callocObject(SIZEOF_POINTERLIST(MAX_PRIORITY + 1),
+                         GCT_POINTERLIST);
+        RunQueues->length = MAX_PRIORITY + 1;
+
         MainThread = BuildThread(&javaThread);
 
         /* AllThreads is initialized to NULL by the garbage collector.
@@ -385,7 +425,9 @@ void InitializeThreading(INSTANCE_CLASS mainClass, ARRAY argumentsArg)
 
         /* Initialize VM registers */
         CurrentThread = MainThread;
-        RunnableThreads = NULL;
+        RunQueueMask = 0;
+        RunnableThreadCount = 0;
+        ScheduleCount = 0;
         TimerQueue = NULL;
 
         setSP((MainThread->stack->cells - 1));
@@ -760,7 +802,7 @@ void suspendSpecificThread(THREAD thread)
     } else {
 
         if (!(thread->state & (THREAD_SUSPENDED | THREAD_DEAD))) {
-            removeFromQueue(&RunnableThreads, thread);
+            removeRunnableThread(thread);
         }
     }
     thread->state |= THREAD_DBG_SUSPENDED;
@@ -811,10 +853,40 @@ void resumeThread(THREAD thisThread)
          * of whatever sort of callback routine we are in, and it will then
          * be able to proceed */
     } else {
-        /* If the new thread has higher priority then */
-        /* add to head of the wait queue and signal that */
-        /* it is time to reschedule the processor */
-        addThreadToQueue(&RunnableThreads, thisThread, AT_END);
+        /* Add the thread to its run queue.  If the new thread has */
+        /* higher priority than the current one, signal that it is */
+        /* time to reschedule the processor, so that the new thread */
+        /* runs as soon as possible */
+        addRunnableThread(thisThread, AT_END);
+        if (CurrentThread != NIL &&
+              thisThread->runPriority > threadPriority(CurrentThread)) {
+            signalTimeToReschedule();
+        }
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      threadPriorityChanged()
+ * TYPE:          public instance-level operation
+ * OVERVIEW:      Called after the Java-level priority of a thread has
+ *                been changed.  Moves the thread to the run queue of
+ *                its new priority if it is waiting to run, and lets
+ *                the current thread give way to threads of higher
+ *                priority if it has lowered its own priority.
+ * INTERFACE:
+ *   parameters:  thread pointer
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void threadPriorityChanged(THREAD thisThread)
+{
+    if (thisThread == CurrentThread) {
+        signalTimeToReschedule();
+    } else if (thisThread->state == THREAD_ACTIVE &&
+               thisThread->runPriority != threadPriority(thisThread)) {
+        if (removeRunnableThread(thisThread)) {
+            addRunnableThread(thisThread, AT_END);
+        }
     }
 }
 
@@ -845,7 +917,7 @@ void resumeSpecificThread(THREAD thisThread)
  *=======================================================================*/
 
 int activeThreadCount() {
-    return (CurrentThread ? 1 : 0) + queueLength(RunnableThreads);
+    return (CurrentThread ? 1 : 0) + RunnableThreadCount;
 }
 
 /*=========================================================================
@@ -880,7 +952,7 @@ int isActivated(THREAD thread)
 
 THREAD removeFirstRunnableThread()
 {
-    return removeQueueStart(&RunnableThreads);
+    return removeNextRunnableThread();
 }
 
 #endif /* ENABLE_JAVA_DEBUGGER */
@@ -1467,17 +1539,77 @@ removeCondvarWait(MONITOR monitor, bool_t notifyAll) {
     while (notifyAll);
 }
 
+/*=========================================================================
+ * FUNCTION:      findLockRecord()
+ * TYPE:          Monitor handler
+ * OVERVIEW:      Find the lock record that a thread uses for an object
+ *                whose .mhc field is an MHC_EXTENDED_LOCK.
+ * INTERFACE:
+ *   parameters:  thread: the thread that has locked the object
+ *                object: the object
+ *   returns:     the lock record of the object
+ *=======================================================================*/
+
+static LOCKRECORD
+findLockRecord(THREAD thread, OBJECT object) {
+    int i;
+    /* Locks are usually released in the reverse order, so the record
+     * we are looking for is almost always at the top of the stack */
+    for (i = thread->lockRecordCount - 1; i >= 0; i--) {
+        if (thread->lockRecords[i].object == object) {
+            return &thread->lockRecords[i];
+        }
+    }
+    fatalError(KVM_MSG_LOCK_RECORD_NOT_FOUND);
+    return NULL;
+}
+
+/*=========================================================================
+ * FUNCTION:      freeLockRecord()
+ * TYPE:          Monitor handler
+ * OVERVIEW:      Release a lock record, and pop any unused records off
+ *                the top of the lock record stack of the thread.
+ * INTERFACE:
+ *   parameters:  thread: the thread that owns the record
+ *                record: the lock record
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+static void
+freeLockRecord(THREAD thread, LOCKRECORD record) {
+    int count = thread->lockRecordCount;
+    record->object = NULL;
+    record->depth = 0;
+    while (count > 0 && thread->lockRecords[count - 1].object == NULL) {
+        count--;
+    }
+    thread->lockRecordCount = count;
+}
+
 static bool_t
 allocateFastLock(THREAD thread, OBJECT object, int depth, long hashCode) {
-    if (IS_EXTENDED_LOCK_FREE(thread)) {
-        /* thisLock->object = object; */
-        thread->extendedLock.depth = depth;
-        thread->extendedLock.hashCode = hashCode;
-        SET_OBJECT_EXTENDED_LOCK(object, thread);
-        return TRUE;
+    LOCKRECORD record;
+    if (thread->lockRecordCount < LOCKRECORDSTACKSIZE) {
+        record = &thread->lockRecords[thread->lockRecordCount++];
     } else {
-        return FALSE;
+        /* The stack is full.  Look for a hole left by a lock that
+         * was released out of order. */
+        int i;
+        for (i = 0; ; i++) {
+            if (i == LOCKRECORDSTACKSIZE) {
+                return FALSE;
+            }
+            if (thread->lockRecords[i].object == NULL) {
+                break;
+            }
+        }
+        record = &thread->lockRecords[i];
     }
+    record->object = object;
+    record->depth = depth;
+    record->hashCode = hashCode;
+    SET_OBJECT_EXTENDED_LOCK(object, thread);
+    return TRUE;
 }
 
 void
@@ -1494,8 +1626,9 @@ clearObjectMonitor(OBJECT object) {
 
         case MHC_EXTENDED_LOCK: {
             THREAD thread = OBJECT_MHC_EXTENDED_THREAD(object);
-            hashCode = thread->extendedLock.hashCode;
-            FREE_EXTENDED_LOCK(thread);
+            LOCKRECORD record = findLockRecord(thread, object);
+            hashCode = record->hashCode;
+            freeLockRecord(thread, record);
             break;
         }
 
@@ -1506,6 +1639,33 @@ clearObjectMonitor(OBJECT object) {
     SET_OBJECT_HASHCODE(object, hashCode);
 }
 
+/*=========================================================================
+ * FUNCTION:      deflateObjectMonitor()
+ * TYPE:          Monitor handler
+ * OVERVIEW:      Detach an idle real monitor from an object.  Called by
+ *                the garbage collector when it finds a live object
+ *                with a real monitor.  If no thread owns the monitor or
+ *                waits on it, the hash code is moved back into the
+ *                object and the monitor is left for the collector to
+ *                reclaim; the next monitorEnter on the object will use
+ *                lightweight locking again.
+ * INTERFACE:
+ *   parameters:  object: an object with a real monitor
+ *   returns:     TRUE if the monitor was detached from the object
+ *=======================================================================*/
+
+bool_t
+deflateObjectMonitor(OBJECT object) {
+    MONITOR monitor = OBJECT_MHC_MONITOR(object);
+    if (   monitor->owner == NULL
+        && monitor->monitor_waitq == NULL
+        && monitor->condvar_waitq == NULL) {
+        SET_OBJECT_HASHCODE(object, monitor->hashCode);
+        return TRUE;
+    }
+    return FALSE;
+}
+
 static MONITOR
 upgradeToRealMonitor(OBJECT object)
 {
@@ -1551,11 +1711,12 @@ upgradeToRealMonitor(OBJECT object)
 
         case MHC_EXTENDED_LOCK: {
             THREAD thread = OBJECT_MHC_EXTENDED_THREAD(object);
+            LOCKRECORD record = findLockRecord(thread, object);
             monitor->owner = thread;
-            monitor->depth = thread->extendedLock.depth;
-            monitor->hashCode = thread->extendedLock.hashCode;
+            monitor->depth = record->depth;
+            monitor->hashCode = record->hashCode;
             /* Free this fast lock, since it is no longer in use */
-            FREE_EXTENDED_LOCK(thread);
+            freeLockRecord(thread, record);
             break;
 
        default:                /* Needed to keep compiler happy */
@@ -1572,7 +1733,7 @@ monitorHashCodeAddress(OBJECT object) {
         case MHC_SIMPLE_LOCK: {
             THREAD thisThread = OBJECT_MHC_SIMPLE_THREAD(object);
             if (allocateFastLock(thisThread, object, 1, 0)) {
-                return &thisThread->extendedLock.hashCode;
+                return &findLockRecord(thisThread, object)->hashCode;
             } else {
                 MONITOR monitor = upgradeToRealMonitor(object);
                 /* object may be trash, because of a GC, but doesn't matter */
@@ -1582,7 +1743,7 @@ monitorHashCodeAddress(OBJECT object) {
 
         case MHC_EXTENDED_LOCK: {
             THREAD thread = OBJECT_MHC_EXTENDED_THREAD(object);
-            return &thread->extendedLock.hashCode;
+            return &findLockRecord(thread, object)->hashCode;
         }
 
         default:                /* Keep compiler happy */
@@ -1670,13 +1831,14 @@ monitorEnter(OBJECT object)
 
         case MHC_EXTENDED_LOCK:
             if (OBJECT_MHC_EXTENDED_THREAD(object) == thisThread) {
-                thisThread->extendedLock.depth++;
+                LOCKRECORD record = findLockRecord(thisThread, object);
+                record->depth++;
 
 #if INCLUDEDEBUGCODE
                 if (tracemonitors) {
                     fprintf(stdout, format,
                             (long)thisThread, "fast", (long)object,
-                            (long)thisThread, (long)thisThread->extendedLock.depth);
+                            (long)thisThread, (long)record->depth);
                 }
 #endif /* INCLUDEDEBUGCODE */
 
@@ -1770,26 +1932,27 @@ monitorExit(OBJECT object, char** exceptionName)
             if (OBJECT_MHC_EXTENDED_THREAD(object) != thisThread) {
                 break;
             } else {
-                int newDepth;
+                LOCKRECORD record = findLockRecord(thisThread, object);
+                long newDepth;
 
 #if INCLUDEDEBUGCODE
                 if (tracemonitors) {
                     fprintf(stdout, format,
                             (long)thisThread, "fast", (long)object,
-                            (long)thisThread, (long)thisThread->extendedLock.depth);
+                            (long)thisThread, (long)record->depth);
                 }
 #endif /* INCLUDEDEBUGCODE */
 
-                newDepth = --thisThread->extendedLock.depth;
+                newDepth = --record->depth;
                 if (newDepth == 0) {
                     /* Release the fast lock.  No one is waiting for it */
-                    SET_OBJECT_HASHCODE(object, thisThread->extendedLock.hashCode);
-                    FREE_EXTENDED_LOCK(thisThread);
+                    SET_OBJECT_HASHCODE(object, record->hashCode);
+                    freeLockRecord(thisThread, record);
                     return MonitorStatusRelease;
                 } else {
-                    if (newDepth == 1 && thisThread->extendedLock.hashCode==0){
+                    if (newDepth == 1 && record->hashCode == 0) {
                         /* Simplify this to a simple lock */
-                        FREE_EXTENDED_LOCK(thisThread);
+                        freeLockRecord(thisThread, record);
                         SET_OBJECT_SIMPLE_LOCK(object, thisThread);
                     }
                     return MonitorStatusOwn;
@@ -2070,21 +2233,153 @@ removeFromQueue(THREAD *queue_p, THREAD waiter)
     return (result);
 }
 
-static int
-queueLength(THREAD queue) {
-    int length = 0;
-    START_CRITICAL_SECTION
-    if (queue == NULL) {
-        ;
-    } else {
-        THREAD thread = queue;
-        do {
-            length++;
-            thread = thread->nextThread;
-        } while (thread != queue);
+/*=========================================================================
+ * Run queue manipulation functions (internal to this file)
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      threadPriority()
+ * TYPE:          private instance-level operation
+ * OVERVIEW:      Return the Java-level priority of a thread, which
+ *                selects its run queue.
+ * INTERFACE:
+ *   parameters:  thisThread: a thread
+ *   returns:     a priority between MIN_PRIORITY and MAX_PRIORITY
+ *=======================================================================*/
+
+static int threadPriority(THREAD thisThread)
+{
+    JAVATHREAD javaThread = thisThread->javaThread;
+    if (javaThread == NULL ||
+          javaThread->priority < MIN_PRIORITY ||
+          javaThread->priority > MAX_PRIORITY) {
+        return NORM_PRIORITY;
     }
+    return (int)javaThread->priority;
+}
+
+/*=========================================================================
+ * FUNCTION:      addRunnableThread()
+ * TYPE:          private instance-level operation
+ * OVERVIEW:      Add a thread to the run queue of its priority.
+ * INTERFACE:
+ *   parameters:  thisThread: thread to add to the queue
+ *                where:      AT_START or AT_END
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+static void addRunnableThread(THREAD thisThread, queueWhere where)
+{
+    int priority = threadPriority(thisThread);
+
+    START_CRITICAL_SECTION
+        THREAD queue = RUN_QUEUE(priority);
+        thisThread->runPriority = priority;
+        thisThread->readySince = ScheduleCount;
+        if (queue == NIL) {
+            SET_RUN_QUEUE(priority, thisThread);
+            thisThread->nextThread = thisThread;
+        } else {
+            /* Add thisThread after queue, which always points
+             * to the last element of the list */
+            thisThread->nextThread = queue->nextThread;
+            queue->nextThread = thisThread;
+            if (where == AT_END) {
+                SET_RUN_QUEUE(priority, thisThread);
+            }
+        }
+        RunQueueMask |= (1 << priority);
+        RunnableThreadCount++;
+    END_CRITICAL_SECTION
+}
+
+/*=========================================================================
+ * FUNCTION:      removeNextRunnableThread()
+ * TYPE:          private instance-level operation
+ * OVERVIEW:      Remove the next thread to run from the run queues.
+ *                This is normally the first thread of the highest
+ *                priority queue that isn't empty.  Every
+ *                PRIORITY_AGING_INTERVAL calls, if threads of lower
+ *                priority are waiting, the thread at the start of
+ *                a queue that has waited longest is taken instead.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     A THREAD pointer or NIL
+ *=======================================================================*/
+
+static THREAD removeNextRunnableThread(void)
+{
+    THREAD thisThread = NIL;
+
+    START_CRITICAL_SECTION
+        if (RunQueueMask != 0) {
+            int priority = MAX_PRIORITY;
+            THREAD queue;
+
+            while (!(RunQueueMask & (1 << priority))) {
+                priority--;
+            }
+
+            if (++ScheduleCount % PRIORITY_AGING_INTERVAL == 0 &&
+                  (RunQueueMask & ((1 << priority) - 1)) != 0) {
+                long oldest = RUN_QUEUE(priority)->nextThread->readySince;
+                int p;
+                for (p = priority - 1; p >= MIN_PRIORITY; p--) {
+                    if (RunQueueMask & (1 << p)) {
+                        long readySince = RUN_QUEUE(p)->nextThread->readySince;
+                        if (readySince < oldest) {
+                            oldest = readySince;
+                            priority = p;
+                        }
+                    }
+                }
+            }
+
+            /* queue points to the last item on a circular list */
+            queue = RUN_QUEUE(priority);
+            thisThread = queue->nextThread;
+            if (thisThread == queue) {
+                /* We were the only item on the list */
+                SET_RUN_QUEUE(priority, NIL);
+                RunQueueMask &= ~(1 << priority);
+            } else {
+                queue->nextThread = thisThread->nextThread;
+            }
+            thisThread->nextThread = NIL;
+            RunnableThreadCount--;
+        }
+    END_CRITICAL_SECTION
+
+    return thisThread;
+}
+
+/*=========================================================================
+ * FUNCTION:      removeRunnableThread()
+ * TYPE:          private instance-level operation
+ * OVERVIEW:      Remove a thread from its run queue.
+ * INTERFACE:
+ *   parameters:  thisThread: the thread to remove
+ *   returns:     TRUE if the thread was found on its queue,
+ *                FALSE otherwise
+ *=======================================================================*/
+
+static bool_t removeRunnableThread(THREAD thisThread)
+{
+    int priority = thisThread->runPriority;
+    bool_t result;
+
+    START_CRITICAL_SECTION
+        THREAD queue = RUN_QUEUE(priority);
+        result = removeFromQueue(&queue, thisThread);
+        if (result) {
+            SET_RUN_QUEUE(priority, queue);
+            if (queue == NIL) {
+                RunQueueMask &= ~(1 << priority);
+            }
+            RunnableThreadCount--;
+        }
     END_CRITICAL_SECTION
-    return (length);
+    return result;
 }
 
 /*=========================================================================
@@ -2134,7 +2429,8 @@ printMonitor(OBJECT object) {
         case MHC_EXTENDED_LOCK: {
             THREAD thread = OBJECT_MHC_EXTENDED_THREAD(object);
             fprintf(stdout, "Object %lx fast lock on thread %lx, depth=%lx\n",
-                   (long)object, (long)thread, (long)thread->extendedLock.depth);
+                   (long)object, (long)thread,
+                   (long)findLockRecord(thread, object)->depth);
             break;
         }
 
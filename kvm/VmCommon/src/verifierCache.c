@@ -0,0 +1,489 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ *
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Class file verifier
+ * FILE:      verifierCache.c
+ * OVERVIEW:  Persistent cache of verification results.  This file
+ *            implements the checkVerifiedClassList() and
+ *            appendVerifiedClassList() hooks used by verifyClass().
+ *
+ *            Each class file loaded from a JAR file is digested with
+ *            SHA-256 as it is loaded, together with the size and
+ *            modification time of the JAR file and a stamp of the
+ *            whole class path.  When a class passes
+ *            verification, its digest is appended to the cache file.
+ *            On later runs, a class whose digest is in the cache file
+ *            is not verified again; only its stack maps are rewritten.
+ *
+ *            Whether a class verifies depends on the other classes it
+ *            refers to, such as its superclasses, not just on its own
+ *            bytes.  Those may be in any JAR file on the class path,
+ *            which is why the class path stamp (see getJarClassPathStamp())
+ *            is part of the digest: when any JAR file on the class path
+ *            changes, or the class path itself does, every class is
+ *            verified again.  The cache file is stamped with the VM
+ *            build and the class path, and discarded as a whole if
+ *            either changes.  Since changes to the files in a directory
+ *            can't be detected, nothing is cached while the class path
+ *            contains a directory.  Failed verifications are never
+ *            cached.
+ *=======================================================================*/
+
+/*=========================================================================
+ * Include files
+ *=======================================================================*/
+
+#include <global.h>
+
+#if CACHE_VERIFICATION_RESULT
+
+/*=========================================================================
+ * Definitions and declarations
+ *=======================================================================*/
+
+#define VERIFIER_CACHE_MAGIC   0x4B564643   /* "KVFC" */
+
+/* Bump this whenever the verifier changes what it accepts */
+#define VERIFIER_CACHE_VERSION 4
+
+#define DIGEST_SIZE 32
+
+typedef struct verifierCacheHeaderStruct {
+    unsigned long magic;
+    unsigned long version;
+    char          buildStamp[32];
+    long          classPathStamp;
+} verifierCacheHeader;
+
+/* A class loaded during this run, with the digest of its class file */
+typedef struct loadedClassDigestStruct {
+    INSTANCE_CLASS clazz;
+    unsigned char  digest[DIGEST_SIZE];
+} loadedClassDigest;
+
+typedef struct sha256ContextStruct {
+    unsigned long state[8];
+    unsigned long length;       /* Bytes hashed so far */
+    unsigned char buffer[64];
+} sha256Context;
+
+/*=========================================================================
+ * Variables
+ *=======================================================================*/
+
+char* VerifierCacheFile;
+long  VerifierCacheHitCounter;
+long  VerifierCacheMissCounter;
+
+static bool_t             cacheEnabled;
+static bool_t             cacheFileIsCurrent;
+static verifierCacheHeader cacheHeader;
+
+/* Sorted digests read from the cache file */
+static unsigned char*     cachedDigests;
+static long               cachedDigestCount;
+
+static loadedClassDigest* loadedClasses;
+static long               loadedClassCount;
+static long               loadedClassLimit;
+
+static const unsigned long sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*=========================================================================
+ * Static functions (private to this file)
+ *=======================================================================*/
+
+static void sha256Init(sha256Context *context);
+static void sha256Block(sha256Context *context, const unsigned char *block);
+static void sha256Update(sha256Context *context,
+                         const unsigned char *data, unsigned long length);
+static void sha256Final(sha256Context *context, unsigned char *digest);
+static void sha256UpdateStamp(sha256Context *context, long stamp);
+static int  compareDigests(const void *a, const void *b);
+static loadedClassDigest *findLoadedClass(INSTANCE_CLASS clazz);
+static bool_t isCachedDigest(const unsigned char *digest);
+
+/*=========================================================================
+ * SHA-256 (FIPS 180-2)
+ *=======================================================================*/
+
+#define ROTR32(x, n) ((((x) >> (n)) | ((x) << (32 - (n)))) & 0xFFFFFFFF)
+
+static void
+sha256Init(sha256Context *context)
+{
+    context->state[0] = 0x6a09e667;
+    context->state[1] = 0xbb67ae85;
+    context->state[2] = 0x3c6ef372;
+    context->state[3] = 0xa54ff53a;
+    context->state[4] = 0x510e527f;
+    context->state[5] = 0x9b05688c;
+    context->state[6] = 0x1f83d9ab;
+    context->state[7] = 0x5be0cd19;
+    context->length = 0;
+}
+
+static void
+sha256Block(sha256Context *context, const unsigned char *block)
+{
+    unsigned long w[64];
+    unsigned long a, b, c, d, e, f, g, h;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        w[i] = ((unsigned long)block[4*i] << 24)
+             | ((unsigned long)block[4*i + 1] << 16)
+             | ((unsigned long)block[4*i + 2] << 8)
+             |  (unsigned long)block[4*i + 3];
+    }
+    for (i = 16; i < 64; i++) {
+        unsigned long s0 = ROTR32(w[i-15], 7) ^ ROTR32(w[i-15], 18)
+                         ^ (w[i-15] >> 3);
+        unsigned long s1 = ROTR32(w[i-2], 17) ^ ROTR32(w[i-2], 19)
+                         ^ (w[i-2] >> 10);
+        w[i] = (w[i-16] + s0 + w[i-7] + s1) & 0xFFFFFFFF;
+    }
+
+    a = context->state[0]; b = context->state[1];
+    c = context->state[2]; d = context->state[3];
+    e = context->state[4]; f = context->state[5];
+    g = context->state[6]; h = context->state[7];
+
+    for (i = 0; i < 64; i++) {
+        unsigned long s1 = ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25);
+        unsigned long ch = (e & f) ^ (~e & g);
+        unsigned long t1 = (h + s1 + ch + sha256K[i] + w[i]) & 0xFFFFFFFF;
+        unsigned long s0 = ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22);
+        unsigned long maj = (a & b) ^ (a & c) ^ (b & c);
+        unsigned long t2 = (s0 + maj) & 0xFFFFFFFF;
+        h = g; g = f; f = e;
+        e = (d + t1) & 0xFFFFFFFF;
+        d = c; c = b; b = a;
+        a = (t1 + t2) & 0xFFFFFFFF;
+    }
+
+    context->state[0] = (context->state[0] + a) & 0xFFFFFFFF;
+    context->state[1] = (context->state[1] + b) & 0xFFFFFFFF;
+    context->state[2] = (context->state[2] + c) & 0xFFFFFFFF;
+    context->state[3] = (context->state[3] + d) & 0xFFFFFFFF;
+    context->state[4] = (context->state[4] + e) & 0xFFFFFFFF;
+    context->state[5] = (context->state[5] + f) & 0xFFFFFFFF;
+    context->state[6] = (context->state[6] + g) & 0xFFFFFFFF;
+    context->state[7] = (context->state[7] + h) & 0xFFFFFFFF;
+}
+
+static void
+sha256Update(sha256Context *context,
+             const unsigned char *data, unsigned long length)
+{
+    unsigned long used = context->length & 63;
+    context->length += length;
+
+    if (used > 0) {
+        unsigned long room = 64 - used;
+        if (length < room) {
+            memcpy(context->buffer + used, data, length);
+            return;
+        }
+        memcpy(context->buffer + used, data, room);
+        sha256Block(context, context->buffer);
+        data += room;
+        length -= room;
+    }
+    for ( ; length >= 64; data += 64, length -= 64) {
+        sha256Block(context, data);
+    }
+    memcpy(context->buffer, data, length);
+}
+
+static void
+sha256Final(sha256Context *context, unsigned char *digest)
+{
+    unsigned long used = context->length & 63;
+    unsigned long bits = context->length << 3;
+    int i;
+
+    context->buffer[used++] = 0x80;
+    if (used > 56) {
+        memset(context->buffer + used, 0, 64 - used);
+        sha256Block(context, context->buffer);
+        used = 0;
+    }
+    memset(context->buffer + used, 0, 56 - used);
+    /* Inputs are far below 2^32 bytes, so the high length word is zero */
+    context->buffer[56] = context->buffer[57] = context->buffer[58] = 0;
+    context->buffer[59] = (unsigned char)(context->length >> 29);
+    context->buffer[60] = (unsigned char)(bits >> 24);
+    context->buffer[61] = (unsigned char)(bits >> 16);
+    context->buffer[62] = (unsigned char)(bits >> 8);
+    context->buffer[63] = (unsigned char)bits;
+    sha256Block(context, context->buffer);
+
+    for (i = 0; i < 8; i++) {
+        digest[4*i]     = (unsigned char)(context->state[i] >> 24);
+        digest[4*i + 1] = (unsigned char)(context->state[i] >> 16);
+        digest[4*i + 2] = (unsigned char)(context->state[i] >> 8);
+        digest[4*i + 3] = (unsigned char)context->state[i];
+    }
+}
+
+/* Hash all the bytes of a stamp, most significant first */
+static void
+sha256UpdateStamp(sha256Context *context, long stamp)
+{
+    unsigned char stampBytes[sizeof(long)];
+    int i;
+
+    for (i = 0; i < (int)sizeof(long); i++) {
+        stampBytes[i] = (unsigned char)
+            ((unsigned long)stamp >> (8 * (sizeof(long) - 1 - i)));
+    }
+    sha256Update(context, stampBytes, sizeof(stampBytes));
+}
+
+/*=========================================================================
+ * Helper functions
+ *=======================================================================*/
+
+static int
+compareDigests(const void *a, const void *b)
+{
+    return memcmp(a, b, DIGEST_SIZE);
+}
+
+static bool_t
+isCachedDigest(const unsigned char *digest)
+{
+    return cachedDigestCount > 0
+        && bsearch(digest, cachedDigests, cachedDigestCount,
+                   DIGEST_SIZE, compareDigests) != NULL;
+}
+
+static loadedClassDigest *
+findLoadedClass(INSTANCE_CLASS clazz)
+{
+    /* Classes are usually verified soon after being loaded */
+    long i;
+    for (i = loadedClassCount - 1; i >= 0; i--) {
+        if (loadedClasses[i].clazz == clazz) {
+            return &loadedClasses[i];
+        }
+    }
+    return NULL;
+}
+
+/*=========================================================================
+ * Verification cache operations
+ *=======================================================================*/
+
+/*=========================================================================
+ * FUNCTION:      InitializeVerifierCache()
+ * TYPE:          public global operation
+ * OVERVIEW:      Read the cache file named by VerifierCacheFile, if any.
+ *                Must be called before any class file is loaded.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void InitializeVerifierCache(void)
+{
+    verifierCacheHeader header;
+    FILE *file;
+
+    cacheEnabled = FALSE;
+    cacheFileIsCurrent = FALSE;
+    cachedDigests = NULL;
+    cachedDigestCount = 0;
+    loadedClasses = NULL;
+    loadedClassCount = loadedClassLimit = 0;
+    VerifierCacheHitCounter = VerifierCacheMissCounter = 0;
+
+    if (VerifierCacheFile == NULL) {
+        return;
+    }
+
+    memset(&cacheHeader, 0, sizeof(cacheHeader));
+    cacheHeader.magic   = VERIFIER_CACHE_MAGIC;
+    cacheHeader.version = VERIFIER_CACHE_VERSION;
+    sprintf(cacheHeader.buildStamp, "%.20s %d",
+            __DATE__ " " __TIME__, ROMIZING);
+    cacheHeader.classPathStamp = getJarClassPathStamp();
+    if (cacheHeader.classPathStamp == 0) {
+        return;
+    }
+    cacheEnabled = TRUE;
+
+    file = fopen(VerifierCacheFile, "rb");
+    if (file == NULL) {
+        return;
+    }
+    if (fread(&header, sizeof(header), 1, file) == 1
+          && memcmp(&header, &cacheHeader, sizeof(header)) == 0) {
+        long start = ftell(file);
+        long size;
+        fseek(file, 0, SEEK_END);
+        size = ftell(file) - start;
+        fseek(file, start, SEEK_SET);
+        cacheFileIsCurrent = TRUE;
+        cachedDigests = malloc(size + 1);
+        if (cachedDigests != NULL) {
+            /* A partially written last entry is ignored */
+            cachedDigestCount = fread(cachedDigests, DIGEST_SIZE,
+                                      size / DIGEST_SIZE, file);
+            qsort(cachedDigests, cachedDigestCount, DIGEST_SIZE,
+                  compareDigests);
+        }
+    }
+    fclose(file);
+}
+
+/*=========================================================================
+ * FUNCTION:      FinalizeVerifierCache()
+ * TYPE:          public global operation
+ * OVERVIEW:      Release the memory used by the verification cache.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void FinalizeVerifierCache(void)
+{
+#if INCLUDEDEBUGCODE
+    if (traceverifier && cacheEnabled) {
+        fprintf(stdout, "Verifier cache: %ld hits, %ld misses\n",
+                VerifierCacheHitCounter, VerifierCacheMissCounter);
+    }
+#endif
+    free(cachedDigests);
+    free(loadedClasses);
+    cachedDigests = NULL;
+    loadedClasses = NULL;
+    cachedDigestCount = loadedClassCount = loadedClassLimit = 0;
+    cacheEnabled = FALSE;
+}
+
+/*=========================================================================
+ * FUNCTION:      registerClassfileDigest()
+ * TYPE:          public operation
+ * OVERVIEW:      Called by the class loader when it has opened the class
+ *                file of a class.  Remembers the digest of the class file
+ *                for checkVerifiedClassList() and appendVerifiedClassList().
+ * INTERFACE:
+ *   parameters:  clazz: the class being loaded
+ *                ClassFileH: its open class file
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void registerClassfileDigest(INSTANCE_CLASS clazz,
+                             FILEPOINTER_HANDLE ClassFileH)
+{
+    sha256Context context;
+    unsigned char *data;
+    long length;
+    long classPathStamp;
+
+    if (!cacheEnabled) {
+        return;
+    }
+    /* The class path may have been extended (see appendClassPath()) */
+    classPathStamp = getJarClassPathStamp();
+    if (classPathStamp == 0) {
+        return;
+    }
+    if (loadedClassCount == loadedClassLimit) {
+        loadedClassLimit = loadedClassLimit * 2 + 64;
+        loadedClasses = realloc(loadedClasses,
+                            loadedClassLimit * sizeof(loadedClassDigest));
+        if (loadedClasses == NULL) {
+            loadedClassCount = loadedClassLimit = 0;
+            cacheEnabled = FALSE;
+            return;
+        }
+    }
+
+    ASSERTING_NO_ALLOCATION
+        data = getClassfileContents(ClassFileH, &length);
+        if (data != NULL) {
+            loadedClassDigest *record = &loadedClasses[loadedClassCount++];
+            sha256Init(&context);
+            sha256UpdateStamp(&context, getClassfileStamp(ClassFileH));
+            sha256UpdateStamp(&context, classPathStamp);
+            sha256Update(&context, data, length);
+            sha256Final(&context, record->digest);
+            record->clazz = clazz;
+        }
+    END_ASSERTING_NO_ALLOCATION
+}
+
+/*=========================================================================
+ * FUNCTION:      checkVerifiedClassList(), appendVerifiedClassList()
+ * TYPE:          public operations
+ * OVERVIEW:      Check whether a class has passed verification in an
+ *                earlier run, and record that it has passed now.
+ * INTERFACE:
+ *   parameters:  thisClass: the class being verified
+ *   returns:     checkVerifiedClassList(): TRUE if the class need not be
+ *                verified again
+ *=======================================================================*/
+
+bool_t checkVerifiedClassList(INSTANCE_CLASS thisClass)
+{
+    loadedClassDigest *record = findLoadedClass(thisClass);
+    if (record == NULL) {
+        return FALSE;
+    }
+    if (isCachedDigest(record->digest)) {
+        VerifierCacheHitCounter++;
+        return TRUE;
+    }
+    VerifierCacheMissCounter++;
+    return FALSE;
+}
+
+void appendVerifiedClassList(INSTANCE_CLASS thisClass)
+{
+    loadedClassDigest *record = findLoadedClass(thisClass);
+    FILE *file;
+
+    if (record == NULL) {
+        return;
+    }
+    /* An out-of-date cache file is started over */
+    file = fopen(VerifierCacheFile, cacheFileIsCurrent ? "ab" : "wb");
+    if (file == NULL) {
+        return;
+    }
+    if (!cacheFileIsCurrent) {
+        fwrite(&cacheHeader, sizeof(cacheHeader), 1, file);
+        cacheFileIsCurrent = TRUE;
+    }
+    fwrite(record->digest, DIGEST_SIZE, 1, file);
+    fclose(file);
+}
+
+#endif /* CACHE_VERIFICATION_RESULT */
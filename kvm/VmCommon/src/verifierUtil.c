@@ -552,6 +552,9 @@ int verifyClass(INSTANCE_CLASS thisClass) {
 #endif
     if (thisClass->methodTable) {
         if (!checkVerifiedClassList(thisClass)) {
+            /* Read the code of methods that was skipped at load time */
+            loadClassMethodCode(thisClass);
+
             /* Verify all methods */
             for (i = 0; i < thisClass->methodTable->length; i++) {
                 METHOD thisMethod = &thisClass->methodTable->methods[i];
@@ -350,7 +350,17 @@ typedef struct CE_Modifiers *CEModPtr;
 
 #define MIN(x, y)          ((x) < (y) ? (x) : (y))
 
-#define MAX_INPUT_PACKET_SIZE 300
+/* Size of the buffers used to receive and send debugger packets. */
+/* Packet data that doesn't fit is read or written directly. */
+#define DEBUGGER_IO_BUFFER_SIZE 4096
+
+/* Largest packet accepted from the debugger.  No command that KVM */
+/* implements comes close; a larger length means a broken stream. */
+#define MAX_INPUT_PACKET_SIZE (64 * 1024)
+
+/* Maximum number of queued commands handled, and replied to with a */
+/* single write, by one call to ProcessDebugCmds() */
+#define DEBUGGER_COMMAND_BATCH 32
 
 #define DEBUG_MAX_CLASSNAME 256
 #define DEBUG_MAX_SIG 64
@@ -423,6 +433,15 @@ void processBreakCommands(void);
 ByteCode getBreakpointOpcode( VMEventPtr *, struct Modifiers ** );
 void handleBreakpoint( THREAD thread );
 int handleSingleStep(THREAD thread, THREAD *);
+bool_t updateDebugInterpreter(void);
+
+/* Make the interpreter continue in DebugInterpret() from the next */
+/* reschedule point.  Called whenever a thread starts stepping or  */
+/* stops at a breakpoint. */
+#define armDebugInterpreter() {      \
+    DebugInterpreterArmed = TRUE;    \
+    signalTimeToReschedule();        \
+}
 CEModPtr GetCEModifier();
 void FreeCEModifier(CEModPtr);
 
@@ -468,6 +487,8 @@ int dbgStdOutWrite(void *buf, int len);
 int dbgRead(void *buf, int len, int flag);
 int dbgReceivePacket(PACKET_INPUT_STREAM_HANDLE);
 int dbgSendPacket(struct Packet *);
+int dbgFlushOutput(void);
+bool_t dbgPacketAvail(void);
 bool_t dbgInitialized(void);
 void dbgFlush(void);
 
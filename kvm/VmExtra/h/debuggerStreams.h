@@ -164,7 +164,8 @@ int inStream_error(PACKET_INPUT_STREAM_HANDLE inH);
  */
 
 #define INITIAL_SEGMENT_SIZE   256
-#define MAX_SEGMENT_SIZE       512
+#define MAX_SEGMENT_SIZE       4096
+#define LOCATION_SIZE          17
 #define SIZEOF_PACKETSTREAM    StructSizeInCells(PacketStream)
 #define SIZEOF_PACKETDATA      StructSizeInCells(PacketData)
 #define SIZEOF_PACKET          StructSizeInCells(Packet)
@@ -198,6 +199,11 @@ void outStream_writeLong64(PACKET_OUTPUT_STREAM_HANDLE outH, unsigned long val);
 
 void outStream_writeLocation(PACKET_OUTPUT_STREAM_HANDLE outH, BYTE tag,
                             long clazzID, long methodID, unsigned long loc);
+void outStream_writeFrame(PACKET_OUTPUT_STREAM_HANDLE outH, long frameID,
+                          BYTE tag, long clazzID, long methodID,
+                          unsigned long loc);
+void outStream_writeClassInfo(PACKET_OUTPUT_STREAM_HANDLE outH, BYTE tag,
+                              CLASS clazz, long status);
 
 void outStream_writeString(PACKET_OUTPUT_STREAM_HANDLE outH, 
                           CONST_CHAR_HANDLE string);
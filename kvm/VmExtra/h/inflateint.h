@@ -113,6 +113,81 @@ typedef struct inflaterState {
 #endif
 } inflaterState;
 
+/*=========================================================================
+ * Table-driven fast decoder
+ *=======================================================================*/
+
+/* When this option is turned on, Huffman blocks are decoded by a
+ * table-driven decoder that keeps a 64-bit bit buffer, resolves
+ * literal/length and distance symbols (including the length and
+ * distance base values) with a single lookup in a two-level table, and
+ * copies matches a word at a time.  The decode tables live in static
+ * memory, so the fast decoder never allocates from the Java heap.
+ * It costs about 13 kilobytes of static data, so it is off by default;
+ * ports that can afford the space turn it on in machine_md.h.
+ *
+ * The fast decoder writes straight into the output buffer, so it is
+ * not used by ports that redefine INFLATER_PUT_BYTE.
+ */
+#ifndef INFLATE_FAST_DECODER
+#define INFLATE_FAST_DECODER 0
+#endif
+
+#if defined(INFLATE_DEBUG_FILE) || defined(INFLATER_PUT_BYTE)
+#undef  INFLATE_FAST_DECODER
+#define INFLATE_FAST_DECODER 0
+#endif
+
+/* One entry of a fast decode table.  "op" tells what the entry is:
+ *     FAST_LITERAL       "value" is a literal byte (or, for the code
+ *                        length alphabet, the decoded symbol)
+ *     FAST_BASE | n      "value" is a length or distance base, to which
+ *                        the next n bits of input must be added
+ *     FAST_END_OF_BLOCK  end of the current block
+ *     FAST_SUBTABLE | n  the code is longer than the root table; the
+ *                        next n bits index the subtable at "value"
+ *     FAST_INVALID       no code maps to this entry
+ * "bits" is the number of bits consumed by the code itself (for root
+ * entries pointing to a subtable, the number of root bits).
+ */
+typedef struct fastHuffmanEntry {
+    unsigned char  op;
+    unsigned char  bits;
+    unsigned short value;
+} fastHuffmanEntry;
+
+#define FAST_LITERAL       0x00
+#define FAST_BASE          0x10
+#define FAST_END_OF_BLOCK  0x20
+#define FAST_SUBTABLE      0x40
+#define FAST_INVALID       0x60
+#define FAST_OP_KIND(op)   ((op) & 0x70)
+#define FAST_OP_BITS(op)   ((op) & 0x0F)
+
+/* The kind of alphabet a fast table decodes */
+#define FAST_TABLE_CODELENGTHS 0
+#define FAST_TABLE_LITXLEN     1
+#define FAST_TABLE_DISTANCES   2
+
+/* Root table sizes (in bits) and total table capacities (in entries).
+ * The capacities leave a generous margin over the largest tables that
+ * any complete code with at most MAX_BITS bits per code can need.
+ */
+#define FAST_LITXLEN_ROOT_BITS   10
+#define FAST_DISTANCE_ROOT_BITS   8
+#define FAST_CODELENGTH_BITS      7
+#define FAST_LITXLEN_TABLE_SIZE  2048
+#define FAST_DISTANCE_TABLE_SIZE 1024
+
+/* The fast inner loop runs only when it can't run out of buffered
+ * input or output space in one iteration.  Each iteration consumes at
+ * most 48 bits (15 + 5 for the length, 15 + 13 for the distance) and
+ * refills to more than 56, reading at most 8 bytes.  It writes at
+ * most 258 bytes, plus up to 7 bytes of slack for word-sized copies.
+ */
+#define FAST_MIN_INPUT    8
+#define FAST_MIN_OUTPUT   (258 + 8)
+
 /*=========================================================================
  * Macros used internally
  *=======================================================================*/
@@ -160,7 +235,18 @@ typedef struct inflaterState {
     result = huff >> 4;                                            \
     }
 
+/* Size of the buffer through which compressed input is read.  The fast
+ * decoder reads whole words out of this buffer, so a larger buffer
+ * means fewer trips through the slower byte-at-a-time path.
+ */
+#ifndef INFLATEBUFFERSIZE
+#if INFLATE_FAST_DECODER
+#define INFLATEBUFFERSIZE 4096
+#else
 #define INFLATEBUFFERSIZE 256
+#endif
+#endif
+
 unsigned char inflateBuffer[INFLATEBUFFERSIZE];
 int inflateBufferIndex;
 int inflateBufferCount;
@@ -79,6 +79,7 @@ static void clearEvent(VMEventPtr ep);
  *========================================================================*/
 
 static bool_t resumeOK = FALSE;
+static long resumeCount;   /* Number of times resumeOK has been set */
 
 HASHTABLE debuggerHashTable;
 
@@ -149,7 +150,8 @@ static const unsigned char opcodeLengths[] = {
      5, 5, 1,                      /* 200 - 202 */
               3, 3, 3, 3, 3, 3, 3, /* 202 - 209.  Artificial */
      3, 3, 3, 0, 3, 3, 3, 5, 3, 3, /* 210.        Artificial */
-     4, 3, 3, 1                    /* 220 - 223.  Aritificial */
+     4, 3, 3, 1,                   /* 220 - 223.  Aritificial */
+     3, 3, 3, 3, 3, 3, 3, 3        /* 224 - 231.  *_READY */
  };
 
 /*========================================================================
@@ -240,6 +242,9 @@ static void * allocAlignedBytes(long size) {
 
 static void setResumeOK(bool_t val) {
     resumeOK = val;
+    if (val) {
+        resumeCount++;
+    }
 }
 
 /*========================================================================
@@ -2361,6 +2366,7 @@ void handleBreakpoint(THREAD threadArg)
         
         thread->nextOpcode = opcode;
         thread->isAtBreakpoint = TRUE;
+        armDebugInterpreter();
 
         cep = GetCEModifier();
         cep->loc.classID = GET_CLASS_DEBUGGERID(&clazz->clazz);
@@ -2379,6 +2385,32 @@ breakout:
     END_TEMPORARY_ROOTS
 }
 
+/*========================================================================
+ * Function:        updateDebugInterpreter()
+ * Overview:        check whether any thread still needs the checks
+ *                  made by DebugInterpret() before every bytecode
+ * Interface:
+ *   parameters:    none
+ *   returns:       TRUE if the debug interpreter is still needed
+ *
+ * Notes:   Called by DebugInterpret() at each thread switch, so that
+ *      the VM goes back to FastInterpret() once stepping has ended
+ *      and no thread is left stopped at a breakpoint.
+ *=======================================================================*/
+
+bool_t updateDebugInterpreter()
+{
+    THREAD thread;
+
+    for (thread = AllThreads; thread != NULL;
+         thread = thread->nextAliveThread) {
+        if (thread->isStepping || thread->isAtBreakpoint) {
+            return DebugInterpreterArmed = TRUE;
+        }
+    }
+    return DebugInterpreterArmed = FALSE;
+}
+
 /*========================================================================
  * Function:        VirtualMachine_AllClasses()
  * Overview:        send all loaded class id's to the debugger
@@ -2414,16 +2446,15 @@ VirtualMachine_AllClasses(PACKET_INPUT_STREAM_HANDLE inH,
     FOR_ALL_CLASSES(clazz)
         if (IS_ARRAY_CLASS(clazz) ||
               ((INSTANCE_CLASS)clazz)->status >= CLASS_LOADED) { 
-            outStream_writeByte(outH, getJDWPTagType(clazz));
-            outStream_writeClass(outH, clazz);
-            outStream_writeClassName(outH, clazz);
+            long status;
             if (IS_ARRAY_CLASS(clazz)) { 
-                outStream_writeLong(outH, (JDWP_ClassStatus_INITIALIZED |
-                    JDWP_ClassStatus_VERIFIED | JDWP_ClassStatus_PREPARED));
+                status = JDWP_ClassStatus_INITIALIZED |
+                    JDWP_ClassStatus_VERIFIED | JDWP_ClassStatus_PREPARED;
             } else { 
-                outStream_writeLong(outH, 
-                                 getJDWPClassStatus((INSTANCE_CLASS)clazz));
+                status = getJDWPClassStatus((INSTANCE_CLASS)clazz);
             }
+            outStream_writeClassInfo(outH, getJDWPTagType(clazz),
+                                     clazz, status);
         }
     END_FOR_ALL_CLASSES
 }
@@ -3217,10 +3248,9 @@ ThreadReference_Frames(PACKET_INPUT_STREAM_HANDLE inH,
                 /* This is needed to preserve currentFP */
                 stack = currentFP->stack;   /* This is protected, above */
                 fpOffset = (char *)currentFP - (char *)stack;
-                outStream_writeLong(outH, index);
-                outStream_writeLocation(outH, JDWP_TypeTag_CLASS,
-                                        (GET_CLASS_DEBUGGERID(&clazz->clazz)),
-                                        getMethodIndex(method), offset);
+                outStream_writeFrame(outH, index, JDWP_TypeTag_CLASS,
+                                     (GET_CLASS_DEBUGGERID(&clazz->clazz)),
+                                     getMethodIndex(method), offset);
 #if INCLUDEDEBUGCODE
                 if (tracedebugger) { 
                     fprintf(stdout, "    %ld: %s.%s\n", 
@@ -3601,6 +3631,7 @@ static void createEvent(PACKET_INPUT_STREAM_HANDLE inH,
                 /* setup the relevant info */
         thread = GET_VMTHREAD(newMod->u.step.threadID);
                 thread->isStepping = TRUE;
+                armDebugInterpreter();
 /*
                 newMod->u.step.thread->stepInfo.target.cl =
             cep->step.target.cl;
@@ -4087,6 +4118,8 @@ void ProcessDebugCmds(int timeout)
     void **f2Array;
     CommandHandler func;
     Packet *p;
+    long resumes;
+    int count = 0;
 
     if (!vmDebugReady) {
         return;
@@ -4103,56 +4136,68 @@ void ProcessDebugCmds(int timeout)
                                                    GCT_POINTERLIST));
         in->numPointers = 2;
         in->packet = (Packet *)callocObject(SIZEOF_PACKET, GCT_POINTERLIST);
-        in->segment = in->packet->type.cmd.data =
-            (PacketData *)callocObject(SIZEOF_PACKETDATA, GCT_POINTERLIST);
         in->packet->type.cmd.numPointers = 1;
 
-        in->packet->type.cmd.data->data =
-                   (unsigned char *)mallocBytes(MAX_INPUT_PACKET_SIZE);
-        in->segment->numPointers = 1;
-
-        if (dbgReceivePacket(&in) == SYS_ERR) { 
-          /* We most likely lost the connection to the debug agent */
-          VirtualMachine_Resume(&in, &out);
-          vmDebugReady = FALSE;
-          setNotification(0);
-          clearAllBreakpoints();
-          goto getOut;
-        } 
+        /*
+         * Handle the commands that the debugger has already sent, up to
+         * DEBUGGER_COMMAND_BATCH of them, and send all the replies at once.
+         * A command that lets the VM resume ends the batch, since the code
+         * waiting in processBreakCommands() must run before the next one.
+         */
+        do {
+            in->segment = in->packet->type.cmd.data =
+                (PacketData *)callocObject(SIZEOF_PACKETDATA, GCT_POINTERLIST);
+
+            if (dbgReceivePacket(&in) == SYS_ERR) { 
+              /* We most likely lost the connection to the debug agent */
+              VirtualMachine_Resume(&in, &out);
+              vmDebugReady = FALSE;
+              setNotification(0);
+              clearAllBreakpoints();
+              goto getOut;
+            } 
 
-        p = in->packet;
-        if (p->type.cmd.flags & FLAGS_Reply) {
-            /* It's a reply, just drop it */
-            goto getOut;
-        }
-        cmd = &p->type.cmd;
+            p = in->packet;
+            if (p->type.cmd.flags & FLAGS_Reply) {
+                /* It's a reply, just drop it */
+                continue;
+            }
+            cmd = &p->type.cmd;
 
-        if (cmd->cmdSet == KVM_CMDSET) {
-            f2Array = (void **)funcArray[0];
-        } else {
-            if (cmd->cmdSet == 0 || cmd->cmdSet > JDWP_HIGHEST_COMMAND_SET) {
-                fprintf(stderr, KVM_MSG_UNKNOWN_DEBUGGER_COMMAND_SET);
+            if (cmd->cmdSet == KVM_CMDSET) {
+                f2Array = (void **)funcArray[0];
+            } else {
+                if (cmd->cmdSet == 0 || cmd->cmdSet > JDWP_HIGHEST_COMMAND_SET) {
+                    fprintf(stderr, KVM_MSG_UNKNOWN_DEBUGGER_COMMAND_SET);
+                    VM_EXIT(0);
+                }
+                f2Array = (void **)funcArray[cmd->cmdSet];
+            }
+            if (f2Array == NULL || cmd->cmd > (int)f2Array[0]) {
+                fprintf(stderr, KVM_MSG_UNKNOWN_JDWP_COMMAND);
                 VM_EXIT(0);
             }
-            f2Array = (void **)funcArray[cmd->cmdSet];
-        }
-        if (f2Array == NULL || cmd->cmd > (int)f2Array[0]) {
-            fprintf(stderr, KVM_MSG_UNKNOWN_JDWP_COMMAND);
-            VM_EXIT(0);
-        }
-        func = (CommandHandler)(f2Array[cmd->cmd]);
+            func = (CommandHandler)(f2Array[cmd->cmd]);
 
-        outStream_initReply(&out, inStream_id(&in));
-        inStream_init(&in);
+            outStream_initReply(&out, inStream_id(&in));
+            inStream_init(&in);
 
-        waitOnSuspend = FALSE;
+            waitOnSuspend = FALSE;
+            resumes = resumeCount;
         
-        func(&in, &out);
+            func(&in, &out);
 
-        if (inStream_error(&in)) {
-            outStream_setError(&out, inStream_error(&in));
-        }
-        outStream_sendReply(&out);
+            if (inStream_error(&in)) {
+                outStream_setError(&out, inStream_error(&in));
+            }
+            outStream_sendReply(&out);
+            if (resumeCount != resumes) {
+                break;
+            }
+        } while (vmDebugReady && ++count < DEBUGGER_COMMAND_BATCH &&
+                 dbgPacketAvail());
+
+        dbgFlushOutput();
 getOut:
     END_TEMPORARY_ROOTS
 }
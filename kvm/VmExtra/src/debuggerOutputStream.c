@@ -78,6 +78,16 @@ outStream_initReply(PACKET_OUTPUT_STREAM_HANDLE outH, long id)
     stream->packet->type.cmd.flags = FLAGS_Reply;
 }
 
+/* Stores a 32-bit value in network byte order */
+static void
+putInt(unsigned char *buffer, unsigned long value)
+{
+    buffer[0] = (unsigned char)(value >> 24);
+    buffer[1] = (unsigned char)(value >> 16);
+    buffer[2] = (unsigned char)(value >> 8);
+    buffer[3] = (unsigned char)value;
+}
+
 static void
 writeBytes(PACKET_OUTPUT_STREAM_HANDLE outH, void *source, 
            long size, bool_t isHandle)
@@ -105,7 +115,9 @@ writeBytes(PACKET_OUTPUT_STREAM_HANDLE outH, void *source,
     while (size > 0) {
         long count;
         if (stream->left == 0) {
-            int segSize = MAX_SEGMENT_SIZE;
+            /* Each segment is twice as large as the previous one, */
+            /* so that large replies need only a few segments */
+            long segSize = MIN(stream->segment->index * 2, MAX_SEGMENT_SIZE);
             unhand(outH)->segment->next =
                 (struct PacketData *)callocObject(SIZEOF_PACKETDATA,
                                                   GCT_POINTERLIST);
@@ -181,11 +193,29 @@ outStream_writeLong(PACKET_OUTPUT_STREAM_HANDLE outH, long val)
 void
 outStream_writeLong64(PACKET_OUTPUT_STREAM_HANDLE outH, unsigned long val)
 {
-    long zero = 0;
+    unsigned char buffer[8];
 
-    val = HOST_TO_JAVA_INT(val);
-    writeBytes(outH, &zero, sizeof(zero), FALSE);
-    writeBytes(outH, &val, sizeof(val), FALSE);
+    putInt(&buffer[0], 0);
+    putInt(&buffer[4], val);
+    writeBytes(outH, buffer, sizeof(buffer), FALSE);
+}
+
+/*
+ * The functions below write the records that make up the larger
+ * replies with a single call to writeBytes(), rather than one call
+ * for each field.
+ */
+
+/* Stores tag, class, method and 64-bit offset in buffer */
+static void
+putLocation(unsigned char *buffer, BYTE tag, long clazzID, 
+            long methodID, unsigned long loc)
+{
+    buffer[0] = tag;
+    putInt(&buffer[1], clazzID);
+    putInt(&buffer[5], methodID);
+    putInt(&buffer[9], 0);
+    putInt(&buffer[13], loc);
 }
 
 void
@@ -193,10 +223,37 @@ outStream_writeLocation(PACKET_OUTPUT_STREAM_HANDLE outH,
                         BYTE tag, long clazzID, 
                         long methodID, unsigned long loc)
 {
-    outStream_writeByte(outH, tag);
-    outStream_writeLong(outH, clazzID);
-    outStream_writeLong(outH, methodID);
-    outStream_writeLong64(outH, loc);
+    unsigned char buffer[LOCATION_SIZE];
+
+    putLocation(buffer, tag, clazzID, methodID, loc);
+    writeBytes(outH, buffer, sizeof(buffer), FALSE);
+}
+
+/* A frame of ThreadReference.Frames: frame ID and location */
+void
+outStream_writeFrame(PACKET_OUTPUT_STREAM_HANDLE outH, long frameID,
+                     BYTE tag, long clazzID, 
+                     long methodID, unsigned long loc)
+{
+    unsigned char buffer[4 + LOCATION_SIZE];
+
+    putInt(buffer, frameID);
+    putLocation(&buffer[4], tag, clazzID, methodID, loc);
+    writeBytes(outH, buffer, sizeof(buffer), FALSE);
+}
+
+/* A class of VirtualMachine.AllClasses: tag, class, signature, status */
+void
+outStream_writeClassInfo(PACKET_OUTPUT_STREAM_HANDLE outH, BYTE tag,
+                         CLASS clazz, long status)
+{
+    unsigned char buffer[5];
+
+    buffer[0] = tag;
+    putInt(&buffer[1], GET_CLASS_DEBUGGERID(clazz));
+    writeBytes(outH, buffer, sizeof(buffer), FALSE);
+    outStream_writeClassName(outH, clazz);
+    outStream_writeLong(outH, status);
 }
 
 void
@@ -246,12 +303,14 @@ outStream_writeClassName(PACKET_OUTPUT_STREAM_HANDLE outH, CLASS clazz)
     } else { 
         char *packageName = UStringInfo(clazz->packageName);
         if (IS_ARRAY_CLASS(clazz)) {
+            int depth = 0;
             outStream_writeLong(outH, packageNameLength + baseNameLength + 1);
             /* Output  the '[' that are at the beginning of the name */
-            while (baseName[0] == '[') { 
-                outStream_writeByte(outH, '[');
-                baseName++; baseNameLength--;
+            while (baseName[depth] == '[') { 
+                depth++;
             }
+            writeBytes(outH, baseName, depth, FALSE);
+            baseName += depth; baseNameLength -= depth;
             outStream_writeByte(outH, 'L');
             writeBytes(outH, packageName, packageNameLength, FALSE);
             outStream_writeByte(outH, '/');
@@ -305,7 +364,9 @@ outStream_sendCommand(PACKET_OUTPUT_STREAM_HANDLE outH)
     int error;
     PACKET_OUTPUT_STREAM stream = unhand(outH);
     if (!stream->error) {
+        /* Events are not part of a batch of replies; send them now */
         error = dbgSendPacket(stream->packet);
+        dbgFlushOutput();
     } 
 }
 
@@ -100,34 +100,65 @@ int listenSocket;
 int errno;
 #endif
 
+/*=========================================================================
+ * I/O buffers
+ *=======================================================================*/
+
+/*
+ * Packets are read from the socket in as large pieces as are available,
+ * so that several commands sent back to back by the debugger can be
+ * taken from one read.  Replies are collected in the output buffer and
+ * sent together when dbgFlushOutput() is called, instead of writing each
+ * field of the packet header to the socket on its own.  Packet data that
+ * doesn't fit in the buffers is read and written directly.
+ */
+
+static unsigned char dbgInBuffer[DEBUGGER_IO_BUFFER_SIZE];
+static int dbgInStart;          /* First unread byte in dbgInBuffer */
+static int dbgInEnd;            /* End of the data in dbgInBuffer */
+
+static unsigned char dbgOutBuffer[DEBUGGER_IO_BUFFER_SIZE];
+static int dbgOutLength;        /* Bytes waiting in dbgOutBuffer */
+
+#define PACKET_HEADER_SIZE 11
+
 /*=========================================================================
  * Functions
  *=======================================================================*/
 
+static unsigned long getPacketInt(unsigned char *p)
+{
+    return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) |
+           ((unsigned long)p[2] << 8)  |  (unsigned long)p[3];
+}
+
+static void putPacketInt(unsigned char *p, unsigned long value)
+{
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)value;
+}
+
 /*
  * Select on the dbgSocket and wait for a character to arrive.
  * Timeout is in millisecs.
  */
 
-bool_t dbgCharAvail(int timeout)
+static bool_t socketReadable(int timeout)
 {
     fd_set readFDs, writeFDs, exceptFDs;
     int numFDs = 0;
     int width;
     struct timeval tv, *tvp;
 
-    if (dbgSocket == 0)
-        return FALSE;
     FD_ZERO(&readFDs);
     FD_ZERO(&writeFDs);
     FD_ZERO(&exceptFDs);
     FD_SET((unsigned int)dbgSocket, &readFDs);
     width = dbgSocket;
     if (timeout == -1) {
-        tv.tv_sec = 0;
-        tv.tv_usec = 20000;
-        tvp = &tv;
-    tvp = NULL;
+        tvp = NULL;
     } else {
         tv.tv_sec = timeout / 1000;
         tv.tv_usec = (timeout % 1000) * 1000;
@@ -142,12 +173,31 @@ bool_t dbgCharAvail(int timeout)
     }
 }
 
+bool_t dbgCharAvail(int timeout)
+{
+    if (dbgSocket == 0)
+        return FALSE;
+    if (dbgInEnd > dbgInStart)
+        return TRUE;
+    /* The debugger may be waiting for our replies before it sends more */
+    if (dbgFlushOutput() == SYS_ERR)
+        return TRUE;    /* so that the caller sees the lost connection */
+    return socketReadable(timeout);
+}
+
 static int dbgWriteX(int fd, void *buf, int len)
 {
-    int bytes;
+    char *ptr = buf;
+    int total = 0;
 
-    bytes = send(fd, buf, len, 0);
-    return (bytes);
+    while (total < len) {
+        int bytes = send(fd, ptr + total, len - total, 0);
+        if (bytes <= 0) {
+            return total;
+        }
+        total += bytes;
+    }
+    return total;
 }
 
 int dbgWrite(void *buf, int len)
@@ -156,55 +206,84 @@ int dbgWrite(void *buf, int len)
 
     if (dbgSocket == 0)
         return 0;
+    if (dbgFlushOutput() == SYS_ERR)
+        return 0;
     bytes = dbgWriteX(dbgSocket, buf, len);
     return (bytes);
 }
 
+/*
+ * Send the packets collected in the output buffer
+ */
+
+int dbgFlushOutput()
+{
+    int length = dbgOutLength;
+
+    dbgOutLength = 0;
+    if (length == 0 || dbgSocket == 0)
+        return SYS_OK;
+    if (dbgWriteX(dbgSocket, dbgOutBuffer, length) != length)
+        return SYS_ERR;
+    return SYS_OK;
+}
+
+static int bufferOutput(void *buf, long len)
+{
+    if (dbgOutLength + len > DEBUGGER_IO_BUFFER_SIZE) {
+        if (dbgFlushOutput() == SYS_ERR)
+            return SYS_ERR;
+        if (len > DEBUGGER_IO_BUFFER_SIZE) {
+            /* Large data goes straight to the socket */
+            if (dbgWriteX(dbgSocket, buf, len) != len)
+                return SYS_ERR;
+            return SYS_OK;
+        }
+    }
+    memcpy(&dbgOutBuffer[dbgOutLength], buf, len);
+    dbgOutLength += len;
+    return SYS_OK;
+}
+
+/*
+ * Add a packet to the output buffer.  The packet is sent when the
+ * buffer fills up or dbgFlushOutput() is called.
+ */
+
 int dbgSendPacket(struct Packet *packet)
 {
-    long len = 11; /* size of packet header */
+    unsigned char header[PACKET_HEADER_SIZE];
+    long len = PACKET_HEADER_SIZE;
     struct PacketData *data;
 
+    if (dbgSocket == 0)
+        return SYS_ERR;
+
     data = packet->type.cmd.data;
     do {
         len += data->length;
         data = data->next;
     } while (data != NULL);
 
-    len = (long)htonl(len);
-
-    if (dbgWriteX(dbgSocket,&len,sizeof(long)) != sizeof(long))
-        return SYS_ERR;
-
-    packet->type.cmd.id = (long)htonl(packet->type.cmd.id);
-
-    if (dbgWriteX(dbgSocket, &(packet->type.cmd.id),sizeof(long)) != sizeof(long))
-        return SYS_ERR;
-
-    if (dbgWriteX(dbgSocket, &(packet->type.cmd.flags),sizeof(unsigned char)) != sizeof(unsigned char))
-        return SYS_ERR;
-
+    putPacketInt(&header[0], len);
+    putPacketInt(&header[4], packet->type.cmd.id);
+    header[8] = packet->type.cmd.flags;
     if (packet->type.cmd.flags & FLAGS_Reply) {
-        short errorCode = htons(packet->type.reply.errorCode);
-        if (dbgWriteX(dbgSocket, &(errorCode)
-                     ,sizeof(short)) != sizeof(short))
-            return SYS_ERR;
+        header[9]  = (unsigned char)(packet->type.reply.errorCode >> 8);
+        header[10] = (unsigned char)packet->type.reply.errorCode;
     } else {
-        if (dbgWriteX(dbgSocket, &(packet->type.cmd.cmdSet)
-                     ,sizeof(unsigned char)) != sizeof(unsigned char))
-            return SYS_ERR;
-    
-        if (dbgWriteX(dbgSocket,(char *)&(packet->type.cmd.cmd)
-                     ,sizeof(unsigned char)) != sizeof(unsigned char))
-            return SYS_ERR;
+        header[9]  = packet->type.cmd.cmdSet;
+        header[10] = packet->type.cmd.cmd;
     }
+    if (bufferOutput(header, PACKET_HEADER_SIZE) == SYS_ERR)
+        return SYS_ERR;
 
     data = packet->type.cmd.data;
     do {
         if (data->length == 0)
             break;
 
-        if (dbgWriteX(dbgSocket,(char *)data->data,data->length) != data->length)
+        if (bufferOutput(data->data, data->length) == SYS_ERR)
             return SYS_ERR;
 
         data = data->next;
@@ -216,137 +295,167 @@ int dbgSendPacket(struct Packet *packet)
 void dbgFlush()
 {
     char buf[16];
+
+    dbgInStart = dbgInEnd = 0;
     while (dbgRead(buf, 16, 0) > 0)
         continue;
 }
 
-int dbgRead(void *buf, int len, int blockflag)
+/*
+ * Read as much as is available from the socket into the input buffer.
+ * Returns the number of bytes read, or 0 if the connection is closed.
+ */
+
+static int fillInputBuffer()
 {
     int nread;
-    unsigned long nleft = len;
-    char *ptr = buf;
-    unsigned long total = 0;
-    int error;
 
-    if (dbgSocket == 0)
+    if (dbgInStart == dbgInEnd) {
+        dbgInStart = dbgInEnd = 0;
+    } else if (dbgInStart > 0) {
+        memmove(dbgInBuffer, &dbgInBuffer[dbgInStart], dbgInEnd - dbgInStart);
+        dbgInEnd -= dbgInStart;
+        dbgInStart = 0;
+    }
+    if (dbgInEnd == DEBUGGER_IO_BUFFER_SIZE) {
         return 0;
+    }
     do {
-        nread = recv(dbgSocket, ptr, nleft, 0);
-        /* socket is non-blocking so check for errwouldblock */
+        nread = recv(dbgSocket, (char *)&dbgInBuffer[dbgInEnd],
+                     DEBUGGER_IO_BUFFER_SIZE - dbgInEnd, 0);
 #if NONBLOCKING
-        if (nread < 0 && errno != EWOULDBLOCK) {
-            return 0;
-        }
+    } while (nread < 0 && errno == EWOULDBLOCK);
 #else
-        if (nread < 0) {
-            error = errno;
-            return 0;
-        }
+    } while (0);
 #endif /* NONBLOCKING */
-        /*
-         * just return what we've read so far (may be zero, that's ok)
-         * at this point if nread < 0 then err == netErrWouldBlock
-         */
-        if (nread < 0 && !blockflag)
-            break;
-        if (nread < 0)
-            continue;    /* only get here if nread < 0 AND */
-                    /* err == netErrWouldBlock AND blockflag true */
-        /* if we got zero back then the connection is closed so return -1 */
-        if (nread == 0) {
-            if (total > 0)
-                return total;
-            else
-                return 0;
-        }
-        total += nread;
-        nleft -= nread;
-        ptr   += nread;
-    } while (nleft);
+    if (nread <= 0) {
+        return 0;
+    }
+    dbgInEnd += nread;
+    return nread;
+}
 
+int dbgRead(void *buf, int len, int blockflag)
+{
+    char *ptr = buf;
+    int total = 0;
+
+    if (dbgSocket == 0)
+        return 0;
+    while (total < len) {
+        int count = dbgInEnd - dbgInStart;
+        if (count > 0) {
+            count = MIN(count, len - total);
+            memcpy(ptr + total, &dbgInBuffer[dbgInStart], count);
+            dbgInStart += count;
+            total += count;
+        } else if (len - total >= DEBUGGER_IO_BUFFER_SIZE) {
+            /* Large data is read directly into place */
+            int nread = recv(dbgSocket, ptr + total, len - total, 0);
+            if (nread <= 0) {
+                break;
+            }
+            total += nread;
+        } else {
+            if (!blockflag && !socketReadable(0)) {
+                break;
+            }
+            dbgFlushOutput();
+            if (fillInputBuffer() == 0) {
+                break;
+            }
+        }
+    }
     return total;
 }
 
-int dbgReceivePacket(PACKET_INPUT_STREAM_HANDLE streamH)
+/*
+ * Check whether a complete packet can be read without waiting.
+ * Used to handle the commands sent back to back by the debugger
+ * together, and to send their replies together.
+ */
+
+bool_t dbgPacketAvail()
 {
-    long length, readLength;
-    unsigned char *readBuf;
-    unsigned char *newSeg;
-    PACKET_INPUT_STREAM stream = unhand(streamH);
-    Packet *pkt = stream->packet;
-    int sysError;
-
-    sysError = SYS_OK;
-    if (dbgRead(&length, sizeof(long), TRUE) < sizeof(long)) {
-        return SYS_ERR;
+    int available;
+
+    if (dbgSocket == 0)
+        return FALSE;
+    available = dbgInEnd - dbgInStart;
+    if (available < PACKET_HEADER_SIZE ||
+          available < (long)getPacketInt(&dbgInBuffer[dbgInStart])) {
+        if (!socketReadable(0) || fillInputBuffer() == 0) {
+            return FALSE;
+        }
+        available = dbgInEnd - dbgInStart;
     }
-    length = ntohl(length);
-    if (dbgRead(&(pkt->type.cmd.id), sizeof(long), TRUE) < sizeof(long)) {
+    /* Packets larger than the buffer are always read in pieces */
+    return available >= PACKET_HEADER_SIZE &&
+        (available >= (long)getPacketInt(&dbgInBuffer[dbgInStart]) ||
+         dbgInEnd - dbgInStart == DEBUGGER_IO_BUFFER_SIZE);
+}
+
+/*
+ * Drop the connection to the debugger after a malformed packet.
+ * The stream can't be resynchronized, so reading from it again
+ * would only misinterpret the rest of the packet.
+ */
+
+static void dropConnection()
+{
+    shutdown(dbgSocket, 2);
+    close(dbgSocket);
+    dbgSocket = 0;
+    dbgInStart = dbgInEnd = 0;
+    dbgOutLength = 0;
+}
+
+/*
+ * Read a packet.  The data of the packet is read into a single segment
+ * of the exact size of the data.  Packets longer than
+ * MAX_INPUT_PACKET_SIZE are rejected, and the connection is dropped.
+ */
+
+int dbgReceivePacket(PACKET_INPUT_STREAM_HANDLE streamH)
+{
+    unsigned char header[PACKET_HEADER_SIZE];
+    long length;
+    unsigned char *data;
+    PACKET_INPUT_STREAM stream;
+    Packet *pkt;
+
+    if (dbgRead(header, PACKET_HEADER_SIZE, TRUE) < PACKET_HEADER_SIZE) {
         return SYS_ERR;
     }
-    pkt->type.cmd.id = htonl(pkt->type.cmd.id);
-    if (dbgRead(&(pkt->type.cmd.flags), sizeof(unsigned char), TRUE) <
-        sizeof (unsigned char)) {
+    length = (long)getPacketInt(&header[0]) - PACKET_HEADER_SIZE;
+    if (length < 0 || length > MAX_INPUT_PACKET_SIZE - PACKET_HEADER_SIZE) {
+        dropConnection();
         return SYS_ERR;
     }
+
+    stream = unhand(streamH);
+    pkt = stream->packet;
+    pkt->type.cmd.id = (long)getPacketInt(&header[4]);
+    pkt->type.cmd.flags = header[8];
     if (pkt->type.cmd.flags & FLAGS_Reply) {
-        if (dbgRead(&(pkt->type.reply.errorCode), sizeof(short),
-            TRUE) < sizeof(short)) {
-            return SYS_ERR;
-        }
+        pkt->type.reply.errorCode = (short)((header[9] << 8) | header[10]);
     } else {
-        if (dbgRead(&(pkt->type.cmd.cmdSet), sizeof(unsigned char),
-            TRUE) < sizeof(unsigned char)) {
-                return SYS_ERR;
-            }
-        if (dbgRead(&(pkt->type.cmd.cmd), sizeof(unsigned char),
-            TRUE) < sizeof(unsigned char)) {
-                return SYS_ERR;
-            }
+        pkt->type.cmd.cmdSet = header[9];
+        pkt->type.cmd.cmd = header[10];
     }
-    length -= ((sizeof(long) * 2) + (sizeof(unsigned char)*3));
 
-    if (length < 0) {
-        return SYS_ERR;
-    } else if (length == 0) {
-        stream->segment->length = 0;
+    stream->segment->length = length;
+    if (length == 0) {
         return SYS_OK;
-    } else {
-        readBuf = stream->segment->data;
-        while (length > 0) {
-            if (readBuf == NULL) {
-                sysError = SYS_ERR;
-                goto breakout;
-            }
-
-            /* XXXX */
-            if ((readLength = length) > MAX_INPUT_PACKET_SIZE) {
-                readLength = MAX_INPUT_PACKET_SIZE;
-            }
-            stream->segment->length = readLength;
-
-            if (dbgRead(readBuf, readLength, TRUE) != readLength) {
-                sysError = SYS_ERR;
-                goto breakout;
-            }
-            length -= readLength;
-            if (length == 0) { 
-                break;
-            }
-            unhand(streamH)->segment->next =
-                (struct PacketData *)callocObject(SIZEOF_PACKETDATA,
-                                                  GCT_POINTERLIST);
-            unhand(streamH)->segment->numPointers = 2;
-            newSeg = (unsigned char *)mallocBytes(MAX_INPUT_PACKET_SIZE);
-            stream = unhand(streamH);
-            stream->segment->next->data = newSeg;
-            stream->segment->next->numPointers = 1;
-            stream->segment = stream->segment->next;
-            readBuf = stream->segment->data;
-        }
-breakout:
-        return sysError;
     }
+    data = (unsigned char *)mallocBytes(length);
+    stream = unhand(streamH);   /* GC may have happened */
+    stream->segment->data = data;
+    stream->segment->numPointers = 1;
+    if (dbgRead(data, length, TRUE) != length) {
+        return SYS_ERR;
+    }
+    return SYS_OK;
 }
 
 /*=========================================================================
@@ -496,6 +605,7 @@ void CloseDebuggerIO()
     struct timeval tv;
 
     if (dbgSocket) {
+        dbgFlushOutput();
         FD_ZERO(&readFDs);
         FD_ZERO(&writeFDs);
         FD_ZERO(&exceptFDs);
@@ -514,6 +624,8 @@ void CloseDebuggerIO()
     }
     dbgSocket = 0;
     listenSocket = 0;
+    dbgInStart = dbgInEnd = 0;
+    dbgOutLength = 0;
 }
 
 bool_t dbgInitialized()
@@ -42,6 +42,10 @@
 
 #include <global.h>
 
+#if USE_SSE2_MATH
+#include <emmintrin.h>
+#endif
+
 static const double
 one   =  1.00000000000000000000e+00, /* 0x3FF00000, 0x00000000 */
 pio4  =  7.85398163397448278999e-01, /* 0x3FE921FB, 0x54442D18 */
@@ -85,8 +89,26 @@ double __kernel_tan(double x, double y, int iy) {
      *    x^5(T[1]+x^4*T[3]+...+x^20*T[11]) +
      *    x^5(x^2*(T[2]+x^4*T[4]+...+x^22*[T12]))
      */
+#if USE_SSE2_MATH
+    {
+        /* Evaluate both halves at once: the low lane holds the odd
+         * coefficients, the high lane the even ones.  Each lane does
+         * exactly the same multiplications and additions in the same
+         * order as the C code below, so the results are identical */
+        __m128d ww = _mm_set1_pd(w);
+        __m128d p  = _mm_set_pd(T[12], T[11]);
+        p = _mm_add_pd(_mm_set_pd(T[10], T[9]), _mm_mul_pd(ww, p));
+        p = _mm_add_pd(_mm_set_pd(T[8],  T[7]), _mm_mul_pd(ww, p));
+        p = _mm_add_pd(_mm_set_pd(T[6],  T[5]), _mm_mul_pd(ww, p));
+        p = _mm_add_pd(_mm_set_pd(T[4],  T[3]), _mm_mul_pd(ww, p));
+        p = _mm_add_pd(_mm_set_pd(T[2],  T[1]), _mm_mul_pd(ww, p));
+        r = _mm_cvtsd_f64(p);
+        v = z*_mm_cvtsd_f64(_mm_unpackhi_pd(p, p));
+    }
+#else
     r = T[1]+w*(T[3]+w*(T[5]+w*(T[7]+w*(T[9]+w*T[11]))));
     v = z*(T[2]+w*(T[4]+w*(T[6]+w*(T[8]+w*(T[10]+w*T[12])))));
+#endif
     s = z*x;
     r = y + z*(s*(r+v)+y);
     r += T[0]*s;
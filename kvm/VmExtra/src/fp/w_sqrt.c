@@ -11,8 +11,21 @@
 
 #include <global.h>
 
+#if USE_SSE2_MATH
+#include <emmintrin.h>
+#endif
+
 double JFP_lib_sqrt(double x) {
+#if USE_SSE2_MATH
+    /* SQRTSD is correctly rounded, and so is __ieee754_sqrt.  The
+     * special cases agree too: sqrt(-0) is -0, a NaN is returned
+     * unchanged (quieted), and a negative number or -Inf gives the
+     * default NaN, as (x-x)/(x-x) does in e_sqrt.c */
+    __m128d value = _mm_set_sd(x);
+    return _mm_cvtsd_f64(_mm_sqrt_sd(value, value));
+#else
     return __ieee754_sqrt(x);
+#endif
 }
 
 
@@ -56,6 +56,17 @@ static HuffmanCodeTable *makeCodeTable(inflaterState *state,
 static bool_t inflateHuffman(inflaterState *state, bool_t fixedHuffman);
 static bool_t inflateStored(inflaterState *state);
 
+#if INFLATE_FAST_DECODER
+static bool_t inflateHuffmanFast(inflaterState *state, bool_t fixedHuffman);
+static bool_t decodeDynamicHuffmanTablesFast(inflaterState *state);
+static bool_t makeFastCodeTable(unsigned char *codelen, unsigned numElems,
+                                int kind, unsigned rootBits,
+                                fastHuffmanEntry *table, unsigned tableSize);
+
+static fastHuffmanEntry fastLitxlenTable[FAST_LITXLEN_TABLE_SIZE];
+static fastHuffmanEntry fastDistanceTable[FAST_DISTANCE_TABLE_SIZE];
+#endif /* INFLATE_FAST_DECODER */
+
 /*=========================================================================
  * Decompression functions
  *=======================================================================*/
@@ -178,6 +189,15 @@ inflateData(void *compData, /* compressed data source */
                 result = inflateStored(state);
                 break;
 
+#if INFLATE_FAST_DECODER
+            case BTYPE_FIXED_HUFFMAN:
+                result = inflateHuffmanFast(state, TRUE);
+                break;
+
+            case BTYPE_DYNA_HUFFMAN:
+                result = inflateHuffmanFast(state, FALSE);
+                break;
+#else
             case BTYPE_FIXED_HUFFMAN:
                 result = inflateHuffman(state, TRUE);
                 break;
@@ -187,6 +207,7 @@ inflateData(void *compData, /* compressed data source */
                     result = inflateHuffman(state, FALSE);
                 END_TEMPORARY_ROOTS
                 break;
+#endif /* INFLATE_FAST_DECODER */
         }
         if (!result) { 
             break;
@@ -734,6 +755,531 @@ makeCodeTable(inflaterState *state,
     return table;
 }
 
+#if INFLATE_FAST_DECODER
+
+/*=========================================================================
+ * Fast decoder
+ *=======================================================================*/
+
+/* The fast decoder keeps its bits in a 64-bit buffer.  These macros
+ * are the counterparts of NEEDBITS, NEXTBITS and DUMPBITS above.
+ */
+
+#define FAST_NEEDBITS(j) {                                      \
+      while (bitCount < (j)) {                                  \
+           bitBuf |= ((ulong64)NEXTBYTE) << bitCount;           \
+           inRemaining--; bitCount += 8;                        \
+      }                                                         \
+}
+
+#define FAST_NEXTBITS(j) \
+       ((unsigned int)bitBuf & ((1 << (j)) - 1))
+
+#define FAST_DUMPBITS(j) {                                      \
+       ASSERT((j) <= bitCount);                                 \
+       bitBuf >>= (j);                                          \
+       bitCount -= (j);                                         \
+    }
+
+/* Fill the bit buffer to more than 56 bits straight out of
+ * inflateBuffer.  The caller guarantees that at least FAST_MIN_INPUT
+ * bytes are buffered.
+ */
+#define FAST_REFILL {                                                    \
+      while (bitCount <= 56) {                                           \
+           bitBuf |= ((ulong64)inflateBuffer[inflateBufferIndex++])      \
+                         << bitCount;                                    \
+           inflateBufferCount--; inRemaining--; bitCount += 8;           \
+      }                                                                  \
+}
+
+/* Decode one symbol using the given fast table. The bits of the code
+ * must already be in the bit buffer.
+ */
+#define FAST_DECODE(table, rootBits, entry) {                            \
+      entry = table[FAST_NEXTBITS(rootBits)];                            \
+      if (FAST_OP_KIND(entry.op) == FAST_SUBTABLE) {                     \
+          FAST_DUMPBITS(entry.bits);                                     \
+          entry = table[entry.value +                                    \
+                        FAST_NEXTBITS(FAST_OP_BITS(entry.op))];          \
+      }                                                                  \
+      FAST_DUMPBITS(entry.bits);                                         \
+}
+
+/* Can the unchecked inner loop run one more iteration? */
+#define FAST_LOOP_OK                                                     \
+    (inflateBufferCount >= FAST_MIN_INPUT && inRemaining >= FAST_MIN_INPUT \
+     && outLength - outOffset >= FAST_MIN_OUTPUT)
+
+/*=========================================================================
+ * FUNCTION:  inflateHuffmanFast
+ * TYPE:      Huffman block decoding
+ * INTERFACE:
+ *   parameters: inflater state, TRUE for a block with fixed Huffman codes
+ *   returns:    TRUE if the block was decoded successfully, or
+ *               FALSE if an error occurs
+ * NOTE:
+ *    While there is plenty of buffered input and room for output, the
+ *    inner loop refills the bit buffer from inflateBuffer a word at a
+ *    time and decodes without any bounds checks on the input.  Near the
+ *    end of the input or output it falls back to decoding one checked
+ *    symbol at a time, reading input with NEXTBYTE just as inflateHuffman
+ *    does.
+ *
+ *    The rest of the inflater assumes that no more than 32 bits are
+ *    held in state->inData.  Bytes that the inner loop has read ahead
+ *    are therefore pushed back into inflateBuffer whenever it exits.
+ *    That is always possible, since the inner loop never refills
+ *    inflateBuffer itself.
+ *=========================================================================*/
+
+static bool_t
+inflateHuffmanFast(inflaterState *state, bool_t fixedHuffman)
+{
+    void *inFile = state->inFile;
+    JarGetByteFunctionType getBytes = state->getBytes;
+    register ulong64 bitBuf;
+    register unsigned int bitCount;
+    register long inRemaining;
+    register unsigned char *outFile;
+    unsigned long outLength = state->outLength;
+    unsigned long outOffset = state->outOffset;
+    unsigned int litxlenBits, distanceBits;
+    const fastHuffmanEntry *lcodes = fastLitxlenTable;
+    const fastHuffmanEntry *dcodes = fastDistanceTable;
+    bool_t noerror = FALSE;
+
+    if (fixedHuffman) {
+        unsigned char codelen[288];
+        memset(codelen, 8, 144);
+        memset(codelen + 144, 9, 256 - 144);
+        memset(codelen + 256, 7, 280 - 256);
+        memset(codelen + 280, 8, 288 - 280);
+        if (!makeFastCodeTable(codelen, 288, FAST_TABLE_LITXLEN,
+                               FAST_LITXLEN_ROOT_BITS, fastLitxlenTable,
+                               FAST_LITXLEN_TABLE_SIZE)) {
+            return FALSE;
+        }
+        memset(codelen, 5, 32);
+        if (!makeFastCodeTable(codelen, 32, FAST_TABLE_DISTANCES,
+                               FAST_DISTANCE_ROOT_BITS, fastDistanceTable,
+                               FAST_DISTANCE_TABLE_SIZE)) {
+            return FALSE;
+        }
+    } else if (!decodeDynamicHuffmanTablesFast(state)) {
+        return FALSE;
+    }
+
+    litxlenBits = FAST_LITXLEN_ROOT_BITS;
+    distanceBits = FAST_DISTANCE_ROOT_BITS;
+
+    bitBuf = state->inData;
+    bitCount = state->inDataSize;
+    inRemaining = state->inRemaining;
+
+    ASSERTING_NO_ALLOCATION
+    outFile = unhand(state->outFileH);
+
+    for (;;) {
+        fastHuffmanEntry entry;
+        unsigned int length, distance;
+
+        if (FAST_LOOP_OK) {
+            long startRemaining = inRemaining;
+            long readAhead;
+            bool_t endOfBlock = FALSE;
+            bool_t failed = FALSE;
+
+            do {
+                FAST_REFILL;
+                FAST_DECODE(lcodes, litxlenBits, entry);
+                if (entry.op == FAST_LITERAL) {
+                    outFile[outOffset++] = (unsigned char)entry.value;
+                    continue;
+                } else if (FAST_OP_KIND(entry.op) != FAST_BASE) {
+                    if (entry.op == FAST_END_OF_BLOCK) {
+                        endOfBlock = TRUE;
+                    } else {
+                        ziperr(KVM_MSG_JAR_INVALID_LITERAL_OR_LENGTH);
+                        failed = TRUE;
+                    }
+                    break;
+                }
+                length = entry.value + FAST_NEXTBITS(FAST_OP_BITS(entry.op));
+                FAST_DUMPBITS(FAST_OP_BITS(entry.op));
+
+                FAST_DECODE(dcodes, distanceBits, entry);
+                if (FAST_OP_KIND(entry.op) != FAST_BASE) {
+                    ziperr(KVM_MSG_JAR_BAD_DISTANCE_CODE);
+                    failed = TRUE;
+                    break;
+                }
+                distance = entry.value + FAST_NEXTBITS(FAST_OP_BITS(entry.op));
+                FAST_DUMPBITS(FAST_OP_BITS(entry.op));
+
+                if (outOffset < distance) {
+                    ziperr(KVM_MSG_JAR_COPY_UNDERFLOW);
+                    failed = TRUE;
+                    break;
+                } else {
+                    unsigned char *to = outFile + outOffset;
+                    unsigned char *from = to - distance;
+                    unsigned char *end = to + length;
+                    if (distance >= 8) {
+                        /* Copy a word at a time.  This may write up to 7
+                         * bytes beyond the end of the match, which
+                         * FAST_MIN_OUTPUT leaves room for.  These bytes
+                         * are overwritten by later output. */
+                        do {
+                            memcpy(to, from, 8);
+                            to += 8; from += 8;
+                        } while (to < end);
+                    } else if (distance == 1) {
+                        memset(to, *from, length);
+                    } else {
+                        do {
+                            *to++ = *from++;
+                        } while (to < end);
+                    }
+                    outOffset += length;
+                }
+            } while (FAST_LOOP_OK);
+
+            /* Push back whole bytes that were read ahead during this
+             * run of the inner loop */
+            readAhead = startRemaining - inRemaining;
+            if (readAhead > (long)(bitCount >> 3)) {
+                readAhead = bitCount >> 3;
+            }
+            inflateBufferIndex -= readAhead;
+            inflateBufferCount += readAhead;
+            inRemaining += readAhead;
+            bitCount -= readAhead << 3;
+            bitBuf &= ((ulong64)1 << bitCount) - 1;
+
+            if (endOfBlock) {
+                noerror = TRUE;
+                goto done_loop;
+            } else if (failed) {
+                goto done_loop;
+            }
+        }
+
+        /* Decode one symbol, checking everything */
+        if (inRemaining < 0) {
+            goto done_loop;
+        }
+        FAST_NEEDBITS(MAX_BITS + MAX_ZIP_EXTRA_LENGTH_BITS);
+        FAST_DECODE(lcodes, litxlenBits, entry);
+
+        if (entry.op == FAST_LITERAL) {
+            if (outOffset < outLength) {
+                outFile[outOffset++] = (unsigned char)entry.value;
+            } else {
+                goto done_loop;
+            }
+        } else if (entry.op == FAST_END_OF_BLOCK) {
+            noerror = TRUE;
+            goto done_loop;
+        } else if (FAST_OP_KIND(entry.op) != FAST_BASE) {
+            ziperr(KVM_MSG_JAR_INVALID_LITERAL_OR_LENGTH);
+            goto done_loop;
+        } else {
+            length = entry.value + FAST_NEXTBITS(FAST_OP_BITS(entry.op));
+            FAST_DUMPBITS(FAST_OP_BITS(entry.op));
+
+            FAST_NEEDBITS(MAX_BITS);
+            FAST_DECODE(dcodes, distanceBits, entry);
+            if (FAST_OP_KIND(entry.op) != FAST_BASE) {
+                ziperr(KVM_MSG_JAR_BAD_DISTANCE_CODE);
+                goto done_loop;
+            }
+            FAST_NEEDBITS(MAX_ZIP_EXTRA_DISTANCE_BITS);
+            distance = entry.value + FAST_NEXTBITS(FAST_OP_BITS(entry.op));
+            FAST_DUMPBITS(FAST_OP_BITS(entry.op));
+
+            if (outOffset < distance) {
+                ziperr(KVM_MSG_JAR_COPY_UNDERFLOW);
+                goto done_loop;
+            } else if (outOffset + length > outLength) {
+                ziperr(KVM_MSG_JAR_OUTPUT_OVERFLOW);
+                goto done_loop;
+            } else {
+                unsigned long prev = outOffset - distance;
+                unsigned long end = outOffset + length;
+                while (outOffset != end) {
+                    outFile[outOffset++] = outFile[prev++];
+                }
+            }
+        }
+    }
+
+ done_loop:
+    END_ASSERTING_NO_ALLOCATION
+
+    ASSERT(bitCount <= 32);
+    state->inData = (unsigned long)bitBuf;
+    state->inDataSize = bitCount;
+    state->inRemaining = inRemaining;
+    state->outOffset = outOffset;
+    return noerror;
+}
+
+/*=========================================================================
+ * FUNCTION:  decodeDynamicHuffmanTablesFast
+ * TYPE:      Huffman code Decoding
+ * INTERFACE:
+ *   parameters: inflater state
+ *   returns:    TRUE if successful in decoding or
+ *               FALSE if an error occurs
+ * NOTE:
+ *    Same as decodeDynamicHuffmanTables, but builds fast decode tables
+ *    in fastLitxlenTable and fastDistanceTable.  The code length codes
+ *    are decoded through the distance table, which isn't needed until
+ *    all the code lengths have been read.
+ *=======================================================================*/
+
+static bool_t
+decodeDynamicHuffmanTablesFast(inflaterState *state)
+{
+    DECLARE_IN_VARIABLES
+
+    int hlit, hdist, hclen;
+    int i;
+    unsigned char codelen[286 + 32];
+    unsigned char *codePtr, *endCodePtr;
+
+    LOAD_IN;
+
+    NEEDBITS(14);
+    hlit = 257 + NEXTBITS(5);
+    DUMPBITS(5);
+    hdist = 1 + NEXTBITS(5);
+    DUMPBITS(5);
+    hclen = 4 + NEXTBITS(4);
+    DUMPBITS(4);
+
+    memset(codelen, 0x0, 19);
+    for (i=0; i<hclen; i++) {
+        NEEDBITS(3);
+        if (inRemaining < 0) {
+            return FALSE;
+        }
+        codelen[(int)ccode_idx[i]] = NEXTBITS(3);
+        DUMPBITS(3);
+    }
+
+    if (!makeFastCodeTable(codelen, 19, FAST_TABLE_CODELENGTHS,
+                           FAST_CODELENGTH_BITS, fastDistanceTable,
+                           FAST_DISTANCE_TABLE_SIZE)) {
+        return FALSE;
+    }
+
+    memset(codelen, 0x0, sizeof(codelen));
+    for (   codePtr = codelen, endCodePtr = codePtr + hlit + hdist;
+        codePtr < endCodePtr; ) {
+
+        fastHuffmanEntry entry;
+        int val;
+
+        if (inRemaining < 0) {
+            return FALSE;
+        }
+
+        NEEDBITS(MAX_BITS + 7); /* 7 is max repeat bits below */
+        entry = fastDistanceTable[NEXTBITS(FAST_CODELENGTH_BITS)];
+        if (entry.op != FAST_LITERAL) {
+            ziperr(KVM_MSG_JAR_BAD_CODELENGTH_CODE);
+            return FALSE;
+        }
+        DUMPBITS(entry.bits);
+        val = entry.value;
+
+        if (val <= 15) {
+            *codePtr++ = val;
+        } else {
+            unsigned repeat  = (val == 18) ? 11 : 3;
+            unsigned bits    = (val == 18) ? 7 : (val - 14);
+
+            repeat += NEXTBITS(bits); /* The NEEDBITS is above */
+            DUMPBITS(bits);
+
+            if (codePtr + repeat > endCodePtr) {
+                ziperr(KVM_MSG_JAR_BAD_REPEAT_CODE);
+                return FALSE;
+            }
+
+            if (val == 16) {
+                if (codePtr == codelen) {
+                    ziperr(KVM_MSG_JAR_BAD_REPEAT_CODE);
+                    return FALSE;
+                }
+                memset(codePtr, codePtr[-1], repeat);
+            }
+            codePtr += repeat;
+        }
+    }
+
+    if (!makeFastCodeTable(codelen, hlit, FAST_TABLE_LITXLEN,
+                           FAST_LITXLEN_ROOT_BITS, fastLitxlenTable,
+                           FAST_LITXLEN_TABLE_SIZE)
+        || !makeFastCodeTable(codelen + hlit, hdist, FAST_TABLE_DISTANCES,
+                              FAST_DISTANCE_ROOT_BITS, fastDistanceTable,
+                              FAST_DISTANCE_TABLE_SIZE)) {
+        return FALSE;
+    }
+
+    STORE_IN;
+    return TRUE;
+}
+
+/*=========================================================================
+ * FUNCTION:  makeFastCodeTable
+ * TYPE:      Huffman code table creation
+ * INTERFACE:
+ *   parameters: code lengths, number of elements, kind of alphabet,
+ *               root table bits, table, table capacity (in entries)
+ *   returns:    TRUE if the table was built successfully, or
+ *               FALSE if an error occurs
+ * NOTE:
+ *    The root table has 1 << rootBits entries and is indexed by the
+ *    next rootBits bits of input.  Codes longer than rootBits get a
+ *    pointer to a subtable that is just large enough for the longest
+ *    code sharing that root prefix.  The root table is always built
+ *    with the full rootBits so that the decoder can use a constant.
+ *=======================================================================*/
+
+static bool_t
+makeFastCodeTable(unsigned char *codelen, /* Code lengths */
+                  unsigned numElems,      /* Size of the alphabet */
+                  int kind,               /* FAST_TABLE_... */
+                  unsigned rootBits,      /* Bits in the root table */
+                  fastHuffmanEntry *table,
+                  unsigned tableSize)
+{
+    unsigned int bitLengthCount[MAX_BITS + 1];
+    unsigned int codes[MAX_BITS + 1];
+    unsigned char subtableBits[1 << FAST_LITXLEN_ROOT_BITS];
+    unsigned int rootSize = 1 << rootBits;
+    unsigned int rootMask = rootSize - 1;
+    unsigned int nextSubtable = rootSize;
+    unsigned int code, bits, sym, j;
+    fastHuffmanEntry invalid;
+
+    ASSERT(rootBits <= FAST_LITXLEN_ROOT_BITS && rootSize <= tableSize);
+
+    memset(bitLengthCount, 0, sizeof(bitLengthCount));
+    for (sym = 0; sym < numElems; sym++) {
+        bitLengthCount[codelen[sym]]++;
+    }
+    if (bitLengthCount[0] == numElems) {
+        ziperr(KVM_MSG_JAR_CODE_TABLE_EMPTY);
+        return FALSE;
+    }
+
+    /* First code of each length, left-justified in MAX_BITS bits, as in
+     * makeCodeTable */
+    code = 0;
+    for (bits = 1; bits <= MAX_BITS; bits++) {
+        codes[bits] = code;
+        code += bitLengthCount[bits] << (MAX_BITS - bits);
+    }
+    if (code > (1 << MAX_BITS)) {
+        /* Over-subscribed code */
+        ziperr(KVM_MSG_JAR_UNEXPECTED_BIT_CODES);
+        return FALSE;
+    }
+
+    invalid.op = FAST_INVALID;
+    invalid.bits = 0;
+    invalid.value = 0;
+    for (j = 0; j < rootSize; j++) {
+        table[j] = invalid;
+    }
+
+    /* Find out how large a subtable each root prefix needs */
+    memset(subtableBits, 0, rootSize);
+    for (bits = rootBits + 1; bits <= MAX_BITS; bits++) {
+        unsigned int first = codes[bits];
+        unsigned int count = bitLengthCount[bits];
+        for (j = 0; j < count; j++) {
+            unsigned int c = first + (j << (MAX_BITS - bits));
+            unsigned int prefix = REVERSE_15BITS(c) & rootMask;
+            subtableBits[prefix] = bits - rootBits;
+        }
+    }
+    for (j = 0; j < rootSize; j++) {
+        if (subtableBits[j] != 0) {
+            unsigned int size = 1 << subtableBits[j];
+            unsigned int k;
+            if (nextSubtable + size > tableSize) {
+                ziperr(KVM_MSG_JAR_CODE_TABLE_OVERFLOW);
+                return FALSE;
+            }
+            table[j].op = FAST_SUBTABLE | subtableBits[j];
+            table[j].bits = rootBits;
+            table[j].value = nextSubtable;
+            for (k = 0; k < size; k++) {
+                table[nextSubtable + k] = invalid;
+            }
+            nextSubtable += size;
+        }
+    }
+
+    for (sym = 0; sym < numElems; sym++) {
+        fastHuffmanEntry entry;
+        bits = codelen[sym];
+        if (bits == 0) {
+            continue;
+        }
+
+        /* Get the next code of the current length */
+        code = codes[bits];
+        codes[bits] += 1 << (MAX_BITS - bits);
+        code = REVERSE_15BITS(code);
+
+        if (kind == FAST_TABLE_CODELENGTHS) {
+            entry.op = FAST_LITERAL;
+            entry.value = sym;
+        } else if (kind == FAST_TABLE_DISTANCES) {
+            if (sym > MAX_ZIP_DISTANCE_CODE) {
+                continue;
+            }
+            entry.op = FAST_BASE | dist_extra_bits[sym];
+            entry.value = dist_base[sym];
+        } else if (sym < 256) {
+            entry.op = FAST_LITERAL;
+            entry.value = sym;
+        } else if (sym == 256) {
+            entry.op = FAST_END_OF_BLOCK;
+            entry.value = 0;
+        } else if (sym <= 285) {
+            entry.op = FAST_BASE | ll_extra_bits[sym - LITXLEN_BASE];
+            entry.value = ll_length_base[sym - LITXLEN_BASE];
+        } else {
+            continue;
+        }
+
+        if (bits <= rootBits) {
+            entry.bits = bits;
+            for (j = code; j < rootSize; j += 1 << bits) {
+                table[j] = entry;
+            }
+        } else {
+            fastHuffmanEntry *subtable = &table[table[code & rootMask].value];
+            unsigned int size = 1 << FAST_OP_BITS(table[code & rootMask].op);
+            entry.bits = bits - rootBits;
+            for (j = code >> rootBits; j < size; j += 1 << entry.bits) {
+                subtable[j] = entry;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+#endif /* INFLATE_FAST_DECODER */
+
 #if INCLUDEDEBUGCODE
 
 static void
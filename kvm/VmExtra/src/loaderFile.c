@@ -65,6 +65,9 @@ struct jarPointerStruct {
     bool_t isJarFile;      /* always FALSE */
     long dataLen;          /* length of data stream */
     long dataIndex;        /* current position for reading */
+#if CACHE_VERIFICATION_RESULT
+    long jarStamp;         /* stamp of the JAR file (getFileStamp_md) */
+#endif
     unsigned char data[1];
 };
 
@@ -73,6 +76,9 @@ typedef struct classPathEntryStruct {
         struct jarInfoStruct jarInfo; /* if it's a jar file */
         /* Leave possibility of other types, for later */
     } u;
+#if CACHE_VERIFICATION_RESULT
+    long  stamp;  /* size and modification time of a jar file */
+#endif
     char  type;
     char  name[1];
 } *CLASS_PATH_ENTRY, **CLASS_PATH_ENTRY_HANDLE;
@@ -278,6 +284,9 @@ openClassfileInternal(BYTES_HANDLE filenameH) {
                     result->isJarFile = TRUE;
                     result->dataLen = length;
                     result->dataIndex = 0;
+#if CACHE_VERIFICATION_RESULT
+                    result->jarStamp = entry->stamp;
+#endif
                     fp = (FILEPOINTER)result;
                 }
                 break;
@@ -437,6 +446,62 @@ int getBytesAvailable(FILEPOINTER_HANDLE ClassFileH)
     }
 }
 
+#if CACHE_VERIFICATION_RESULT || ENABLE_LAZY_METHOD_LOADING
+
+unsigned char*
+getClassfileContents(FILEPOINTER_HANDLE ClassFileH, long *lengthP)
+{
+    FILEPOINTER ClassFile = unhand(ClassFileH);
+    if (!ClassFile->isJarFile) {
+        return NULL;
+    } else {
+        struct jarPointerStruct *ds = (struct jarPointerStruct *)ClassFile;
+        *lengthP = ds->dataLen;
+        return ds->data;
+    }
+}
+
+#endif /* CACHE_VERIFICATION_RESULT || ENABLE_LAZY_METHOD_LOADING */
+
+#if CACHE_VERIFICATION_RESULT
+
+long
+getClassfileStamp(FILEPOINTER_HANDLE ClassFileH)
+{
+    FILEPOINTER ClassFile = unhand(ClassFileH);
+    if (!ClassFile->isJarFile) {
+        return 0;
+    } else {
+        return ((struct jarPointerStruct *)ClassFile)->jarStamp;
+    }
+}
+
+long
+getJarClassPathStamp(void)
+{
+    int paths = ClassPathTable->length;
+    unsigned long stamp = 0;
+    int i;
+
+    for (i = 0; i < paths; i++) {
+        CLASS_PATH_ENTRY entry =
+            (CLASS_PATH_ENTRY)ClassPathTable->data[i].cellp;
+        const char *name;
+        if (entry->type != 'j') {
+            /* Changes to the files in a directory can't be detected */
+            return 0;
+        }
+        for (name = entry->name; *name != '\0'; name++) {
+            stamp = stamp * 37 + (unsigned char)*name;
+        }
+        stamp = stamp * 31 + (unsigned long)entry->stamp;
+    }
+    /* Zero is reserved for class paths that can't be stamped */
+    return (stamp == 0) ? 1 : (long)stamp;
+}
+
+#endif /* CACHE_VERIFICATION_RESULT */
+
 void
 skipBytes(FILEPOINTER_HANDLE ClassFileH, unsigned long length)
 {
@@ -513,46 +578,35 @@ void closeClassfile(FILEPOINTER_HANDLE ClassFileH)
 }
 
 /*=========================================================================
- * FUNCTION:      InitializeClassLoading()
- * TYPE:          constructor (kind of)
- * OVERVIEW:      Set up the dynamic class loader.
- *                Read the optional environment variable CLASSPATH
- *                and set up the class path for classfile loading
- *                correspondingly. Actual implementation of this
- *                function is platform-dependent.
+ * FUNCTION:      countClassPathEntries(), addClassPathEntries()
+ * TYPE:          private class path operations
+ * OVERVIEW:      Count the individual directory paths along a class
+ *                path, and store them in the class path table starting
+ *                at the given index.  The table must have room for all
+ *                of them.  Entries that are neither a directory nor a
+ *                JAR file are left out.
  * INTERFACE:
- *   parameters:  <none>
- *   returns:     nothing directly, but the operation initializes
- *                the global classpath variables.
+ *   parameters:  class path, index of the first new entry
+ *   returns:     the number of entries; <nothing>
  *=======================================================================*/
 
-void InitializeClassLoading()
+static int
+countClassPathEntries(const char *classpath)
 {
-    char *classpath = UserClassPath;
-    int length, pathCount, i;
+    int pathCount = 1;
 
-    int tableIndex;
-    int previousI;
-
-    /*  Count the number of individual directory paths along CLASSPATH */
-    length = strlen(classpath);
-    pathCount = 1;
-
-    for (i = 0; i < length; i++) {
-        if (classpath[i] == PATH_SEPARATOR) pathCount++;
+    for ( ; *classpath != '\0'; classpath++) {
+        if (*classpath == PATH_SEPARATOR) pathCount++;
     }
+    return pathCount;
+}
 
-    /* We use callocObject() since we'll be allocating new objects to fill
-     * up the table */
-    ClassPathTable = (POINTERLIST)callocObject(SIZEOF_POINTERLIST(pathCount),
-                                               GCT_POINTERLIST);
-    makeGlobalRoot((cell **)&ClassPathTable);
-
-    ClassPathTable->length = pathCount;
-    MaxClassPathTableLength = 0;
-
-    tableIndex = 0;
-    previousI = 0;
+static void
+addClassPathEntries(const char *classpath, int tableIndex)
+{
+    int length = strlen(classpath);
+    int previousI = 0;
+    int i;
 
     for (i = 0; i <= length; i++) {
        if (classpath[i] == PATH_SEPARATOR || classpath[i] == 0) {
@@ -621,6 +675,12 @@ void InitializeClassLoading()
            }
 #endif /* JAR_FILES_USE_STDIO */
 
+#if CACHE_VERIFICATION_RESULT
+           if (result->type == 'j') {
+               result->stamp = getFileStamp_md(result->name);
+           }
+#endif
+
            if (result->type == '\0') {
                /* bad entry  */
                ClassPathTable->length--;
@@ -633,6 +693,67 @@ void InitializeClassLoading()
     }
 }
 
+/*=========================================================================
+ * FUNCTION:      InitializeClassLoading()
+ * TYPE:          constructor (kind of)
+ * OVERVIEW:      Set up the dynamic class loader.
+ *                Read the optional environment variable CLASSPATH
+ *                and set up the class path for classfile loading
+ *                correspondingly. Actual implementation of this
+ *                function is platform-dependent.
+ * INTERFACE:
+ *   parameters:  <none>
+ *   returns:     nothing directly, but the operation initializes
+ *                the global classpath variables.
+ *=======================================================================*/
+
+void InitializeClassLoading()
+{
+    int pathCount = countClassPathEntries(UserClassPath);
+
+    /* We use callocObject() since we'll be allocating new objects to fill
+     * up the table */
+    ClassPathTable = (POINTERLIST)callocObject(SIZEOF_POINTERLIST(pathCount),
+                                               GCT_POINTERLIST);
+    makeGlobalRoot((cell **)&ClassPathTable);
+
+    ClassPathTable->length = pathCount;
+    MaxClassPathTableLength = 0;
+
+    addClassPathEntries(UserClassPath, 0);
+}
+
+/*=========================================================================
+ * FUNCTION:      appendClassPath()
+ * TYPE:          public class path operation
+ * OVERVIEW:      Add the entries of a class path to the end of the
+ *                class path that the class loader was initialized
+ *                with.  This is used to apply the class path of an
+ *                application to a VM that has already loaded the
+ *                system classes (see the zygote in StartJVM.c).
+ * INTERFACE:
+ *   parameters:  class path
+ *   returns:     <nothing>
+ *=======================================================================*/
+
+void appendClassPath(const char *classpath)
+{
+    int oldCount = ClassPathTable->length;
+    int pathCount = countClassPathEntries(classpath);
+    POINTERLIST newTable;
+    int i;
+
+    newTable = (POINTERLIST)callocObject(
+        SIZEOF_POINTERLIST(oldCount + pathCount), GCT_POINTERLIST);
+    newTable->length = oldCount + pathCount;
+    for (i = 0; i < oldCount; i++) {
+        newTable->data[i].cellp = ClassPathTable->data[i].cellp;
+    }
+    ClassPathTable = newTable;
+
+    addClassPathEntries(classpath, oldCount);
+}
+
 /*=========================================================================
  * FUNCTION:      FinalizeClassLoading()
  * TYPE:          destructor (kind of)
@@ -48,6 +48,39 @@ void printHelpText() {
     fprintf(stdout, "  -classpath <filepath>\n");
     fprintf(stdout, "  -heapsize <size> (e.g. 65536 or 128k or 1M)\n");
 
+#if ENABLE_CLASS_SNAPSHOT
+    fprintf(stdout, "  -snapshot <file>\n");
+    fprintf(stdout, "  -dumpsnapshot <file>\n");
+#endif /* ENABLE_CLASS_SNAPSHOT */
+#if ENABLE_APP_IMAGE
+    fprintf(stdout, "  -appimage <library>\n");
+#endif /* ENABLE_APP_IMAGE */
+#if CACHE_VERIFICATION_RESULT
+    fprintf(stdout, "  -verifiercache <file>\n");
+#endif /* CACHE_VERIFICATION_RESULT */
+#if ENABLE_LAZY_METHOD_LOADING
+    fprintf(stdout, "  -lazymethods\n");
+#endif /* ENABLE_LAZY_METHOD_LOADING */
+#if ENABLE_PREALLOCATED_EXCEPTIONS
+    fprintf(stdout, "  -reuseexceptions\n");
+#endif /* ENABLE_PREALLOCATED_EXCEPTIONS */
+#if ENABLE_METRICS
+    fprintf(stdout, "  -metricsfile <file>\n");
+#endif /* ENABLE_METRICS */
+#if ENABLE_HEAP_DUMP
+    fprintf(stdout, "  -heapdumpfile <file>\n");
+    fprintf(stdout, "  -heapdumponoom\n");
+#endif /* ENABLE_HEAP_DUMP */
+#if ENABLE_ALLOCATION_SAMPLING
+    fprintf(stdout, "  -allocsampling <bytes>\n");
+#endif /* ENABLE_ALLOCATION_SAMPLING */
+#if ENABLE_GC_LOG
+    fprintf(stdout, "  -gclog <file>\n");
+#endif /* ENABLE_GC_LOG */
+#if ENABLE_DYNAMIC_NATIVES
+    fprintf(stdout, "  -nativelib <library>\n");
+#endif /* ENABLE_DYNAMIC_NATIVES */
+
 #if ENABLE_JAVA_DEBUGGER
     fprintf(stdout, "  -debugger\n");
     fprintf(stdout, "  -suspend\n");
@@ -77,6 +110,7 @@ int main (int argc, char* argv[]) {
 
     JamEnabled = FALSE;
     JamRepeat = FALSE;
+    JamZygote = FALSE;
     RequestedHeapSize = DEFAULTHEAPSIZE;
 
 #if ENABLE_JAVA_DEBUGGER
@@ -146,6 +180,67 @@ int main (int argc, char* argv[]) {
             UserClassPath = argv[2];
             argv+=2; argc -=2;
 
+#if ENABLE_CLASS_SNAPSHOT
+        } else if ((strcmp(argv[1], "-snapshot") == 0) && argc > 2) {
+            ClassSnapshotFile = argv[2];
+            ClassSnapshotDump = FALSE;
+            argv+=2; argc -=2;
+        } else if ((strcmp(argv[1], "-dumpsnapshot") == 0) && argc > 2) {
+            ClassSnapshotFile = argv[2];
+            ClassSnapshotDump = TRUE;
+            argv+=2; argc -=2;
+#endif /* ENABLE_CLASS_SNAPSHOT */
+#if ENABLE_APP_IMAGE
+        } else if ((strcmp(argv[1], "-appimage") == 0) && argc > 2) {
+            AppImageFile = argv[2];
+            argv+=2; argc -=2;
+#endif /* ENABLE_APP_IMAGE */
+#if CACHE_VERIFICATION_RESULT
+        } else if ((strcmp(argv[1], "-verifiercache") == 0) && argc > 2) {
+            VerifierCacheFile = argv[2];
+            argv+=2; argc -=2;
+#endif /* CACHE_VERIFICATION_RESULT */
+#if ENABLE_LAZY_METHOD_LOADING
+        } else if (strcmp(argv[1], "-lazymethods") == 0) {
+            LazyMethodLoading = TRUE;
+            argv++; argc--;
+#endif /* ENABLE_LAZY_METHOD_LOADING */
+#if ENABLE_PREALLOCATED_EXCEPTIONS
+        } else if (strcmp(argv[1], "-reuseexceptions") == 0) {
+            ReuseVMExceptions = TRUE;
+            argv++; argc--;
+#endif /* ENABLE_PREALLOCATED_EXCEPTIONS */
+#if ENABLE_METRICS
+        } else if ((strcmp(argv[1], "-metricsfile") == 0) && argc > 2) {
+            MetricsDumpFile = argv[2];
+            argv+=2; argc -=2;
+#endif /* ENABLE_METRICS */
+#if ENABLE_HEAP_DUMP
+        } else if ((strcmp(argv[1], "-heapdumpfile") == 0) && argc > 2) {
+            HeapDumpFile = argv[2];
+            argv+=2; argc -=2;
+        } else if (strcmp(argv[1], "-heapdumponoom") == 0) {
+            HeapDumpOnOutOfMemory = TRUE;
+            argv++; argc--;
+#endif /* ENABLE_HEAP_DUMP */
+#if ENABLE_ALLOCATION_SAMPLING
+        } else if ((strcmp(argv[1], "-allocsampling") == 0) && argc > 2) {
+            AllocationSampleInterval = atol(argv[2]);
+            argv+=2; argc -=2;
+#endif /* ENABLE_ALLOCATION_SAMPLING */
+#if ENABLE_GC_LOG
+        } else if ((strcmp(argv[1], "-gclog") == 0) && argc > 2) {
+            GCLogFile = argv[2];
+            argv+=2; argc -=2;
+#endif /* ENABLE_GC_LOG */
+#if ENABLE_DYNAMIC_NATIVES
+        } else if ((strcmp(argv[1], "-nativelib") == 0) && argc > 2) {
+            if (!loadNativeLibrary(argv[2])) {
+                exit(1);
+            }
+            argv+=2; argc -=2;
+#endif /* ENABLE_DYNAMIC_NATIVES */
+
 #if INCLUDEDEBUGCODE
 
 #define CHECK_FOR_OPTION_IN_ARGV(varName, userName)  \
@@ -181,6 +276,11 @@ int main (int argc, char* argv[]) {
                   && argc > 2) {
             jamInstalledAppsDir = argv[2];
             argv+=2; argc-=2;
+#if ENABLE_ZYGOTE
+        } else if (JamEnabled && (strcmp(argv[1], "-zygote") == 0)) {
+            JamZygote = TRUE;
+            argv++; argc--;
+#endif /* ENABLE_ZYGOTE */
 #endif /* USE_JAM */
 
         } else {
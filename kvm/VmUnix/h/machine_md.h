@@ -74,9 +74,61 @@ unsigned long * Calendar_md(void);
 #define PROCESSOR_ARCHITECTURE_X86 1
 #endif
 
+#if defined(__SSE2_MATH__) && !defined(USE_SSE2_MATH)
+/* Double arithmetic is done in SSE2 registers (always on x86-64), */
+/* so SSE2 instructions can be used in the java.lang.Math functions */
+#define USE_SSE2_MATH 1
+#endif
+
 /* Make the VM run a little faster (can afford the extra space) */
 #define ENABLEFASTBYTECODES 1
 
+/* Use the table-driven inflater for reading compressed JAR files */
+#define INFLATE_FAST_DECODER 1
+
+/* Support the -snapshot and -dumpsnapshot options (see snapshot.c) */
+#define ENABLE_CLASS_SNAPSHOT 1
+
+/* Support the -verifiercache option (see verifierCache.c) */
+#define CACHE_VERIFICATION_RESULT 1
+
+/* Support the -lazymethods option (see loader.c) */
+#define ENABLE_LAZY_METHOD_LOADING 1
+
+/* Cache exception handler lookups (see frame.c) */
+#define CACHE_EXCEPTION_HANDLERS 1
+
+/* Support the -reuseexceptions option (see frame.c) */
+#define ENABLE_PREALLOCATED_EXCEPTIONS 1
+
+/* Keep runtime metrics, dumped on SIGUSR1 (see metrics.c) */
+#define ENABLE_METRICS 1
+
+/* Support heap histograms and HPROF heap dumps, on SIGUSR2 and with */
+/* the -heapdumpfile and -heapdumponoom options (see heapDump.c) */
+#define ENABLE_HEAP_DUMP 1
+
+/* Support sampled allocation-site profiling with -allocsampling */
+/* (see allocSampling.c) */
+#define ENABLE_ALLOCATION_SAMPLING 1
+
+/* Support the structured GC log written with -gclog (see gcLog.c) */
+#define ENABLE_GC_LOG 1
+
+/* Let the garbage collector zero free memory, rather than the */
+/* allocator (see collector.c) */
+#define ENABLE_PREZEROED_HEAP 1
+
+/* Support loading native libraries with -nativelib (see native.c) */
+#define ENABLE_DYNAMIC_NATIVES 1
+
+/* Support romized application classes with -appimage (see appImage.c) */
+#define ENABLE_APP_IMAGE ROMIZING
+
+/* Support running JAM applications from a zygote with -zygote */
+/* (see StartJVM.c) */
+#define ENABLE_ZYGOTE 1
+
 /* Override the sleep function defined in main.h */
 #define SLEEP_FOR(delta)                                     \
     {                                                        \
@@ -110,6 +162,13 @@ void  freeVirtualMemory_md(void *address, long size);
 enum { PVM_NoAccess, PVM_ReadOnly, PVM_ReadWrite };
 void  protectVirtualMemory_md(void *address, long size, int protection);
 
+/* Class snapshot support */
+void* mapSnapshotImage_md(const char *fileName, long offset, long size,
+                          void *preferredAddress);
+void  unmapSnapshotImage_md(void *address, long size);
+long  getFileStamp_md(const char *fileName);
+void  getBinaryBounds_md(char **start, char **end);
+
 /*=========================================================================
  * FUNCTION:      The stub of GetAndStoreNextKVMEvent
  * TYPE:          event handler
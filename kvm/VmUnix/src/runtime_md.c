@@ -26,6 +26,14 @@
 #include <signal.h>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#if ENABLE_DYNAMIC_NATIVES
+#include <dlfcn.h>
+#endif
+#if ENABLE_ZYGOTE
+#include <sys/wait.h>
+#include <sys/resource.h>
+#endif
 
 /*=========================================================================
  * Definitions and variables
@@ -116,6 +124,141 @@ protectVirtualMemory_md(void *address, long size, int protection) {
     mprotect(address, size, flag);
 }
 
+/*=========================================================================
+ * FUNCTION:      mapSnapshotImage_md(), unmapSnapshotImage_md(),
+ *                getFileStamp_md(), getBinaryBounds_md()
+ * TYPE:          class snapshot support
+ * OVERVIEW:      Map part of a file copy-on-write, preferably at the
+ *                given address, identify the current contents of
+ *                a file by its size and modification time, and find
+ *                the addresses of the code and data of the VM binary.
+ * INTERFACE:
+ *   parameters:  fileName, page-aligned offset and size of the mapping,
+ *                preferred address
+ *   returns:     the mapped address, or NULL; the file stamp, or 0 if
+ *                the file does not exist
+ *=======================================================================*/
+
+void *
+mapSnapshotImage_md(const char *fileName, long offset, long size,
+                    void *preferredAddress) {
+    int fd = open(fileName, O_RDONLY);
+    void *result;
+    if (fd < 0) {
+        return NULL;
+    }
+    result = mmap(preferredAddress, size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE, fd, offset);
+    close(fd);
+    return (result == MAP_FAILED) ? NULL : result;
+}
+
+void
+unmapSnapshotImage_md(void *address, long size) {
+    munmap(address, size);
+}
+
+long
+getFileStamp_md(const char *fileName) {
+    struct stat info;
+    if (stat(fileName, &info) != 0) {
+        return 0;
+    }
+    return (long)info.st_size * 31 + (long)info.st_mtime;
+}
+
+/* Defined by the linker at the start and the end of the executable */
+#ifdef LINUX
+extern char __executable_start[];
+#define BINARY_START __executable_start
+#else
+extern char _start[];
+#define BINARY_START _start
+#endif
+extern char _end[];
+
+void
+getBinaryBounds_md(char **start, char **end) {
+    *start = BINARY_START;
+    *end = _end;
+}
+
+#if ENABLE_ZYGOTE
+
+/*=========================================================================
+ * FUNCTION:      forkProcess_md(), waitForProcess_md(), getMaxRSS_md()
+ * TYPE:          zygote support
+ * OVERVIEW:      Fork a child of the zygote, wait for it to exit, and
+ *                measure the memory used by that child or the zygote.
+ *                The child's figure comes from wait4() for its pid
+ *                alone, not from RUSAGE_CHILDREN, which would report
+ *                the largest of all children waited for so far.
+ * INTERFACE:
+ *   parameters:  process id of the child, and where to store its
+ *                largest resident set size
+ *   returns:     the process id of the child (0 in the child, -1 on
+ *                failure); the exit code of the child; the largest
+ *                resident set size of the zygote.  Sizes are in
+ *                kilobytes, or -1 if unknown
+ *=======================================================================*/
+
+int
+forkProcess_md(void) {
+    return fork();
+}
+
+int
+waitForProcess_md(int pid, long* maxRSS) {
+    struct rusage usage;
+    int status;
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        *maxRSS = -1;
+        return FATAL_ERROR_EXIT_CODE;
+    }
+    *maxRSS = usage.ru_maxrss;
+    if (!WIFEXITED(status)) {
+        return FATAL_ERROR_EXIT_CODE;
+    }
+    return WEXITSTATUS(status);
+}
+
+long
+getMaxRSS_md(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+    return usage.ru_maxrss;
+}
+
+#endif /* ENABLE_ZYGOTE */
+
+#if ENABLE_DYNAMIC_NATIVES
+
+/*=========================================================================
+ * FUNCTION:      loadNativeLibrary_md(), findNativeLibrarySymbol_md()
+ * TYPE:          native library support
+ * OVERVIEW:      Load a shared library of native methods, and find a
+ *                function defined by it.  Libraries are never unloaded,
+ *                since the VM keeps pointers to their native methods.
+ * INTERFACE:
+ *   parameters:  path of the library; library handle, symbol name
+ *   returns:     the library handle or the address of the symbol,
+ *                or NULL if not found
+ *=======================================================================*/
+
+void *
+loadNativeLibrary_md(const char *path) {
+    return dlopen(path, RTLD_NOW | RTLD_GLOBAL);
+}
+
+void *
+findNativeLibrarySymbol_md(void *library, const char *name) {
+    return dlsym(library, name);
+}
+
+#endif /* ENABLE_DYNAMIC_NATIVES */
+
 /*=========================================================================
  * FUNCTION:      signal_handler (showStack)
  * TYPE:          debugging operation
@@ -156,6 +299,46 @@ static void signal_handler(int sig) {
     abort();
 }
 
+#if ENABLE_METRICS
+
+/*=========================================================================
+ * FUNCTION:      metrics_signal_handler
+ * TYPE:          signal handler
+ * OVERVIEW:      called when we receive SIGUSR1 on Unix.  The metrics
+ *                are dumped the next time the interpreter reschedules,
+ *                since it isn't safe to print them here.
+ * INTERFACE:
+ *   parameters:  signal
+ *   returns:     none
+ *=======================================================================*/
+
+static void metrics_signal_handler(int sig) {
+    MetricsDumpRequested = TRUE;
+    signalTimeToReschedule();
+}
+
+#endif /* ENABLE_METRICS */
+
+#if ENABLE_HEAP_DUMP
+
+/*=========================================================================
+ * FUNCTION:      heapdump_signal_handler
+ * TYPE:          signal handler
+ * OVERVIEW:      called when we receive SIGUSR2 on Unix.  The heap
+ *                histogram and heap dump are written the next time
+ *                the interpreter reschedules.
+ * INTERFACE:
+ *   parameters:  signal
+ *   returns:     none
+ *=======================================================================*/
+
+static void heapdump_signal_handler(int sig) {
+    HeapDumpRequested = TRUE;
+    signalTimeToReschedule();
+}
+
+#endif /* ENABLE_HEAP_DUMP */
+
 /*=========================================================================
  * FUNCTION:      InitializeFloatingPoint
  * TYPE:          initialization
@@ -193,6 +376,18 @@ void InitializeNativeCode() {
     signal(SIGBUS,  signal_handler); 
     signal(SIGSEGV, signal_handler); 
     signal(SIGPIPE, SIG_IGN);
+#if ENABLE_METRICS
+    /*
+     * Dump the runtime metrics on request (kill -USR1 <pid>)
+     */
+    signal(SIGUSR1, metrics_signal_handler);
+#endif
+#if ENABLE_HEAP_DUMP
+    /*
+     * Print a heap histogram and write a heap dump (kill -USR2 <pid>)
+     */
+    signal(SIGUSR2, heapdump_signal_handler);
+#endif
 }
 
 /*=========================================================================
@@ -239,6 +434,28 @@ CurrentTime_md(void)
 #endif /* COMPILER_SUPPORTS_LONG */
 }
 
+#if ENABLE_GC_LOG || ENABLE_ZYGOTE
+
+/*=========================================================================
+ * FUNCTION:      CurrentTimeMicros_md()
+ * TYPE:          machine-specific implementation of native function
+ * OVERVIEW:      Returns the current time with microsecond resolution,
+ *                for timing the phases of garbage collection.
+ * INTERFACE:
+ *   parameters:  none
+ *   returns:     current time, in microseconds
+ *=======================================================================*/
+
+ulong64
+CurrentTimeMicros_md(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (ulong64)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+#endif /* ENABLE_GC_LOG || ENABLE_ZYGOTE */
+
 /*=========================================================================
  * FUNCTION:      Calendar_md()
  * TYPE:          machine-specific implementation of native function
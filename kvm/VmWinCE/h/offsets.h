@@ -243,16 +243,16 @@
         _macro_(CHECKCAST_FAST, 0xdd) \
         _macro_(INSTANCEOF_FAST, 0xde) \
         _macro_(CUSTOMCODE, 0xdf) \
+        _macro_(GETSTATIC_READY, 0xe0) \
+        _macro_(GETSTATICP_READY, 0xe1) \
+        _macro_(GETSTATIC2_READY, 0xe2) \
+        _macro_(PUTSTATIC_READY, 0xe3) \
+        _macro_(PUTSTATIC2_READY, 0xe4) \
+        _macro_(INVOKESTATIC_READY, 0xe5) \
+        _macro_(NEW_READY, 0xe6) \
+        _macro_(ARRAYCOPY_READY, 0xe7) \
 
 #define FOR_EACH_EXTRA_BYTE_CODE(_macro_) \
-        _macro_(UNUSED_E0, 0xe0) \
-        _macro_(UNUSED_E1, 0xe1) \
-        _macro_(UNUSED_E2, 0xe2) \
-        _macro_(UNUSED_E3, 0xe3) \
-        _macro_(UNUSED_E4, 0xe4) \
-        _macro_(UNUSED_E5, 0xe5) \
-        _macro_(UNUSED_E6, 0xe6) \
-        _macro_(UNUSED_E7, 0xe7) \
         _macro_(UNUSED_E8, 0xe8) \
         _macro_(UNUSED_E9, 0xe9) \
         _macro_(UNUSED_EA, 0xea) \
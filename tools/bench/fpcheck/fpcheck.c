@@ -0,0 +1,200 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+/*=========================================================================
+ * KVM
+ *=========================================================================
+ * SYSTEM:    KVM
+ * SUBSYSTEM: Floating point
+ * FILE:      fpcheck.c
+ * OVERVIEW:  Checks that the SSE2 versions of the java.lang.Math
+ *            functions (USE_SSE2_MATH) give bit-for-bit the same
+ *            results as the fdlibm code in kvm/VmExtra/src/fp.
+ *
+ *            The Makefile compiles the fp sources twice, with and
+ *            without USE_SSE2_MATH, and renames the entry points of
+ *            the two builds to fdlibm_... and sse2_...  This program
+ *            runs edge cases, random bit patterns and random values
+ *            in the ranges of the kernels through both, and reports
+ *            every input whose results differ in any bit.
+ *
+ *              fpcheck [-n count] [-seed seed]
+ *
+ *            The exit status is 1 if any result differs.
+ *=======================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+double fdlibm_sqrt(double x);
+double fdlibm_tan(double x);
+double fdlibm_kernel_tan(double x, double y, int iy);
+double sse2_sqrt(double x);
+double sse2_tan(double x);
+double sse2_kernel_tan(double x, double y, int iy);
+
+/* Print at most this many differences per function */
+#define MAX_REPORTS 10
+
+typedef unsigned long long bits64;
+
+typedef struct functionStruct {
+    const char* name;
+    double    (*fdlibm)(double);
+    double    (*sse2)(double);
+    long        inputs;
+    long        differences;
+} function;
+
+static double fdlibm_kernel_tan1(double x) { return fdlibm_kernel_tan(x, 0.0, 1); }
+static double sse2_kernel_tan1(double x)   { return sse2_kernel_tan(x, 0.0, 1); }
+static double fdlibm_kernel_cot(double x)  { return fdlibm_kernel_tan(x, 0.0, -1); }
+static double sse2_kernel_cot(double x)    { return sse2_kernel_tan(x, 0.0, -1); }
+
+static function functions[] = {
+    { "sqrt",        fdlibm_sqrt,        sse2_sqrt,        0, 0 },
+    { "tan",         fdlibm_tan,         sse2_tan,         0, 0 },
+    { "kernel_tan",  fdlibm_kernel_tan1, sse2_kernel_tan1, 0, 0 },
+    { "kernel_cot",  fdlibm_kernel_cot,  sse2_kernel_cot,  0, 0 },
+};
+
+#define FUNCTION_COUNT (sizeof(functions) / sizeof(functions[0]))
+
+static bits64 randomState;
+
+static bits64
+nextRandom(void)
+{
+    /* xorshift64* */
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return randomState * 2685821657736338717ULL;
+}
+
+static bits64
+toBits(double x)
+{
+    bits64 result;
+    memcpy(&result, &x, sizeof(result));
+    return result;
+}
+
+static double
+fromBits(bits64 bits)
+{
+    double result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+/* A random double in [low, high) */
+static double
+randomIn(double low, double high)
+{
+    return low + (high - low) * ((nextRandom() >> 11) * (1.0 / 9007199254740992.0));
+}
+
+static void
+check(function* f, double x)
+{
+    double expected = f->fdlibm(x);
+    double actual = f->sse2(x);
+
+    f->inputs++;
+    if (toBits(expected) != toBits(actual)) {
+        if (++f->differences <= MAX_REPORTS) {
+            printf("%s(%.17g [%016llx]): fdlibm %016llx, sse2 %016llx\n",
+                   f->name, x, toBits(x), toBits(expected), toBits(actual));
+        }
+    }
+}
+
+static void
+checkAll(double x)
+{
+    unsigned int i;
+    for (i = 0; i < FUNCTION_COUNT; i++) {
+        check(&functions[i], x);
+    }
+}
+
+/* Edge cases, checked with both signs and their neighbours */
+static const bits64 edgeCases[] = {
+    0x0000000000000000ULL,   /* 0 */
+    0x0000000000000001ULL,   /* Smallest denormal */
+    0x000FFFFFFFFFFFFFULL,   /* Largest denormal */
+    0x0010000000000000ULL,   /* Smallest normal */
+    0x3E30000000000000ULL,   /* 2^-28, small argument of __kernel_tan */
+    0x3E40000000000000ULL,   /* 2^-27 */
+    0x3FE5942800000000ULL,   /* 0.6744, large argument of __kernel_tan */
+    0x3FE921FB54442D18ULL,   /* pi/4 */
+    0x3FF0000000000000ULL,   /* 1 */
+    0x3FF921FB54442D18ULL,   /* pi/2 */
+    0x400921FB54442D18ULL,   /* pi */
+    0x4139000000000000ULL,   /* 2^20 * pi/2, limit of the medium case */
+    0x7FEFFFFFFFFFFFFFULL,   /* Largest finite */
+    0x7FF0000000000000ULL,   /* Infinity */
+    0x7FF0000000000001ULL,   /* Signalling NaN */
+    0x7FF8000000000000ULL,   /* Quiet NaN */
+    0x7FFFFFFFFFFFFFFFULL,   /* Quiet NaN, all payload bits */
+};
+
+#define EDGE_CASE_COUNT (sizeof(edgeCases) / sizeof(edgeCases[0]))
+
+int
+main(int argc, char** argv)
+{
+    long count = 1000000;
+    bits64 seed = 1;
+    long failures = 0;
+    clock_t start;
+    unsigned int i;
+    long n;
+
+    for (i = 1; i < (unsigned int)argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < (unsigned int)argc) {
+            count = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-seed") == 0 && i + 1 < (unsigned int)argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "Usage: %s [-n count] [-seed seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    randomState = (seed == 0) ? 1 : seed;
+    start = clock();
+
+    for (i = 0; i < EDGE_CASE_COUNT; i++) {
+        bits64 bits = edgeCases[i];
+        int delta;
+        for (delta = -2; delta <= 2; delta++) {
+            checkAll(fromBits(bits + delta));
+            checkAll(fromBits((bits + delta) | 0x8000000000000000ULL));
+        }
+    }
+
+    for (n = 0; n < count; n++) {
+        /* Any bit pattern */
+        checkAll(fromBits(nextRandom()));
+        /* The range of the kernels, and a few periods of tan */
+        checkAll(randomIn(-0.7854, 0.7854));
+        checkAll(randomIn(0.6, 0.7));
+        checkAll(randomIn(-100.0, 100.0));
+        /* Tiny arguments, around the 2^-28 threshold */
+        checkAll(randomIn(-1.0e-8, 1.0e-8));
+    }
+
+    for (i = 0; i < FUNCTION_COUNT; i++) {
+        function* f = &functions[i];
+        printf("%-12s %10ld inputs, %ld different\n",
+               f->name, f->inputs, f->differences);
+        failures += f->differences;
+    }
+    printf("%.2f s\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+    return (failures == 0) ? 0 : 1;
+}
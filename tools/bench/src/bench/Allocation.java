@@ -0,0 +1,77 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package bench;
+
+/**
+ * Benchmarks for object allocation and garbage collection.
+ */
+class Allocation {
+
+    static class Node {
+        Node next;
+        int value;
+
+        Node(Node next, int value) {
+            this.next = next;
+            this.value = value;
+        }
+    }
+
+    /** Short-lived small objects; most of them die immediately */
+    static class SmallObjects extends Benchmark {
+        SmallObjects() {
+            super("gc", "smallObjects", "object");
+        }
+
+        public int run(int iterations) {
+            Node last = null;
+            for (int i = 0; i < iterations; i++) {
+                last = new Node(null, i);
+            }
+            return last == null ? 0 : last.value;
+        }
+    }
+
+    /** Short-lived arrays of varying size */
+    static class Arrays extends Benchmark {
+        Arrays() {
+            super("gc", "arrays", "array");
+        }
+
+        public int run(int iterations) {
+            int sum = 0;
+            for (int i = 0; i < iterations; i++) {
+                byte[] b = new byte[16 + (i & 127)];
+                int[] a = new int[4 + (i & 31)];
+                sum += b.length + a.length;
+            }
+            return sum;
+        }
+    }
+
+    /**
+     * A window of live objects, so that each collection has to mark
+     * and move a non-trivial amount of data.
+     */
+    static class Retained extends Benchmark {
+        private static final int WINDOW = 4096;
+
+        Retained() {
+            super("gc", "retained", "object");
+        }
+
+        public int run(int iterations) {
+            Node[] live = new Node[WINDOW];
+            int sum = 0;
+            for (int i = 0; i < iterations; i++) {
+                int slot = i & (WINDOW - 1);
+                live[slot] = new Node(live[(slot + 1) & (WINDOW - 1)], i);
+                sum += live[slot].value;
+            }
+            return sum;
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package bench;
+
+/**
+ * A single benchmark.  Each benchmark belongs to a subsystem of the
+ * virtual machine, and performs some fixed amount of work per
+ * iteration, so that results can be compared between builds.
+ */
+public abstract class Benchmark {
+
+    /** The subsystem of the virtual machine that this benchmark measures */
+    public final String subsystem;
+
+    /** The name of the benchmark, unique within its subsystem */
+    public final String name;
+
+    /** The unit of one iteration, as reported in the results */
+    public final String unit;
+
+    protected Benchmark(String subsystem, String name, String unit) {
+        this.subsystem = subsystem;
+        this.name = name;
+        this.unit = unit;
+    }
+
+    /**
+     * Runs the given number of iterations.
+     *
+     * @return a value computed from the work done, so that the work
+     *         can't be skipped.
+     */
+    public abstract int run(int iterations) throws Exception;
+
+    /**
+     * Returns false if the benchmark can only be run once per virtual
+     * machine instance (e.g., because it loads classes).  Such a
+     * benchmark is run exactly once with maxIterations() iterations.
+     */
+    public boolean isRepeatable() {
+        return true;
+    }
+
+    /**
+     * Returns the number of iterations for benchmarks that are not
+     * repeatable.
+     */
+    public int maxIterations() {
+        return 0;
+    }
+
+    /**
+     * Returns additional results of the last run as JSON members,
+     * e.g. <code>"avgLatencyMs":2</code>, or null if there are none.
+     */
+    public String details() {
+        return null;
+    }
+}
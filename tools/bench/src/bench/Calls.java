@@ -0,0 +1,75 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package bench;
+
+/**
+ * Benchmarks for method invocation: static, virtual (with a
+ * polymorphic receiver) and interface calls.
+ */
+class Calls {
+
+    interface Shape {
+        int area(int scale);
+    }
+
+    static class Square implements Shape {
+        public int area(int scale) { return scale * scale; }
+        int size(int n) { return n + 1; }
+    }
+
+    static class Rectangle extends Square {
+        public int area(int scale) { return scale * (scale + 1); }
+        int size(int n) { return n + 2; }
+    }
+
+    private static int add(int a, int b) {
+        return a + b;
+    }
+
+    static class StaticCall extends Benchmark {
+        StaticCall() {
+            super("calls", "static", "call");
+        }
+
+        public int run(int iterations) {
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                result = add(result, i);
+            }
+            return result;
+        }
+    }
+
+    static class VirtualCall extends Benchmark {
+        VirtualCall() {
+            super("calls", "virtual", "call");
+        }
+
+        public int run(int iterations) {
+            Square[] receivers = { new Square(), new Rectangle() };
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                result = receivers[i & 1].size(result);
+            }
+            return result;
+        }
+    }
+
+    static class InterfaceCall extends Benchmark {
+        InterfaceCall() {
+            super("calls", "interface", "call");
+        }
+
+        public int run(int iterations) {
+            Shape[] receivers = { new Square(), new Rectangle() };
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                result += receivers[i & 1].area(i & 15);
+            }
+            return result;
+        }
+    }
+}
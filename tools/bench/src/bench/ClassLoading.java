@@ -0,0 +1,174 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package bench;
+
+import java.io.InputStream;
+
+/**
+ * Benchmarks for reading the class path: inflating compressed JAR
+ * entries, and loading, verifying and initializing classes.
+ */
+class ClassLoading {
+
+    /** Number of classes generated by the Makefile (bench.load.L0...) */
+    static final int GENERATED_CLASSES = 64;
+
+    /**
+     * Inflates a compressed resource from the JAR file.  One iteration
+     * is one kilobyte of inflated data, so perSecond is in KB/s.
+     */
+    static class Inflate extends Benchmark {
+        private static final String RESOURCE = "/bench/data.txt";
+
+        private final byte[] buffer = new byte[1024];
+        private int resourceSize = -1;
+
+        Inflate() {
+            super("classloading", "inflate", "KB");
+        }
+
+        private int readResource(int[] checksum) throws Exception {
+            InputStream in = getClass().getResourceAsStream(RESOURCE);
+            if (in == null) {
+                throw new Exception("Missing resource " + RESOURCE);
+            }
+            int total = 0;
+            try {
+                int n;
+                while ((n = in.read(buffer, 0, buffer.length)) > 0) {
+                    checksum[0] += buffer[n - 1];
+                    total += n;
+                }
+            } finally {
+                in.close();
+            }
+            return total;
+        }
+
+        public int run(int iterations) throws Exception {
+            int[] checksum = new int[1];
+            if (resourceSize < 0) {
+                resourceSize = readResource(checksum);
+            }
+            long remaining = (long)iterations * 1024;
+            while (remaining > 0) {
+                remaining -= readResource(checksum);
+            }
+            return checksum[0] + resourceSize;
+        }
+    }
+
+    /**
+     * Inflates every entry of the CLDC classes.zip.  The VM won't read
+     * class files as resources, so the Makefile copies them into the
+     * benchmark JAR as bench/classes/<name>.dat and lists their names
+     * in bench/classes.lst.  One iteration is one megabyte of inflated
+     * data, so perSecond is in MB/s.
+     */
+    static class InflateClasses extends Benchmark {
+        private static final String LIST = "/bench/classes.lst";
+        private static final String PREFIX = "/bench/classes/";
+
+        private final byte[] buffer = new byte[4096];
+        private String[] entries;
+
+        InflateClasses() {
+            super("classloading", "inflateclasses", "MB");
+        }
+
+        private InputStream open(String name) throws Exception {
+            InputStream in = getClass().getResourceAsStream(name);
+            if (in == null) {
+                throw new Exception("Missing resource " + name);
+            }
+            return in;
+        }
+
+        private String[] readList() throws Exception {
+            InputStream in = open(LIST);
+            StringBuffer sb = new StringBuffer();
+            try {
+                int c;
+                while ((c = in.read()) >= 0) {
+                    sb.append((char)c);
+                }
+            } finally {
+                in.close();
+            }
+            String list = sb.toString();
+            int count = 0;
+            for (int i = 0; i < list.length(); i++) {
+                if (list.charAt(i) == '\n') {
+                    count++;
+                }
+            }
+            String[] names = new String[count];
+            int start = 0;
+            for (int i = 0; i < count; i++) {
+                int end = list.indexOf('\n', start);
+                names[i] = PREFIX + list.substring(start, end) + ".dat";
+                start = end + 1;
+            }
+            return names;
+        }
+
+        private int readEntry(String name, int[] checksum) throws Exception {
+            InputStream in = open(name);
+            int total = 0;
+            try {
+                int n;
+                while ((n = in.read(buffer, 0, buffer.length)) > 0) {
+                    checksum[0] += buffer[n - 1];
+                    total += n;
+                }
+            } finally {
+                in.close();
+            }
+            return total;
+        }
+
+        public int run(int iterations) throws Exception {
+            int[] checksum = new int[1];
+            if (entries == null) {
+                entries = readList();
+            }
+            long remaining = (long)iterations * 1024 * 1024;
+            while (remaining > 0) {
+                for (int i = 0; i < entries.length; i++) {
+                    remaining -= readEntry(entries[i], checksum);
+                }
+            }
+            return checksum[0];
+        }
+    }
+
+    /**
+     * Loads the generated classes.  Since a class is only loaded
+     * once, this benchmark can only run once per VM instance.
+     */
+    static class LoadClasses extends Benchmark {
+        LoadClasses() {
+            super("classloading", "load", "class");
+        }
+
+        public boolean isRepeatable() {
+            return false;
+        }
+
+        public int maxIterations() {
+            return GENERATED_CLASSES;
+        }
+
+        public int run(int iterations) throws Exception {
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                Class c = Class.forName("bench.load.L" + i);
+                result += c.newInstance().hashCode() & 1;
+            }
+            return result;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package bench;
+
+/**
+ * Benchmarks for throwing and catching exceptions, both those thrown
+ * by Java code and those raised by the virtual machine itself.
+ */
+class Exceptions {
+
+    static class BenchException extends Exception {
+        final int value;
+
+        BenchException(int value) {
+            this.value = value;
+        }
+    }
+
+    static class ThrowCatch extends Benchmark {
+        ThrowCatch() {
+            super("exceptions", "throwCatch", "exception");
+        }
+
+        public int run(int iterations) {
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                try {
+                    throw new BenchException(i);
+                } catch (BenchException e) {
+                    result += e.value;
+                }
+            }
+            return result;
+        }
+    }
+
+    /** NullPointerException and ArithmeticException raised by the VM */
+    static class VMException extends Benchmark {
+        VMException() {
+            super("exceptions", "vmException", "exception");
+        }
+
+        public int run(int iterations) {
+            Object[] objects = { null };
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                try {
+                    if ((i & 1) == 0) {
+                        result += objects[0].hashCode();
+                    } else {
+                        result += i / (i & 0);
+                    }
+                } catch (NullPointerException e) {
+                    result++;
+                } catch (ArithmeticException e) {
+                    result += 2;
+                }
+            }
+            return result;
+        }
+    }
+
+    /** An exception thrown by a library method, with a message */
+    static class NumberFormat extends Benchmark {
+        NumberFormat() {
+            super("exceptions", "numberFormat", "exception");
+        }
+
+        public int run(int iterations) {
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                try {
+                    result += Integer.parseInt("12x");
+                } catch (NumberFormatException e) {
+                    result++;
+                }
+            }
+            return result;
+        }
+    }
+
+    /** An exception that unwinds through several frames */
+    static class Unwind extends Benchmark {
+        Unwind() {
+            super("exceptions", "unwind", "exception");
+        }
+
+        private static int recurse(int depth) throws BenchException {
+            if (depth == 0) {
+                throw new BenchException(depth);
+            }
+            return recurse(depth - 1) + 1;
+        }
+
+        public int run(int iterations) {
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                try {
+                    result += recurse(8);
+                } catch (BenchException e) {
+                    result += e.value + 1;
+                }
+            }
+            return result;
+        }
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package bench;
+
+/**
+ * Benchmarks for the bytecode interpreter loop: arithmetic, local
+ * variable, array and field bytecodes and table/lookup switches.
+ */
+class Interpreter {
+
+    static class IntegerLoop extends Benchmark {
+        IntegerLoop() {
+            super("interpreter", "intLoop", "loop");
+        }
+
+        public int run(int iterations) {
+            int a = 1, b = 3;
+            for (int i = 0; i < iterations; i++) {
+                a = a * 31 + (b ^ i);
+                b = (b << 1) - (a >> 3);
+            }
+            return a + b;
+        }
+    }
+
+    static class ArrayLoop extends Benchmark {
+        private final int[] data = new int[64];
+
+        ArrayLoop() {
+            super("interpreter", "arrayLoop", "element");
+        }
+
+        public int run(int iterations) {
+            int[] data = this.data;
+            int length = data.length;
+            int sum = 0;
+            for (int i = 0; i < iterations; i++) {
+                int index = i & (length - 1);
+                data[index] += i;
+                sum += data[(index + 1) & (length - 1)];
+            }
+            return sum;
+        }
+    }
+
+    static class FieldAccess extends Benchmark {
+        private int x;
+        private int y;
+        private static int count;
+
+        FieldAccess() {
+            super("interpreter", "fieldAccess", "access");
+        }
+
+        public int run(int iterations) {
+            for (int i = 0; i < iterations; i++) {
+                x += y;
+                y = x - count;
+                count++;
+            }
+            return x ^ y;
+        }
+    }
+
+    static class Switch extends Benchmark {
+        Switch() {
+            super("interpreter", "switch", "switch");
+        }
+
+        public int run(int iterations) {
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                switch (i & 7) {
+                    case 0:  result += 1; break;
+                    case 1:  result ^= i; break;
+                    case 2:  result -= 3; break;
+                    case 3:  result <<= 1; break;
+                    case 4:  result >>>= 1; break;
+                    case 5:  result |= 5; break;
+                    case 6:  result &= ~i; break;
+                    default: result++; break;
+                }
+                switch (result & 0x3000) {
+                    case 0x1000: result--; break;
+                    case 0x3000: result++; break;
+                }
+            }
+            return result;
+        }
+    }
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package bench;
+
+/**
+ * Runs the benchmark suite and prints one result per line in JSON
+ * format, e.g.
+ *
+ * <pre>
+ * {"subsystem":"calls","benchmark":"interface","iterations":524288,
+ *  "ms":1012,"unit":"call","perSecond":518070,"checksum":12345}
+ * </pre>
+ *
+ * (on a single line).  Usage:
+ *
+ * <pre>
+ *   kvm -classpath bench.jar bench.Main [-time ms] [filter...]
+ * </pre>
+ *
+ * Each repeatable benchmark is run with a doubling number of
+ * iterations until a run takes at least the given time (1000 ms by
+ * default); the last run is reported.  A filter is either the name
+ * of a subsystem or "subsystem.benchmark"; if filters are given,
+ * only the matching benchmarks are run.
+ */
+public class Main {
+
+    static Benchmark[] benchmarks() {
+        return new Benchmark[] {
+            new Interpreter.IntegerLoop(),
+            new Interpreter.ArrayLoop(),
+            new Interpreter.FieldAccess(),
+            new Interpreter.Switch(),
+            new Calls.StaticCall(),
+            new Calls.VirtualCall(),
+            new Calls.InterfaceCall(),
+            new Allocation.SmallObjects(),
+            new Allocation.Arrays(),
+            new Allocation.Retained(),
+            new Strings.Append(),
+            new Strings.Compare(),
+            new Strings.IntegerToString(),
+            new Synchronization.Uncontended(),
+            new Synchronization.Nested(),
+            new Synchronization.SynchronizedMethod(),
+            new Exceptions.ThrowCatch(),
+            new Exceptions.VMException(),
+            new Exceptions.NumberFormat(),
+            new Exceptions.Unwind(),
+            new ClassLoading.Inflate(),
+            new ClassLoading.InflateClasses(),
+            new ClassLoading.LoadClasses(),
+            new Threads.Yield(),
+            new Threads.PingPong(),
+            new Threads.WakeupLatency(),
+        };
+    }
+
+    public static void main(String[] args) throws Exception {
+        long minTime = 1000;
+        int filterCount = 0;
+        String[] filters = new String[args.length];
+
+        for (int i = 0; i < args.length; i++) {
+            if (args[i].equals("-time") && i + 1 < args.length) {
+                minTime = Long.parseLong(args[++i]);
+            } else {
+                filters[filterCount++] = args[i];
+            }
+        }
+
+        Benchmark[] list = benchmarks();
+        for (int i = 0; i < list.length; i++) {
+            Benchmark b = list[i];
+            if (filterCount == 0 || matches(b, filters, filterCount)) {
+                measure(b, minTime);
+            }
+        }
+    }
+
+    private static boolean matches(Benchmark b, String[] filters, int count) {
+        String fullName = b.subsystem + "." + b.name;
+        for (int i = 0; i < count; i++) {
+            if (filters[i].equals(b.subsystem) || filters[i].equals(fullName)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    private static void measure(Benchmark b, long minTime) throws Exception {
+        int iterations;
+        int checksum;
+        long time;
+
+        if (b.isRepeatable()) {
+            iterations = 1;
+            for (;;) {
+                long start = System.currentTimeMillis();
+                checksum = b.run(iterations);
+                time = System.currentTimeMillis() - start;
+                if (time >= minTime || iterations >= (1 << 30)) {
+                    break;
+                }
+                iterations <<= 1;
+            }
+        } else {
+            iterations = b.maxIterations();
+            long start = System.currentTimeMillis();
+            checksum = b.run(iterations);
+            time = System.currentTimeMillis() - start;
+        }
+        report(b, iterations, time, checksum);
+
+        /* Don't let the garbage of one benchmark slow down the next one */
+        System.gc();
+    }
+
+    private static void report(Benchmark b, int iterations, long time,
+                               int checksum) {
+        long perSecond = (time == 0) ? 0 : (iterations * 1000L) / time;
+        StringBuffer sb = new StringBuffer(160);
+        sb.append("{\"subsystem\":\"").append(b.subsystem)
+          .append("\",\"benchmark\":\"").append(b.name)
+          .append("\",\"iterations\":").append(iterations)
+          .append(",\"ms\":").append(time)
+          .append(",\"unit\":\"").append(b.unit)
+          .append("\",\"perSecond\":").append(perSecond)
+          .append(",\"checksum\":").append(checksum);
+        String details = b.details();
+        if (details != null) {
+            sb.append(',').append(details);
+        }
+        sb.append('}');
+        System.out.println(sb.toString());
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package bench;
+
+/**
+ * Benchmarks for java.lang.String, StringBuffer and the number
+ * conversion routines.
+ */
+class Strings {
+
+    static class Append extends Benchmark {
+        Append() {
+            super("strings", "append", "string");
+        }
+
+        public int run(int iterations) {
+            int length = 0;
+            for (int i = 0; i < iterations; i++) {
+                StringBuffer sb = new StringBuffer();
+                sb.append("value=").append(i).append(',').append("done");
+                length += sb.toString().length();
+            }
+            return length;
+        }
+    }
+
+    static class Compare extends Benchmark {
+        private static final String[] WORDS = {
+            "java.lang.Object", "java.lang.String", "java.lang.Thread",
+            "java.util.Vector", "java.util.Hashtable", "java.io.InputStream"
+        };
+
+        Compare() {
+            super("strings", "compare", "comparison");
+        }
+
+        public int run(int iterations) {
+            String[] words = WORDS;
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                String a = words[i % words.length];
+                String b = words[(i + 1) % words.length];
+                result += a.compareTo(b);
+                if (a.equals(b)) {
+                    result++;
+                }
+                result += a.indexOf('.', 5) + a.hashCode();
+            }
+            return result;
+        }
+    }
+
+    static class IntegerToString extends Benchmark {
+        IntegerToString() {
+            super("strings", "intToString", "conversion");
+        }
+
+        public int run(int iterations) {
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                result += Integer.parseInt(Integer.toString(i * 7919));
+            }
+            return result;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package bench;
+
+/**
+ * Benchmarks for monitor enter and exit.  All of them are
+ * uncontended, and measure the cost of the locking fast paths.
+ */
+class Synchronization {
+
+    private int counter;
+
+    synchronized int increment() {
+        return ++counter;
+    }
+
+    static class Uncontended extends Benchmark {
+        Uncontended() {
+            super("sync", "uncontended", "lock");
+        }
+
+        public int run(int iterations) {
+            Object lock = new Object();
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                synchronized (lock) {
+                    result += i;
+                }
+            }
+            return result;
+        }
+    }
+
+    /** Recursive locking, and several objects locked at the same time */
+    static class Nested extends Benchmark {
+        Nested() {
+            super("sync", "nested", "lock");
+        }
+
+        public int run(int iterations) {
+            Object a = new Object();
+            Object b = new Object();
+            int result = 0;
+            for (int i = 0; i < iterations; i++) {
+                synchronized (a) {
+                    synchronized (b) {
+                        synchronized (a) {
+                            result += i;
+                        }
+                    }
+                }
+            }
+            return result;
+        }
+    }
+
+    /** Locks an object that also has its identity hash code computed */
+    static class SynchronizedMethod extends Benchmark {
+        SynchronizedMethod() {
+            super("sync", "synchronizedMethod", "call");
+        }
+
+        public int run(int iterations) {
+            Synchronization s = new Synchronization();
+            int result = s.hashCode();
+            for (int i = 0; i < iterations; i++) {
+                result += s.increment();
+            }
+            return result;
+        }
+    }
+}
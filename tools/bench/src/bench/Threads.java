@@ -0,0 +1,157 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package bench;
+
+/**
+ * Benchmarks for the thread scheduler: thread switches caused by
+ * Thread.yield() and by wait()/notify(), and the time it takes a
+ * high priority thread to run after it wakes up.
+ */
+class Threads {
+
+    static class Yield extends Benchmark {
+        private volatile int count;
+
+        Yield() {
+            super("threads", "yield", "switch");
+        }
+
+        public int run(final int iterations) throws Exception {
+            count = 0;
+            Thread other = new Thread() {
+                public void run() {
+                    for (int i = 0; i < iterations; i++) {
+                        count++;
+                        Thread.yield();
+                    }
+                }
+            };
+            other.start();
+            for (int i = 0; i < iterations; i++) {
+                Thread.yield();
+            }
+            other.join();
+            return count;
+        }
+    }
+
+    /** Two threads that pass a token back and forth */
+    static class PingPong extends Benchmark {
+        private int turn;
+
+        PingPong() {
+            super("threads", "pingPong", "handoff");
+        }
+
+        synchronized void pass(int me, int next) throws InterruptedException {
+            while (turn != me) {
+                wait();
+            }
+            turn = next;
+            notify();
+        }
+
+        public int run(final int iterations) throws Exception {
+            turn = 0;
+            Thread other = new Thread() {
+                public void run() {
+                    try {
+                        for (int i = 0; i < iterations; i++) {
+                            pass(1, 0);
+                        }
+                    } catch (InterruptedException e) {
+                    }
+                }
+            };
+            other.start();
+            for (int i = 0; i < iterations; i++) {
+                pass(0, 1);
+            }
+            other.join();
+            return turn;
+        }
+    }
+
+    /**
+     * A high priority thread that sleeps repeatedly while low priority
+     * threads keep the processor busy.  Each iteration is one wakeup;
+     * the details give the average and worst delay between the end of
+     * the sleep and the moment the thread ran again.
+     */
+    static class WakeupLatency extends Benchmark {
+        private static final int SLEEP_MS = 5;
+        private static final int BUSY_THREADS = 3;
+
+        private volatile boolean done;
+        private long totalLatency;
+        private long maxLatency;
+        private int wakeups;
+
+        WakeupLatency() {
+            super("threads", "wakeupLatency", "wakeup");
+        }
+
+        public int run(final int iterations) throws Exception {
+            Thread[] busy = new Thread[BUSY_THREADS];
+            final int[] work = new int[BUSY_THREADS];
+
+            done = false;
+            for (int i = 0; i < BUSY_THREADS; i++) {
+                final int me = i;
+                busy[i] = new Thread() {
+                    public void run() {
+                        while (!done) {
+                            work[me]++;
+                        }
+                    }
+                };
+                busy[i].setPriority(Thread.MIN_PRIORITY);
+                busy[i].start();
+            }
+
+            Thread sleeper = new Thread() {
+                public void run() {
+                    long total = 0;
+                    long max = 0;
+                    try {
+                        for (int i = 0; i < iterations; i++) {
+                            long start = System.currentTimeMillis();
+                            Thread.sleep(SLEEP_MS);
+                            long latency =
+                                System.currentTimeMillis() - start - SLEEP_MS;
+                            if (latency < 0) {
+                                latency = 0;
+                            }
+                            total += latency;
+                            if (latency > max) {
+                                max = latency;
+                            }
+                        }
+                    } catch (InterruptedException e) {
+                    }
+                    totalLatency = total;
+                    maxLatency = max;
+                }
+            };
+            sleeper.setPriority(Thread.MAX_PRIORITY);
+            sleeper.start();
+            sleeper.join();
+
+            done = true;
+            for (int i = 0; i < BUSY_THREADS; i++) {
+                busy[i].join();
+            }
+            wakeups = iterations;
+            return (int)totalLatency;
+        }
+
+        public String details() {
+            long average = (wakeups == 0) ? 0 : totalLatency / wakeups;
+            return "\"avgLatencyMs\":" + average
+                 + ",\"maxLatencyMs\":" + maxLatency;
+        }
+    }
+}
@@ -249,6 +249,15 @@ public class KVMClassTable extends KVMHashtable {
         return ((KVMClassName)x).hashCode() & 0xFFFFFFFFL;
     }
 
+    Object entryFromName(String name) { 
+        return new KVMClassName(name);
+    }
+
+    // The VM compares the keys of classes, which include the depth
+    int baseHeadKey(Object x) { 
+        return getClassKey((KVMClassName)x);
+    }
+
     public String toString() { 
         return "<ClassTable " + hashCode() + ">";
     }
@@ -10,6 +10,9 @@ package runtime;
 import java.util.Enumeration;
 import java.util.Hashtable;
 import java.util.Vector;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
 
 abstract 
 public class KVMHashtable { 
@@ -20,6 +23,8 @@ public class KVMHashtable {
     private Hashtable nextEntry = new Hashtable();
     private Hashtable seen = new Hashtable();
     private Hashtable keys = new Hashtable();
+    // Entries of the base ROM image, when writing an application image
+    private Hashtable baseEntries = new Hashtable();
 
     public Enumeration enumerate() { 
         return seen.keys();
@@ -88,6 +93,122 @@ public class KVMHashtable {
         return size;
     }
 
+    int getCount() { 
+        return seen.size();
+    }
+
+    int getBaseCount() { 
+        return baseEntries.size();
+    }
+
+    boolean isBaseEntry(Object x) { 
+        return baseEntries.get(x) != null;
+    }
+
+    /*
+     * Add an entry of the base ROM image, with the key that it has there.
+     * The entries of each bucket must be added from the last to the first.
+     */
+    void addBaseEntry(Object x, int key) { 
+        checkType(x);
+        seen.put(x, x);
+        baseEntries.put(x, x);
+        int bucket = (int)(hash(x) % size);
+        Object oldNext = firstEntry[bucket];
+        firstEntry[bucket] = x;
+        if (oldNext != null) { 
+            nextEntry.put(x, oldNext);
+        }
+        if (key != -1) { 
+            setKey(x, key);
+        }
+    }
+
+    // The name under which an entry is written to a key file, and back
+    String entryName(Object x) { 
+        return x.toString();
+    }
+
+    Object entryFromName(String name) { 
+        return name;
+    }
+
+    // The key of a base entry that the VM checks when linking an
+    // application image to the base ROM image.
+    int baseHeadKey(Object x) { 
+        Integer Key = (Integer)keys.get(x);
+        return (Key == null) ? 0 : Key.intValue();
+    }
+
+    /*
+     * Write all the entries and their keys to a key file.  Each bucket is
+     * written from its last entry to its first, the order in which 
+     * readBaseEntries() adds them back.
+     */
+    void writeEntries(DataOutputStream keyFile) throws IOException { 
+        Vector list = new Vector();
+        keyFile.writeInt(size);
+        keyFile.writeInt(seen.size());
+        for (int i = 0; i < size; i++) { 
+            list.setSize(0);
+            for (Object item = firstEntry[i]; item != null; 
+                item = nextEntry.get(item)) { 
+                list.addElement(item);
+            }
+            keyFile.writeInt(list.size());
+            for (int j = list.size() - 1; j >= 0; j--) { 
+                Object item = list.elementAt(j);
+                Integer Key = (Integer)keys.get(item);
+                keyFile.writeUTF(entryName(item));
+                keyFile.writeInt(Key == null ? -1 : Key.intValue());
+            }
+        }
+    }
+
+    void readBaseEntries(DataInputStream keyFile) throws IOException { 
+        if (keyFile.readInt() != size) { 
+            throw new IOException("Hashtable size doesn't match " + this);
+        }
+        int count = keyFile.readInt();
+        for (int i = 0; i < size; i++) { 
+            for (int j = keyFile.readInt(); j > 0; j--) { 
+                Object item = entryFromName(keyFile.readUTF());
+                addBaseEntry(item, keyFile.readInt());
+            }
+        }
+        if (count != baseEntries.size()) { 
+            throw new IOException("Bad key file for " + this);
+        }
+    }
+
+    /*
+     * Write the records with which the VM puts the entries of an 
+     * application image at the front of the buckets of the base ROM
+     * image.  The entries of the image come before the base entries in
+     * each bucket.  "next" is the name of the next field of an entry.
+     */
+    void writeBucketRecords(CCodeWriter out, String table, String next) { 
+        for (int i = 0; i < size; i++) { 
+            Object first = firstEntry[i];
+            if (first == null || isBaseEntry(first)) { 
+                continue;
+            }
+            Object last = first;
+            for (Object item = nextEntry.get(first); 
+                 item != null && !isBaseEntry(item); 
+                 item = nextEntry.get(item)) { 
+                last = item;
+            }
+            Object base = nextEntry.get(last);
+            out.print("\tAPP_BUCKET_RECORD(" + table + ", " + i + ", " 
+                      + ((base == null) ? 0 : baseHeadKey(base)) + ", ");
+            tableEntry(out, i, first);
+            out.print(", &(");
+            tableEntry(out, i, last);
+            out.println(")" + next + "),");
+        }
+    }
+
     protected void setKey(Object x, int key) { 
         checkType(x);
         Integer Key = new Integer(key);
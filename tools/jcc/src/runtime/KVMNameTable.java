@@ -35,12 +35,22 @@ class KVMNameTable extends KVMHashtable {
     KVMClassTable classTable;
 
     void writeTable(CCodeWriter out, String tableName) { 
+    writeStrings(out);
+    super.writeTable(out, tableName);
+    }
+
+    // Write the strings, without the hashtable.  The strings of the base
+    // ROM image aren't written when writing an application image.
+    void writeStrings(CCodeWriter out) { 
     Vector all = new Vector();
     BitSet seenSizes   = new BitSet();
     for (int i = 0; i < TABLE_SIZE; i++) { 
         for (  String entry = (String)getFirst(i); 
            entry != null; 
            entry = (String)getNext(entry)) { 
+        if (isBaseEntry(entry)) { 
+            continue;
+        }
         String keyFilled = 
             Integer.toHexString(getNameKey(entry)+0x10000).substring(1);
         all.add(new String[]{entry, keyFilled});
@@ -76,7 +86,9 @@ class KVMNameTable extends KVMHashtable {
         String[] pair = (String[])e.nextElement(); 
         String entry = pair[0];
         String key = pair[1];
-        String nextEntryName = getUString((String)getNext(entry));
+        String next = (String)getNext(entry);
+        String nextEntryName = 
+            (next == null || isBaseEntry(next)) ? "NULL" : getUString(next);
             out.print("\tUSTRING(" + key + ", " + nextEntryName + ", " + 
               entry.length() + ", ");
             out.printSafeString(entry);
@@ -92,7 +104,6 @@ class KVMNameTable extends KVMHashtable {
         out.println();
     }
     out.println("};\n");
-    super.writeTable(out, tableName);
     }
 
 
@@ -144,6 +144,21 @@ public class KVMStackMap implements Const {
     out.println(prefix + "},");
     }
 
+    // The contents of the stack map of a method, as written by
+    // printDefinition().  Methods with equal contents can share one map.
+    String contents(EVMMethodInfo meth) { 
+    MethodInfo mi = meth.method;
+    StackMapFrame frames[] = mi.stackMapTable;
+    StringBuffer sb = new StringBuffer();
+    sb.append(useShortStackMaps(meth) ? 'S' : 'L');
+    for (int i = 0; i < frames.length; i++) { 
+        sb.append(frames[i].getOffset()).append(',')
+          .append(frames[i].getStackSize()).append(',')
+          .append(frameToLong(mi, frames[i])).append(';');
+    }
+    return sb.toString();
+    }
+
     java.util.Hashtable useShortStackMapsCache = new java.util.Hashtable();
     static int longStackMaps;
 
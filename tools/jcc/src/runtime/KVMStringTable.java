@@ -16,14 +16,21 @@ public class KVMStringTable extends vm.StringTable {
     static final public String stringArrayName = "stringArrayInternal";
     
     StringHashTable stringHashTable = new StringHashTable();
+    boolean hasCharacterArray;
 
     final int writeStrings(KVMWriter writer, String name){
-    writeCharacterArray(writer);
-    writeStringInfo(writer);
+    writeStringData(writer);
     stringHashTable.writeTable(writer.out, name);
     return internedStringCount();
     }
 
+    // Write the strings, without the hashtable
+    final int writeStringData(KVMWriter writer){
+    hasCharacterArray = writeCharacterArray(writer);
+    writeStringInfo(writer);
+    return internedStringCount();
+    }
+
     private boolean writeCharacterArray(KVMWriter writer) {
     final CCodeWriter out = writer.out;
     int n = arrangeStringData();
@@ -143,5 +150,9 @@ public class KVMStringTable extends vm.StringTable {
         writeString(out, s);
         }
     }
+
+    String entryName(Object x) { 
+        return ((StringConstant)x).str.string;
+    }
     }
 }
@@ -15,6 +15,9 @@ import java.util.Vector;
 import java.util.Enumeration;
 import java.util.Hashtable;
 import java.io.OutputStream;
+import java.io.DataOutputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
 
 /*
  * The CoreImageWriter for the Embedded VM
@@ -42,9 +45,19 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
 
     boolean        buildingRelocationTable = false;
     boolean        relocatableROM = false;
+    boolean        applicationImage = false;
 
-    protected static final String           staticStoreName = "KVM_staticData";
-    protected static final String           masterStaticStoreName = "KVM_masterStaticData";
+    // Written with "-imageAttribute keys=<file>", for KVM_AppWriter
+    String         keyFileName;
+
+    protected String           staticStoreName = "KVM_staticData";
+    protected String           masterStaticStoreName = "KVM_masterStaticData";
+
+    // The C expression for the address of the constant pool entry or
+    // static variable being written by writeConstant(), and the link
+    // records of an application image (see KVM_AppWriter)
+    String         constantSlot;
+    Vector         links = new Vector();
 
     // In ROMjava.c we need to make several "forward static" declarations,
     // where the forward declaration has no initializer and the later
@@ -76,6 +89,22 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
     MethodInfo runCustomCodeMethod;
     MethodConstant runCustomCodeConstant;
 
+    // Methods with identical bytecode, exception handler tables or stack
+    // maps share one copy, that of the first such method.  These map the
+    // contents to the native name of that method, and the native name
+    // of every other method to it.
+    Hashtable codeContents = new Hashtable();
+    Hashtable handlerContents = new Hashtable();
+    Hashtable stackMapContents = new Hashtable();
+    Hashtable codeOwners = new Hashtable();
+    Hashtable handlerOwners = new Hashtable();
+    Hashtable stackMapOwners = new Hashtable();
+
+    /* for statistics only: bytes not written because they are shared */
+    int  nsharedcode;
+    int  nsharedhandlers;
+    int  nsharedstackmaps;
+
     public KVMWriter( ){ 
         nameTable = new KVMNameTable(); 
         classTable = new KVMClassTable(nameTable);
@@ -91,6 +120,10 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
     }
 
     public boolean setAttribute( String attribute ){
+        if (attribute.startsWith("keys=")) { 
+            keyFileName = attribute.substring(5);
+            return true;
+        }
         return false; 
     }
 
@@ -168,7 +201,7 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         if (relocatableROM) { 
             out.println("void *StringSectionHeader = &StringSectionHeader;");
         }
-        njavastrings = stringTable.writeStrings(this, "InternStringTable");
+        njavastrings = writeInternStringTable();
         if (relocatableROM) { 
             out.println("void *StringSectionTrailer = &StringSectionTrailer;");
         }
@@ -182,7 +215,7 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         if (relocatableROM) { 
             out.println("void *UTFSectionHeader = &UTFSectionHeader;");
         }
-        nameTable.writeTable(out, "UTFStringTable");
+        writeUTFStringTable();
         if (relocatableROM) { 
             out.println("void *UTFSectionTrailer = &UTFSectionTrailer;");
         }
@@ -192,9 +225,17 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
 
         out.println("\014");
         writeEpilog();
+
+        if (keyFileName != null) { 
+            writeKeyFile(keyFileName);
+        }
         } else { 
         writeRelocationFile(classes);
         }
+    } catch (IOException e) { 
+            out.flush();
+            System.out.println(e);
+            formatError = true;
     } catch (DataFormatException e) { 
             out.flush();
             System.out.println(e);
@@ -212,7 +253,7 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
     protected void initialPass(ClassClass classes[]) { 
         for (int i = 0; i < classes.length; i++) { 
             EVMClass cc = (EVMClass) classes[i];
-            if (cc.isPrimitiveClass()) { 
+            if (cc.isPrimitiveClass() || !isImageClass(cc.ci.className)) { 
                 /* Do nothing */
             } else if (cc.isArrayClass()) {             
                 /* Make sure this is in the table */
@@ -240,13 +281,15 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
                 for (int index = 0; index < fieldCount; index++) { 
                     classTable.getNameAndTypeKey(f[index]);
             if (f[index].isStaticMember() && 
-            f[index].value instanceof StringConstant) { 
+            f[index].value instanceof StringConstant &&
+            isImageString((StringConstant) f[index].value)) { 
                         stringTable.intern( (StringConstant) f[index].value);
             }
         }
                 for (int index = 1; index < constantCount;) {
                     ConstantObject obj = cpool[index];
-                    if (obj instanceof StringConstant){
+                    if (obj instanceof StringConstant &&
+                        isImageString((StringConstant) obj)){
                         stringTable.intern( (StringConstant) obj);
                     }
                     index += obj.nSlots;
@@ -275,6 +318,9 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
 
         for (Enumeration e = classTable.enumerate(); e.hasMoreElements(); ) { 
             String name = ((KVMClassName)e.nextElement()).toString();
+            if (!isImageClass(name)) { 
+                continue;
+            }
             ClassInfo ci = ClassInfo.lookupClass(name);
             if (ci == null) { 
                 if (name.charAt(0) == '[') { 
@@ -322,6 +368,9 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
          */
         for (int cno = 0; cno < nclass; cno++ ){
             EVMClass c = (EVMClass)(classes[cno]);
+            if (!isImageClass(c.ci.className)) { 
+                continue;
+            }
             c.orderStatics();
             nRef += c.nStaticRef;
             nStaticWords += c.nStaticWords;
@@ -341,7 +390,8 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         for ( int cno = 0; cno < nclass; cno++ ){
             EVMClass c = (EVMClass)(classes[cno]);
             FieldInfo f[] = c.statics;
-            if ((f == null) || (f.length == 0 )) { 
+            if ((f == null) || (f.length == 0 ) 
+                   || !isImageClass(c.ci.className)) { 
         continue; // this class has none
         }
             int nFields = f.length;
@@ -368,6 +418,8 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         public void print(int index) { 
             ConstantObject value = staticInitialValue[index];
             if (value != null) { 
+            constantSlot = "&" + masterStaticStoreName 
+                + ".roots[" + (index - 1) + "]";
             out.print("ROM_STATIC_");
             if (value.nSlots == 1) { 
                 writeConstant(value, false);
@@ -414,7 +466,7 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         for (Enumeration e = classTable.enumerate(); e.hasMoreElements(); ) { 
             String name = ((KVMClassName)e.nextElement()).toString();
             ClassInfo ci = ClassInfo.lookupClass(name);
-            if (ci != null) { 
+            if (ci != null && isImageClass(name)) { 
                 EVMClass cc = (EVMClass)ci.vmClass;
                 if (!cc.isPrimitiveClass() && !cc.isArrayClass()) { 
                     String nativeName = cc.getNativeName();
@@ -453,7 +505,9 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         for (Enumeration e = classTable.enumerate(); e.hasMoreElements(); ) { 
             String name = ((KVMClassName)e.nextElement()).toString();
             ClassInfo ci = ClassInfo.lookupClass(name);
-            if (ci == null) { 
+            if (!isImageClass(name)) { 
+                /* Part of the base ROM image */
+            } else if (ci == null) { 
                 writeRawClassDefinition(name);
             } else { 
                 EVMClass cc = (EVMClass)ci.vmClass;
@@ -468,12 +522,9 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         }
     out.println("};");
 
-        /* Write out the Class Table */
-        out.println("\014");
-        classTable.writeTable(out, "ClassTable");
-        /* Write the primitive array table */
+        /* Write out the Class Table and the primitive array table */
         out.println("\014");
-        writePrimitiveArrayTable(classes);
+        writeClassTables(classes);
 
     if (relocatableROM) { 
         out.println("void *ClassDefinitionSectionTrailer = &ClassDefinitionSectionTrailer;");
@@ -505,6 +556,10 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         }
         if (c.ci.superClass == null) {
             out.println("\t\tNULL, \\");
+        } else if (!isImageClass(c.ci.superClass.name.string)) { 
+            out.println("\t\tNULL, \\");
+            addClassLink("&AllClassblocks." + nativeName + ".superClass",
+                         c.ci.superClass.name.string);
         } else {
             ClassInfo sci = ClassInfo.lookupClass(c.ci.superClass.name.string);
             String superName = ((EVMClass)(sci.vmClass)).getNativeName();
@@ -545,9 +600,17 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
             ClassInfo elemClass = 
                 ClassInfo.lookupClass(((ClassConstant)cp).name.string);
             String elemName = ((EVMClass)(elemClass.vmClass)).getNativeName();
+            if (!isImageClass(elemClass.className)) { 
+                writeBasicClassInfo(c, "arrayClassStruct", 
+                                    "ARRAY_OF_LINKED_OBJECT", access);
+                out.println("\t\tNULL),");
+                addClassLink("&AllClassblocks." + c.getNativeName() 
+                             + ".u.elemClass", elemClass.className);
+            } else { 
             writeBasicClassInfo(c, "arrayClassStruct", 
                                 "ARRAY_OF_OBJECT", access);
         out.println("\t\tAllClassblocks." + elemName + "),");
+            }
         } else {
             String baseName = ((ArrayClassInfo)(c.ci)).baseName.toUpperCase();
             writeBasicClassInfo(c, "arrayClassStruct", 
@@ -583,13 +646,16 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         if (packageKey == -1) {
             out.println("\t\tNULL, ");
         } else { 
-            out.println("\t\t" + nameTable.getUString(packageName) 
+            out.println("\t\t" + nameReference(packageName, 
+                          "&AllClassblocks." + nativeName + ".clazz.packageName")
                         + ",  /* " + packageName + " */ \\");
         }
-        out.println("\t\t" + nameTable.getUString(fullBaseName) 
+        out.println("\t\t" + nameReference(fullBaseName, 
+                          "&AllClassblocks." + nativeName + ".clazz.baseName")
                     + ",  /* " + fullBaseName + " */ \\");
         KVMClassName nextName = (KVMClassName)classTable.getNext(cn);
-        if (nextName == null) { 
+        if (nextName == null || !isImageClass(nextName.toString())) { 
+            /* An application image is linked to the base by the VM */
             out.print("\t\tNULL, ");
         } else {
             EVMClass next = nextName.getEVMClass();
@@ -656,7 +722,9 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
     }
     sectionCounter.endLastSection();
     out.println("};\n");
-    if (!relocatableROM) { 
+    if (applicationImage) { 
+        // RunCustomCodeMethod is part of the base ROM image
+    } else if (!relocatableROM) { 
         // We need to coercion to remove the CONST-ness
         out.print("METHOD RunCustomCodeMethod = (METHOD) ROM_CLINIT_");
         writeConstant(runCustomCodeConstant, true);
@@ -755,6 +823,7 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         /* Find the values of the two special methods */
     Vector todo = new Vector();
     Vector natives = new Vector();
+    Vector shared = new Vector();
     SectionCounter sectionCounter = 
         new SectionCounter(relocatableROM ? 50000 : Integer.MAX_VALUE);
     
@@ -775,6 +844,13 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
                     /* Do nothing */
                 } else if ((mi.access & Const.ACC_NATIVE) != 0) { 
             natives.addElement(meth);
+                } else if (mi != runCustomCodeMethod && 
+                           findSharedOwner(codeContents, codeOwners, 
+                                           new ArrayEqual(mi.code), 
+                                           meth.getNativeName()) != null) {
+                    // Written after all the others; see below
+                    shared.addElement(meth);
+                    nsharedcode += mi.code.length;
                 } else { 
             String methodNativeName = meth.getNativeName();
                     int alignment = meth.alignment();
@@ -797,6 +873,35 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         }
         }
     }
+    // The bytecode of a method is only shared when it is read-only.
+    // The copies come last, so that the layout of the others, and their
+    // alignment, doesn't depend on whether they are there.
+    if (shared.size() > 0) { 
+        out.println("#if ENABLEFASTBYTECODES || ENABLE_JAVA_DEBUGGER");
+        todo.addElement(SHARED_CODE_START);
+        for (Enumeration e = shared.elements(); e.hasMoreElements(); ) { 
+        EVMMethodInfo meth = (EVMMethodInfo)e.nextElement();
+        MethodInfo mi = meth.method;
+        String methodNativeName = meth.getNativeName();
+        int alignment = meth.alignment();
+        int padding = 
+            alignment - (sectionCounter.getOffset() % alignment);
+        if (padding != alignment) { 
+            sectionCounter.notNextSection(padding);
+            out.println("\t\tBYTE padding" + (++padCount) + "["
+                + padding + "];");
+            todo.addElement(new Integer(padding));
+        }
+        sectionCounter.notNextSection(mi.code.length);
+        out.println("\t\t/* " +  prettyName(mi) + " */");
+        out.println("\t\tBYTE " + methodNativeName 
+                + "[" + mi.code.length + "];" );
+        todo.addElement(meth);
+        todo.addElement(methodNativeName);
+        }
+        todo.addElement(SHARED_CODE_END);
+        out.println("#endif");
+    }
     sectionCounter.endLastSection();
     ncodebytes = sectionCounter.getTotalLength();
         out.println("};");
@@ -809,7 +914,13 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
     sectionCounter.startFirstSection(SectionCounter.Initialization); 
     for (Enumeration e = todo.elements(); e.hasMoreElements(); ) { 
         Object nextElement = e.nextElement();
-        if (nextElement instanceof Integer) { 
+        if (nextElement == SHARED_CODE_START) { 
+        out.println("#if ENABLEFASTBYTECODES || ENABLE_JAVA_DEBUGGER");
+        continue;
+        } else if (nextElement == SHARED_CODE_END) { 
+        out.println("#endif");
+        continue;
+        } else if (nextElement instanceof Integer) { 
         int padding = ((Integer)nextElement).intValue();
         sectionCounter.notNextSection(padding);
         out.println("\t\t{ 0 }, /* padding size " + padding + " */");
@@ -818,7 +929,11 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
             EVMMethodInfo meth = (EVMMethodInfo)nextElement;
         String methodNativeName = (String)e.nextElement();
             final MethodInfo mi = meth.method;
+        if (codeOwners.get(methodNativeName) != null) { 
+        sectionCounter.notNextSection(mi.code.length);
+        } else { 
         sectionCounter.maybeNextSection(mi.code.length);
+        }
             out.println("\t\t{ /* " + mi.parent.className + ": " 
                       + prettyName(mi) + " */");
         writeArray(mi.code.length, 10, "\t\t\t", 
@@ -865,7 +980,12 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
             mi.exceptionTable = empty;
         }
                 int tryCatches = mi.exceptionTable.length;
-                if (tryCatches > 0) { 
+                if (tryCatches > 0 &&
+                    findSharedOwner(handlerContents, handlerOwners,
+                                    handlerTableContents(mi),
+                                    meth.getNativeName()) != null) { 
+                    nsharedhandlers += 4 + 8 * tryCatches;
+                } else if (tryCatches > 0) { 
                     String methodNativeName = meth.getNativeName();
                     todo.addElement(meth);
                     ncatchframes += tryCatches;
@@ -922,7 +1042,12 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         if (mi.stackMapTable == null) { 
             mi.stackMapTable = empty;
         }
-        if (mi.stackMapTable.length > 0) { 
+        if (mi.stackMapTable.length > 0 &&
+            findSharedOwner(stackMapContents, stackMapOwners,
+                            stackMapUtil.contents(meth),
+                            meth.getNativeName()) != null) { 
+            nsharedstackmaps += 4 + 4 * mi.stackMapTable.length;
+        } else if (mi.stackMapTable.length > 0) { 
                     todo.addElement(meth);
             stackMapUtil.printDeclaration(out, meth, "\t");
                 } 
@@ -978,17 +1103,27 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         }
         } else { 
         String methodNativeName = meth.getNativeName();
+        String codeOwner = (String)codeOwners.get(methodNativeName);
+        if (codeOwner == null) { 
         out.println("\t\t\t\t\tAllCode." 
                 + methodNativeName + "_CodeSection."
                 + methodNativeName + ", \\");
+        } else { 
+        out.println("\t\t\t\t\tROM_SHARED_CODE(AllCode." 
+                + codeOwner + "_CodeSection." + methodNativeName 
+                + ", AllCode." + codeOwner + "_CodeSection." 
+                + codeOwner + "), \\");
+        }
                 if (mi.exceptionTable.length > 0) { 
-                    out.println("\t\t\t\t\t&AllHandlers." + methodNativeName
+                    out.println("\t\t\t\t\t&AllHandlers." 
+                + sharedName(handlerOwners, methodNativeName)
                 + ", \\");
         } else { 
             out.println("\t\t\t\t\t0, \\");
         }
                 if (mi.stackMapTable.length > 0) { 
-                    out.println("\t\t\t\t\t&AllStackMaps." + methodNativeName
+                    out.println("\t\t\t\t\t&AllStackMaps." 
+                + sharedName(stackMapOwners, methodNativeName)
                 + ", \\");
         } else { 
             out.println("\t\t\t\t\t0, \\");
@@ -1064,6 +1199,8 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
             break;
         }
         out.print("\t\t\tROM_CPOOL_");
+        constantSlot = "&AllConstantPools." + c.getNativeName() 
+                + ".entries[" + index + "]";
             writeConstant(cpool[index], true);
         index += cp.nSlots;
         out.println(index < length ? "," : "");
@@ -1153,9 +1290,14 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
              break;
 
         case Const.CONSTANT_STRING:
+        if (!isImageString((StringConstant)value)) { 
+            out.print("INT(0)");
+            addStringLink(((StringConstant)value).str.string);
+        } else { 
         out.print("STRING(");
             stringTable.writeString(out, (StringConstant)value);
         out.print(")");
+        }
         if (verbose) { 
         out.print(" /* ");
         out.printSafeString(((StringConstant)value).str.string);
@@ -1179,7 +1321,12 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
             if (value.isResolved()) {
                 ClassInfo ci = ((ClassConstant)value).find();
                 EVMClass c = (EVMClass)(ci.vmClass);
+                if (!isImageClass(ci.className)) { 
+                    out.print("INT(0) /* " + ci.className + " */");
+                    addClassLink(constantSlot, ci.className);
+                } else { 
                 out.print("CLASS(" + c.getNativeName() + ")");
+                }
             } else {
                 System.out.println("Unresolved class constant: "+value.toString() );
         formatError = true;
@@ -1193,8 +1340,15 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
                 MethodInfo mi = ((MethodConstant)value).find();
                 ClassInfo  ci = mi.parent;
                 EVMClass   EVMci = (EVMClass)(ci.vmClass);
+        if (!isImageClass(ci.className)) { 
+            out.print("INT(0)");
+            addLink("APP_LINK_METHOD_RECORD(" + constantSlot + ", "
+                    + classTable.getClassKey(ci.className) + ", "
+                    + classTable.getNameAndTypeKey(mi) + ")");
+        } else { 
         out.print("METHOD(" + EVMci.getNativeName() 
               + ", " + mi.index + ")");
+        }
         if (verbose) { 
             out.print(" /* " + prettyName(mi) + " */");
         }
@@ -1210,7 +1364,14 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
                 FieldInfo fi = ((FieldConstant)value).find();
                 ClassInfo ci = fi.parent;
                 String className = ((EVMClass)(ci.vmClass)).getNativeName();
+        if (!isImageClass(ci.className)) { 
+            out.print("INT(0)");
+            addLink("APP_LINK_FIELD_RECORD(" + constantSlot + ", "
+                    + classTable.getClassKey(ci.className) + ", "
+                    + classTable.getNameAndTypeKey(fi) + ")");
+        } else { 
         out.print("FIELD(" + className + ", " + fi.index + ")");
+        }
         if (verbose) { 
             out.print(" /* " + prettyName(fi) + " */");
         }
@@ -1436,8 +1597,60 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
         o.println(Localizer.getString("cwriter.field_blocks", Integer.toString(nfields)));
         o.println(Localizer.getString("cwriter.constant_pool_entries", Integer.toString(nconstants)));
         o.println(Localizer.getString("cwriter.java_strings",Integer.toString(njavastrings)));
+        o.println(Localizer.getString("cwriter.shared_code", Integer.toString(nsharedcode)));
+        o.println(Localizer.getString("cwriter.shared_handlers", Integer.toString(nsharedhandlers)));
+        o.println(Localizer.getString("cwriter.shared_stack_maps", Integer.toString(nsharedstackmaps)));
+        o.println(Localizer.getString("cwriter.shared_string_chars", Integer.toString(stringTable.sharedChars)));
+        // Java code is only shared when it is read-only, which it isn't
+        // in the usual builds, so it is left out of the total
+        o.println(Localizer.getString("cwriter.shared_total",
+                      Integer.toString(nsharedhandlers + nsharedstackmaps
+                                       + 2 * stringTable.sharedChars)));
     }
     
+    /*
+     * Returns the native name of the method whose copy of "contents" the
+     * method "name" should use, or null if it is the first one with these
+     * contents.  Nothing is shared in a relocatable ROM, which is split
+     * into separate resources.
+     */
+    String findSharedOwner(Hashtable contents, Hashtable owners, 
+                           Object key, String name) { 
+        if (relocatableROM) { 
+            return null;
+        }
+        String owner = (String)contents.get(key);
+        if (owner == null) { 
+            contents.put(key, name);
+            return null;
+        }
+        owners.put(name, owner);
+        return owner;
+    }
+
+    String sharedName(Hashtable owners, String name) { 
+        String owner = (String)owners.get(name);
+        return (owner == null) ? name : owner;
+    }
+
+    // The catch types are indices into the constant pool of the class of
+    // the method, so tables are equal if they have the same numbers
+    String handlerTableContents(MethodInfo mi) { 
+        StringBuffer sb = new StringBuffer();
+        for (int k = 0; k < mi.exceptionTable.length; k++) { 
+            ExceptionEntry ee = mi.exceptionTable[k];
+            sb.append(ee.startPC).append(',').append(ee.endPC).append(',')
+              .append(ee.handlerPC).append(',')
+              .append(ee.catchType == null ? 0 : ee.catchType.index)
+              .append(';');
+        }
+        return sb.toString();
+    }
+
+    // Markers for writeAllByteCodes()
+    private static final Object SHARED_CODE_START = new Object();
+    private static final Object SHARED_CODE_END = new Object();
+
     abstract public static class ArrayPrinter { 
         abstract void print(int index);
         boolean finalComma() { return false; }
@@ -1569,4 +1782,106 @@ public class KVMWriter implements CoreImageWriter, Const, EVMConst {
     protected void writeRelocationFile(ClassClass classes[]) { 
     }
 
+    // Here so that KVM_AppWriter can override them.  An application
+    // image doesn't contain the classes and strings of the base ROM
+    // image, or the hashtables themselves.
+    protected boolean isImageClass(String className) { 
+        return true;
+    }
+
+    protected boolean isImageString(StringConstant s) { 
+        return true;
+    }
+
+    protected String nameReference(String name, String slot) { 
+        return nameTable.getUString(name);
+    }
+
+    protected int writeInternStringTable() { 
+        return stringTable.writeStrings(this, "InternStringTable");
+    }
+
+    protected void writeUTFStringTable() { 
+        nameTable.writeTable(out, "UTFStringTable");
+    }
+
+    protected void writeClassTables(ClassClass classes[]) { 
+        classTable.writeTable(out, "ClassTable");
+        out.println("\014");
+        writePrimitiveArrayTable(classes);
+    }
+
+    /*
+     * Record that the object of the base ROM image that the application
+     * image refers to must be stored at "slot" when the image is linked.
+     */
+    protected void addLink(String record) { 
+        if (constantSlot == null) { 
+            System.out.println("Reference to the base image in " 
+                               + "unexpected place: " + record);
+            formatError = true;
+        }
+        links.addElement(record);
+    }
+
+    protected void addClassLink(String slot, String className) { 
+        constantSlot = slot;
+        addLink("APP_LINK_CLASS_RECORD(" + slot + ", " 
+                + classTable.getClassKey(className) + ")");
+    }
+
+    protected void addStringLink(String string) { 
+        addLink("APP_LINK_STRING_RECORD(" + constantSlot + ", "
+                + utfLiteral(string) + ", " + utfLength(string) + ")");
+    }
+
+    /*
+     * Write the keys that this image gives to names and classes, and the
+     * strings that it interns, so that application images can be built
+     * against it (see KVM_AppWriter).
+     */
+    protected void writeKeyFile(String fileName) throws IOException { 
+        DataOutputStream keys = 
+            new DataOutputStream(new FileOutputStream(fileName));
+        keys.writeInt(KVM_AppWriter.KEY_FILE_MAGIC);
+        nameTable.writeEntries(keys);
+        classTable.writeEntries(keys);
+        stringTable.stringHashTable.writeEntries(keys);
+        keys.close();
+    }
+
+    // The contents of a string as a C literal of its UTF-8 bytes
+    String utfLiteral(String string) { 
+        StringBuffer bytes = new StringBuffer();
+        for (int i = 0; i < string.length(); i++) { 
+            char c = string.charAt(i);
+            if (c >= 0x0001 && c <= 0x007F) { 
+                bytes.append(c);
+            } else if (c <= 0x07FF) { 
+                bytes.append((char)(0xC0 | (c >> 6)));
+                bytes.append((char)(0x80 | (c & 0x3F)));
+            } else { 
+                bytes.append((char)(0xE0 | (c >> 12)));
+                bytes.append((char)(0x80 | ((c >> 6) & 0x3F)));
+                bytes.append((char)(0x80 | (c & 0x3F)));
+            }
+        }
+        java.io.ByteArrayOutputStream literal = 
+            new java.io.ByteArrayOutputStream();
+        CCodeWriter writer = new CCodeWriter(literal);
+        writer.printSafeString(bytes.toString());
+        writer.flush();
+        return literal.toString();
+    }
+
+    int utfLength(String string) { 
+        int length = 0;
+        for (int i = 0; i < string.length(); i++) { 
+            char c = string.charAt(i);
+            length += (c >= 0x0001 && c <= 0x007F) ? 1 
+                    : (c <= 0x07FF) ? 2 : 3;
+        }
+        return length;
+    }
+
 }
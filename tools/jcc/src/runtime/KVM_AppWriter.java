@@ -0,0 +1,245 @@
+/*
+ *        KVM_AppWriter.java
+ *
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+package runtime;
+import vm.Const;
+import vm.EVMConst;
+import components.*;
+import vm.*;
+import util.*;
+import java.util.Vector;
+import java.util.Enumeration;
+import java.util.Hashtable;
+import java.io.DataInputStream;
+import java.io.FileInputStream;
+import java.io.IOException;
+
+/*
+ * The CoreImageWriter for application images (-arch KVM_App).
+ *
+ * An application image holds the classes of an application, romized
+ * against the ROM image of a VM.  JavaCodeCompact is given the same
+ * classes as when the VM was romized, followed by those of the
+ * application, and the key file that was written for the VM with
+ * "-imageAttribute keys=<file>":
+ *
+ *   JavaCodeCompact -arch KVM_App -imageAttribute base=ROMjava.keys
+ *                   -o AppImage.c classes.zip app.jar
+ *
+ * The classes, names and strings of the base ROM image are not written
+ * again.  References to them are written as link records that the VM
+ * resolves when it loads the image (see appImage.c), and the image gets
+ * the keys that the VM would give to its names and classes if they were
+ * loaded from class files.  The C file is compiled into a shared library
+ * that exports the descriptor "KVM_AppImage".
+ */
+
+public class KVM_AppWriter extends KVMWriter
+    implements CoreImageWriter, Const, EVMConst {
+
+    static final int KEY_FILE_MAGIC = 0x4B564D4B;    /* "KVMK" */
+
+    // Strings interned by the base ROM image
+    Hashtable baseStrings = new Hashtable();
+    int baseStringCount;
+    boolean haveBase;
+
+    public KVM_AppWriter() {
+        applicationImage = true;
+        staticStoreName = "AppImage_staticData";
+        masterStaticStoreName = "AppImage_masterStaticData";
+    }
+
+    public boolean setAttribute( String attribute ){
+        if (attribute.startsWith("base=")) {
+            try {
+                readKeyFile(attribute.substring(5));
+            } catch (IOException e) {
+                System.out.println(e);
+                formatError = true;
+            }
+            haveBase = true;
+            return true;
+        }
+        return super.setAttribute(attribute);
+    }
+
+    /*
+     * Read the key file of the base ROM image (see writeKeyFile()), and
+     * put its names and classes into our hashtables with the same keys.
+     */
+    void readKeyFile(String fileName) throws IOException {
+        DataInputStream keys =
+            new DataInputStream(new FileInputStream(fileName));
+        if (keys.readInt() != KEY_FILE_MAGIC) {
+            throw new IOException(fileName + " is not a key file");
+        }
+        nameTable.readBaseEntries(keys);
+        classTable.readBaseEntries(keys);
+
+        // Interned strings have no keys; the VM looks them up by value
+        int size = keys.readInt();
+        baseStringCount = keys.readInt();
+        for (int i = 0; i < size; i++) {
+            for (int j = keys.readInt(); j > 0; j--) {
+                String string = keys.readUTF();
+                keys.readInt();
+                baseStrings.put(string, string);
+            }
+        }
+        keys.close();
+    }
+
+    protected void initialPass(ClassClass classes[]) {
+        if (!haveBase) {
+            System.out.println("No base image: use -imageAttribute base=<keyfile>");
+            formatError = true;
+        }
+        for (int i = 0; i < classes.length; i++) {
+            EVMClass cc = (EVMClass) classes[i];
+            if (cc.isPrimitiveClass() || cc.isArrayClass()
+                  || !isImageClass(cc.ci.className)) {
+                continue;
+            }
+            EVMMethodInfo m[] = cc.methods;
+            int nmethod = (m == null) ? 0 : m.length;
+            for (int j = 0; j < nmethod; j++) {
+                MethodInfo mi = m[j].method;
+                if ((mi.access & Const.ACC_NATIVE) != 0) {
+                    // The image can't be linked to native code
+                    System.out.println("Native method in application image: "
+                                       + prettyName(mi));
+                    formatError = true;
+                }
+            }
+        }
+        super.initialPass(classes);
+    }
+
+    protected boolean isImageClass(String className) {
+        return !classTable.isBaseEntry(new KVMClassName(className));
+    }
+
+    protected boolean isImageString(StringConstant s) {
+        return baseStrings.get(s.str.string) == null;
+    }
+
+    protected String nameReference(String name, String slot) {
+        if (nameTable.isBaseEntry(name)) {
+            constantSlot = slot;
+            addLink("APP_LINK_NAME_RECORD(" + slot + ", "
+                    + nameTable.getNameKey(name) + ")");
+            return "NULL";
+        }
+        return super.nameReference(name, slot);
+    }
+
+    // The hashtables are those of the base ROM image
+    protected int writeInternStringTable() {
+        return stringTable.writeStringData(this);
+    }
+
+    protected void writeUTFStringTable() {
+        nameTable.writeStrings(out);
+    }
+
+    protected void writeClassTables(ClassClass classes[]) {
+    }
+
+    protected void writeProlog(){
+        java.util.Date date = new java.util.Date();
+        out.println("/* This is a generated file.  Do not modify.");
+        out.println(" * Generated on " + date);
+        out.println(" */\n");
+        out.println();
+        out.println("#define COMPILING_APPIMAGE 1");
+        out.println();
+        out.println("/* The VM writes the links to the base image into the");
+        out.println(" * image, so nothing is const. */");
+        out.println("#define CONST");
+        out.println();
+        for ( int i = 0; i < stdHeader.length; i++ ){
+            out.println( stdHeader[i] );
+        }
+        out.println("#if ENABLE_APP_IMAGE");
+        out.println();
+    }
+
+    protected void writeEpilog() {
+        Vector classes = new Vector();
+        for (Enumeration e = classTable.enumerate(); e.hasMoreElements(); ) {
+            KVMClassName cn = (KVMClassName)e.nextElement();
+            if (!classTable.isBaseEntry(cn)) {
+                classes.addElement(cn);
+            }
+        }
+        if (classes.size() == 0) {
+            System.out.println("No application classes");
+            formatError = true;
+        }
+
+        out.println("static struct appImageLinkStruct AppImage_links[] = {");
+        for (Enumeration e = links.elements(); e.hasMoreElements(); ) {
+            out.println("\t" + e.nextElement() + ",");
+        }
+        // There is always at least one: the superclass of a class
+        out.println("};\n");
+
+        out.println("static struct appImageBucketStruct AppImage_buckets[] = {");
+        nameTable.writeBucketRecords(out, "APP_TABLE_UTF", "->next");
+        classTable.writeBucketRecords(out, "APP_TABLE_CLASS", "->clazz.next");
+        stringTable.stringHashTable.writeBucketRecords(out,
+                                                       "APP_TABLE_STRING",
+                                                       "->next");
+        out.println("};\n");
+
+        out.println("static CLASS AppImage_classes[] = {");
+        for (Enumeration e = classes.elements(); e.hasMoreElements(); ) {
+            out.print("\t(CLASS)");
+            classTable.tableEntry(out, 0, e.nextElement());
+            out.println(",");
+        }
+        out.println("};\n");
+
+        int nameCount = nameTable.getCount() - nameTable.getBaseCount();
+        int classCount = classTable.getCount() - classTable.getBaseCount();
+        int stringCount = stringTable.stringHashTable.getCount();
+
+        String descriptor[] = {
+            "struct appImageStruct KVM_AppImage = {",
+            "\tAPP_IMAGE_MAGIC,",
+            "\tAPP_IMAGE_VERSION,",
+            "\t{ " + nameTable.getBaseCount() + ", "
+                   + classTable.getBaseCount() + ", "
+                   + baseStringCount + " },",
+            "\t{ " + nameCount + ", " + classCount + ", " + stringCount + " },",
+            "\tsizeof(AppImage_buckets) / sizeof(AppImage_buckets[0]),",
+            "\tAppImage_buckets,",
+            "\tsizeof(AppImage_links) / sizeof(AppImage_links[0]),",
+            "\tAppImage_links,",
+            "\tsizeof(AppImage_classes) / sizeof(AppImage_classes[0]),",
+            "\tAppImage_classes,",
+            "\t" + stringCount + ",",
+            "\t" + ((stringCount > 0) ? "stringArrayInternal" : "NULL") + ",",
+            "\t" + (stringTable.hasCharacterArray
+                    ? "(SHORTARRAY)&" + KVMStringTable.charArrayName : "NULL")
+                 + ",",
+            "\t" + staticStoreName + ",",
+            "\t(long *)&" + masterStaticStoreName + ",",
+            "\tsizeof(" + staticStoreName + "),",
+            "\t(char *)&AllClassblocks,",
+            "\tsizeof(AllClassblocks)",
+            "};",
+            "",
+            "#endif /* ENABLE_APP_IMAGE */",
+            "",
+            "#endif"
+        };
+        for (int i = 0; i < descriptor.length; i++) {
+            out.println(descriptor[i]);
+        }
+    }
+}
@@ -11,6 +11,8 @@ import components.StringConstant;
 import components.UnicodeConstant;
 import java.util.Hashtable;
 import java.util.Enumeration;
+import java.util.Arrays;
+import java.util.Comparator;
 
 /**
  *
@@ -31,8 +33,8 @@ import java.util.Enumeration;
  * We enter them in a Str2ID structure, which will be wanted
  * at runtime. And we assign layout of the runtime char[] data.
  * Much aliasing of data is possible, since this is read-only and
- * not usually zero-terminated. We won't do any of that, for now.
- * There is much potential here.
+ * not usually zero-terminated. A string that is contained in another
+ * one shares its data.
  */
 
 public class StringTable {
@@ -41,6 +43,7 @@ public class StringTable {
     public StringBuffer data;
     private int        aggregateSize;
     private int        stringIndex = 0;
+    public int        sharedChars;    // characters not written, for statistics
 
     public void intern( StringConstant s ){
     StringConstant t = (StringConstant)htable.get( s );
@@ -69,18 +72,39 @@ public class StringTable {
      */
     public int arrangeStringData(){
     /*
-     * Our initial guess is simply to concatenate all the data.
-     * Later, we can try to be cleverer.
+     * Concatenate the data, longest strings first, and point each
+     * string that is already contained in the data at that copy.
      */
-    data = new StringBuffer( aggregateSize );
-    int curOffset = 0;
+    StringConstant all[] = new StringConstant[ htable.size() ];
+    int n = 0;
     Enumeration s = allStrings();
     while ( s.hasMoreElements() ){
-        StringConstant t = (StringConstant)s.nextElement();
-        t.unicodeOffset = curOffset;
-        data.append( t.str.string );
-        curOffset += t.str.string.length();
+        all[n++] = (StringConstant)s.nextElement();
+    }
+    Arrays.sort( all, new Comparator() {
+        public int compare( Object o1, Object o2 ){
+        String s1 = ((StringConstant)o1).str.string;
+        String s2 = ((StringConstant)o2).str.string;
+        if ( s1.length() != s2.length() ){
+            return s2.length() - s1.length();
+        }
+        return s1.compareTo( s2 );
+        }
+    });
+    data = new StringBuffer( aggregateSize );
+    sharedChars = 0;
+    for ( int i = 0; i < n; i++ ){
+        StringConstant t = all[i];
+        String string = t.str.string;
+        int offset = data.indexOf( string );
+        if ( offset >= 0 ){
+        t.unicodeOffset = offset;
+        sharedChars += string.length();
+        } else {
+        t.unicodeOffset = data.length();
+        data.append( string );
+        }
     }
-    return curOffset;
+    return data.length();
     }
 }
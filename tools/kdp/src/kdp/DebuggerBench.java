@@ -0,0 +1,210 @@
+/*
+ * Copyright 2003 Sun Microsystems, Inc. All rights reserved.
+ * SUN PROPRIETARY/CONFIDENTIAL. Use is subject to license terms.
+ */
+
+package kdp;
+
+import java.net.*;
+import java.io.*;
+
+/**
+ * Measures how fast the KVM debugger agent answers the large requests
+ * that a debugger makes when it attaches or stops: the list of all
+ * classes and the stack frames of all threads.  The benchmark talks
+ * to the KVM directly, the same way the proxy does, so the times
+ * don't include the proxy.  Usage:
+ *
+ * <pre>
+ *   kvm -debugger -nosuspend -port 2800 -classpath app.jar app.Main &amp;
+ *   java kdp.DebuggerBench [-host name] [-port 2800] [-count 200]
+ *                          [-pipeline 8] [-warmup ms]
+ * </pre>
+ *
+ * After letting the application run for the warm-up time, the VM is
+ * suspended and each request is sent <i>count</i> times, first one at
+ * a time and then with up to <i>pipeline</i> requests in flight.  One
+ * JSON line is printed for each run, e.g.
+ *
+ * <pre>
+ * {"subsystem":"debugger","benchmark":"allClasses","pipeline":8,
+ *  "iterations":200,"ms":412,"unit":"reply","perSecond":485,
+ *  "replyBytes":21874}
+ * </pre>
+ *
+ * (on a single line).  The VM is told to exit when the benchmark is done.
+ */
+public class DebuggerBench implements VMConstants {
+
+    static final int FRAMES_CMD = 6;
+    static final int SUSPEND_CMD = 8;
+
+    Socket socket;
+    DataInputStream in;
+    DataOutputStream out;
+    int nextID = 1;
+    int[] threads;
+    long replyBytes;
+
+    public static void main(String[] args) throws Exception {
+        String host = "localhost";
+        int port = 2800;
+        int count = 200;
+        int pipeline = 8;
+        long warmup = 2000;
+
+        for (int i = 0; i + 1 < args.length; i += 2) {
+            if (args[i].equals("-host")) {
+                host = args[i + 1];
+            } else if (args[i].equals("-port")) {
+                port = Integer.parseInt(args[i + 1]);
+            } else if (args[i].equals("-count")) {
+                count = Integer.parseInt(args[i + 1]);
+            } else if (args[i].equals("-pipeline")) {
+                pipeline = Integer.parseInt(args[i + 1]);
+            } else if (args[i].equals("-warmup")) {
+                warmup = Long.parseLong(args[i + 1]);
+            } else {
+                System.err.println("Unknown option " + args[i]);
+                System.exit(1);
+            }
+        }
+
+        DebuggerBench bench = new DebuggerBench();
+        bench.connect(host, port);
+        Thread.sleep(warmup);
+        bench.suspend();
+        bench.run("allClasses", VIRTUALMACHINE_CMDSET, ALL_CLASSES_CMD,
+                  count, 1);
+        bench.run("allClasses", VIRTUALMACHINE_CMDSET, ALL_CLASSES_CMD,
+                  count, pipeline);
+        bench.run("frames", THREADREFERENCE_CMDSET, FRAMES_CMD, count, 1);
+        bench.run("frames", THREADREFERENCE_CMDSET, FRAMES_CMD,
+                  count, pipeline);
+        bench.exit();
+    }
+
+    void connect(String host, int port) throws IOException {
+        while (socket == null) {
+            try {
+                socket = new Socket(host, port);
+            } catch (ConnectException e) {
+                System.err.println("KVM not ready");
+                try {
+                    Thread.sleep(500);
+                } catch (InterruptedException ie) {}
+            }
+        }
+        socket.setTcpNoDelay(true);
+        in = new DataInputStream(
+                 new BufferedInputStream(socket.getInputStream()));
+        out = new DataOutputStream(
+                 new BufferedOutputStream(socket.getOutputStream()));
+
+        ByteArrayOutputStream data = new ByteArrayOutputStream();
+        DataOutputStream d = new DataOutputStream(data);
+        byte[] name = "KVM Reference Debugger Agent".getBytes();
+        d.writeInt(name.length);
+        d.write(name);
+        d.writeByte(1);     /* major version */
+        d.writeByte(2);     /* minor version */
+        send(KVM_CMDSET, KVM_HANDSHAKE_CMD, data.toByteArray());
+        out.flush();
+        receiveReply();
+    }
+
+    void suspend() throws IOException {
+        send(VIRTUALMACHINE_CMDSET, SUSPEND_CMD, new byte[0]);
+        out.flush();
+        receiveReply();
+
+        send(VIRTUALMACHINE_CMDSET, ALL_THREADS_CMD, new byte[0]);
+        out.flush();
+        DataInputStream reply = receiveReply();
+        threads = new int[reply.readInt()];
+        for (int i = 0; i < threads.length; i++) {
+            threads[i] = reply.readInt();
+        }
+    }
+
+    void exit() throws IOException {
+        ByteArrayOutputStream data = new ByteArrayOutputStream();
+        new DataOutputStream(data).writeInt(0);
+        send(VIRTUALMACHINE_CMDSET, EXIT_CMD, data.toByteArray());
+        out.flush();
+        socket.close();
+    }
+
+    /*
+     * Send the command count times, keeping up to pipeline commands
+     * in flight, and print the time it took to get all the replies.
+     */
+    void run(String name, int cmdSet, int cmd, int count, int pipeline)
+        throws IOException {
+        int sent = 0;
+        int received = 0;
+
+        replyBytes = 0;
+        long start = System.currentTimeMillis();
+        while (received < count) {
+            while (sent < count && sent - received < pipeline) {
+                send(cmdSet, cmd, arguments(cmdSet, sent));
+                sent++;
+            }
+            out.flush();
+            receiveReply();
+            received++;
+        }
+        long time = System.currentTimeMillis() - start;
+
+        long perSecond = (time == 0) ? 0 : (count * 1000L) / time;
+        System.out.println("{\"subsystem\":\"debugger\",\"benchmark\":\""
+                           + name + "\",\"pipeline\":" + pipeline
+                           + ",\"iterations\":" + count
+                           + ",\"ms\":" + time
+                           + ",\"unit\":\"reply\",\"perSecond\":" + perSecond
+                           + ",\"replyBytes\":" + (replyBytes / count) + "}");
+    }
+
+    byte[] arguments(int cmdSet, int index) throws IOException {
+        ByteArrayOutputStream data = new ByteArrayOutputStream();
+        if (cmdSet == THREADREFERENCE_CMDSET) {
+            DataOutputStream d = new DataOutputStream(data);
+            d.writeInt(threads[index % threads.length]);
+            d.writeInt(0);      /* first frame */
+            d.writeInt(-1);     /* all frames */
+        }
+        return data.toByteArray();
+    }
+
+    void send(int cmdSet, int cmd, byte[] data) throws IOException {
+        out.writeInt(11 + data.length);
+        out.writeInt(nextID++);
+        out.writeByte(0);
+        out.writeByte(cmdSet);
+        out.writeByte(cmd);
+        out.write(data);
+    }
+
+    /*
+     * Read packets until a reply arrives; events sent by the VM
+     * in the meantime are ignored.
+     */
+    DataInputStream receiveReply() throws IOException {
+        for (;;) {
+            int length = in.readInt();
+            in.readInt();       /* id */
+            byte flags = in.readByte();
+            short error = in.readShort();
+            byte[] data = new byte[length - 11];
+            in.readFully(data);
+            if ((flags & Packet.Reply) != 0) {
+                if (error != 0) {
+                    throw new IOException("Error " + error + " from KVM");
+                }
+                replyBytes += length;
+                return new DataInputStream(new ByteArrayInputStream(data));
+            }
+        }
+    }
+}
@@ -35,6 +35,7 @@
 
 #ifdef UNIX
 #include <unistd.h>
+#include <sys/wait.h>
 #endif
 
 #include <oobj.h>
@@ -752,6 +753,182 @@ VerifyFile(char *fn)
     }
 }
 
+/*=========================================================================
+ * FUNCTION:      AddClassToList()
+ * TYPE:          Collects classes to be verified
+ * OVERVIEW:      Appends a copy of a class name to a class list.
+ *
+ * INTERFACE:
+ *   parameters:  list:  the class list
+ *                name:  class name in the form expected by VerifyFile()
+ *   returns:     nothing
+ *=======================================================================*/
+
+void
+AddClassToList(classlist_t *list, char *name)
+{
+    if (list->count == list->size) {
+        list->size = (list->size == 0) ? 64 : list->size * 2;
+        list->names = (char **)realloc(list->names,
+                                       list->size * sizeof(char *));
+        if (list->names == NULL) {
+            panic("out of memory");
+        }
+    }
+    list->names[list->count] = strdup(name);
+    if (list->names[list->count] == NULL) {
+        panic("out of memory");
+    }
+    list->count++;
+}
+
+/*=========================================================================
+ * FUNCTION:      VerifyClassList()
+ * TYPE:          Verifies the collected classes
+ * OVERVIEW:      Calls VerifyFile() for all classes of a class list and
+ *                empties the list.
+ *
+ *  With -j N (N > 1) the list is split into N contiguous parts that are
+ *  verified by forked worker processes.  Each worker has its own copy of
+ *  the loaded classes, string tables and the rest of the global state of
+ *  the verifier, so none of it needs locking.  Every class is written
+ *  to its own file by WriteClass(), and the JAR file is only created
+ *  after all workers have finished.  The output of each worker is
+ *  collected in temporary files and copied to stdout and stderr in
+ *  worker order, so that the messages appear in the same order as in
+ *  a sequential run.  If a worker stops with a fatal error, the whole
+ *  program stops once all workers have finished.
+ *
+ * INTERFACE:
+ *   parameters:  list:  the class list
+ *   returns:     nothing
+ *=======================================================================*/
+
+#ifdef UNIX
+
+/* Exit status of a worker that verified all of its classes */
+#define WORKER_DONE          0x10
+#define WORKER_ERROR         0x01  /* errorCode was set */
+#define WORKER_WROTE_CLASSES 0x02  /* tmpDirExists was set */
+
+static void
+copyWorkerLog(FILE *log, FILE *out)
+{
+    char buf[BUFSIZ];
+    size_t n;
+
+    rewind(log);
+    while ((n = fread(buf, 1, sizeof(buf), log)) > 0) {
+        fwrite(buf, 1, n, out);
+    }
+    fclose(log);
+}
+
+static void
+verifyInWorkers(classlist_t *list, int workers)
+{
+    pid_t *pids = (pid_t *)malloc(workers * sizeof(pid_t));
+    FILE **logs = (FILE **)malloc(2 * workers * sizeof(FILE *));
+    bool_t failed = FALSE;
+    int i, w;
+
+    if (pids == NULL || logs == NULL) {
+        panic("out of memory");
+    }
+
+    /* Load the classes every worker needs only once */
+    FindClass(0, "java/lang/Object", TRUE);
+
+    for (w = 0; w < workers; w++) {
+        int start = (int)((long)list->count * w / workers);
+        int end = (int)((long)list->count * (w + 1) / workers);
+
+        logs[2 * w] = tmpfile();
+        logs[2 * w + 1] = tmpfile();
+        if (logs[2 * w] == NULL || logs[2 * w + 1] == NULL) {
+            panic("cannot create temporary file");
+        }
+
+        fflush(stdout);
+        fflush(stderr);
+        pids[w] = fork();
+        if (pids[w] == 0) {
+            dup2(fileno(logs[2 * w]), fileno(stdout));
+            dup2(fileno(logs[2 * w + 1]), fileno(stderr));
+            for (i = start; i < end; i++) {
+                VerifyFile(list->names[i]);
+            }
+            fflush(stdout);
+            fflush(stderr);
+            exit(WORKER_DONE
+                 | (errorCode ? WORKER_ERROR : 0)
+                 | (tmpDirExists ? WORKER_WROTE_CLASSES : 0));
+        } else if (pids[w] < 0) {
+            /* Could not create a worker; do its part ourselves */
+            for (i = start; i < end; i++) {
+                VerifyFile(list->names[i]);
+            }
+        }
+    }
+
+    for (w = 0; w < workers; w++) {
+        if (pids[w] > 0) {
+            int status;
+            if (waitpid(pids[w], &status, 0) != pids[w] ||
+                !WIFEXITED(status) ||
+                (WEXITSTATUS(status) & ~(WORKER_ERROR | WORKER_WROTE_CLASSES))
+                    != WORKER_DONE) {
+                failed = TRUE;
+            } else {
+                if (WEXITSTATUS(status) & WORKER_ERROR) {
+                    errorCode = 1;
+                }
+                if (WEXITSTATUS(status) & WORKER_WROTE_CLASSES) {
+                    tmpDirExists = TRUE;
+                }
+            }
+        }
+        fflush(stdout);
+        fflush(stderr);
+        copyWorkerLog(logs[2 * w], stdout);
+        copyWorkerLog(logs[2 * w + 1], stderr);
+    }
+
+    free(pids);
+    free(logs);
+    if (failed) {
+        exit(1);
+    }
+}
+
+#endif /* UNIX */
+
+void
+VerifyClassList(classlist_t *list)
+{
+    int i;
+    int workers = (verify_jobs < list->count) ? verify_jobs : list->count;
+
+#ifdef UNIX
+    if (workers > 1) {
+        verifyInWorkers(list, workers);
+    } else
+#endif
+    {
+        for (i = 0; i < list->count; i++) {
+            VerifyFile(list->names[i]);
+        }
+    }
+
+    for (i = 0; i < list->count; i++) {
+        free(list->names[i]);
+    }
+    free(list->names);
+    list->names = NULL;
+    list->count = 0;
+    list->size = 0;
+}
+
 char *PrintableClassname(char *class_name)
 {
     char *p;
@@ -57,7 +57,6 @@ extern char *output_dir;   /* output directory */
 
 char manifestfile[1024];   /* used for saving the JAR manifest file name */
 
-extern void VerifyFile(register char *fn);
 
 /*=========================================================================
  * FUNCTION:      isJARfile
@@ -530,10 +529,10 @@ loadJARfile(zip_t *entry, const char* filename)
  * OVERVIEW:      Internal function used by ProcessInputs() and recurse_dir.
  *
  *  This function reads all the Zip entries, and stores them temporarily in
- *  tmpdir. If the ZIP entry read is a class file, then VerifyFile is invoked
- *  to verify the class file. Otherwise, the file read is simply copied over
- *  temporarily to the tmpdir. These are later used for generating a new JAR
- *  file.
+ *  tmpdir. The class files found are verified with VerifyClassList()
+ *  once all entries have been read (possibly in parallel, see -j). Other
+ *  files are simply copied over temporarily to the tmpdir. These are later
+ *  used for generating a new JAR file.
  *
  * INTERFACE:
  *   parameters:  ZipEntry:  name of the zip file entry.
@@ -553,8 +552,10 @@ ReadFromZip(zip_t *entry)
     struct stat stat_buf;
     unsigned char *decompData;
     unsigned long decompLen;     /* the decompressed length */
+    classlist_t classes;
 
     FILE *file = fopen(entry->name, "rb");
+    memset(&classes, 0, sizeof(classes));
     if (file == NULL) {
         goto done;
     }
@@ -597,9 +598,7 @@ ReadFromZip(zip_t *entry)
 
         memcpy(filename, p + CENHDRSIZ, nameLength);
 
-        /* We have to calculate nextOffset now, because VerifyFile bashes
-         * str_buffer
-         */
+        /* Calculate the offset of the next central header */
         nextOffset = offset + CENHDRSIZ + nameLength + CENEXT(p) + CENCOM(p);
 
         if (JAR_DEBUG && verbose)
@@ -621,8 +620,8 @@ ReadFromZip(zip_t *entry)
                 jio_fprintf(stderr,
                  "ReadFromZip: Verifying classfile %s\n", filename);
 
-            /* call VerifyFile to verify the class */
-            VerifyFile(filename);
+            /* the class is verified after all entries have been read */
+            AddClassToList(&classes, filename);
         } else {
             /* Read and copy over the file to tmpdir */
             /* p points at the central header for the file */
@@ -809,6 +808,9 @@ done:
         fclose(file);
     }
 
+    /* VerifyFile bashes str_buffer, so this must happen last */
+    VerifyClassList(&classes);
+
     if (jdstream != NULL) {
 
         jdstream->type = JAR_RESOURCE;
@@ -47,6 +47,7 @@ bool_t no_finalizers = FALSE;
 char tmp_dir[32];                /* temporary directory */
 extern char *output_dir;         /* output directory */
 bool_t tmpDirExists = FALSE;
+int verify_jobs = 1;             /* number of worker processes */
 
 extern void VerifyFile(register char *fn);
 extern bool_t ProcessJARfile(char *buf, int len);
@@ -62,12 +63,16 @@ static void usage(char *progname);
  *  This function reads a directory, searching for either another directory,
  *  JAR file or an individual class name that is to be verified.
  *
+ *  The classes found are added to a class list, which is verified
+ *  by the caller.
+ *
  * INTERFACE:
  *   parameters:  dirname   name of the directory entry. 
  *                pkgname   name of the package
+ *                classes   list of classes to be verified
  *   returns:     nothing 
  *=======================================================================*/
-static void recurse_dir(char *dirname, char *pkgname)
+static void recurse_dir(char *dirname, char *pkgname, classlist_t *classes)
 {
     struct dirent *ent;
         char buf[MAXPACKAGENAME];
@@ -112,7 +117,7 @@ static void recurse_dir(char *dirname, char *pkgname)
                 jio_fprintf(stderr, 
                    "recurse_dir: Recursive directory found, calling recurse_dir ([%s] [%s])\n",
                        buf, pkgbuf);
-            recurse_dir(buf, pkgbuf);
+            recurse_dir(buf, pkgbuf, classes);
             continue;
         } else if (isJARfile (buf, len)) {
          
@@ -125,6 +130,9 @@ static void recurse_dir(char *dirname, char *pkgname)
                     jio_fprintf(stderr, 
                      "recurse_dir: Found JAR file [%s] in dir!\n", buf);
 
+                /* verify the classes found so far before the JAR file */
+                VerifyClassList(classes);
+
                 if (!ProcessJARfile(buf, len)) {
 
                 fprintf(stderr, "Not a valid JAR file [%s]\n", buf);
@@ -142,7 +150,7 @@ static void recurse_dir(char *dirname, char *pkgname)
                     if (JAR_DEBUG && verbose)
                     jio_fprintf(stderr, 
                 "recurse_dir: Verifying Class [%s] \n", pkgbuf);
-            VerifyFile(pkgbuf);
+            AddClassToList(classes, pkgbuf);
         }
     }
 
@@ -178,6 +186,9 @@ static void ProcessInputs(char *argname)
     
     
     if ((res == 0) && (stat_buf.st_mode & S_IFDIR)) {
+        classlist_t classes;
+        memset(&classes, 0, sizeof(classes));
+
         /* Append dir separator if it does not yet exist. */
         if (buf[len - 1] != LOCAL_DIR_SEPARATOR &&
         buf[len - 1] != DIR_SEPARATOR) {
@@ -185,7 +196,8 @@ static void ProcessInputs(char *argname)
         buf[len + 1] = 0;
         }
         pushDirectoryOntoClassPath(buf);
-        recurse_dir(buf, "");
+        recurse_dir(buf, "", &classes);
+        VerifyClassList(&classes);
         popClassPath();
     } else if ((res == 0) && (isJARfile (buf, len))) {
         /* the classes to be verified are in a JAR file */
@@ -268,6 +280,15 @@ int main(argc, argv)
             } else if (strcmp(argv[0], "-d") == 0) {
                 output_dir = strdup(argv[1]);
         argc--; argv++;
+            } else if (strcmp(argv[0], "-j") == 0) {
+                if (argc > 1 && atoi(argv[1]) > 0) {
+                    verify_jobs = atoi(argv[1]);
+                    argc--; argv++;
+                } else {
+                    fprintf(stderr, "-j requires a number of processes\n");
+                    usage(progname);
+                    exit(1);
+                }
         } else if (strcmp(argv[0], "-classpath") == 0) {
         if (argc > 1) {
             char *buf = (char *)malloc(strlen(argv[1]) + 32);
@@ -413,6 +434,7 @@ static void usage(char *progname) {
     fprintf(stderr, "   -nofinalize    No finalizers allowed\n");
     fprintf(stderr, "   -nonative      No native methods allowed\n");
     fprintf(stderr, "   -nofp          No floating point operations allowed\n");
+    fprintf(stderr, "   -j <number>    Number of classes preverified in parallel (default is 1)\n");
     fprintf(stderr, "   @<filename>    Read command line arguments from a text file\n");
     fprintf(stderr, "                  Command line arguments must all be on a single line\n");
     fprintf(stderr, "                  Directory names must be enclosed in double quotes (\")\n");
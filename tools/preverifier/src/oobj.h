@@ -655,6 +655,18 @@ void printCurrentClassName(void);
 void ensure_dir_exists(char *dir);
 void ensure_dir_writable(char *dir);
 
+/* Classes collected for verification by VerifyClassList() */
+typedef struct classlist {
+    char **names;
+    int count;
+    int size;
+} classlist_t;
+
+void AddClassToList(classlist_t *list, char *name);
+void VerifyClassList(classlist_t *list);
+
+extern int verify_jobs;       /* number of worker processes (-j) */
+
 extern bool_t no_native_methods;
 extern bool_t no_floating_point;
 extern bool_t no_finalizers;